@@ -0,0 +1,41 @@
+// annotation_history.cpp
+#include "annotation_history.h"
+
+void EditJournal::record(const BoxEdit& e)
+{
+    // redo kuyruğunu kes
+    if (m_pos < m_ops.size())
+        m_ops.resize(m_pos);
+
+    m_ops.push_back(e);
+    m_pos = m_ops.size();
+
+    // Sınır: %25 taşınca en eskileri tek seferde at (her kayıtta kaydırma yok)
+    if (m_ops.size() > m_max + m_max / 4) {
+        // Son eylemin başı: en az o eylem her zaman kalır (yoksa Ctrl+Z boşa düşer)
+        int current = m_ops.size() - 1;
+        while (current > 0 && m_ops[current].joinPrev) --current;
+
+        int drop = m_ops.size() - m_max;
+        // Bir eylemi ortadan bölme: joinPrev zincirinin ortasında kesme
+        while (drop < current && m_ops[drop].joinPrev) ++drop;
+        drop = qMin(drop, current);
+        if (drop <= 0) return;                      // tek dev eylem: bölünmez, olduğu gibi kalır
+        m_ops.remove(0, drop);
+        m_pos -= drop;
+        if (!m_ops.isEmpty()) m_ops[0].joinPrev = false;
+    }
+}
+
+const BoxEdit* EditJournal::undo()
+{
+    if (!canUndo()) return nullptr;
+    --m_pos;
+    return &m_ops[m_pos];
+}
+
+const BoxEdit* EditJournal::redo()
+{
+    if (!canRedo()) return nullptr;
+    return &m_ops[m_pos++];
+}
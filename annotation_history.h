@@ -0,0 +1,47 @@
+// annotation_history.h
+#pragma once
+
+#include <QVector>
+#include <QtGlobal>
+
+// Tek bir kutu düzenlemesi (delta). Kutu listesinin tamamı değil, sadece
+// değişen kutunun önce/sonra hali saklanır → kayıt başına ~40 byte.
+struct BoxEdit
+{
+    enum class Op : quint8 { Create, Move, Resize, Delete, ClassChange };
+
+    Op      op        = Op::Create;
+    bool    joinPrev  = false;   // önceki kayıtla aynı kullanıcı eylemi (tek Ctrl+Z ile geri alınır)
+    qint16  clsBefore = 0;
+    qint16  clsAfter  = 0;
+    qint32  index     = -1;      // m_boxes içindeki konum
+    float   before[4] {};        // x, y, w, h (sahne px)
+    float   after[4]  {};
+};
+
+// Görsel başına undo/redo günlüğü.
+//  - [0, pos) uygulanmış, [pos, size) redo için bekleyen kayıtlar
+//  - yeni kayıt redo kuyruğunu keser
+//  - kapasite aşılınca en eski kayıtlar toplu silinir (amortize O(1))
+class EditJournal
+{
+public:
+    explicit EditJournal(int maxOps = 500) : m_max(qMax(8, maxOps)) {}
+
+    void record(const BoxEdit& e);
+
+    // Geri alınacak/yinelenecek kaydı döndürür ve imleci kaydırır; yoksa nullptr
+    const BoxEdit* undo();
+    const BoxEdit* redo();
+    const BoxEdit* peekRedo() const { return canRedo() ? &m_ops[m_pos] : nullptr; }
+
+    bool canUndo() const { return m_pos > 0; }
+    bool canRedo() const { return m_pos < m_ops.size(); }
+    void clear()         { m_ops.clear(); m_pos = 0; }
+    int  size() const    { return m_ops.size(); }
+
+private:
+    QVector<BoxEdit> m_ops;
+    int              m_pos = 0;
+    int              m_max;
+};
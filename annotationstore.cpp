@@ -0,0 +1,722 @@
+// annotationstore.cpp
+#include "annotationstore.h"
+#include "label_serializer.h"
+#include "dirscanner.h"
+#include "imagesizecache.h"
+#include "labelcompare.h"       // parseVOCxml
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QDebug>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+namespace {
+
+constexpr char    kMagic[8]  = {'A','N','N','S','T','O','R','1'};
+constexpr quint32 kVersion   = 1;
+constexpr quint32 kWalMagic  = 0x314C4157;   // "WAL1"
+
+// Taban dosya başlığı. Bölümler 8 byte hizalı; sayılar yerel (little-endian) düzende.
+struct FileHeader
+{
+    char    magic[8];
+    quint32 version;
+    quint32 imageCount;
+    quint64 boxCount;
+    quint32 classCount;
+    quint32 reserved;
+    quint64 offStemIdx, offStemBytes, offWidth, offHeight, offFirstBox;
+    quint64 offCls, offX1, offY1, offX2, offY2;
+    quint64 offClassIdx, offClassBytes;
+    quint64 fileSize;
+};
+static_assert(sizeof(FileHeader) == 136, "FileHeader layout");
+
+inline quint64 align8(quint64 v) { return (v + 7) & ~quint64(7); }
+
+quint32 fnv32(const char* p, qsizetype n)
+{
+    quint32 h = 2166136261u;
+    for (qsizetype i = 0; i < n; ++i) { h ^= quint8(p[i]); h *= 16777619u; }
+    return h;
+}
+
+template <typename T>
+void appendPod(QByteArray& out, const T& v) { out.append(reinterpret_cast<const char*>(&v), sizeof(T)); }
+
+template <typename T>
+bool readPod(const char*& p, const char* end, T* v)
+{
+    if (end - p < qsizetype(sizeof(T))) return false;
+    memcpy(v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+void setErr(QString* err, const QString& msg) { if (err) *err = msg; }
+
+// Hedefi tek adımda değiştir: arada hiçbir an hedefsiz kalınmaz (QFile::rename üzerine yazmaz)
+bool replaceFile(const QString& from, const QString& to)
+{
+#ifdef Q_OS_WIN
+    return MoveFileExW(reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(from).utf16()),
+                       reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(to).utf16()),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) == 0;
+#endif
+}
+
+} // namespace
+
+// ---------------------------
+// mmap edilmiş taban
+// ---------------------------
+struct AnnotationStore::Base
+{
+    QFile          file;
+    uchar*         map    = nullptr;
+    quint32        images = 0;
+    quint64        boxes  = 0;
+    const quint32* stemIdx   = nullptr;
+    const char*    stemBytes = nullptr;
+    const quint32* width     = nullptr;
+    const quint32* height    = nullptr;
+    const quint32* firstBox  = nullptr;
+    const qint32*  cls = nullptr;
+    const float   *x1 = nullptr, *y1 = nullptr, *x2 = nullptr, *y2 = nullptr;
+    QStringList    classes;
+
+    ~Base() { if (map) file.unmap(map); }
+
+    QByteArray stemBytesAt(int i) const {
+        return QByteArray::fromRawData(stemBytes + stemIdx[i], int(stemIdx[i+1] - stemIdx[i]));
+    }
+    QString stemAt(int i) const {
+        return QString::fromUtf8(stemBytes + stemIdx[i], int(stemIdx[i+1] - stemIdx[i]));
+    }
+    ImageView view(int i) const {
+        ImageView v;
+        v.stem  = stemAt(i);
+        v.size  = QSize(int(width[i]), int(height[i]));
+        const quint32 b = firstBox[i];
+        v.count = int(firstBox[i+1] - b);
+        v.cls = cls + b; v.x1 = x1 + b; v.y1 = y1 + b; v.x2 = x2 + b; v.y2 = y2 + b;
+        return v;
+    }
+};
+
+AnnotationStore::AnnotationStore(QObject* parent)
+    : QObject(parent)
+{
+    m_io.setMaxThreadCount(1);                        // WAL sırası = kayıt sırası
+    m_jobs.setMaxThreadCount(1);
+}
+
+AnnotationStore::~AnnotationStore()
+{
+    m_jobs.waitForDone();                             // dışa aktarım bu nesneye dokunuyor
+    close();
+}
+
+// ---------------------------
+// Açma / kapama
+// ---------------------------
+bool AnnotationStore::open(const QString& path, QString* err)
+{
+    close();
+    if (!QFileInfo::exists(path) && !writeBase(path, {}, {}, err)) return false;
+
+    auto base = mapBase(path, err);
+    if (!base) return false;
+
+    QMutexLocker lk(&m_mutex);
+    m_path    = path;
+    m_base    = base;
+    m_classes = base->classes;
+    m_overlay.clear();
+    m_putAt.clear();
+    m_wal.setFileName(path + ".wal");
+    if (!m_wal.open(QIODevice::ReadWrite)) {
+        setErr(err, m_wal.errorString());
+        m_base.reset();
+        return false;
+    }
+    if (!replayWal(err)) {
+        m_wal.close();
+        m_base.reset();
+        return false;
+    }
+    m_open = true;
+    qDebug() << "[AnnStore] opened" << path << "images =" << base->images
+             << "boxes =" << base->boxes << "wal =" << m_overlay.size();
+    return true;
+}
+
+void AnnotationStore::close()
+{
+    m_io.waitForDone();                               // bekleyen WAL kayıtları diske insin
+    QMutexLocker lk(&m_mutex);
+    if (m_wal.isOpen()) m_wal.close();
+    m_base.reset();
+    m_overlay.clear();
+    m_putAt.clear();
+    m_open = false;
+}
+
+std::shared_ptr<AnnotationStore::Base> AnnotationStore::mapBase(const QString& path, QString* err)
+{
+    auto b = std::make_shared<Base>();
+    b->file.setFileName(path);
+    if (!b->file.open(QIODevice::ReadOnly)) { setErr(err, b->file.errorString()); return {}; }
+
+    const qint64 size = b->file.size();
+    if (size < qint64(sizeof(FileHeader))) { setErr(err, "store: truncated header"); return {}; }
+    b->map = b->file.map(0, size);
+    if (!b->map) { setErr(err, "store: mmap failed"); return {}; }
+
+    FileHeader h;
+    memcpy(&h, b->map, sizeof(h));
+    if (memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion
+        || h.fileSize != quint64(size)) {
+        setErr(err, "store: bad header");
+        return {};
+    }
+
+    const quint64 n = h.imageCount, m = h.boxCount, c = h.classCount;
+    const auto inside = [size](quint64 off, quint64 len){
+        return off % 4 == 0 && off <= quint64(size) && len <= quint64(size) - off;
+    };
+    if (!inside(h.offStemIdx, 4*(n+1)) || !inside(h.offWidth, 4*n) || !inside(h.offHeight, 4*n)
+        || !inside(h.offFirstBox, 4*(n+1)) || !inside(h.offCls, 4*m)
+        || !inside(h.offX1, 4*m) || !inside(h.offY1, 4*m) || !inside(h.offX2, 4*m) || !inside(h.offY2, 4*m)
+        || !inside(h.offClassIdx, 4*(c+1))) {
+        setErr(err, "store: section out of range");
+        return {};
+    }
+
+    const uchar* p = b->map;
+    b->images    = h.imageCount;
+    b->boxes     = h.boxCount;
+    b->stemIdx   = reinterpret_cast<const quint32*>(p + h.offStemIdx);
+    b->stemBytes = reinterpret_cast<const char*>(p + h.offStemBytes);
+    b->width     = reinterpret_cast<const quint32*>(p + h.offWidth);
+    b->height    = reinterpret_cast<const quint32*>(p + h.offHeight);
+    b->firstBox  = reinterpret_cast<const quint32*>(p + h.offFirstBox);
+    b->cls       = reinterpret_cast<const qint32*>(p + h.offCls);
+    b->x1        = reinterpret_cast<const float*>(p + h.offX1);
+    b->y1        = reinterpret_cast<const float*>(p + h.offY1);
+    b->x2        = reinterpret_cast<const float*>(p + h.offX2);
+    b->y2        = reinterpret_cast<const float*>(p + h.offY2);
+    if (!inside(h.offStemBytes, b->stemIdx[n]) || b->firstBox[n] != m) {
+        setErr(err, "store: inconsistent tables");
+        return {};
+    }
+
+    const quint32* ci = reinterpret_cast<const quint32*>(p + h.offClassIdx);
+    const char*    cb = reinterpret_cast<const char*>(p + h.offClassBytes);
+    if (!inside(h.offClassBytes, ci[c])) { setErr(err, "store: bad class table"); return {}; }
+    for (quint64 i = 0; i < c; ++i)
+        b->classes << QString::fromUtf8(cb + ci[i], int(ci[i+1] - ci[i]));
+    return b;
+}
+
+// ---------------------------
+// WAL
+// ---------------------------
+// Kayıt: [magic u32][len u32][payload][fnv32(payload) u32]
+// payload: [stemLen u16][stem][w u32][h u32][n u32][cls i32 × n][x1 f32 × n][y1][x2][y2]
+bool AnnotationStore::replayWal(QString* err)
+{
+    Q_UNUSED(err);
+    const QByteArray all = m_wal.readAll();
+    const char* p   = all.constData();
+    const char* end = p + all.size();
+    qint64 good = 0;
+
+    for (;;) {
+        quint32 magic = 0, len = 0, sum = 0;
+        if (!readPod(p, end, &magic) || magic != kWalMagic || !readPod(p, end, &len)) break;
+        if (end - p < qsizetype(len) + 4) break;
+        const char* pay = p;
+        p += len;
+        readPod(p, end, &sum);
+        if (sum != fnv32(pay, len)) break;                   // yarım yazılmış kayıt
+
+        const char* q = pay;
+        const char* qe = pay + len;
+        quint16 sl = 0; quint32 w = 0, h = 0, n = 0;
+        if (!readPod(q, qe, &sl) || qe - q < sl) break;
+        const QString stem = QString::fromUtf8(q, sl);
+        q += sl;
+        if (!readPod(q, qe, &w) || !readPod(q, qe, &h) || !readPod(q, qe, &n)) break;
+        if (quint64(qe - q) != quint64(n) * 20) break;
+
+        ImageRecord r;
+        r.size = QSize(int(w), int(h));
+        r.cls.resize(n); r.x1.resize(n); r.y1.resize(n); r.x2.resize(n); r.y2.resize(n);
+        memcpy(r.cls.data(), q, 4*n); q += 4*n;
+        memcpy(r.x1.data(),  q, 4*n); q += 4*n;
+        memcpy(r.y1.data(),  q, 4*n); q += 4*n;
+        memcpy(r.x2.data(),  q, 4*n); q += 4*n;
+        memcpy(r.y2.data(),  q, 4*n);
+        m_overlay.insert(stem, r);
+        m_putAt.insert(stem, m_putSeq);
+        good = (p - all.constData());
+    }
+
+    if (good < all.size()) {
+        qWarning() << "[AnnStore] WAL tail dropped at" << good << "of" << all.size();
+        m_wal.resize(good);
+    }
+    m_wal.seek(good);
+    return true;
+}
+
+QByteArray AnnotationStore::walRecord(const QString& stem, const ImageRecord& rec, QString* err)
+{
+    const QByteArray s = stem.toUtf8();
+    const quint32 n = quint32(rec.count());
+    if (s.size() > 0xFFFF) { setErr(err, "store: stem too long"); return {}; }
+
+    QByteArray payload;
+    payload.reserve(2 + s.size() + 12 + 20 * int(n));
+    appendPod(payload, quint16(s.size()));
+    payload.append(s);
+    appendPod(payload, quint32(qMax(0, rec.size.width())));
+    appendPod(payload, quint32(qMax(0, rec.size.height())));
+    appendPod(payload, n);
+    payload.append(reinterpret_cast<const char*>(rec.cls.constData()), 4*n);
+    payload.append(reinterpret_cast<const char*>(rec.x1.constData()),  4*n);
+    payload.append(reinterpret_cast<const char*>(rec.y1.constData()),  4*n);
+    payload.append(reinterpret_cast<const char*>(rec.x2.constData()),  4*n);
+    payload.append(reinterpret_cast<const char*>(rec.y2.constData()),  4*n);
+
+    QByteArray out;
+    out.reserve(payload.size() + 12);
+    appendPod(out, kWalMagic);
+    appendPod(out, quint32(payload.size()));
+    out.append(payload);
+    appendPod(out, fnv32(payload.constData(), payload.size()));
+    return out;
+}
+
+bool AnnotationStore::appendWal(const QByteArray& record, QString* err)
+{
+    QMutexLocker lk(&m_mutex);
+    if (!m_open) { setErr(err, "store: not open"); return false; }
+    if (m_wal.write(record) != record.size() || !m_wal.flush()) {
+        setErr(err, m_wal.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool AnnotationStore::putImage(const QString& stem, const ImageRecord& rec, QString* err)
+{
+    const QByteArray out = walRecord(stem, rec, err);
+    if (out.isEmpty() || !appendWal(out, err)) return false;
+    QMutexLocker lk(&m_mutex);
+    m_overlay.insert(stem, rec);
+    m_putAt.insert(stem, ++m_putSeq);
+    return true;
+}
+
+bool AnnotationStore::putImageAsync(const QString& stem, const ImageRecord& rec, QString* err)
+{
+    const QByteArray out = walRecord(stem, rec, err);
+    if (out.isEmpty()) return false;
+    {
+        QMutexLocker lk(&m_mutex);
+        if (!m_open) { setErr(err, "store: not open"); return false; }
+        m_overlay.insert(stem, rec);
+        m_putAt.insert(stem, ++m_putSeq);
+    }
+    m_io.start([this, out]{
+        QString e;
+        if (!appendWal(out, &e)) emit walWriteFailed(e);
+    });
+    return true;
+}
+
+// ---------------------------
+// Sorgu / gezinme
+// ---------------------------
+int AnnotationStore::findStem(const Base& b, const QByteArray& stem)
+{
+    int lo = 0, hi = int(b.images) - 1;
+    while (lo <= hi) {
+        const int mid = (lo + hi) / 2;
+        const QByteArray s = b.stemBytesAt(mid);
+        const int c = memcmp(s.constData(), stem.constData(), size_t(qMin(s.size(), stem.size())));
+        const int d = c != 0 ? c : int(s.size() - stem.size());
+        if (d == 0) return mid;
+        if (d < 0) lo = mid + 1; else hi = mid - 1;
+    }
+    return -1;
+}
+
+bool AnnotationStore::lookup(const QString& stem, ImageRecord* out) const
+{
+    QMutexLocker lk(&m_mutex);
+    if (!m_open) return false;
+    auto it = m_overlay.constFind(stem);
+    if (it != m_overlay.cend()) { *out = *it; return true; }
+
+    const int i = m_base ? findStem(*m_base, stem.toUtf8()) : -1;
+    if (i < 0) return false;
+    const ImageView v = m_base->view(i);
+    ImageRecord r;
+    r.size = v.size;
+    for (int k = 0; k < v.count; ++k) r.append(v.cls[k], v.x1[k], v.y1[k], v.x2[k], v.y2[k]);
+    *out = r;
+    return true;
+}
+
+int AnnotationStore::imageCount() const
+{
+    QMutexLocker lk(&m_mutex);
+    if (!m_base) return 0;
+    int n = int(m_base->images);
+    for (auto it = m_overlay.cbegin(); it != m_overlay.cend(); ++it)
+        if (findStem(*m_base, it.key().toUtf8()) < 0) ++n;
+    return n;
+}
+
+void AnnotationStore::forEachImage(const std::function<void(const ImageView&)>& fn) const
+{
+    std::shared_ptr<const Base> base;
+    QHash<QString, ImageRecord> overlay;      // implicit shared: kopya ucuz
+    {
+        QMutexLocker lk(&m_mutex);
+        base    = m_base;
+        overlay = m_overlay;
+    }
+
+    if (base) {
+        for (quint32 i = 0; i < base->images; ++i) {
+            if (!overlay.isEmpty() && overlay.contains(base->stemAt(int(i)))) continue;
+            fn(base->view(int(i)));
+        }
+    }
+    for (auto it = overlay.cbegin(); it != overlay.cend(); ++it) {
+        ImageView v;
+        v.stem  = it.key();
+        v.size  = it->size;
+        v.count = it->count();
+        v.cls = it->cls.constData(); v.x1 = it->x1.constData(); v.y1 = it->y1.constData();
+        v.x2  = it->x2.constData();  v.y2 = it->y2.constData();
+        fn(v);
+    }
+}
+
+QStringList AnnotationStore::classes() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_classes;
+}
+
+void AnnotationStore::setClasses(const QStringList& names)
+{
+    QMutexLocker lk(&m_mutex);
+    m_classes = names;
+}
+
+// ---------------------------
+// Taban yazımı
+// ---------------------------
+bool AnnotationStore::writeBase(const QString& path, const QStringList& classes,
+                                const QHash<QString, ImageRecord>& images, QString* err)
+{
+    // Görseller stem baytlarına göre sıralı (ikili arama için)
+    QVector<QPair<QByteArray, const ImageRecord*>> rows;
+    rows.reserve(images.size());
+    quint64 boxes = 0, stemBytes = 0;
+    for (auto it = images.cbegin(); it != images.cend(); ++it) {
+        rows.push_back({it.key().toUtf8(), &it.value()});
+        boxes     += quint64(it->count());
+        stemBytes += quint64(rows.back().first.size());
+    }
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b){ return a.first < b.first; });
+    if (boxes > 0xFFFFFFFFull || stemBytes > 0xFFFFFFFFull) { setErr(err, "store: too large"); return false; }
+
+    QVector<QByteArray> cls;
+    quint64 classBytes = 0;
+    for (const QString& c : classes) { cls << c.toUtf8(); classBytes += quint64(cls.back().size()); }
+
+    const quint64 n = quint64(rows.size()), m = boxes, c = quint64(cls.size());
+    FileHeader h{};
+    memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version    = kVersion;
+    h.imageCount = quint32(n);
+    h.boxCount   = m;
+    h.classCount = quint32(c);
+    quint64 off = align8(sizeof(FileHeader));
+    h.offStemIdx    = off; off = align8(off + 4*(n+1));
+    h.offStemBytes  = off; off = align8(off + stemBytes);
+    h.offWidth      = off; off = align8(off + 4*n);
+    h.offHeight     = off; off = align8(off + 4*n);
+    h.offFirstBox   = off; off = align8(off + 4*(n+1));
+    h.offCls        = off; off = align8(off + 4*m);
+    h.offX1         = off; off = align8(off + 4*m);
+    h.offY1         = off; off = align8(off + 4*m);
+    h.offX2         = off; off = align8(off + 4*m);
+    h.offY2         = off; off = align8(off + 4*m);
+    h.offClassIdx   = off; off = align8(off + 4*(c+1));
+    h.offClassBytes = off; off = align8(off + classBytes);
+    h.fileSize      = off;
+
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) { setErr(err, f.errorString()); return false; }
+
+    quint64 pos = 0;
+    const auto put = [&](const void* d, quint64 len){
+        if (len) f.write(static_cast<const char*>(d), qint64(len));
+        pos += len;
+    };
+    const auto padTo = [&](quint64 target){
+        static const char zeros[8] = {};
+        while (pos < target) put(zeros, qMin<quint64>(8, target - pos));
+    };
+    const auto putU32 = [&](quint32 v){ put(&v, 4); };
+
+    put(&h, sizeof(h));
+    padTo(h.offStemIdx);
+    { quint32 o = 0; for (const auto& r : rows) { putU32(o); o += quint32(r.first.size()); } putU32(o); }
+    padTo(h.offStemBytes);
+    for (const auto& r : rows) put(r.first.constData(), quint64(r.first.size()));
+    padTo(h.offWidth);
+    for (const auto& r : rows) putU32(quint32(qMax(0, r.second->size.width())));
+    padTo(h.offHeight);
+    for (const auto& r : rows) putU32(quint32(qMax(0, r.second->size.height())));
+    padTo(h.offFirstBox);
+    { quint32 o = 0; for (const auto& r : rows) { putU32(o); o += quint32(r.second->count()); } putU32(o); }
+
+    // Sütunlar: her dizi ayrı ayrı, görsel sırasıyla
+    padTo(h.offCls);
+    for (const auto& r : rows) put(r.second->cls.constData(), 4*quint64(r.second->count()));
+    const QVector<float> ImageRecord::* cols[] = { &ImageRecord::x1, &ImageRecord::y1,
+                                                   &ImageRecord::x2, &ImageRecord::y2 };
+    const quint64 colOff[] = { h.offX1, h.offY1, h.offX2, h.offY2 };
+    for (int k = 0; k < 4; ++k) {
+        padTo(colOff[k]);
+        for (const auto& r : rows) put((r.second->*cols[k]).constData(), 4*quint64(r.second->count()));
+    }
+
+    padTo(h.offClassIdx);
+    { quint32 o = 0; for (const auto& s : cls) { putU32(o); o += quint32(s.size()); } putU32(o); }
+    padTo(h.offClassBytes);
+    for (const auto& s : cls) put(s.constData(), quint64(s.size()));
+    padTo(h.fileSize);
+
+    if (!f.commit()) { setErr(err, f.errorString()); return false; }
+    return true;
+}
+
+bool AnnotationStore::compact(QString* err)
+{
+    // Anlık görüntü al, yeni tabanı kilitsiz yaz (sorgular beklemez); kilit yalnız takas için
+    std::shared_ptr<const Base> base;
+    QHash<QString, ImageRecord> overlay;
+    QStringList classes;
+    quint64 seq = 0;
+    {
+        QMutexLocker lk(&m_mutex);
+        if (!m_open) { setErr(err, "store: not open"); return false; }
+        if (m_base.use_count() > 1) { setErr(err, "store: busy (export running)"); return false; }
+        base    = m_base;
+        overlay = m_overlay;
+        classes = m_classes;
+        seq     = m_putSeq;
+    }
+
+    QHash<QString, ImageRecord> all;
+    all.reserve(int(base->images) + overlay.size());
+    for (quint32 i = 0; i < base->images; ++i) {
+        const ImageView v = base->view(int(i));
+        ImageRecord r;
+        r.size = v.size;
+        r.cls = QVector<qint32>(v.cls, v.cls + v.count);
+        r.x1  = QVector<float>(v.x1, v.x1 + v.count);
+        r.y1  = QVector<float>(v.y1, v.y1 + v.count);
+        r.x2  = QVector<float>(v.x2, v.x2 + v.count);
+        r.y2  = QVector<float>(v.y2, v.y2 + v.count);
+        all.insert(v.stem, r);
+    }
+    for (auto it = overlay.cbegin(); it != overlay.cend(); ++it) all.insert(it.key(), it.value());
+    overlay.clear();
+
+    const QString tmp = m_path + ".compact";
+    if (!writeBase(tmp, classes, all, err)) { QFile::remove(tmp); return false; }
+    all.clear();
+
+    QMutexLocker lk(&m_mutex);
+    base.reset();
+    if (!m_open || m_base.use_count() > 1) {
+        setErr(err, m_open ? "store: busy (export running)" : "store: not open");
+        QFile::remove(tmp);
+        return false;
+    }
+    m_base.reset();                                   // eski eşleme kalksın (Windows'ta rename için şart)
+    if (!replaceFile(tmp, m_path)) {                  // eski taban yerinde: yeniden eşle, WAL'a dokunma
+        setErr(err, "store: replace failed: " + tmp);
+        QFile::remove(tmp);
+        m_base = mapBase(m_path, nullptr);
+        m_open = bool(m_base);
+        return false;
+    }
+    m_base = mapBase(m_path, err);
+    if (!m_base) { m_open = false; return false; }
+
+    // Yeni taban yerinde; WAL ancak şimdi boşaltılabilir
+
+    // Anlık görüntüden sonra gelen kayıtlar overlay'de kalır; WAL'ları I/O kuyruğunda sırada
+    for (auto it = m_putAt.begin(); it != m_putAt.end(); ) {
+        if (it.value() > seq) { ++it; continue; }
+        m_overlay.remove(it.key());
+        it = m_putAt.erase(it);
+    }
+    m_wal.resize(0);
+    m_wal.seek(0);
+    return true;
+}
+
+void AnnotationStore::compactAsync()
+{
+    m_io.start([this]{
+        QString err;
+        const bool ok = compact(&err);
+        emit compacted(ok, err);
+    });
+}
+
+// ---------------------------
+// Dışa aktarım (LabelImg düzeni)
+// ---------------------------
+// Görsel kutuları → serileştirici kutuları (normalize xyxy)
+static void toSerializerBoxes(const AnnotationStore::ImageView& v, QVector<LabelSerializer::Box>* out)
+{
+    out->resize(v.count);
+    for (int k = 0; k < v.count; ++k)
+        (*out)[k] = {v.cls[k], v.x1[k], v.y1[k], v.x2[k], v.y2[k]};
+}
+
+bool AnnotationStore::exportYOLO(const QString& outDir, QString* err) const
+{
+    if (!QDir().mkpath(outDir)) { setErr(err, "mkpath failed: " + outDir); return false; }
+    const QDir od(outDir);
+    int failed = 0;
+    LabelSerializer ser;
+    QVector<LabelSerializer::Box> boxes;
+    forEachImage([&](const ImageView& v){
+        toSerializerBoxes(v, &boxes);
+        const QByteArray& text = ser.yolo(boxes.constData(), int(boxes.size()));
+        if (!LabelSerializer::writeFile(od.filePath(v.stem + ".txt"), text, failed ? nullptr : err)) ++failed;
+    });
+    return failed == 0;
+}
+
+bool AnnotationStore::exportVOC(const QString& outDir, const QString& imagesDir, QString* err) const
+{
+    if (!QDir().mkpath(outDir)) { setErr(err, "mkpath failed: " + outDir); return false; }
+    const QDir od(outDir);
+    const QStringList names = classes();
+    int failed = 0;
+    LabelSerializer ser;
+    QVector<LabelSerializer::Box> boxes;
+    forEachImage([&](const ImageView& v){
+        const QSize sz = v.size.isEmpty() ? ImageSizeCache::instance().sizeForStem(imagesDir, v.stem) : v.size;
+        if (sz.isEmpty()) {
+            if (!failed) setErr(err, "image size unknown: " + v.stem);
+            ++failed;
+            return;
+        }
+        toSerializerBoxes(v, &boxes);
+        const QByteArray& xml = ser.voc(boxes.constData(), int(boxes.size()), sz, names, sz.width(), sz.height());
+        if (!LabelSerializer::writeFile(od.filePath(v.stem + ".xml"), xml, failed ? nullptr : err)) ++failed;
+    });
+    ImageSizeCache::instance().flush();
+    return failed == 0;
+}
+
+void AnnotationStore::exportAsync(const QString& outDir, bool voc, const QString& imagesDir)
+{
+    m_jobs.start([this, outDir, voc, imagesDir]{
+        QString err;
+        const bool ok = voc ? exportVOC(outDir, imagesDir, &err) : exportYOLO(outDir, &err);
+        emit exported(outDir, ok, err);
+    });
+}
+
+// ---------------------------
+// Etiket klasöründen kurulum
+// ---------------------------
+bool AnnotationStore::buildFromLabels(const QString& labelsDir, bool voc, const QString& imagesDir,
+                                      const QStringList& classesIn, const QString& outPath, QString* err)
+{
+    // stem → görsel yolu (boyut için başlık okuması); paylaşılan tarayıcı önbelleğini kullanır
+    QHash<QString, QString> imageByStem;
+    if (!imagesDir.isEmpty()) {
+        for (const QString& p : DirScanner::instance().listImages(imagesDir))
+            imageByStem.insert(QFileInfo(p).completeBaseName(), p);
+    }
+    const auto sizeOf = [&](const QString& stem) -> QSize {
+        const QString p = imageByStem.value(stem);
+        return p.isEmpty() ? QSize() : ImageSizeCache::instance().sizeOf(p);
+    };
+
+    QStringList classes = classesIn;
+    QHash<QString, ImageRecord> images;
+    int skipped = 0;
+
+    QDirIterator it(labelsDir, QStringList{ voc ? "*.xml" : "*.txt" }, QDir::Files);
+    while (it.hasNext()) {
+        it.next();
+        const QString name = it.fileName();
+        if (!voc && name == QLatin1String("classes.txt")) continue;
+        const QString stem = QFileInfo(name).completeBaseName();
+
+        QFile f(it.filePath());
+        if (!f.open(QIODevice::ReadOnly)) { ++skipped; continue; }
+        ImageRecord r;
+
+        if (!voc) {
+            r.size = sizeOf(stem);
+            const QByteArray all = f.readAll();
+            for (const QByteArray& line : all.split('\n')) {
+                const QList<QByteArray> t = line.simplified().split(' ');
+                if (t.size() < 5) continue;
+                bool ok[5];
+                const int   c  = t[0].toInt(&ok[0]);
+                const float cx = t[1].toFloat(&ok[1]), cy = t[2].toFloat(&ok[2]);
+                const float w  = t[3].toFloat(&ok[3]), h  = t[4].toFloat(&ok[4]);
+                if (!(ok[0] && ok[1] && ok[2] && ok[3] && ok[4])) continue;
+                r.append(c, cx - w/2, cy - h/2, cx + w/2, cy + h/2);
+            }
+        } else {
+            VOCDoc doc;
+            if (!parseVOCxml(f.readAll(), &doc)) { ++skipped; continue; }
+            r.size = !doc.size.isEmpty() ? doc.size : sizeOf(stem);
+            if (r.size.isEmpty()) { ++skipped; continue; }       // normalize edilemez
+            for (const VOCObject& o : std::as_const(doc.objects)) {
+                int c = classes.indexOf(o.name);
+                if (c < 0) { classes << o.name; c = classes.size() - 1; }
+                r.append(c, float(o.x1 / r.size.width()),  float(o.y1 / r.size.height()),
+                            float(o.x2 / r.size.width()),  float(o.y2 / r.size.height()));
+            }
+        }
+        images.insert(stem, r);
+    }
+
+    if (skipped) qWarning() << "[AnnStore] build: skipped" << skipped << "label files";
+    ImageSizeCache::instance().flush();
+    return writeBase(outPath, classes, images, err);
+}
@@ -0,0 +1,118 @@
+// annotationstore.h
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <functional>
+#include <memory>
+
+// Veri seti genelinde tek dosyalık, sütunlu (columnar) etiket deposu.
+//
+//  <ad>.annstore  (mmap ile açılır, salt okunur taban)
+//    başlık | görsel tablosu: stem (UTF-8 arena, ada göre sıralı), width, height, firstBox
+//           | kutu tablosu  : cls[i32], x1[], y1[], x2[], y2[] (f32, 0..1 normalize, ayrı diziler)
+//           | sınıf adları
+//  <ad>.annstore.wal  (sadece sona ekleme)
+//    annotator kayıtları: "bu görselin kutuları artık şunlar" — açılışta tabanın üzerine oynatılır
+//
+// compact() WAL'ı tabana katar. LabelImg uyumu için YOLO/VOC klasörlerine dışa aktarılabilir.
+// GUI için *Async sürümler: WAL ekleme + sıkıştırma tek sıralı I/O thread'inde, dışa aktarım ayrı
+// havuzda; sonuçlar sinyalle döner. Yıkıcı uçuştaki işleri bekler (nesne işten önce ölmez).
+class AnnotationStore : public QObject
+{
+    Q_OBJECT
+public:
+    // Tek görselin kutuları (SoA). Taban için mmap'e, WAL kaydı için belleğe işaret eder.
+    struct ImageView {
+        QString        stem;
+        QSize          size;           // 0x0: bilinmiyor
+        int            count = 0;
+        const qint32*  cls = nullptr;
+        const float*   x1  = nullptr;
+        const float*   y1  = nullptr;
+        const float*   x2  = nullptr;
+        const float*   y2  = nullptr;
+    };
+
+    // Bellek içi görsel kaydı (WAL / kurulum için)
+    struct ImageRecord {
+        QSize            size;
+        QVector<qint32>  cls;
+        QVector<float>   x1, y1, x2, y2;
+        void append(int c, float a, float b, float d, float e) { cls << c; x1 << a; y1 << b; x2 << d; y2 << e; }
+        int  count() const { return int(cls.size()); }
+    };
+
+    explicit AnnotationStore(QObject* parent=nullptr);
+    ~AnnotationStore() override;
+
+    bool    open(const QString& path, QString* err=nullptr);   // yoksa boş depo oluşturur
+    void    close();
+    bool    isOpen() const { return m_open; }
+    QString path() const   { return m_path; }
+
+    QStringList classes() const;
+    void        setClasses(const QStringList& names);          // WAL'a yazılmaz; compact ile kalıcı
+
+    // Tek görsel sorgusu (GUI: annotator açılışı)
+    bool lookup(const QString& stem, ImageRecord* out) const;
+
+    // Annotator kaydı → WAL (tek write + flush)
+    bool putImage(const QString& stem, const ImageRecord& rec, QString* err=nullptr);
+    // Aynısı, GUI için: kayıt sorgulara hemen yansır, WAL'a I/O thread'inde sırayla yazılır
+    bool putImageAsync(const QString& stem, const ImageRecord& rec, QString* err=nullptr);
+
+    // Veri seti geneli gezinme. Anlık görüntü alınır; geri çağrı sırasında kilit tutulmaz.
+    void forEachImage(const std::function<void(const ImageView&)>& fn) const;
+    int  imageCount() const;
+
+    bool compact(QString* err=nullptr);                          // WAL → taban, WAL sıfırlanır
+    void compactAsync();                                         // bekleyen WAL yazımlarından sonra → compacted()
+
+    // Dışa aktarım (LabelImg uyumlu)
+    bool exportYOLO(const QString& outDir, QString* err=nullptr) const;
+    bool exportVOC (const QString& outDir, const QString& imagesDir, QString* err=nullptr) const;
+    void exportAsync(const QString& outDir, bool voc, const QString& imagesDir);   // → exported()
+
+    // Mevcut etiket klasöründen taban dosyası üret (YOLO .txt veya VOC .xml)
+    static bool buildFromLabels(const QString& labelsDir, bool voc, const QString& imagesDir,
+                                const QStringList& classes, const QString& outPath, QString* err=nullptr);
+
+    static bool writeBase(const QString& path, const QStringList& classes,
+                          const QHash<QString, ImageRecord>& images, QString* err=nullptr);
+
+signals:
+    // Arka plan işlerinin sonucu (worker thread'den; GUI alıcısına queued)
+    void walWriteFailed(const QString& error);
+    void compacted(bool ok, const QString& error);
+    void exported(const QString& outDir, bool ok, const QString& error);
+
+private:
+    struct Base;   // mmap edilmiş taban (anlık görüntüler paylaşır)
+
+    static QByteArray walRecord(const QString& stem, const ImageRecord& rec, QString* err);
+    bool appendWal(const QByteArray& record, QString* err);
+    bool replayWal(QString* err);
+    static std::shared_ptr<Base> mapBase(const QString& path, QString* err);
+    static int findStem(const Base& b, const QByteArray& stem);
+
+    QString                          m_path;
+    bool                             m_open = false;
+    mutable QMutex                   m_mutex;
+    std::shared_ptr<const Base>      m_base;
+    QHash<QString, ImageRecord>      m_overlay;     // WAL'dan gelen, tabanı geçersiz kılan kayıtlar
+    QStringList                      m_classes;
+    QFile                            m_wal;
+    quint64                          m_putSeq = 0;
+    QHash<QString, quint64>          m_putAt;       // stem → son putImage sırası (sıkıştırma bunu korur)
+
+    QThreadPool                      m_io;          // tek thread: WAL eklemeleri + sıkıştırma, sıralı
+    QThreadPool                      m_jobs;        // dışa aktarım (anlık görüntü üzerinde)
+};
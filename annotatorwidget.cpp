@@ -1,4 +1,13 @@
 #include "annotatorwidget.h"
+#include "label_writer.h"
+#include "label_serializer.h"
+#include "imagelistmodel.h"
+#include "dirscanner.h"
+#include "annotationstore.h"
+#include "boxtracker.h"
+#include "edgesnap.h"
+#include "preannotator.h"
+#include "ioukernel.h"
 
 #include <QMouseEvent>
 #include <QWheelEvent>
@@ -8,10 +17,10 @@
 #include <QFile>
 #include <QTextStream>
 #include <QStringConverter>     // Qt6 için (setEncoding)
-#include <QXmlStreamWriter>     // PascalVOC: stream writer
+#include <QImageReader>
+#include <QMetaObject>
 #include <QPainter>
 #include <QPen>
-#include <QOperatingSystemVersion>
 #include <QDebug>
 #include <algorithm>
 #include <cmath>
@@ -52,6 +61,29 @@ static QString sanitizeDirLike(const QString& in)
     return s;
 }
 
+// Görseli en fazla `target` boyutunda decode et (0 → tam çözünürlük).
+// JPEG'de setScaledSize libjpeg DCT ölçeklemesini kullanır: büyük görselde birkaç kat hızlı.
+// *full: EXIF döndürmesi uygulanmış tam çözünürlük boyutu (başlıktan, decode yok).
+static QImage decodeImage(const QString& path, const QSize& target, QSize* full)
+{
+    QImageReader r(path);
+    r.setAutoTransform(true);
+    const QSize raw = r.size();
+    const bool  rot = (r.transformation() & QImageIOHandler::TransformationRotate90);
+    const QSize disp = rot ? raw.transposed() : raw;
+    if (full) *full = disp;
+
+    // Görüntü hedeften kayda değer büyük değilse doğrudan tam decode
+    if (disp.isValid() && target.isValid()
+        && (disp.width() > target.width() * 3 / 2 || disp.height() > target.height() * 3 / 2)) {
+        const QSize want = disp.scaled(target, Qt::KeepAspectRatio);
+        r.setScaledSize(rot ? want.transposed() : want);       // ölçek dönüşümden önce uygulanır
+    }
+    QImage img = r.read();
+    if (full && !disp.isValid() && !img.isNull()) *full = img.size();   // başlıksız format
+    return img;
+}
+
 // Dosya-içi yardımcı
 static inline QRectF clampRect(const QRectF& r, const QSize& s) {
     QRectF img(QPointF(0,0), s);
@@ -83,6 +115,43 @@ AnnotatorWidget::AnnotatorWidget(QWidget* parent)
     m_minBoxPx      = 6.0;      // sahne pikselinde min kutu kenarı
     m_pressScene    = QPointF();
     m_startBoxScene = QRectF();
+
+    // Kayıtlar arka planda: GUI thread diske hiç beklemez
+    m_writer = new LabelWriter(this);
+    connect(m_writer, &LabelWriter::written, this, &AnnotatorWidget::onLabelWritten);
+
+    // Tam çözünürlük yükseltmesi için tek worker (sıradaki görsel bir öncekini beklemez; eski sonuç atılır)
+    m_decodePool.setMaxThreadCount(1);
+    m_pix->setTransformationMode(Qt::SmoothTransformation);
+
+    // İnceleme modu ileri okuma: sonraki görseller görünüm boyutunda, gezinmeyle yarışmasın diye düşük öncelik
+    m_prefetchPool.setMaxThreadCount(2);
+    m_prefetchPool.setThreadPriority(QThread::LowPriority);
+
+    // Sonraki kareye taşıma: kutular durulunca arka planda hesapla (tek worker, düşük öncelik)
+    m_trackPool.setMaxThreadCount(1);
+    m_trackPool.setThreadPriority(QThread::LowPriority);
+    m_trackDebounce.setSingleShot(true);
+    m_trackDebounce.setInterval(400);
+    connect(&m_trackDebounce, &QTimer::timeout, this, &AnnotatorWidget::startPropagation);
+    connect(this, &AnnotatorWidget::boxesChanged, this, &AnnotatorWidget::schedulePropagation);
+}
+
+AnnotatorWidget::~AnnotatorWidget()
+{
+    m_decodePool.clear();
+    m_decodePool.waitForDone();    // uçuştaki decode bu nesneye sonuç göndermesin
+    m_trackPool.clear();
+    m_trackPool.waitForDone();
+    if (m_dirScan) DirScanner::instance().cancel(m_dirScan);   // sonuç zaten bu nesneye bağlı, düşer
+    m_prefetchPool.clear();
+    m_prefetchPool.waitForDone();
+
+    // Yazıcı bekleyenleri kendi yıkıcısında (bu thread'de) yazar ve written yayar: üyeler
+    // yıkılmadan önce bağlantıyı kes ve burada boşalt (~QWidget'taki çocuk silmeyi bekleme)
+    disconnect(m_writer, nullptr, this, nullptr);
+    delete m_writer;
+    m_writer = nullptr;
 }
 
 void AnnotatorWidget::setSaveDir(const QString& d)
@@ -110,47 +179,238 @@ void AnnotatorWidget::setSaveDir(const QString& d)
 
 void AnnotatorWidget::setImageList(const QStringList& list, int startIndex)
 {
+    cancelDirScan();           // dışarıdan yeni liste: bekleyen openDir/startReview sonucu düşer
+    applyImageList(list, startIndex);
+}
+
+void AnnotatorWidget::applyImageList(const QStringList& list, int startIndex)
+{
+    autosaveBeforeLeave();
+    leaveReview();             // dışarıdan yeni liste: inceleme biter
+    if (m_imageModel) disconnect(m_imageModel, nullptr, this, nullptr);
+    m_imageModel = nullptr;
     m_images = list;
-    if (m_images.isEmpty()) {
+    startAt(startIndex);
+}
+
+// Büyük klasörler: yolları kopyalamadan paylaşılan modelden oku
+void AnnotatorWidget::setImageModel(ImageListModel* model, int startIndex)
+{
+    cancelDirScan();
+    autosaveBeforeLeave();
+    leaveReview();
+    m_images.clear();
+    if (m_imageModel) disconnect(m_imageModel, nullptr, this, nullptr);
+    m_imageModel = model;
+    if (model) {
+        // Tarama sürerken satırlar sona eklenir: listede henüz olmayan anahtar kareleri yerleştir
+        connect(model, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex&, int first, int last){
+            if (!m_imageModel || m_keyframes.unresolvedCount() == 0) return;
+            QHash<QString, int> byStem;
+            for (int i = first; i <= last; ++i)
+                byStem.insert(QFileInfo(m_imageModel->pathAt(i)).completeBaseName(), i);
+            if (m_keyframes.resolve([&](const QString& stem){ return byStem.value(stem, -1); }) > 0)
+                viewport()->update();
+        });
+        // Tarama bitince model ada göre sıralanır → anahtar kareleri ve açık görselin satırını yeniden bul
+        connect(model, &QAbstractItemModel::layoutChanged, this, [this]{
+            if (m_imageModel) relocateAfterListChange();
+        });
+    }
+    startAt(startIndex);
+}
+
+void AnnotatorWidget::setAnnotationStore(AnnotationStore* store)
+{
+    if (m_store) disconnect(m_store, nullptr, this, nullptr);
+    m_store = store;
+    if (!store) return;
+    connect(store, &AnnotationStore::walWriteFailed, this, [this](const QString& err){
+        emit log(QStringLiteral("[store] WAL write failed: %1").arg(err));
+    });
+}
+
+void AnnotatorWidget::setPreAnnotator(PreAnnotator* pre)
+{
+    if (m_pre) disconnect(m_pre, nullptr, this, nullptr);
+    m_pre = pre;
+    if (!pre) return;
+    connect(pre, &PreAnnotator::proposalsReady, this, [this](const QString& path, int){
+        if (path == m_imagePath && m_proposals.isEmpty()) showModelProposals();
+    });
+    connect(pre, &PreAnnotator::failed, this, [this](const QString& path, const QString& err){
+        emit log(QStringLiteral("[pre] %1: %2").arg(QFileInfo(path).fileName(), err));
+    });
+    requestPreannotation();
+}
+
+int AnnotatorWidget::imageCount() const
+{
+    return m_imageModel ? m_imageModel->totalCount() : int(m_images.size());
+}
+
+QString AnnotatorWidget::imageAt(int i) const
+{
+    if (i < 0 || i >= imageCount()) return {};
+    return m_imageModel ? m_imageModel->pathAt(i) : m_images[i];
+}
+
+void AnnotatorWidget::startAt(int startIndex)
+{
+    if (imageCount() == 0) {
+        stashSession();
         m_index = -1;
         m_imagePath.clear();
         m_boxes.clear();
-        if (m_pix) m_pix->setPixmap(QPixmap());
+        m_proposals.clear();
+        m_journal.clear();
+        m_sel = -1;
+        ++m_decodeGen;
+        m_imageSize = QSize();
+        m_fullImage = QImage();
+        m_fullRes   = true;
+        m_upgrading = false;
+        if (m_pix) { m_pix->setPixmap(QPixmap()); m_pix->setTransform(QTransform()); }
         m_scene.setSceneRect(QRectF());
         viewport()->update();
         return;
     }
-    m_index  = qBound(0, startIndex, m_images.size()-1);
-    loadImage(m_images[m_index]);
+    m_index  = qBound(0, startIndex, imageCount()-1);
+    loadKeyframes();
+    loadImage(imageAt(m_index));
+}
+
+// Liste yeniden sıralandı / tamamlandı: anahtar kareleri stem ile yerine oturt, açık görselin satırını bul
+void AnnotatorWidget::relocateAfterListChange()
+{
+    if (!m_keyframes.isEmpty() || m_keyframes.unresolvedCount() > 0) {
+        QHash<QString, int> byStem;
+        for (int i = 0, n = imageCount(); i < n; ++i)
+            byStem.insert(QFileInfo(imageAt(i)).completeBaseName(), i);
+        m_keyframes.reindex([&](const QString& stem){ return byStem.value(stem, -1); });
+    }
+    if (m_imagePath.isEmpty() || imageAt(m_index) == m_imagePath) return;
+    for (int i = 0, n = imageCount(); i < n; ++i)
+        if (imageAt(i) == m_imagePath) { m_index = i; return; }
+}
+
+void AnnotatorWidget::cancelDirScan()
+{
+    if (m_dirScan) DirScanner::instance().cancel(m_dirScan);
+    m_dirScan = 0;
+    ++m_dirScanGen;
+}
+
+// Gezinme indeksi değiştirmeden çağırır: anahtar kare bilgisi açık görselin karesine yazılsın
+void AnnotatorWidget::autosaveBeforeLeave()
+{
+    if (m_autosave && m_dirty && !m_imagePath.isEmpty()) saveCurrent();
 }
 
 bool AnnotatorWidget::loadImage(const QString& path)
 {
-    QPixmap px(path);
-    if (px.isNull()) return false;
+    // Görsel değişmeden önce: autosave açıksa kaydedilmemiş kutuları kuyruğa bırak
+    // (gezinme yolları bunu indeks değişmeden yapar; burası kalan çağıranlar için)
+    if (m_autosave && m_dirty && !m_imagePath.isEmpty() && path != m_imagePath)
+        saveCurrent();
+
+    // İlk gösterim: görünüm boyutunda decode (fitInView zaten küçültecekti); inceleme modunda
+    // ileri okuma aynı boyutta hazırladıysa decode yok
+    const QSize target = decodeTarget();
+    QSize  full;
+    QImage img;
+    const auto pre = m_prefetched.constFind(path);
+    if (pre != m_prefetched.cend() && pre->target == target) {
+        img  = pre->img;
+        full = pre->full;
+    } else {
+        img = decodeImage(path, target, &full);
+    }
+    if (img.isNull() || full.isEmpty()) return false;
+    if (m_reviewActive) m_prefetched.insert(path, {img, full, target});   // A ile geri dönüş de anında
+
+    // önceki görselin kutu + undo durumunu sakla (geri dönünce aynen gelsin)
+    stashSession();
     m_imagePath = path;
 
-    // görsel değişti → kutuları temizle & stem güncelle
+    // görsel değişti → kutuları temizle & stem güncelle (oturum varsa geri yükle)
     m_boxes.clear();
+    m_proposals.clear();
+    m_dirty = false;
+    m_sel   = -1;
+    m_journal.clear();
+    const bool hadSession = m_sessions.contains(path);
+    restoreSession(path);
     m_currentStem = QFileInfo(m_imagePath).completeBaseName();
 
+    ++m_decodeGen;
+    m_imageSize = full;
+
+    // Oturum yoksa kutular depodan (normalize → sahne px)
+    AnnotationStore::ImageRecord rec;
+    if (!hadSession && m_store && m_store->isOpen() && m_store->lookup(m_currentStem, &rec)) {
+        for (int k = 0; k < rec.count(); ++k) {
+            Box b;
+            b.cls  = rec.cls[k];
+            b.rect = QRectF(QPointF(rec.x1[k] * full.width(), rec.y1[k] * full.height()),
+                            QPointF(rec.x2[k] * full.width(), rec.y2[k] * full.height()));
+            m_boxes.push_back(b);
+        }
+    }
+
+    // Kayıt yoksa anahtar karelerden (anahtar karenin kendisi ya da ara değer; normalize → sahne px)
+    QVector<KeyframeTracks::Key> keys;
+    if (!hadSession && m_boxes.isEmpty() && !m_reviewActive && m_imagePath == imageAt(m_index)
+        && m_keyframes.boxesAt(m_index, m_interpMode, &keys)) {
+        for (const auto& k : std::as_const(keys)) {
+            Box b;
+            b.cls   = k.cls;
+            b.track = k.track;
+            b.rect  = QRectF(k.rect.x() * full.width(), k.rect.y() * full.height(),
+                             k.rect.width() * full.width(), k.rect.height() * full.height());
+            m_boxes.push_back(b);
+        }
+        if (!m_keyframes.isKeyframe(m_index))
+            emit info(QStringLiteral("Ara kare: %1 kutu anahtar karelerden hesaplandı (kaydedince yazılır)")
+                          .arg(keys.size()));
+    }
+    m_fullRes   = (img.size() == full);
+    m_fullImage = m_fullRes ? img : QImage();
+    m_upgrading = false;
     if (m_pix) {
-        m_pix->setPixmap(px);
+        m_pix->setPixmap(QPixmap::fromImage(img));
         m_pix->setOffset(0,0);
+        // Sahne = tam çözünürlük pikseli; küçük decode ölçekle aynı alanı kaplar
+        m_pix->setTransform(QTransform::fromScale(double(full.width())  / img.width(),
+                                                  double(full.height()) / img.height()));
     }
-    m_scene.setSceneRect(QRectF(QPointF(0,0), px.size()));
+    m_scene.setSceneRect(QRectF(QPointF(0,0), full));
     resetTransform();
-    fitInView(m_pix, Qt::KeepAspectRatio);
+    fitInView(m_scene.sceneRect(), Qt::KeepAspectRatio);
     viewport()->update();
 
+    requestPreannotation();
+    if (m_reviewActive) {
+        prefetchAround();
+        if (const ReviewQueue::Item* it = reviewItem())
+            emit info(QStringLiteral("İnceleme %1/%2 — %3  uyumsuzluk %4  (TP %5, sınıf %6, FP %7, FN %8)")
+                          .arg(m_index + 1).arg(imageCount()).arg(it->stem)
+                          .arg(it->disagreement, 0, 'f', 2).arg(it->c.tp).arg(it->c.mis).arg(it->c.fp).arg(it->c.fn));
+    }
+
     emit boxesChanged(m_boxes, m_currentStem);
     return true;
 }
 
+QSize AnnotatorWidget::decodeTarget() const
+{
+    // görünmeden önce yüklenirse viewport küçük olabilir → makul bir alt sınır
+    return (QSizeF(viewport()->size()) * viewport()->devicePixelRatioF()).toSize().expandedTo(QSize(1024, 768));
+}
+
 QString AnnotatorWidget::currentImage() const
 {
-    if (m_index < 0 || m_index >= m_images.size()) return {};
-    return m_images[m_index];
+    return imageAt(m_index);
 }
 
 void AnnotatorWidget::setFormat(const QString& f)
@@ -167,39 +427,52 @@ void AnnotatorWidget::setActiveClass(const QString& c)
 
 void AnnotatorWidget::clearBoxes()
 {
+    if (!m_boxes.isEmpty()) markDirty();
+    // Tek eylem olarak günlüğe yaz (sondan başa silme; tek Ctrl+Z hepsini geri getirir)
+    for (int i = m_boxes.size()-1; i >= 0; --i)
+        recordEdit(BoxEdit::Op::Delete, i, m_boxes[i].rect, QRectF(),
+                   m_boxes[i].cls, m_boxes[i].cls, i != m_boxes.size()-1);
     m_boxes.clear();
+    m_sel = -1;
     viewport()->update();
     emit boxesChanged(m_boxes, m_currentStem);
 }
 
-// =========================
-// YENİ: Görsel listeleyici
-// =========================
-QStringList AnnotatorWidget::listImagesCaseInsensitive(const QString& dir)
-{
-    QStringList out;
-    QDir d(dir);
-    const QStringList files = d.entryList(QDir::Files, QDir::Name);
-    for (const QString& f : files) {
-        const QString ext = QFileInfo(f).suffix().toLower();
-        if (QStringList{"png","jpg","jpeg","bmp","tif","tiff"}.contains(ext))
-            out << d.absoluteFilePath(f);
-    }
-    return out;
-}
-
 // =========================
 // YENİ: Klasör aç
 // =========================
 bool AnnotatorWidget::openDir(const QString& dirIn)
 {
     const QString dir = sanitizeDirLike(dirIn);
-    QStringList imgs = listImagesCaseInsensitive(dir);
-    if (imgs.isEmpty()) {
-        qWarning() << "[Annotator] openDir: no images in" << dir;
+    if (!QFileInfo(dir).isDir()) {
+        qWarning() << "[Annotator] openDir: not a directory" << dir;
         return false;
     }
-    setImageList(imgs, 0);      // setImageList zaten ilk görseli yükler
+    // Paylaşılan tarayıcı arka planda (klasör değişmediyse önbellekten tek parça): ilk parça gelince
+    // onun ilk görseli açılır; tarama bitince sıralı tam liste, açık görsel yeniden yüklenmeden yerine konur
+    cancelDirScan();
+    const quint64 gen = m_dirScanGen;
+    auto shown = std::make_shared<bool>(false);
+    m_dirScan = DirScanner::instance().listImagesAsync(dir, this,
+        [this, gen, shown, dir](const QStringList& imgs){
+            if (gen != m_dirScanGen) return;
+            m_dirScan = 0;
+            if (imgs.isEmpty()) {
+                qWarning() << "[Annotator] openDir: no images in" << dir;
+                emit info(QStringLiteral("Klasörde görsel yok: %1").arg(QDir::toNativeSeparators(dir)));
+                return;
+            }
+            if (!*shown) { applyImageList(imgs, 0); return; }
+            m_images = imgs;
+            relocateAfterListChange();
+        },
+        [this, gen, shown](const QStringList& part){
+            if (gen != m_dirScanGen || *shown || part.isEmpty()) return;
+            *shown = true;
+            QStringList first = part;
+            DirScanner::sortNames(first);
+            applyImageList(first, 0);      // ilk görseli yükler; gezinme bu parça içinde
+        });
     return true;
 }
 
@@ -341,7 +614,7 @@ static inline void clampBoxScene(QRectF& r, const QSize& imgSize, qreal minPx)
 void AnnotatorWidget::mousePressEvent(QMouseEvent* e)
 {
     // Önce: handle/kutu hit-test (LabelImg davranışı)
-    if (e->button() == Qt::LeftButton && m_pix && !m_pix->pixmap().isNull()) {
+    if (e->button() == Qt::LeftButton && hasImage()) {
         const QPointF w = e->pos();
         Hit hit = hitTest(w);
 
@@ -362,8 +635,26 @@ void AnnotatorWidget::mousePressEvent(QMouseEvent* e)
         }
     }
 
+    // Öneri kutusuna tıklandı: kabul et ve hemen taşımaya başla (düzenlenebilir)
+    if (e->button() == Qt::LeftButton && hasImage() && !m_proposals.isEmpty()) {
+        const QPointF sp = mapToScene(e->pos());
+        for (int i = m_proposals.size()-1; i >= 0; --i) {
+            if (!m_proposals[i].rect.contains(sp)) continue;
+            acceptProposal(i);
+            m_sel           = m_boxes.size()-1;
+            m_hot           = Handle::None;
+            m_mode          = Mode::Moving;
+            m_pressScene    = sp;
+            m_startBoxScene = m_boxes[m_sel].rect;
+            setCursor(Qt::SizeAllCursor);
+            e->accept();
+            viewport()->update();
+            return;
+        }
+    }
+
     // Hit yoksa: mevcut çizim akışın (yeni kutu oluşturma)
-    if (e->button()==Qt::LeftButton && m_pix && !m_pix->pixmap().isNull()) {
+    if (e->button()==Qt::LeftButton && hasImage()) {
         m_mode       = Mode::Creating;
         m_drawing    = true;
         m_sel        = -1;
@@ -392,7 +683,7 @@ void AnnotatorWidget::mouseMoveEvent(QMouseEvent* e)
         const QPointF curS = mapToScene(e->pos());
         const QPointF d    = curS - m_pressScene;
         QRectF r           = m_startBoxScene.translated(d);
-        clampBoxScene(r, m_pix->pixmap().size(), m_minBoxPx);
+        clampBoxScene(r, m_imageSize, m_minBoxPx);
         m_boxes[m_sel].rect = r;
         viewport()->update();
         e->accept();
@@ -416,7 +707,7 @@ void AnnotatorWidget::mouseMoveEvent(QMouseEvent* e)
         default: break;
         }
 
-        clampBoxScene(r, m_pix->pixmap().size(), m_minBoxPx);
+        clampBoxScene(r, m_imageSize, m_minBoxPx);
         m_boxes[m_sel].rect = r;
         viewport()->update();
         e->accept();
@@ -441,10 +732,15 @@ void AnnotatorWidget::mouseReleaseEvent(QMouseEvent* e)
         // min boyut filtresi
         if (r.width()>3 && r.height()>3) {
             // görüntü sınırları içinde kırp
-            r = r.intersected(QRectF(QPointF(0,0), m_pix->pixmap().size()));
-            clampBoxScene(r, m_pix->pixmap().size(), m_minBoxPx);
-            if (r.isValid())
+            r = r.intersected(QRectF(QPointF(0,0), m_imageSize));
+            clampBoxScene(r, m_imageSize, m_minBoxPx);
+            if (r.isValid()) {
                 m_boxes.push_back({r, m_currentClass});
+                recordEdit(BoxEdit::Op::Create, m_boxes.size()-1, QRectF(), r,
+                           m_currentClass, m_currentClass);
+                if (m_autoSnap) snapBox(m_boxes.size()-1, true);   // aynı Ctrl+Z ile geri alınır (uygunsa)
+                markDirty();
+            }
         }
         viewport()->update();
 
@@ -457,6 +753,12 @@ void AnnotatorWidget::mouseReleaseEvent(QMouseEvent* e)
 
     // Move/Resize bitişi
     if ((m_mode == Mode::Moving || m_mode == Mode::Resizing) && e->button()==Qt::LeftButton) {
+        if (m_sel >= 0 && m_sel < m_boxes.size() && m_boxes[m_sel].rect != m_startBoxScene) {
+            const int cls = m_boxes[m_sel].cls;
+            recordEdit(m_mode == Mode::Moving ? BoxEdit::Op::Move : BoxEdit::Op::Resize,
+                       m_sel, m_startBoxScene, m_boxes[m_sel].rect, cls, cls);
+            markDirty();
+        }
         m_mode = Mode::Idle;
         m_hot  = Handle::None;
         setCursor(Qt::ArrowCursor);
@@ -476,27 +778,91 @@ void AnnotatorWidget::wheelEvent(QWheelEvent* e)
     // Mevcut zoom (AnchorUnderMouse aktif)
     const double s = std::pow(1.0015, e->angleDelta().y());
     scale(s, s);
+    maybeUpgradeResolution();
     e->accept();
 }
 
+void AnnotatorWidget::resizeEvent(QResizeEvent* e)
+{
+    QGraphicsView::resizeEvent(e);
+    maybeUpgradeResolution();      // ör. dock → tam ekran
+}
+
+// Önizleme decode'u ekrandan daha kaba görünmeye başladıysa tam çözünürlüğü arka planda oku
+void AnnotatorWidget::maybeUpgradeResolution()
+{
+    if (m_fullRes || m_upgrading || !m_pix || m_imagePath.isEmpty()) return;
+
+    // decode edilmiş bir piksel ekranda kaç cihaz pikseline denk geliyor?
+    const double k = transform().m11() * m_pix->transform().m11() * viewport()->devicePixelRatioF();
+    if (k <= 1.05) return;
+
+    m_upgrading = true;
+    const quint64 gen  = m_decodeGen;
+    const QString path = m_imagePath;
+    m_decodePool.start([this, gen, path]{
+        const QImage img = decodeImage(path, QSize(), nullptr);
+        QMetaObject::invokeMethod(this, [this, gen, img]{
+            if (gen != m_decodeGen || !m_pix) return;          // bu arada görsel değişti
+            m_upgrading = false;
+            if (img.isNull()) return;
+            m_pix->setPixmap(QPixmap::fromImage(img));
+            m_pix->setTransform(QTransform::fromScale(double(m_imageSize.width())  / img.width(),
+                                                      double(m_imageSize.height()) / img.height()));
+            m_fullRes   = true;
+            m_fullImage = img;
+            viewport()->update();
+        }, Qt::QueuedConnection);
+    });
+}
+
 void AnnotatorWidget::keyPressEvent(QKeyEvent* e)
 {
     if (e->matches(QKeySequence::Save)) { saveCurrent(); return; }
+    if (e->matches(QKeySequence::Undo)) { undo(); return; }
+    if (e->matches(QKeySequence::Redo) ||
+        (e->key()==Qt::Key_Z && (e->modifiers() & Qt::ControlModifier)
+                             && (e->modifiers() & Qt::ShiftModifier))) { redo(); return; }
     if (e->key()==Qt::Key_Delete && !m_boxes.isEmpty()) {
         // Seçili varsa onu sil; yoksa son ekleneni sil
-        if (m_sel >= 0 && m_sel < m_boxes.size()) {
-            m_boxes.removeAt(m_sel);
-            m_sel = -1;
-        } else {
-            m_boxes.removeLast();
-        }
+        const int idx = (m_sel >= 0 && m_sel < m_boxes.size()) ? m_sel : m_boxes.size()-1;
+        recordEdit(BoxEdit::Op::Delete, idx, m_boxes[idx].rect, QRectF(),
+                   m_boxes[idx].cls, m_boxes[idx].cls);
+        m_boxes.removeAt(idx);
+        m_sel = -1;
+        markDirty();
         viewport()->update();
 
         emit boxesChanged(m_boxes, m_currentStem);
         return;
     }
+    if (e->key()==Qt::Key_C && m_sel >= 0 && m_sel < m_boxes.size()
+        && m_currentClass >= 0 && m_boxes[m_sel].cls != m_currentClass) {
+        // Seçili kutuya aktif sınıfı uygula
+        const int before = m_boxes[m_sel].cls;
+        m_boxes[m_sel].cls = m_currentClass;
+        recordEdit(BoxEdit::Op::ClassChange, m_sel, m_boxes[m_sel].rect, m_boxes[m_sel].rect,
+                   before, m_currentClass);
+        markDirty();
+        viewport()->update();
+        emit boxesChanged(m_boxes, m_currentStem);
+        return;
+    }
+    if (!m_proposals.isEmpty() && (e->key()==Qt::Key_Return || e->key()==Qt::Key_Enter)) { acceptProposals(); return; }
+    if (!m_proposals.isEmpty() && e->key()==Qt::Key_Escape) { rejectProposals(); return; }
+    if (e->key()==Qt::Key_T)      { propagateToNext(); return; }                              // burst: sonraki kareye taşı
+    if (e->key()==Qt::Key_R)      { snapSelected(); return; }                                 // kenara yapıştır
+    if (e->key()==Qt::Key_K) {                                                                 // anahtar kare
+        if (e->modifiers() & Qt::ShiftModifier) unmarkKeyframe(); else markKeyframe();
+        return;
+    }
     if (e->key()==Qt::Key_W)      { setDragMode(QGraphicsView::NoDrag); return; }            // çizim modu
     if (e->key()==Qt::Key_Space)  { setDragMode(QGraphicsView::ScrollHandDrag); return; }    // pan
+    if (e->key()==Qt::Key_O && m_reviewActive) {                                              // inceleme katmanı
+        m_reviewOverlay = !m_reviewOverlay;
+        viewport()->update();
+        return;
+    }
     if (e->key()==Qt::Key_D)      { nextImage(); return; }
     if (e->key()==Qt::Key_A)      { prevImage(); return; }
     QGraphicsView::keyPressEvent(e);
@@ -510,6 +876,10 @@ void AnnotatorWidget::drawForeground(QPainter* p, const QRectF& r)
     p->save();
     p->setRenderHint(QPainter::Antialiasing, true);
 
+    // inceleme katmanı: kendi kutularımızın altında
+    if (m_reviewActive && m_reviewOverlay)
+        if (const ReviewQueue::Item* it = reviewItem()) drawReview(p, *it);
+
     QPen pen(Qt::white, 2.0);
     p->setPen(pen);
 
@@ -523,9 +893,10 @@ void AnnotatorWidget::drawForeground(QPainter* p, const QRectF& r)
         p->drawRect(b.rect);
 
         // Etiket arkaplanını sınıf adına göre dinamik genişlikte yap
-        const QString cls = (b.cls>=0 && b.cls<m_classes.size())
-                                ? m_classes[b.cls]
-                                : QString("cls%1").arg(b.cls);
+        QString cls = (b.cls>=0 && b.cls<m_classes.size())
+                          ? m_classes[b.cls]
+                          : QString("cls%1").arg(b.cls);
+        if (b.track >= 0) cls += QString(" #%1").arg(b.track);
         QFontMetrics fm(p->font());
         const int w = fm.horizontalAdvance(cls) + 8;
         QRectF labelRect = QRectF(b.rect.topLeft() + QPointF(0,-18), QSizeF(w,18));
@@ -535,6 +906,22 @@ void AnnotatorWidget::drawForeground(QPainter* p, const QRectF& r)
         p->drawText(labelRect.adjusted(3,0,-3,0), Qt::AlignVCenter|Qt::AlignLeft, cls);
     }
 
+    // öneriler: kesikli turuncu, kaydedilmez
+    if (!m_proposals.isEmpty()) {
+        p->setBrush(Qt::NoBrush);
+        QFontMetrics fm(p->font());
+        for (const auto& b : std::as_const(m_proposals)) {
+            p->setPen(QPen(QColor(255,160,0), 2.0, Qt::DashLine));
+            p->drawRect(b.rect);
+            const QString cls = ((b.cls>=0 && b.cls<m_classes.size()) ? m_classes[b.cls]
+                                                                      : QString("cls%1").arg(b.cls)) + " ?";
+            QRectF labelRect(b.rect.topLeft() + QPointF(0,-18), QSizeF(fm.horizontalAdvance(cls) + 8, 18));
+            p->fillRect(labelRect, QColor(120,70,0,180));
+            p->setPen(Qt::white);
+            p->drawText(labelRect.adjusted(3,0,-3,0), Qt::AlignVCenter|Qt::AlignLeft, cls);
+        }
+    }
+
     // Seçili kutu için handle kareleri
     if (m_sel >= 0 && m_sel < m_boxes.size()) {
         auto handles = handleRectsW(m_boxes[m_sel].rect);
@@ -561,7 +948,117 @@ void AnnotatorWidget::drawForeground(QPainter* p, const QRectF& r)
     p->restore();
 }
 
+// =========================
+// === UNDO / REDO ===
+// =========================
+static inline void packRect(float out[4], const QRectF& r)
+{
+    out[0] = float(r.x());     out[1] = float(r.y());
+    out[2] = float(r.width()); out[3] = float(r.height());
+}
+
+static inline QRectF unpackRect(const float in[4])
+{
+    return QRectF(in[0], in[1], in[2], in[3]);
+}
+
+void AnnotatorWidget::recordEdit(BoxEdit::Op op, int index,
+                                 const QRectF& before, const QRectF& after,
+                                 int clsBefore, int clsAfter, bool joinPrev)
+{
+    BoxEdit e;
+    e.op        = op;
+    e.joinPrev  = joinPrev;
+    e.index     = index;
+    e.clsBefore = qint16(clsBefore);
+    e.clsAfter  = qint16(clsAfter);
+    packRect(e.before, before);
+    packRect(e.after,  after);
+    m_journal.record(e);
+}
+
+void AnnotatorWidget::applyEdit(const BoxEdit& e, bool forward)
+{
+    const int i = e.index;
+    switch (e.op) {
+    case BoxEdit::Op::Create:
+        if (forward) m_boxes.insert(qBound(0, i, int(m_boxes.size())), Box{unpackRect(e.after), e.clsAfter});
+        else if (i >= 0 && i < m_boxes.size()) m_boxes.removeAt(i);
+        break;
+    case BoxEdit::Op::Delete:
+        if (forward) { if (i >= 0 && i < m_boxes.size()) m_boxes.removeAt(i); }
+        else m_boxes.insert(qBound(0, i, int(m_boxes.size())), Box{unpackRect(e.before), e.clsBefore});
+        break;
+    case BoxEdit::Op::Move:
+    case BoxEdit::Op::Resize:
+        if (i >= 0 && i < m_boxes.size())
+            m_boxes[i].rect = unpackRect(forward ? e.after : e.before);
+        break;
+    case BoxEdit::Op::ClassChange:
+        if (i >= 0 && i < m_boxes.size())
+            m_boxes[i].cls = forward ? e.clsAfter : e.clsBefore;
+        break;
+    }
+}
+
+void AnnotatorWidget::undo()
+{
+    if (!m_journal.canUndo()) return;
+    const BoxEdit* e = nullptr;
+    do {
+        e = m_journal.undo();
+        applyEdit(*e, /*forward=*/false);
+    } while (e->joinPrev && m_journal.canUndo());
+
+    m_sel = -1;
+    markDirty();
+    viewport()->update();
+    emit boxesChanged(m_boxes, m_currentStem);
+}
+
+void AnnotatorWidget::redo()
+{
+    if (!m_journal.canRedo()) return;
+    applyEdit(*m_journal.redo(), /*forward=*/true);
+    while (const BoxEdit* next = m_journal.peekRedo()) {
+        if (!next->joinPrev) break;
+        applyEdit(*m_journal.redo(), /*forward=*/true);
+    }
+
+    m_sel = -1;
+    markDirty();
+    viewport()->update();
+    emit boxesChanged(m_boxes, m_currentStem);
+}
+
+void AnnotatorWidget::stashSession()
+{
+    if (m_imagePath.isEmpty()) return;
+    if (m_boxes.isEmpty() && m_journal.size() == 0 && !m_sessions.contains(m_imagePath)) return;
+
+    ImageSession& s = m_sessions[m_imagePath];
+    s.boxes   = m_boxes;
+    s.journal = m_journal;
+    s.dirty   = m_dirty;
+
+    m_sessionLru.removeOne(m_imagePath);
+    m_sessionLru.push_back(m_imagePath);
+    while (m_sessionLru.size() > kMaxSessions)
+        m_sessions.remove(m_sessionLru.takeFirst());
+}
+
+void AnnotatorWidget::restoreSession(const QString& path)
+{
+    auto it = m_sessions.find(path);
+    if (it == m_sessions.end()) return;
+    m_boxes   = it->boxes;
+    m_journal = it->journal;
+    m_dirty   = it->dirty;
+}
+
 // ---- Kaydetme ----
+// Not: saveCurrent diske yazmaz; içeriği üretip LabelWriter kuyruğuna bırakır.
+// Klasör oluşturma (mkpath) ve atomik yazma worker thread'de yapılır.
 bool AnnotatorWidget::saveCurrent()
 {
     if (m_imagePath.isEmpty()) {
@@ -569,189 +1066,705 @@ bool AnnotatorWidget::saveCurrent()
         return false;
     }
 
-    // Fallback: m_saveDir boşsa görüntü klasörü altında labels_* üret
-    if (m_saveDir.isEmpty()) {
+    ensureSaveDir();
+
+    // >>> ÖNEMLİ: Kaydet SONRASINDA **KUTULARI TEMİZLEME / NEXT'E GEÇME YOK**
+    // (m_boxes.clear(); update(); nextImage();) gibi satırlar bilerek yok.
+
+    const bool ok = (m_format == "PascalVOC") ? saveVOC(m_imagePath, m_saveDir)
+                                              : saveYOLO(m_imagePath, m_saveDir);
+
+    // Depo açıksa aynı kutular WAL'a (normalize xyxy); LabelImg dosyaları yine yazılır
+    if (ok && m_store && m_store->isOpen() && !m_imageSize.isEmpty()) {
+        const double W = m_imageSize.width(), H = m_imageSize.height();
+        AnnotationStore::ImageRecord rec;
+        rec.size = m_imageSize;
+        for (const auto& b : std::as_const(m_boxes)) {
+            if (b.cls < 0) continue;
+            const QRectF r = clampRect(b.rect, m_imageSize);
+            rec.append(b.cls, float(r.left() / W), float(r.top() / H),
+                              float(r.right() / W), float(r.bottom() / H));
+        }
+        QString err;                           // WAL yazımı deponun I/O thread'inde
+        if (!m_store->putImageAsync(m_currentStem, rec, &err))
+            emit log(QStringLiteral("[store] WAL write failed: %1").arg(err));
+    }
+
+    // Anahtar karenin kutuları düzenlendiyse ara kareler de yeni haline göre hesaplansın
+    // Kare stem'den: otomatik kayıtta m_index zaten sonraki görsele geçmiş olabilir
+    const int keyframe = ok ? m_keyframes.frameOf(m_currentStem) : -1;
+    if (keyframe >= 0) {
+        storeKeyframe(keyframe);
+        saveKeyframes();
+    } else if (ok && !m_reviewActive && !m_keyframes.isEmpty() && m_journal.size() > 0
+               && !m_keyframes.isEdited(m_currentStem)) {
+        // Elle düzeltilmiş ara kare: oturum önbelleğinden düşse de toplu yazım ezmesin
+        m_keyframes.markEdited(m_currentStem);
+        saveKeyframes();
+    }
+
+    if (ok) m_dirty = false;
+    return ok;
+}
+
+// Fallback: m_saveDir boşsa görüntü klasörü altında labels_* üret (sadece yol hesabı)
+QString AnnotatorWidget::ensureSaveDir()
+{
+    if (m_saveDir.isEmpty() && !m_imagePath.isEmpty()) {
         const bool isVOC = (m_format == "PascalVOC");
         const QFileInfo fi(m_imagePath);
-        QDir base(fi.absolutePath());
         const QString rel = isVOC ? "labels_voc/train" : "labels_yolo/train";
-        QString autoDir = base.filePath(rel);
-        autoDir = sanitizeDirLike(autoDir);
-        if (!QDir().mkpath(autoDir)) {
-            qWarning() << "[Annotator] saveCurrent: mkpath failed for" << autoDir;
-            return false;
-        }
-        m_saveDir = QDir::toNativeSeparators(autoDir);
+        m_saveDir = QDir::toNativeSeparators(QDir::cleanPath(QDir(fi.absolutePath()).filePath(rel)));
         qDebug() << "[Annotator] saveCurrent: auto saveDir =" << m_saveDir;
-    } else {
-        // Verilmiş saveDir’i de temizle/garantile
-        m_saveDir = sanitizeDirLike(m_saveDir);
-        if (!QDir().mkpath(m_saveDir)) {
-            qWarning() << "[Annotator] saveCurrent: mkpath failed for" << m_saveDir;
-            return false;
-        }
     }
+    return m_saveDir;
+}
 
-    // Ek log: ortam
-    qDebug() << "[Annotator] OS =" << QOperatingSystemVersion::current().name();
-    qDebug() << "[Annotator] IMG =" << m_imagePath;
-    qDebug() << "[Annotator] DIR =" << m_saveDir;
-    qDebug() << "[Annotator] FORMAT =" << m_format;
-
-    // >>> ÖNEMLİ: Kaydet SONRASINDA **KUTULARI TEMİZLEME / NEXT'E GEÇME YOK**
-    // (m_boxes.clear(); update(); nextImage();) gibi satırlar bilerek yok.
-
-    if (m_format == "PascalVOC") return saveVOC(m_imagePath, m_saveDir);
-    return saveYOLO(m_imagePath, m_saveDir);
+// m_boxes → serileştirici kutuları (piksel, görüntüye kırpılmış); tampon tekrar kullanılır
+const QVector<LabelSerializer::Box>& AnnotatorWidget::serializerBoxes()
+{
+    m_serBoxes.resize(0);
+    for (const auto& b : std::as_const(m_boxes)) {
+        if (b.cls < 0) continue;  // geçersiz sınıfı yazma
+        const QRectF r = clampRect(b.rect, m_imageSize);
+        m_serBoxes.push_back({b.cls, r.left(), r.top(), r.right(), r.bottom()});
+    }
+    return m_serBoxes;
 }
 
 bool AnnotatorWidget::saveYOLO(const QString& imgPath, const QString& outDir)
 {
-    const QPixmap& px = m_pix->pixmap();
-    if (px.isNull()) {
-        qWarning() << "[Annotator] saveYOLO: pixmap null";
+    // Normalizasyon tam çözünürlüğe göre (ekrandaki önizleme boyutu değil)
+    const QSize sz = m_imageSize;
+    if (sz.isEmpty()) {
+        qWarning() << "[Annotator] saveYOLO: no image";
         return false;
     }
-    const double W = px.width(), H = px.height();
-
-    QStringList lines;
-    for (const auto& b : m_boxes) {
-        if (b.cls < 0) continue;  // geçersiz sınıfı yazma
-        QRectF r = clampRect(b.rect, px.size());
-        const double xc = (r.center().x()) / W;
-        const double yc = (r.center().y()) / H;
-        const double ww = (r.width())      / W;
-        const double hh = (r.height())     / H;
-        lines << QString("%1 %2 %3 %4 %5")
-                     .arg(b.cls)
-                     .arg(xc,0,'f',6)
-                     .arg(yc,0,'f',6)
-                     .arg(ww,0,'f',6)
-                     .arg(hh,0,'f',6);
-    }
 
+    const auto& boxes = serializerBoxes();
     const QString base = QFileInfo(imgPath).completeBaseName();
-    QString outDirSan = sanitizeDirLike(outDir);
-    const QString out  = QDir(outDirSan).filePath(base + ".txt");
+    const QString out  = QDir(outDir).filePath(base + ".txt");
 
-    // Hedef klasör yoksa oluştur
-    const QString outParent = QFileInfo(out).absolutePath();
-    if (!QDir().mkpath(outParent)) {
-        qWarning() << "[Annotator] saveYOLO: mkpath failed for" << outParent;
+    m_writer->enqueue(out, m_serializer.yolo(boxes.constData(), int(boxes.size()), sz.width(), sz.height()));
+    qDebug() << "[Annotator] saveYOLO: queued" << out << "boxes =" << boxes.size();
+    return true;
+}
+
+bool AnnotatorWidget::saveVOC(const QString& imgPath, const QString& outDir)
+{
+    const QSize sz = m_imageSize;
+    if (sz.isEmpty()) {
+        qWarning() << "[Annotator] saveVOC: no image";
         return false;
     }
 
-    QFile f(out);
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "[Annotator] saveYOLO: cannot open file for write:" << out << "err=" << f.error();
-        return false;
+    const auto& boxes = serializerBoxes();
+    const QString base = QFileInfo(imgPath).completeBaseName();
+    const QString out  = QDir(outDir).filePath(base + ".xml");
+
+    m_writer->enqueue(out, m_serializer.voc(boxes.constData(), int(boxes.size()), sz, m_classes));
+    qDebug() << "[Annotator] saveVOC: queued" << out << "boxes =" << boxes.size();
+    return true;
+}
+
+// LabelWriter worker'ı bir dosyayı diske indirdiğinde (GUI thread'de çağrılır)
+void AnnotatorWidget::onLabelWritten(const QString& path, bool ok, const QString& error)
+{
+    // Ara kare toplu yazımı: satır satır log yerine kuyruk boşalınca tek özet
+    if (m_bulkWrites.remove(path)) {
+        if (!ok) {
+            ++m_bulkFailed;
+            qWarning() << "[Annotator] write failed:" << path << error;
+            emit log(QStringLiteral("[keyframe]   yazılamadı: %1 (%2)").arg(path, error));
+        } else {
+            emit labelSaved(path);
+        }
+        if (m_bulkWrites.isEmpty()) {
+            emit info(m_bulkFailed ? QStringLiteral("Ara kareler yazıldı (%1 hata)").arg(m_bulkFailed)
+                                   : QStringLiteral("Ara kareler yazıldı"));
+            m_bulkFailed = 0;
+        }
+        return;
     }
 
-    QTextStream ts(&f);
-#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
-    ts.setEncoding(QStringConverter::Utf8);
-#else
-    ts.setCodec("UTF-8");
-#endif
-    for (const QString& L : lines) ts << L << '\n';
-    f.close();
-    qDebug() << "[Annotator] saveYOLO: wrote" << out;
+    if (!ok) {
+        qWarning() << "[Annotator] write failed:" << path << error;
+        emit log(QStringLiteral("[ours] save FAILED: %1 (%2)").arg(path, error));
+        return;
+    }
 
     // >>> İSTENEN LOG SATIRI (kaydettikten sonra kutular EKRANDA KALIR)
-    emit log(QStringLiteral("[ours] saved: %1").arg(out));
+    emit log(QStringLiteral("[ours] saved: %1").arg(path));
+    emit labelSaved(path);
 
-    emit info(QStringLiteral("Saved YOLO: %1").arg(out));
-    return true;
+    const bool isVOC = path.endsWith(".xml", Qt::CaseInsensitive);
+    emit info(QStringLiteral("Saved %1: %2").arg(isVOC ? QStringLiteral("VOC") : QStringLiteral("YOLO"), path));
 }
 
-bool AnnotatorWidget::saveVOC(const QString& imgPath, const QString& outDir)
+void AnnotatorWidget::nextImage()
 {
-    const QPixmap& px = m_pix->pixmap();
-    if (px.isNull()) {
-        qWarning() << "[Annotator] saveVOC: pixmap null";
-        return false;
+    if (imageCount() == 0) return;
+    if (m_index < imageCount()-1) {
+        autosaveBeforeLeave();
+        ++m_index;
+        loadImage(imageAt(m_index));
+    } else if (m_reviewActive) {
+        emit info(QStringLiteral("İnceleme kuyruğunun sonu (%1 görsel)").arg(imageCount()));
     }
+}
 
-    const QString base = QFileInfo(imgPath).completeBaseName();
-    QString outDirSan = sanitizeDirLike(outDir);
-    const QString out  = QDir(outDirSan).filePath(base + ".xml");
+void AnnotatorWidget::prevImage()
+{
+    if (imageCount() == 0) return;
+    if (m_index > 0) {
+        autosaveBeforeLeave();
+        --m_index;
+        loadImage(imageAt(m_index));
+    }
+}
 
-    // Hedef klasör yoksa oluştur
-    const QString outParent = QFileInfo(out).absolutePath();
-    if (!QDir().mkpath(outParent)) {
-        qWarning() << "[Annotator] saveVOC: mkpath failed for" << outParent;
-        return false;
+// =========================
+// === ÖNERİLER / SONRAKİ KAREYE TAŞIMA ===
+// =========================
+void AnnotatorWidget::setProposals(const QVector<Box>& boxes, const QString& source)
+{
+    m_proposals      = boxes;
+    m_proposalSource = source;
+    viewport()->update();
+    if (!boxes.isEmpty())
+        emit info(QStringLiteral("%1 öneri (%2) — Enter: kabul, Esc: at, tıkla: düzenle")
+                      .arg(boxes.size()).arg(source));
+}
+
+void AnnotatorWidget::acceptProposal(int i, bool joinPrev)
+{
+    if (i < 0 || i >= m_proposals.size()) return;
+    const Box b = m_proposals.takeAt(i);
+    m_boxes.push_back(b);
+    recordEdit(BoxEdit::Op::Create, m_boxes.size()-1, QRectF(), b.rect, b.cls, b.cls, joinPrev);
+    markDirty();
+}
+
+void AnnotatorWidget::acceptProposals()
+{
+    if (m_proposals.isEmpty()) return;
+    // Tek eylem: tek Ctrl+Z hepsini geri alır
+    for (bool first = true; !m_proposals.isEmpty(); first = false)
+        acceptProposal(0, !first);
+    viewport()->update();
+    emit boxesChanged(m_boxes, m_currentStem);
+}
+
+void AnnotatorWidget::rejectProposals()
+{
+    if (m_proposals.isEmpty()) return;
+    m_proposals.clear();
+    viewport()->update();
+}
+
+void AnnotatorWidget::schedulePropagation()
+{
+    m_prop.ready = false;
+    m_trackDebounce.start();
+}
+
+void AnnotatorWidget::startPropagation()
+{
+    const int next = m_index + 1;
+    const quint64 gen = ++m_trackGen;
+    m_prop = Propagation{};
+    if (m_reviewActive || m_boxes.isEmpty() || m_index < 0 || next >= imageCount()) {
+        if (m_propPending) { m_propPending = false; emit info(QStringLiteral("Taşınacak kutu / sonraki kare yok")); }
+        return;
     }
 
-    QFile f(out);
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "[Annotator] saveVOC: cannot open file for write:" << out << "err=" << f.error();
-        return false;
+    m_prop.from = m_imagePath;
+    m_prop.to   = imageAt(next);
+    QVector<QRectF> rects;
+    QVector<int>    classes;
+    for (const auto& b : std::as_const(m_boxes)) { rects << b.rect; classes << b.cls; }
+
+    const QString from = m_prop.from, to = m_prop.to;
+    m_trackPool.start([this, gen, from, to, rects, classes]{
+        const QVector<BoxTracker::Result> res = BoxTracker::track(from, to, rects);
+        QVector<Box> boxes;
+        for (int k = 0; k < res.size(); ++k)
+            if (res[k].ok && res[k].rect.width() > 3 && res[k].rect.height() > 3)
+                boxes.push_back({res[k].rect, classes[k]});
+        const int lost = int(res.size() - boxes.size());
+        QMetaObject::invokeMethod(this, [this, gen, boxes, lost]{
+            if (gen != m_trackGen) return;                   // kutular/görsel bu arada değişti
+            m_prop.boxes = boxes;
+            m_prop.ready = true;
+            if (lost) emit log(QStringLiteral("[track] %1 kutu sonraki karede bulunamadı").arg(lost));
+            if (m_propPending) applyPropagation();
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AnnotatorWidget::propagateToNext()
+{
+    if (m_reviewActive) { emit info(QStringLiteral("İnceleme modunda kareye taşıma kapalı")); return; }
+    if (m_boxes.isEmpty()) { emit info(QStringLiteral("Taşınacak kutu yok")); return; }
+    if (m_index + 1 >= imageCount()) { emit info(QStringLiteral("Sonraki kare yok")); return; }
+
+    m_propPending = true;
+    if (m_prop.ready && m_prop.from == m_imagePath && !m_trackDebounce.isActive()) {
+        applyPropagation();
+        return;
     }
+    if (m_trackDebounce.isActive()) { m_trackDebounce.stop(); startPropagation(); }
+    emit info(QStringLiteral("Takip hesaplanıyor…"));
+}
 
-    QXmlStreamWriter xml(&f);
-    xml.setAutoFormatting(true);
-    xml.writeStartDocument();   // UTF-8 varsayılan
+void AnnotatorWidget::applyPropagation()
+{
+    m_propPending = false;
+    if (!m_prop.ready || m_prop.from != m_imagePath) return;
+    const Propagation prop = m_prop;
 
-    xml.writeStartElement("annotation");
+    nextImage();
+    if (m_imagePath != prop.to) return;
 
-    // <size>
-    xml.writeStartElement("size");
-    xml.writeTextElement("width",  QString::number(px.width()));
-    xml.writeTextElement("height", QString::number(px.height()));
-    xml.writeTextElement("depth",  "3");
-    xml.writeEndElement(); // size
+    // Sonraki karede zaten aynı yeri kaplayan kutu varsa öneri olarak tekrar koyma
+    setProposals(withoutOverlaps(prop.boxes), QStringLiteral("track"));
+}
 
-    // <object>…</object>
-    for (const auto& b : m_boxes) {
-        if (b.cls < 0) continue;  // geçersiz sınıfı yazma
-        QRectF r = clampRect(b.rect, px.size());
-        const QString cls = (b.cls>=0 && b.cls<m_classes.size())
-                                ? m_classes[b.cls]
-                                : QString("cls%1").arg(b.cls);
+QVector<AnnotatorWidget::Box> AnnotatorWidget::withoutOverlaps(const QVector<Box>& boxes) const
+{
+    if (m_boxes.isEmpty()) return boxes;
+    BoxesSoA cand, have;
+    cand.reserve(int(boxes.size()));
+    have.reserve(int(m_boxes.size()));
+    for (const auto& b : boxes)
+        cand.push(float(b.rect.left()), float(b.rect.top()), float(b.rect.right()), float(b.rect.bottom()));
+    for (const auto& e : std::as_const(m_boxes))
+        have.push(float(e.rect.left()), float(e.rect.top()), float(e.rect.right()), float(e.rect.bottom()));
+    std::vector<float> iou(size_t(cand.size()) * have.size());
+    iouMatrix(cand, have, iou.data());
+
+    QVector<Box> fresh;
+    for (int i = 0; i < boxes.size(); ++i) {
+        const float* row = iou.data() + size_t(i) * have.size();
+        if (std::none_of(row, row + have.size(), [](float v){ return v > 0.5f; }))
+            fresh.push_back(boxes[i]);
+    }
+    return fresh;
+}
+
+// =========================
+// === ÖN ETİKETLEME (dedektör önerileri) ===
+// =========================
+void AnnotatorWidget::requestPreannotation()
+{
+    if (!m_pre || !m_pre->hasBackend() || m_index < 0) return;
+    QStringList paths;
+    for (int i = m_index, end = std::min(imageCount(), m_index + 1 + m_pre->lookAhead()); i < end; ++i)
+        paths << imageAt(i);
+    m_pre->request(paths);                    // anında döner; kuyruk yeni pencereyle değişir
+    if (m_proposals.isEmpty()) showModelProposals();
+}
+
+void AnnotatorWidget::showModelProposals()
+{
+    QVector<Proposal> props;
+    if (!m_pre || !hasImage() || !m_pre->take(m_currentStem, &props)) return;
+
+    QVector<Box> boxes;
+    int unknown = 0;
+    for (const auto& p : std::as_const(props)) {
+        const int cls = (p.cls >= 0) ? p.cls : int(m_classes.indexOf(p.label));
+        if (cls < 0 || (!m_classes.isEmpty() && cls >= m_classes.size())) { ++unknown; continue; }
+        const QRectF r = clampRect(p.rect, m_imageSize);
+        if (r.width() > 3 && r.height() > 3) boxes.push_back({r, cls});
+    }
+    if (unknown)
+        emit log(QStringLiteral("[pre] %1 öneri sınıf listesinde olmayan etiketle atlandı").arg(unknown));
+    boxes = withoutOverlaps(boxes);
+    if (!boxes.isEmpty()) setProposals(boxes, m_pre->backendName());
+}
+
+// =========================
+// === ANAHTAR KARELER ===
+// =========================
+QString AnnotatorWidget::keyframeFile() const
+{
+    const QString dir = !m_saveDir.isEmpty() ? m_saveDir : QFileInfo(m_imagePath).absolutePath();
+    return QDir(dir).filePath(QStringLiteral("keyframes.txt"));
+}
 
-        xml.writeStartElement("object");
-        xml.writeTextElement("name", cls);
+void AnnotatorWidget::loadKeyframes()
+{
+    m_keyframes.clear();
+    if (m_reviewActive) return;                // kuyruk sırası kare sırası değil
+    // m_imagePath henüz yeni listeye ait değil → klasör için listenin ilk/aktif görseli
+    const QString dir = !m_saveDir.isEmpty() ? m_saveDir : QFileInfo(imageAt(m_index)).absolutePath();
+    const QString path = QDir(dir).filePath(QStringLiteral("keyframes.txt"));
+    if (!QFile::exists(path)) return;
+
+    QHash<QString, int> byStem;
+    for (int i = 0, n = imageCount(); i < n; ++i)
+        byStem.insert(QFileInfo(imageAt(i)).completeBaseName(), i);
+    QString err;
+    if (!m_keyframes.load(path, [&](const QString& stem){ return byStem.value(stem, -1); }, &err))
+        emit log(QStringLiteral("[keyframe] load failed: %1").arg(err));
+    else if (!err.isEmpty())
+        emit log(QStringLiteral("[keyframe] %1").arg(err));
+    if (!m_keyframes.isEmpty() || m_keyframes.unresolvedCount() > 0)
+        emit log(QStringLiteral("[keyframe] %1 anahtar kare yüklendi (%2 bekliyor): %3")
+                     .arg(m_keyframes.count()).arg(m_keyframes.unresolvedCount()).arg(path));
+}
 
-        xml.writeStartElement("bndbox");
-        xml.writeTextElement("xmin", QString::number(int(r.left())));
-        xml.writeTextElement("ymin", QString::number(int(r.top())));
-        xml.writeTextElement("xmax", QString::number(int(r.right())));
-        xml.writeTextElement("ymax", QString::number(int(r.bottom())));
-        xml.writeEndElement(); // bndbox
+void AnnotatorWidget::saveKeyframes()
+{
+    ensureSaveDir();
+    QString err;
+    if (!m_keyframes.save(keyframeFile(), &err))
+        emit log(QStringLiteral("[keyframe] save failed: %1").arg(err));
+}
 
-        xml.writeEndElement(); // object
+void AnnotatorWidget::storeKeyframe(int frame)
+{
+    const double W = m_imageSize.width(), H = m_imageSize.height();
+    QVector<KeyframeTracks::Key> keys;
+    for (const auto& b : std::as_const(m_boxes)) {
+        if (b.cls < 0) continue;
+        const QRectF r = clampRect(b.rect, m_imageSize);
+        keys.push_back({b.track, b.cls, QRectF(r.x() / W, r.y() / H, r.width() / W, r.height() / H)});
     }
+    m_keyframes.setKeyframe(frame, m_currentStem, keys);
 
-    xml.writeEndElement(); // annotation
-    xml.writeEndDocument();
+    // Atanan track ID'leri ekrandaki kutulara geri yaz (sıra korunur)
+    const auto& stored = m_keyframes.frames().value(frame).keys;
+    for (int i = 0, k = 0; i < m_boxes.size() && k < stored.size(); ++i)
+        if (m_boxes[i].cls >= 0) m_boxes[i].track = stored[k++].track;
+}
 
-    f.close();
-    qDebug() << "[Annotator] saveVOC: wrote" << out;
+void AnnotatorWidget::markKeyframe()
+{
+    if (!hasImage() || m_index < 0) return;
+    if (m_reviewActive) { emit info(QStringLiteral("İnceleme modunda anahtar kare kapalı")); return; }
+    storeKeyframe(m_index);
+    saveKeyframes();
+    viewport()->update();
+    emit info(QStringLiteral("Anahtar kare: %1 (%2 kutu, toplam %3 anahtar kare)")
+                  .arg(m_currentStem).arg(m_boxes.size()).arg(m_keyframes.count()));
+}
+
+void AnnotatorWidget::unmarkKeyframe()
+{
+    if (!m_keyframes.removeKeyframe(m_index)) return;
+    saveKeyframes();
+    emit info(QStringLiteral("Anahtar kare kaldırıldı: %1").arg(m_currentStem));
+}
+
+void AnnotatorWidget::setInterpolationMode(KeyframeTracks::Mode m)
+{
+    if (m_interpMode == m) return;
+    m_interpMode = m;
+    // Açık ara kare düzenlenmediyse yeni kipe göre yeniden hesapla
+    if (hasImage() && !m_dirty && m_journal.size() == 0 && !m_keyframes.isKeyframe(m_index)) {
+        m_sessions.remove(m_imagePath);
+        m_sessionLru.removeOne(m_imagePath);
+        const QString path = m_imagePath;
+        m_imagePath.clear();                   // stashSession tekrar saklamasın
+        loadImage(path);
+    }
+}
+
+void AnnotatorWidget::commitInterpolated()
+{
+    if (m_committing) { emit info(QStringLiteral("Ara kareler zaten yazılıyor")); return; }
+    if (m_keyframes.count() < 2) { emit info(QStringLiteral("En az iki anahtar kare gerekli")); return; }
+    if (m_dirty) saveCurrent();
+
+    const int lo = m_keyframes.firstFrame(), hi = m_keyframes.lastFrame();
+    QStringList images;
+    QVector<int> skip;                         // bu oturumda elle düzenlenmiş ara kareler (kalıcı olanlar: isEdited)
+    for (int i = lo; i <= hi; ++i) {
+        const QString path = imageAt(i);
+        images << path;
+        if (m_keyframes.isKeyframe(i)) continue;
+        const bool edited = (path == m_imagePath) ? m_journal.size() > 0
+                                                  : (m_sessions.contains(path) && m_sessions[path].journal.size() > 0);
+        if (edited) skip << i;
+    }
 
-    // >>> İSTENEN LOG SATIRI
-    emit log(QStringLiteral("[ours] saved: %1").arg(out));
+    const KeyframeTracks snapshot = m_keyframes;
+    const auto mode = m_interpMode;
+    const bool voc  = (m_format == "PascalVOC");
+    const QString outDir = ensureSaveDir();
+    const QStringList classes = m_classes;
+    m_committing = true;
+    emit info(QStringLiteral("Ara kareler yazılıyor: %1 kare…").arg(images.size()));
+
+    // Hesap worker'da; yazma GUI'de LabelWriter kuyruğuna (geçici dosya + rename, aynı yola yazmalar birleşir)
+    const QString kfFile = keyframeFile();
+    QPointer<AnnotatorWidget> self(this);
+    m_trackPool.start([self, snapshot, images, lo, mode, voc, outDir, classes, skip, kfFile]{
+        const auto rep = snapshot.commit(images, lo, mode, voc, outDir, classes, skip);
+        if (!self) return;
+        QMetaObject::invokeMethod(self, [self, rep, outDir, kfFile]{
+            self->m_committing = false;
+            QStringList stems;
+            for (const auto& o : rep.outputs) {
+                self->m_bulkWrites.insert(o.path);
+                self->m_writer->enqueue(o.path, o.content);
+                stems << o.stem;
+            }
+            // Liste bu arada değiştiyse işaretler başka dizinin keyframes.txt'sine gitmesin
+            if (!stems.isEmpty() && self->keyframeFile() == kfFile) {
+                self->m_keyframes.markGenerated(stems);
+                self->saveKeyframes();
+            }
+            emit self->log(QStringLiteral("[keyframe] %1 kuyruğa alındı, %2 atlandı, %3 hata — %4 ms → %5")
+                               .arg(rep.outputs.size()).arg(rep.skipped).arg(rep.failed).arg(rep.elapsedMs).arg(outDir));
+            for (const QString& e : rep.errors) emit self->log(QStringLiteral("[keyframe]   %1").arg(e));
+            if (rep.outputs.isEmpty())
+                emit self->info(QStringLiteral("Yazılacak ara kare yok (%1 atlandı)").arg(rep.skipped));
+        }, Qt::QueuedConnection);
+    });
+}
 
-    emit info(QStringLiteral("Saved VOC: %1").arg(out));
+// =========================
+// === İNCELEME MODU (karşılaştırma kuyruğu) ===
+// =========================
+bool AnnotatorWidget::startReview(const ReviewQueue& queue, const QString& imagesDir)
+{
+    if (queue.isEmpty()) { emit info(QStringLiteral("İnceleme kuyruğu boş: farklı görsel yok")); return false; }
+    cancelDirScan();
+
+    // stem → yol: önce açık liste (diske gitmeden), çözülemeyen kalırsa görsel klasörü
+    QHash<QString, QString> byStem;
+    for (int i = 0, n = imageCount(); i < n; ++i) {
+        const QString p = imageAt(i);
+        byStem.insert(QFileInfo(p).completeBaseName(), p);
+    }
+    const bool unresolved = std::any_of(queue.items.cbegin(), queue.items.cend(),
+                                        [&](const ReviewQueue::Item& it){ return !byStem.contains(it.stem); });
+    if (!unresolved || imagesDir.isEmpty() || !QFileInfo(imagesDir).isDir())
+        return finishReview(queue, byStem);
+
+    // Görsel klasörü arka planda taranır; kuyruk sırası tüm stem'lere bağlı → tarama bitince açılır.
+    // Aynı stem'de ada göre ilk dosya (sıralı tam liste) kazanır.
+    const quint64 gen = m_dirScanGen;
+    emit info(QStringLiteral("İnceleme: görseller taranıyor (%1)…").arg(QDir::toNativeSeparators(imagesDir)));
+    m_dirScan = DirScanner::instance().listImagesAsync(imagesDir, this,
+        [this, gen, queue, byStem](const QStringList& imgs) mutable {
+            if (gen != m_dirScanGen) return;
+            m_dirScan = 0;
+            for (const QString& p : imgs) {
+                const QString stem = QFileInfo(p).completeBaseName();
+                if (!byStem.contains(stem)) byStem.insert(stem, p);
+            }
+            finishReview(queue, byStem);
+        });
     return true;
 }
 
-void AnnotatorWidget::nextImage()
+bool AnnotatorWidget::finishReview(const ReviewQueue& queue, const QHash<QString, QString>& byStem)
 {
-    if (m_images.isEmpty()) return;
-    if (m_index < m_images.size()-1) {
-        ++m_index;
-        loadImage(m_images[m_index]);
+    ReviewQueue review;
+    review.oursDir  = queue.oursDir;
+    review.otherDir = queue.otherDir;
+    review.iouThr   = queue.iouThr;
+    review.mode     = queue.mode;
+    review.items.reserve(queue.size());
+    QStringList paths;
+    for (const ReviewQueue::Item& it : queue.items) {
+        const QString p = byStem.value(it.stem);
+        if (p.isEmpty()) continue;
+        paths << p;
+        review.items.push_back(it);
+    }
+    if (paths.isEmpty()) { emit info(QStringLiteral("İnceleme: kuyruktaki görseller bulunamadı")); return false; }
+    if (const int missing = queue.size() - review.size())
+        emit log(QStringLiteral("[review] %1 görselin dosyası bulunamadı, kuyruktan çıkarıldı").arg(missing));
+
+    autosaveBeforeLeave();
+    // Çıkışta dönülecek liste (kuyruk üstüne kuyruk açılırsa ilk liste korunur)
+    if (!m_reviewActive) {
+        m_reviewPrevModel  = m_imageModel;
+        m_reviewPrevImages = m_imageModel ? QStringList() : m_images;
+        m_reviewPrevIndex  = qMax(0, m_index);
     }
+    leaveReview();
+    m_review        = std::move(review);
+    m_reviewActive  = true;
+    m_reviewOverlay = true;
+
+    if (m_imageModel) disconnect(m_imageModel, nullptr, this, nullptr);
+    m_imageModel = nullptr;
+    m_images     = paths;
+    emit log(QStringLiteral("[review] %1 görsel, anlaşmazlığa göre sıralı (A: %2, B: %3) — D: sonraki, A: önceki, O: katman")
+                 .arg(paths.size()).arg(m_review.oursDir, m_review.otherDir));
+    startAt(0);
+    return true;
 }
 
-void AnnotatorWidget::prevImage()
+void AnnotatorWidget::stopReview()
 {
-    if (m_images.isEmpty()) return;
-    if (m_index > 0) {
-        --m_index;
-        loadImage(m_images[m_index]);
+    if (!m_reviewActive) return;
+    const QPointer<ImageListModel> model  = m_reviewPrevModel;
+    const QStringList              images = m_reviewPrevImages;
+    const int                      index  = m_reviewPrevIndex;
+    m_reviewPrevModel = nullptr;
+    m_reviewPrevImages.clear();
+    if (model) setImageModel(model, index);    // ikisi de leaveReview çağırır
+    else       setImageList(images, index);
+    emit info(QStringLiteral("İnceleme modu kapandı"));
+}
+
+void AnnotatorWidget::leaveReview()
+{
+    // Uçuştaki decode'lar nesil değişince atılır; kuyrukta bekleyenler hiç başlamaz
+    ++m_prefetchGen;
+    m_prefetchPool.clear();
+    m_prefetching.clear();
+    m_prefetched.clear();
+    m_reviewActive = false;
+    m_review       = ReviewQueue();
+}
+
+const ReviewQueue::Item* AnnotatorWidget::reviewItem() const
+{
+    if (!m_reviewActive || m_index < 0 || m_index >= m_review.size() || m_imagePath != imageAt(m_index))
+        return nullptr;
+    return &m_review.items[m_index];
+}
+
+void AnnotatorWidget::prefetchAround()
+{
+    const QSize target = decodeTarget();
+    QStringList window;                        // öncelik: sonraki görseller sırayla, en son bir önceki
+    for (int i = m_index + 1, end = std::min(imageCount(), m_index + 1 + kReviewLookAhead); i < end; ++i)
+        window << imageAt(i);
+    if (m_index > 0) window << imageAt(m_index - 1);
+
+    // Pencere dışındaki ya da eski görünüm boyutundaki decode'ları bırak (bellek pencereyle sınırlı)
+    for (auto it = m_prefetched.begin(); it != m_prefetched.end(); ) {
+        if ((it.key() != m_imagePath && !window.contains(it.key())) || it->target != target)
+            it = m_prefetched.erase(it);
+        else
+            ++it;
+    }
+
+    const quint64 gen = m_prefetchGen;
+    for (const QString& path : std::as_const(window)) {
+        if (m_prefetched.contains(path) || m_prefetching.contains(path)) continue;
+        m_prefetching.insert(path);
+        m_prefetchPool.start([this, gen, path, target]{
+            QSize full;
+            QImage img = decodeImage(path, target, &full);
+            // GUI'de QPixmap::fromImage dönüşümsüz kalsın
+            if (!img.isNull())
+                img = img.convertToFormat(img.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                                : QImage::Format_RGB32);
+            QMetaObject::invokeMethod(this, [this, gen, path, target, img, full]{
+                if (gen != m_prefetchGen) return;          // inceleme bitti / yeniden başladı
+                m_prefetching.remove(path);
+                if (!img.isNull() && !full.isEmpty()) m_prefetched.insert(path, {img, full, target});
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+// A (bizim): düz çizgi, B (karşı): kesikli. Eşleşen soluk renkte; sınıfı tutmayan turuncu,
+// karşılıksız kalın kırmızı (A) / macenta (B) ve alt köşede etiketli.
+void AnnotatorWidget::drawReview(QPainter* p, const ReviewQueue::Item& it)
+{
+    const double W = m_imageSize.width(), H = m_imageSize.height();
+    QFontMetrics fm(p->font());
+    p->setBrush(Qt::NoBrush);
+
+    auto draw = [&](const QVector<ReviewQueue::Box>& boxes, bool ours) {
+        for (const auto& b : boxes) {
+            const QRectF rect(QPointF(b.x1 * W, b.y1 * H), QPointF(b.x2 * W, b.y2 * H));
+            QColor color;
+            qreal  width = 2.0;
+            switch (b.state) {
+            case ReviewQueue::State::Match:
+                color = ours ? QColor(60,200,90,160) : QColor(70,150,255,160);
+                break;
+            case ReviewQueue::State::ClassMismatch:
+                color = QColor(255,170,0);
+                width = 3.0;
+                break;
+            case ReviewQueue::State::Unmatched:
+                color = ours ? QColor(255,50,50) : QColor(255,60,220);
+                width = 3.5;
+                break;
+            }
+            p->setPen(QPen(color, width, ours ? Qt::SolidLine : Qt::DashLine));
+            p->drawRect(rect);
+            if (b.state == ReviewQueue::State::Match) continue;
+
+            const QString cls = QString(ours ? "A " : "B ")
+                              + ((b.cls>=0 && b.cls<m_classes.size()) ? m_classes[b.cls] : QString("cls%1").arg(b.cls));
+            const QRectF labelRect(rect.bottomLeft(), QSizeF(fm.horizontalAdvance(cls) + 8, 18));
+            p->fillRect(labelRect, color.darker(160));
+            p->setPen(Qt::white);
+            p->drawText(labelRect.adjusted(3,0,-3,0), Qt::AlignVCenter|Qt::AlignLeft, cls);
+        }
+    };
+    draw(it.other, false);
+    draw(it.ours, true);
+}
+
+// =========================
+// === KENAR YAPIŞTIRMA ===
+// =========================
+void AnnotatorWidget::snapBox(int i, bool joinPrev)
+{
+    if (i < 0 || i >= m_boxes.size() || !hasImage()) return;
+    const QRectF before = m_boxes[i].rect;
+
+    if (!m_fullImage.isNull()) {
+        applySnap(i, before, EdgeSnap::refine(m_fullImage, QPoint(0, 0), before), joinPrev, joinPrev);
+        return;
+    }
+
+    // Ekranda önizleme decode'u var: arama bandını tam çözünürlükte okumak diske gider →
+    // decode havuzunda oku, sonuç dönünce kutu hâlâ aynıysa uygula
+    const quint64 gen         = m_decodeGen;
+    const int     journalSize = m_journal.size();
+    const QString path        = m_imagePath;
+    const QSize   size        = m_imageSize;
+    m_decodePool.start([this, gen, path, size, i, before, joinPrev, journalSize]{
+        const QRect  region = EdgeSnap::searchRegion(before, size);
+        const QImage part   = EdgeSnap::readRegion(path, region);
+        const QRectF after  = part.isNull() ? before : EdgeSnap::refine(part, region.topLeft(), before);
+        QMetaObject::invokeMethod(this, [this, gen, i, before, after, joinPrev, journalSize]{
+            if (gen != m_decodeGen || i >= m_boxes.size() || m_boxes[i].rect != before) return;   // görsel/kutu değişti
+            // Arada başka düzenleme olduysa oluşturmaya eklenmez, ayrı geri alma adımı olur
+            const bool join = joinPrev && m_journal.size() == journalSize && !m_journal.canRedo();
+            applySnap(i, before, after, join, joinPrev);
+        }, Qt::QueuedConnection);
+    });
+}
+
+// Kutu değiştiyse günlüğe yazar ve bildirir; quiet değilse "kenar yok" bilgisi verir
+bool AnnotatorWidget::applySnap(int i, const QRectF& before, QRectF after, bool joinPrev, bool quiet)
+{
+    after = clampRect(after, m_imageSize);
+    if (!after.isValid() || after == before) {
+        if (!quiet) emit info(QStringLiteral("Kenar yapıştırma: belirgin kenar yok"));
+        return false;
     }
+
+    m_boxes[i].rect = after;
+    recordEdit(BoxEdit::Op::Resize, i, before, after, m_boxes[i].cls, m_boxes[i].cls, joinPrev);
+    markDirty();
+    viewport()->update();
+    emit boxesChanged(m_boxes, m_currentStem);
+    return true;
+}
+
+void AnnotatorWidget::snapSelected()
+{
+    if (m_boxes.isEmpty()) return;
+    const int idx = (m_sel >= 0 && m_sel < m_boxes.size()) ? m_sel : m_boxes.size()-1;
+    snapBox(idx, false);
 }
 
 // =========================
@@ -10,6 +10,18 @@
 #include <QPointF>
 #include <QtGlobal>      // qBound
 #include <QMetaType>     // Q_DECLARE_METATYPE
+#include <QHash>
+#include <QSet>
+#include <QPointer>
+#include <QSize>
+#include <QThreadPool>
+#include <QTimer>
+#include <QImage>
+
+#include "annotation_history.h"   // BoxEdit / EditJournal (undo/redo)
+#include "label_serializer.h"     // YOLO/VOC metni (to_chars, tekrar kullanılan tampon)
+#include "keyframes.h"            // anahtar kare + ara değer
+#include "reviewqueue.h"          // karşılaştırma inceleme kuyruğu
 
 class QMouseEvent;
 class QWheelEvent;
@@ -17,12 +29,17 @@ class QKeyEvent;
 class QPainter;
 class QWidget;        // forward decl.
 class QDockWidget;    // forward decl.
+class LabelWriter;    // forward decl. (arka plan yazıcı)
+class ImageListModel; // forward decl. (sanal dosya listesi)
+class AnnotationStore; // forward decl. (tek dosya etiket deposu)
+class PreAnnotator;    // forward decl. (dedektör önerileri, ileri bakış)
 
 class AnnotatorWidget : public QGraphicsView
 {
     Q_OBJECT
 public:
     explicit AnnotatorWidget(QWidget* parent=nullptr);
+    ~AnnotatorWidget() override;
 
     // --- Mevcut API ---
     bool     loadImage(const QString& path);
@@ -33,27 +50,80 @@ public:
     void     setFormat(const QString& f);
     void     setSaveDir(const QString& d);
     QString  currentImage() const;
+    QSize    imageSize() const { return m_imageSize; }   // tam çözünürlük (sahne px)
     void     setActiveClass(const QString& c);
 
     // --- EKLENEN API (yapıyı bozmadan) ---
-    Q_INVOKABLE bool openDir(const QString& dir);
+    Q_INVOKABLE bool openDir(const QString& dir);   // arka planda taranır: ilk parçada ilk görsel açılır
     Q_INVOKABLE bool openFiles(const QStringList& files);
     bool            loadClassesFromFile(const QString& path);
 
     void     setActiveClassIndex(int idx) { setCurrentClass(idx); }
     int      currentClassIndex() const    { return m_currentClass; }
 
-    static QStringList listImagesCaseInsensitive(const QString& dir);
+    // Görsel değiştirirken (next/prev/liste) kaydedilmemiş kutuları otomatik kaydet
+    void     setAutosave(bool on) { m_autosave = on; }
+    bool     autosave() const     { return m_autosave; }
+    bool     isDirty() const      { return m_dirty; }
+
+    // İsteğe bağlı tek dosya deposu: kayıtlar WAL'a da yazılır, açılışta kutular oradan gelir
+    void     setAnnotationStore(AnnotationStore* store);
+
+    // İsteğe bağlı ön etiketleme: açılan görselden sonraki K görsel için öneri istenir,
+    // hazır olanlar kabul/ret adayı olarak gösterilir (gezinmeyi hiç bekletmez)
+    void     setPreAnnotator(PreAnnotator* pre);
 
     // Kutular (public)
-    struct Box { QRectF rect; int cls = 0; };
+    struct Box { QRectF rect; int cls = 0; int track = -1; };   // track: anahtar kare eşleşmesi (-1: yok)
     using Boxes = QVector<Box>;
 
+    // Öneri kutuları: kaydedilmez; kabul edilince (Enter / tıklayıp düzenleme) gerçek kutu olur.
+    // source: gösterimde ve log'da ("track" vb.)
+    void     setProposals(const QVector<Box>& boxes, const QString& source);
+    int      proposalCount() const { return int(m_proposals.size()); }
+
+    // Anahtar kareler: aradaki kareler gösterimde hesaplanır (kaydedilince diske iner)
+    void     setInterpolationMode(KeyframeTracks::Mode m);
+    KeyframeTracks::Mode interpolationMode() const { return m_interpMode; }
+    int      keyframeCount() const { return m_keyframes.count(); }
+
+    // Kenar yapıştırma: çizim bitince otomatik (isteğe bağlı) ya da R ile seçili kutuya
+    void     setAutoSnap(bool on) { m_autoSnap = on; }
+    bool     autoSnap() const     { return m_autoSnap; }
+
+    // İnceleme modu: karşılaştırma kuyruğu anlaşmazlık sırasıyla gezilir (D/A), iki etiket seti
+    // üst üste çizilir, karşılıksız kutular vurgulanır (O: katmanı gizle/göster). Sonraki görseller
+    // arka planda görünüm boyutunda decode edilir. Stem'ler önce açık listeden, sonra imagesDir'den çözülür
+    // (imagesDir arka planda taranır; o durumda kuyruk tarama bitince açılır, dönüş: başladı mı).
+    bool     startReview(const ReviewQueue& queue, const QString& imagesDir);
+    void     stopReview();                     // önceki görsel listesine döner
+    bool     inReview() const { return m_reviewActive; }
+
 public slots:
     bool saveCurrent();
     void nextImage();
     void prevImage();
     void setImageList(const QStringList& list, int startIndex=0);
+    void setImageModel(ImageListModel* model, int startIndex=0);   // kopyasız, büyük klasörler
+
+    // Undo / Redo (Ctrl+Z / Ctrl+Shift+Z) — görsel başına günlük
+    void undo();
+    void redo();
+
+    // Öneriler: Enter hepsini kabul, Esc hepsini at
+    void acceptProposals();
+    void rejectProposals();
+
+    // Burst: kutuları şablon takibiyle sonraki kareye taşı (T). Sonuç arka planda önceden hesaplanır.
+    void propagateToNext();
+
+    // Anahtar kare (K: işaretle/güncelle, Shift+K: kaldır); ara kareleri toplu yaz (paralel)
+    void markKeyframe();
+    void unmarkKeyframe();
+    void commitInterpolated();
+
+    // Seçili (yoksa son) kutunun kenarlarını en yakın güçlü gradyana yapıştır (R)
+    void snapSelected();
 
     // --- Dock ↔ Full host yönetimi ---
     void setHosts(QDockWidget* dock,
@@ -67,18 +137,64 @@ signals:
     void boxesChanged(const QVector<Box>& boxes, const QString& stem);
     void log(const QString& line);
     void info(const QString& msg);
+    void labelSaved(const QString& labelPath);   // dosya diske indiğinde
 
 protected:
     void mousePressEvent(QMouseEvent*) override;
     void mouseMoveEvent(QMouseEvent*) override;
     void mouseReleaseEvent(QMouseEvent*) override;
     void wheelEvent(QWheelEvent*) override;
+    void resizeEvent(QResizeEvent*) override;
     void keyPressEvent(QKeyEvent*) override;
     void drawForeground(QPainter* p, const QRectF& r) override;
 
 private:
     bool saveYOLO(const QString& imgPath, const QString& outDir);
     bool saveVOC (const QString& imgPath, const QString& outDir);
+    const QVector<LabelSerializer::Box>& serializerBoxes();
+    void onLabelWritten(const QString& path, bool ok, const QString& error);
+    void markDirty() { m_dirty = true; }
+    bool hasImage() const { return !m_imageSize.isEmpty(); }
+    void maybeUpgradeResolution();             // zoom ekran pikselini aştıysa tam çözünürlüğü iste
+    void acceptProposal(int i, bool joinPrev=false);
+    void schedulePropagation();                // kutular/görsel değişince (gecikmeli)
+    void startPropagation();
+    void applyPropagation();
+    QString ensureSaveDir();                   // boşsa görsel klasörü altında labels_* seç
+    QString keyframeFile() const;
+    void    loadKeyframes();
+    void    saveKeyframes();
+    void    storeKeyframe(int frame);          // m_boxes → m_keyframes[frame] (açık görselin karesi)
+    void    autosaveBeforeLeave();             // indeks / liste değişmeden önce: m_index hâlâ açık görselde
+    QVector<Box> withoutOverlaps(const QVector<Box>& boxes) const;   // mevcut kutularla IoU > 0.5 olanları at
+    void    requestPreannotation();
+    void    showModelProposals();
+    void    snapBox(int i, bool joinPrev);     // joinPrev: otomatik (oluşturmayla tek adım, sessiz)
+    bool    applySnap(int i, const QRectF& before, QRectF after, bool joinPrev, bool quiet);
+    QSize   decodeTarget() const;              // ilk gösterim decode boyutu (cihaz pikseli)
+    void    prefetchAround();                  // inceleme: önceki + sonraki kReviewLookAhead görsel
+    void    leaveReview();                     // kuyruk + ileri okuma bırakılır (liste geri yüklenmez)
+    const ReviewQueue::Item* reviewItem() const;
+    void    drawReview(QPainter* p, const ReviewQueue::Item& it);
+
+    // görsel kaynağı: ya m_images ya da paylaşılan model
+    int     imageCount() const;
+    QString imageAt(int i) const;
+    void    startAt(int startIndex);
+    void    applyImageList(const QStringList& list, int startIndex);   // setImageList gövdesi (taramayı bırakmaz)
+    void    relocateAfterListChange();         // liste büyüdü/sıralandı: anahtar kareler + açık görselin satırı
+    void    cancelDirScan();                   // openDir / startReview taraması: sonucu düşer
+    bool    finishReview(const ReviewQueue& queue, const QHash<QString, QString>& byStem);
+
+    // ===========================
+    // UNDO/REDO yardımcıları
+    // ===========================
+    void recordEdit(BoxEdit::Op op, int index,
+                    const QRectF& before, const QRectF& after,
+                    int clsBefore, int clsAfter, bool joinPrev=false);
+    void applyEdit(const BoxEdit& e, bool forward);
+    void stashSession();                       // mevcut görselin kutu+günlük durumunu sakla
+    void restoreSession(const QString& path);  // varsa geri yükle
 
     // ===========================
     // HAREKET / RESIZE yardımcıları
@@ -110,9 +226,77 @@ private:
     QString     m_imagePath;
     QString     m_currentStem;
 
+    // Görüntü: önce görünüm boyutunda decode, gerekince tam çözünürlük (arka planda).
+    // Sahne koordinatları her zaman tam çözünürlük pikseli; m_pix ölçek dönüşümüyle oturur.
+    QSize       m_imageSize;
+    bool        m_fullRes    = true;
+    bool        m_upgrading  = false;
+    quint64     m_decodeGen  = 0;          // görsel değişince uçuştaki decode sonucu atılır
+    QThreadPool m_decodePool;
+    QImage      m_fullImage;               // tam çözünürlük decode elde varsa (kenar yapıştırma için)
+    bool        m_autoSnap   = false;
+
     QStringList m_images;
+    QPointer<ImageListModel> m_imageModel;   // set ise m_images yerine kullanılır
     int         m_index  = -1;
 
+    // kayıt durumu (arka plan yazıcı + autosave)
+    LabelWriter* m_writer   = nullptr;
+    LabelSerializer m_serializer;              // kayıt metni (tampon tekrar kullanılır)
+    QVector<LabelSerializer::Box> m_serBoxes;
+    bool         m_autosave = false;
+    bool         m_dirty    = false;   // son kayıttan beri kutu değişti mi?
+    QPointer<AnnotationStore> m_store;
+    QPointer<PreAnnotator>    m_pre;
+
+    // öneriler (kaydedilmez) + sonraki kareye taşıma (arka planda hazır tutulur)
+    QVector<Box> m_proposals;
+    QString      m_proposalSource;
+    struct Propagation {
+        QString      from, to;                 // görsel yolları
+        QVector<Box> boxes;                    // to karesindeki öneriler
+        bool         ready = false;
+    };
+    Propagation  m_prop;
+    bool         m_propPending = false;        // kullanıcı istedi, sonuç bekleniyor
+    quint64      m_trackGen    = 0;
+    QTimer       m_trackDebounce;
+    QThreadPool  m_trackPool;
+
+    // anahtar kareler (dizide track ID ile ara değer)
+    KeyframeTracks       m_keyframes;
+    KeyframeTracks::Mode m_interpMode = KeyframeTracks::Mode::Linear;
+    bool                 m_committing = false;
+    QSet<QString>        m_bulkWrites;         // LabelWriter kuyruğundaki ara kareler (tek tek loglanmaz)
+    int                  m_bulkFailed = 0;
+
+    // inceleme modu: m_images[i] ↔ m_review.items[i]; önceki liste çıkışta geri yüklenir
+    struct Prefetched { QImage img; QSize full, target; };
+    static constexpr int     kReviewLookAhead = 4;
+    bool                     m_reviewActive  = false;
+    bool                     m_reviewOverlay = true;
+    ReviewQueue              m_review;
+    QStringList              m_reviewPrevImages;
+    QPointer<ImageListModel> m_reviewPrevModel;
+    int                      m_reviewPrevIndex = 0;
+    quint64                  m_dirScan    = 0; // DirScanner bileti (openDir / startReview)
+    quint64                  m_dirScanGen = 0; // liste dışarıdan değişince artar: bekleyen parça/sonuç düşer
+    QHash<QString, Prefetched> m_prefetched;  // yol → decode (pencere dışı budanır)
+    QSet<QString>            m_prefetching;   // uçuştaki decode'lar
+    quint64                  m_prefetchGen = 0;
+    QThreadPool              m_prefetchPool;
+
+    // undo/redo: aktif günlük + ziyaret edilen görsellerin oturumları (LRU sınırlı)
+    struct ImageSession {
+        QVector<Box> boxes;
+        EditJournal  journal;
+        bool         dirty = false;
+    };
+    static constexpr int         kMaxSessions = 64;
+    EditJournal                  m_journal;
+    QHash<QString, ImageSession> m_sessions;     // imagePath → oturum
+    QStringList                  m_sessionLru;   // en son kullanılan sonda
+
     // çizim durumu (yeni kutu oluşturma)
     bool    m_drawing = false;
     QPointF m_startScene, m_lastScene;
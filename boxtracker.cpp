@@ -0,0 +1,198 @@
+// boxtracker.cpp
+#include "boxtracker.h"
+
+#include <QImageReader>
+#include <QRect>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int kLevels = 3;
+
+// 2x2 ortalama ile yarıya indir (gri)
+QImage halve(const QImage& src)
+{
+    const int w = src.width() / 2, h = src.height() / 2;
+    if (w < 1 || h < 1) return {};
+    QImage dst(w, h, QImage::Format_Grayscale8);
+    for (int y = 0; y < h; ++y) {
+        const uchar* a = src.constScanLine(2 * y);
+        const uchar* b = src.constScanLine(2 * y + 1);
+        uchar*       d = dst.scanLine(y);
+        for (int x = 0; x < w; ++x)
+            d[x] = uchar((a[2*x] + a[2*x + 1] + b[2*x] + b[2*x + 1] + 2) >> 2);
+    }
+    return dst;
+}
+
+// Şablon: önceki karenin bir bölgesi (kopyasız)
+struct Tpl
+{
+    const QImage* img = nullptr;
+    int    x = 0, y = 0, w = 0, h = 0;
+    double sum = 0, norm = 0;       // Σt, sqrt(Σ(t - t̄)²)
+
+    bool init(const QImage& src, const QRect& r)
+    {
+        const QRect c = r.intersected(src.rect());
+        if (c.width() < 3 || c.height() < 3) return false;
+        img = &src; x = c.x(); y = c.y(); w = c.width(); h = c.height();
+        qint64 s = 0, ss = 0;
+        for (int row = 0; row < h; ++row) {
+            const uchar* p = src.constScanLine(y + row) + x;
+            int rs = 0, rss = 0;
+            for (int i = 0; i < w; ++i) { const int v = p[i]; rs += v; rss += v * v; }
+            s += rs; ss += rss;
+        }
+        const double n = double(w) * h;
+        sum  = double(s);
+        norm = std::sqrt(std::max(0.0, double(ss) - sum * sum / n));
+        return norm > 1e-3;         // düz (dokusuz) bölge takip edilemez
+    }
+};
+
+// Şablonun img içinde (px,py) sol üst konumundaki NCC skoru
+double nccAt(const Tpl& t, const QImage& img, int px, int py)
+{
+    qint64 sI = 0, sII = 0, sIT = 0;
+    for (int row = 0; row < t.h; ++row) {
+        const uchar* a = img.constScanLine(py + row) + px;
+        const uchar* b = t.img->constScanLine(t.y + row) + t.x;
+        int ri = 0, rii = 0, rit = 0;               // satır başına 32 bit (w ≤ 33k güvenli)
+        for (int i = 0; i < t.w; ++i) {
+            const int va = a[i], vb = b[i];
+            ri  += va;
+            rii += va * va;
+            rit += va * vb;
+        }
+        sI += ri; sII += rii; sIT += rit;
+    }
+    const double n     = double(t.w) * t.h;
+    const double iVar  = double(sII) - double(sI) * double(sI) / n;
+    if (iVar <= 1e-6) return 0.0;
+    return (double(sIT) - double(sI) * t.sum / n) / (std::sqrt(iVar) * t.norm);
+}
+
+// (cx,cy) çevresinde ±r ara; en iyi sol üst konum *bx,*by
+double searchBest(const Tpl& t, const QImage& img, int cx, int cy, int r, int* bx, int* by)
+{
+    const int x0 = std::max(0, cx - r), x1 = std::min(img.width()  - t.w, cx + r);
+    const int y0 = std::max(0, cy - r), y1 = std::min(img.height() - t.h, cy + r);
+    double best = -2.0;
+    *bx = std::clamp(cx, 0, std::max(0, img.width()  - t.w));
+    *by = std::clamp(cy, 0, std::max(0, img.height() - t.h));
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            const double s = nccAt(t, img, x, y);
+            if (s > best) { best = s; *bx = x; *by = y; }
+        }
+    }
+    return best;
+}
+
+QRect scaledDown(const QRect& r, int level)
+{
+    return QRect(r.x() >> level, r.y() >> level,
+                 std::max(1, r.width() >> level), std::max(1, r.height() >> level));
+}
+
+} // namespace
+
+QImage BoxTracker::loadGray(const QString& path, int longSide, QSize* full)
+{
+    QImageReader r(path);
+    r.setAutoTransform(true);
+    const QSize raw  = r.size();
+    const bool  rot  = (r.transformation() & QImageIOHandler::TransformationRotate90);
+    const QSize disp = rot ? raw.transposed() : raw;
+    if (disp.isValid() && longSide > 0 && std::max(disp.width(), disp.height()) > longSide) {
+        const QSize want = disp.scaled(longSide, longSide, Qt::KeepAspectRatio);
+        r.setScaledSize(rot ? want.transposed() : want);
+    }
+    QImage img = r.read();
+    if (full) *full = disp.isValid() ? disp : img.size();
+    if (img.isNull()) return {};
+    return img.convertToFormat(QImage::Format_Grayscale8);
+}
+
+QVector<BoxTracker::Result> BoxTracker::trackGray(const QImage& prev, const QImage& next,
+                                                  const QVector<QRectF>& boxes, const Params& p)
+{
+    QVector<Result> out(boxes.size());
+    if (prev.isNull() || next.isNull() || prev.size() != next.size()) return out;
+
+    QImage pp[kLevels], np[kLevels];
+    pp[0] = prev; np[0] = next;
+    int levels = 1;
+    for (; levels < kLevels; ++levels) {
+        pp[levels] = halve(pp[levels - 1]);
+        np[levels] = halve(np[levels - 1]);
+        if (pp[levels].isNull()) break;
+    }
+
+    for (int k = 0; k < boxes.size(); ++k) {
+        const QRect rb = boxes[k].toAlignedRect().intersected(prev.rect());
+        out[k].rect = boxes[k];
+        if (rb.width() < 4 || rb.height() < 4) continue;
+
+        // Kaba seviye: şablon maxTemplate'e inene kadar (kısa kenar ≥ 4 kalsın)
+        int L = 0;
+        while (L + 1 < levels
+               && (std::max(rb.width(), rb.height()) >> L) > p.maxTemplate
+               && (std::min(rb.width(), rb.height()) >> (L + 1)) >= 4)
+            ++L;
+
+        Tpl t;
+        if (!t.init(pp[L], scaledDown(rb, L))) continue;
+        int bx = 0, by = 0;
+        double score = searchBest(t, np[L], t.x, t.y, std::max(2, p.searchRadius >> L), &bx, &by);
+        int ox = bx - t.x, oy = by - t.y;
+
+        // İnce seviyelerde ±2 düzeltme; şablon kurulamazsa kalan seviyeler kadar ölçekle (ox/oy seviye 0 px)
+        int l = L - 1;
+        for (; l >= 0; --l) {
+            Tpl tl;
+            if (!tl.init(pp[l], scaledDown(rb, l))) break;
+            ox *= 2; oy *= 2;
+            score = searchBest(tl, np[l], tl.x + ox, tl.y + oy, 2, &bx, &by);
+            ox = bx - tl.x; oy = by - tl.y;
+        }
+        ox *= 1 << (l + 1); oy *= 1 << (l + 1);
+
+        out[k].rect  = boxes[k].translated(ox, oy);
+        out[k].score = score;
+        out[k].ok    = score >= p.minScore;
+    }
+    return out;
+}
+
+QVector<BoxTracker::Result> BoxTracker::track(const QString& prevPath, const QString& nextPath,
+                                              const QVector<QRectF>& boxes, const Params& p)
+{
+    QVector<Result> out(boxes.size());
+    QSize fullPrev, fullNext;
+    const QImage a = loadGray(prevPath, p.workLongSide, &fullPrev);
+    QImage       b = loadGray(nextPath, p.workLongSide, &fullNext);
+    if (a.isNull() || b.isNull() || fullPrev.isEmpty() || fullNext.isEmpty()) return out;
+    if (b.size() != a.size())
+        b = b.scaled(a.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    // tam çözünürlük → çalışma ölçeği
+    const double sx = double(a.width())  / fullPrev.width();
+    const double sy = double(a.height()) / fullPrev.height();
+    QVector<QRectF> work;
+    work.reserve(boxes.size());
+    for (const QRectF& r : boxes)
+        work << QRectF(r.x() * sx, r.y() * sy, r.width() * sx, r.height() * sy);
+
+    out = trackGray(a, b, work, p);
+
+    // çalışma ölçeği → sonraki karenin tam çözünürlüğü
+    const double bx = double(fullNext.width())  / a.width();
+    const double by = double(fullNext.height()) / a.height();
+    for (Result& r : out)
+        r.rect = QRectF(r.rect.x() * bx, r.rect.y() * by, r.rect.width() * bx, r.rect.height() * by)
+                     .intersected(QRectF(QPointF(0, 0), fullNext));
+    return out;
+}
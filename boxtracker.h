@@ -0,0 +1,41 @@
+// boxtracker.h
+#pragma once
+
+#include <QImage>
+#include <QRectF>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+// Ardışık (burst) kareler arasında kutu taşıma: yerel pencerede NCC şablon araması.
+//  - İki kare de gri (8 bit) ve küçültülmüş decode edilir; 3 seviyeli piramit
+//  - Kutu başına: şablon küçük olduğu seviyede ±R kaba arama → her ince seviyede ±2 düzeltme
+//  - Sadece öteleme (burst karelerinde kutu boyu pratikte değişmez)
+//  - İç döngü satır başına tamsayı toplamları (Σ I, Σ I², Σ I·T): derleyici vektörleştirir
+// Worker thread'den çağrılmak üzere; GUI'ye dokunmaz.
+class BoxTracker
+{
+public:
+    struct Params {
+        int    workLongSide = 960;   // çalışma çözünürlüğü (uzun kenar, px)
+        int    searchRadius = 48;    // çalışma ölçeğinde arama yarıçapı (px)
+        int    maxTemplate  = 24;    // kaba seviyede şablonun uzun kenarı en fazla
+        double minScore     = 0.55;  // NCC eşiği; altı "kayıp" sayılır
+    };
+    struct Result {
+        QRectF rect;                 // sonraki karede (tam çözünürlük px)
+        double score = 0;            // NCC (-1..1)
+        bool   ok    = false;
+    };
+
+    // Tam çözünürlük koordinatlarında kutular; dönüş aynı sırada
+    static QVector<Result> track(const QString& prevPath, const QString& nextPath,
+                                 const QVector<QRectF>& boxes, const Params& p = Params());
+
+    // Gri (Format_Grayscale8) ve aynı boyutta iki kare; kutular bu karelerin koordinatında
+    static QVector<Result> trackGray(const QImage& prev, const QImage& next,
+                                     const QVector<QRectF>& boxes, const Params& p = Params());
+
+    // EXIF döndürmesi uygulanmış, uzun kenarı en fazla longSide olan gri decode; *full: tam boyut
+    static QImage loadGray(const QString& path, int longSide, QSize* full);
+};
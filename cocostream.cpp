@@ -0,0 +1,370 @@
+// cocostream.cpp
+#include "cocostream.h"
+#include "label_serializer.h"
+
+#include <QIODevice>
+#include <QDebug>
+
+namespace {
+
+constexpr int kReadChunk = 64 * 1024;
+
+void appendUtf8(QByteArray& out, uint cp)
+{
+    if (cp < 0x80)         { out += char(cp); }
+    else if (cp < 0x800)   { out += char(0xC0 | (cp >> 6));  out += char(0x80 | (cp & 0x3F)); }
+    else if (cp < 0x10000) { out += char(0xE0 | (cp >> 12)); out += char(0x80 | ((cp >> 6) & 0x3F));
+                             out += char(0x80 | (cp & 0x3F)); }
+    else                   { out += char(0xF0 | (cp >> 18)); out += char(0x80 | ((cp >> 12) & 0x3F));
+                             out += char(0x80 | ((cp >> 6) & 0x3F)); out += char(0x80 | (cp & 0x3F)); }
+}
+
+int hexVal(int c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+qint64 toId(const QByteArray& num)
+{
+    bool ok = false;
+    const qint64 v = num.toLongLong(&ok);
+    return ok ? v : qint64(num.toDouble());   // "12.0" gibi yazan araçlar var
+}
+
+} // namespace
+
+QByteArray cocoJsonString(const QString& s)
+{
+    static const char hex[] = "0123456789abcdef";
+    const QByteArray u = s.toUtf8();
+    QByteArray out;
+    out.reserve(u.size() + 2);
+    out += '"';
+    for (char ch : u) {
+        const uchar c = uchar(ch);
+        if (c == '"' || c == '\\') { out += '\\'; out += ch; }
+        else if (c < 0x20)         { out += "\\u00"; out += hex[c >> 4]; out += hex[c & 15]; }
+        else                        out += ch;
+    }
+    out += '"';
+    return out;
+}
+
+// ---------------------------
+// JsonPull
+// ---------------------------
+JsonPull::JsonPull(QIODevice* dev)
+    : m_dev(dev)
+{
+}
+
+int JsonPull::peek()
+{
+    if (m_pos >= m_buf.size()) {
+        m_consumed += m_buf.size();
+        m_buf = m_dev ? m_dev->read(kReadChunk) : QByteArray();
+        m_pos = 0;
+        if (m_buf.isEmpty()) return -1;
+    }
+    return uchar(m_buf.at(m_pos));
+}
+
+int JsonPull::get()
+{
+    const int c = peek();
+    if (c >= 0) ++m_pos;
+    return c;
+}
+
+void JsonPull::skipSpace()
+{
+    for (int c = peek(); c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == ',' || c == ':'; c = peek())
+        ++m_pos;
+}
+
+JsonPull::Tok JsonPull::fail(const QString& msg)
+{
+    m_error = QStringLiteral("%1 (byte %2)").arg(msg).arg(bytesRead());
+    return Error;
+}
+
+bool JsonPull::readString()
+{
+    m_text.clear();
+    for (;;) {
+        const int c = get();
+        if (c < 0)    return false;
+        if (c == '"') return true;
+        if (c != '\\') { m_text += char(c); continue; }
+
+        const int e = get();
+        switch (e) {
+        case '"': case '\\': case '/': m_text += char(e); break;
+        case 'b': m_text += '\b'; break;
+        case 'f': m_text += '\f'; break;
+        case 'n': m_text += '\n'; break;
+        case 'r': m_text += '\r'; break;
+        case 't': m_text += '\t'; break;
+        case 'u': {
+            auto hex4 = [this]() -> int {
+                int v = 0;
+                for (int i = 0; i < 4; ++i) {
+                    const int h = hexVal(get());
+                    if (h < 0) return -1;
+                    v = (v << 4) | h;
+                }
+                return v;
+            };
+            int cp = hex4();
+            if (cp < 0) return false;
+            if (cp >= 0xD800 && cp <= 0xDBFF && peek() == '\\') {   // vekil çifti
+                get();
+                if (get() != 'u') return false;
+                const int lo = hex4();
+                if (lo < 0xDC00 || lo > 0xDFFF) return false;
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+            }
+            appendUtf8(m_text, uint(cp));
+            break;
+        }
+        default: return false;
+        }
+    }
+}
+
+bool JsonPull::readLiteral(const char* lit)
+{
+    for (const char* p = lit; *p; ++p)
+        if (get() != uchar(*p)) return false;
+    return true;
+}
+
+JsonPull::Tok JsonPull::next()
+{
+    skipSpace();
+    const int c = peek();
+    switch (c) {
+    case -1:  return End;
+    case '{': ++m_pos; return BeginObject;
+    case '}': ++m_pos; return EndObject;
+    case '[': ++m_pos; return BeginArray;
+    case ']': ++m_pos; return EndArray;
+    case '"': {
+        ++m_pos;
+        if (!readString()) return fail("bad string");
+        for (int s = peek(); s == ' ' || s == '\n' || s == '\r' || s == '\t'; s = peek()) ++m_pos;
+        if (peek() == ':') { ++m_pos; return Key; }
+        return String;
+    }
+    case 't': if (!readLiteral("true"))  return fail("bad literal"); m_bool = true;  return Bool;
+    case 'f': if (!readLiteral("false")) return fail("bad literal"); m_bool = false; return Bool;
+    case 'n': if (!readLiteral("null"))  return fail("bad literal"); return Null;
+    default:
+        break;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        m_text.clear();
+        for (int d = peek(); (d >= '0' && d <= '9') || d == '-' || d == '+' || d == '.' || d == 'e' || d == 'E'; d = peek())
+            m_text += char(get());
+        return Number;
+    }
+    return fail(QStringLiteral("unexpected '%1'").arg(QChar(c)));
+}
+
+bool JsonPull::skipValue(Tok first)
+{
+    if (first == Error || first == End || first == EndObject || first == EndArray) return false;
+    if (first != BeginObject && first != BeginArray) return true;
+    int depth = 1;
+    while (depth > 0) {
+        const Tok t = next();
+        if (t == BeginObject || t == BeginArray)    ++depth;
+        else if (t == EndObject || t == EndArray)   --depth;
+        else if (t == Error || t == End)            return false;
+    }
+    return true;
+}
+
+// ---------------------------
+// CocoReader
+// ---------------------------
+bool CocoReader::read(QIODevice* dev, QString* err)
+{
+    enum Section { Other, Images, Annotations, Categories };
+    JsonPull p(dev);
+    const auto fail = [&](const QString& msg){
+        if (err) *err = p.errorString().isEmpty() ? QStringLiteral("%1 (byte %2)").arg(msg).arg(p.bytesRead())
+                                                  : p.errorString();
+        return false;
+    };
+
+    // Tek öğe: ilgilenilen alanları topla, gerisini (segmentation vb.) atla
+    const auto readObject = [&](Section sec) -> bool {
+        CocoImage im; CocoAnnotation an; CocoCategory cat;
+        for (;;) {
+            JsonPull::Tok t = p.next();
+            if (t == JsonPull::EndObject) break;
+            if (t != JsonPull::Key) return false;
+            const QByteArray k = p.text();
+            t = p.next();
+            if (t == JsonPull::Number) {
+                if (k == "id")               im.id = an.id = cat.id = toId(p.text());
+                else if (k == "width")       im.width  = int(p.text().toDouble());
+                else if (k == "height")      im.height = int(p.text().toDouble());
+                else if (k == "image_id")    an.imageId    = toId(p.text());
+                else if (k == "category_id") an.categoryId = toId(p.text());
+            } else if (t == JsonPull::String) {
+                if (k == "file_name")        im.fileName = QString::fromUtf8(p.text());
+                else if (k == "name")        cat.name    = QString::fromUtf8(p.text());
+            } else if (t == JsonPull::BeginArray && k == "bbox") {
+                int n = 0;
+                for (;;) {
+                    t = p.next();
+                    if (t == JsonPull::EndArray) break;
+                    if (t == JsonPull::Number && n < 4) an.bbox[n++] = p.text().toDouble();
+                    else if (!p.skipValue(t)) return false;
+                }
+            } else if (!p.skipValue(t)) {
+                return false;
+            }
+        }
+        switch (sec) {
+        case Images:      if (onImage)      onImage(im);      break;
+        case Annotations: if (onAnnotation) onAnnotation(an); break;
+        case Categories:  if (onCategory)   onCategory(cat);  break;
+        default: break;
+        }
+        return true;
+    };
+
+    if (p.next() != JsonPull::BeginObject) return fail("COCO: top level is not an object");
+    for (;;) {
+        JsonPull::Tok t = p.next();
+        if (t == JsonPull::EndObject) break;
+        if (t != JsonPull::Key) return fail("COCO: key expected");
+        const QByteArray key = p.text();
+        const Section sec = key == "images" ? Images : key == "annotations" ? Annotations
+                          : key == "categories" ? Categories : Other;
+        t = p.next();
+        if (sec == Other || t != JsonPull::BeginArray) {
+            if (!p.skipValue(t)) return fail("COCO: bad value for " + QString::fromUtf8(key));
+            continue;
+        }
+        for (int n = 0;; ++n) {
+            if ((n & 4095) == 0 && cancelled && cancelled()) return fail("cancelled");
+            t = p.next();
+            if (t == JsonPull::EndArray) break;
+            if (t == JsonPull::BeginObject) {
+                if (!readObject(sec)) return fail("COCO: bad element in " + QString::fromUtf8(key));
+            } else if (!p.skipValue(t)) {
+                return fail("COCO: bad array " + QString::fromUtf8(key));
+            }
+        }
+    }
+    return true;
+}
+
+// ---------------------------
+// CocoWriter
+// ---------------------------
+CocoWriter::CocoWriter() = default;
+
+CocoWriter::~CocoWriter()
+{
+    if (m_out) abort();
+}
+
+bool CocoWriter::open(const QString& path, QString* err)
+{
+    abort();
+    m_out = std::make_unique<QSaveFile>(path);
+    m_spool.setFileName(path + ".annotations.part");
+    if (!m_out->open(QIODevice::WriteOnly) || !m_spool.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (err) *err = m_out->isOpen() ? m_spool.errorString() : m_out->errorString();
+        abort();
+        return false;
+    }
+    m_nextImage = m_nextAnn = 1;
+    m_ok = m_out->write("{\n\"images\":[") > 0;
+    return m_ok;
+}
+
+qint64 CocoWriter::addImage(const QString& fileName, const QSize& size)
+{
+    const qint64 id = m_nextImage++;
+    m_line.resize(0);                          // kapasite korunur
+    m_line += (id > 1) ? ",\n{\"id\":" : "\n{\"id\":";
+    LabelSerializer::appendInt(m_line, id);
+    m_line += ",\"file_name\":";
+    m_line += cocoJsonString(fileName);
+    m_line += ",\"width\":";
+    LabelSerializer::appendInt(m_line, size.width());
+    m_line += ",\"height\":";
+    LabelSerializer::appendInt(m_line, size.height());
+    m_line += '}';
+    if (m_out && m_out->write(m_line) != m_line.size()) m_ok = false;
+    return id;
+}
+
+void CocoWriter::addAnnotation(qint64 imageId, int categoryId, const QRectF& b)
+{
+    const qint64 id = m_nextAnn++;
+    m_line.resize(0);                          // kapasite korunur
+    m_line += (id > 1) ? ",\n{\"id\":" : "\n{\"id\":";
+    LabelSerializer::appendInt(m_line, id);
+    m_line += ",\"image_id\":";
+    LabelSerializer::appendInt(m_line, imageId);
+    m_line += ",\"category_id\":";
+    LabelSerializer::appendInt(m_line, categoryId);
+    m_line += ",\"bbox\":[";
+    LabelSerializer::appendFixed(m_line, b.x(), 2);      m_line += ',';
+    LabelSerializer::appendFixed(m_line, b.y(), 2);      m_line += ',';
+    LabelSerializer::appendFixed(m_line, b.width(), 2);  m_line += ',';
+    LabelSerializer::appendFixed(m_line, b.height(), 2);
+    m_line += "],\"area\":";
+    LabelSerializer::appendFixed(m_line, b.width() * b.height(), 2);
+    m_line += ",\"iscrowd\":0}";
+    if (m_spool.write(m_line) != m_line.size()) m_ok = false;
+}
+
+bool CocoWriter::finish(const QStringList& categories, QString* err)
+{
+    if (!m_out) { if (err) *err = "not open"; return false; }
+    bool ok = m_ok && m_out->write("],\n\"annotations\":[") > 0;
+
+    // Yan dosyayı 1 MB'lık bloklarla hedefe kopyala
+    m_spool.close();
+    if (ok && m_spool.open(QIODevice::ReadOnly)) {
+        QByteArray block;
+        while (ok && !(block = m_spool.read(1 << 20)).isEmpty())
+            ok = m_out->write(block) == block.size();
+        m_spool.close();
+    } else {
+        ok = false;
+    }
+
+    QByteArray tail = "],\n\"categories\":[";
+    for (int c = 0; c < categories.size(); ++c) {
+        tail += (c ? ",\n{\"id\":" : "\n{\"id\":") + QByteArray::number(c + 1)
+              + ",\"name\":" + cocoJsonString(categories[c]) + '}';
+    }
+    tail += "]}\n";
+    ok = ok && m_out->write(tail) == tail.size() && m_out->commit();
+    if (!ok && err) *err = m_out->errorString();
+
+    if (!ok) m_out->cancelWriting();
+    QFile::remove(m_spool.fileName());
+    m_out.reset();
+    return ok;
+}
+
+void CocoWriter::abort()
+{
+    if (m_out) { m_out->cancelWriting(); m_out.reset(); }
+    if (m_spool.isOpen()) m_spool.close();
+    if (!m_spool.fileName().isEmpty()) QFile::remove(m_spool.fileName());
+    m_ok = false;
+}
@@ -0,0 +1,92 @@
+// cocostream.h
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QRectF>
+#include <QSaveFile>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <memory>
+
+class QIODevice;
+
+// COCO instances.json akış okuma/yazma. Belge hiçbir zaman bütün olarak belleğe alınmaz.
+//  - JsonPull  : parça parça (64 KB) okuyan çekme tabanlı JSON ayrıştırıcı (SAX benzeri jetonlar)
+//  - CocoReader: jetonlardan images / annotations / categories öğelerini geri çağrılarla verir;
+//                segmentation gibi ilgisiz alanlar tüketilip atlanır
+//  - CocoWriter: images doğrudan hedefe, annotations yan dosyaya akar; finish() birleştirir
+
+class JsonPull
+{
+public:
+    enum Tok { BeginObject, EndObject, BeginArray, EndArray, Key, String, Number, Bool, Null, End, Error };
+
+    explicit JsonPull(QIODevice* dev);
+
+    Tok               next();
+    const QByteArray& text() const { return m_text; }   // Key/String: çözülmüş UTF-8, Number: sayı metni
+    bool              boolValue() const { return m_bool; }
+    bool              skipValue(Tok first);              // first: değerin ilk jetonu (iç içe yapıyı atlar)
+    QString           errorString() const { return m_error; }
+    qint64            bytesRead() const { return m_consumed + m_pos; }
+
+private:
+    int  peek();                                         // -1: veri sonu
+    int  get();
+    void skipSpace();
+    bool readString();
+    bool readLiteral(const char* lit);
+    Tok  fail(const QString& msg);
+
+    QIODevice*  m_dev;
+    QByteArray  m_buf;
+    int         m_pos = 0;
+    qint64      m_consumed = 0;
+    QByteArray  m_text;
+    bool        m_bool = false;
+    QString     m_error;
+};
+
+struct CocoImage      { qint64 id = 0; QString fileName; int width = 0; int height = 0; };
+struct CocoAnnotation { qint64 id = 0; qint64 imageId = 0; qint64 categoryId = 0; double bbox[4] = {0,0,0,0}; };
+struct CocoCategory   { qint64 id = 0; QString name; };
+
+class CocoReader
+{
+public:
+    std::function<void(const CocoCategory&)>   onCategory;
+    std::function<void(const CocoImage&)>      onImage;
+    std::function<void(const CocoAnnotation&)> onAnnotation;
+    std::function<bool()>                      cancelled;   // isteğe bağlı; true → dur
+
+    bool read(QIODevice* dev, QString* err=nullptr);
+};
+
+class CocoWriter
+{
+public:
+    CocoWriter();
+    ~CocoWriter();
+
+    bool   open(const QString& path, QString* err=nullptr);
+    qint64 addImage(const QString& fileName, const QSize& size);               // görsel kimliği (1..)
+    void   addAnnotation(qint64 imageId, int categoryId, const QRectF& bboxPx);  // categoryId: 1..
+    bool   finish(const QStringList& categories, QString* err=nullptr);         // id = sıra + 1
+    void   abort();
+
+    qint64 imageCount() const      { return m_nextImage - 1; }
+    qint64 annotationCount() const { return m_nextAnn - 1; }
+
+private:
+    std::unique_ptr<QSaveFile> m_out;     // hedef (commit'e kadar geçici dosya)
+    QFile                      m_spool;   // annotations parçası
+    QByteArray                 m_line;    // tekrar kullanılan satır tamponu
+    qint64                     m_nextImage = 1;
+    qint64                     m_nextAnn   = 1;
+    bool                       m_ok = false;
+};
+
+QByteArray cocoJsonString(const QString& s);
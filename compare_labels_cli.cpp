@@ -0,0 +1,187 @@
+// compare_labels_cli.cpp
+// python/compare_labels.py'nin C++ karşılığı: GUI'deki LabelCompare motoru, pencere olmadan.
+//   compare_labels --dirA <klasör> --dirB <klasör> [--iou 0.9] [--csv out.csv]
+//                  [--fmt-a auto|yolo|xyxy|xyxy-pix|xywh|xywh-pix] [--fmt-b ...] [--images <görsel kökü>]
+//                  [--engine-match [--match-iou 0.5] [--optimal]] [--no-recursive] [-j N]
+//                  [--verbose] [--strict] [--report <klasör>]
+// CSV şeması Python betiğiyle aynı: image_stem,class_id,status,iou,strength
+//   status: match / missing_in_A (B'de var, A'da yok) / missing_in_B (A'da var, B'de yok)
+//   strength: IoU >= --iou → strong, değilse weak (sadece match satırlarında)
+// Varsayılan eşleştirme betiğinkiyle aynıdır: motorun MatchMode::PerClass'ı (sınıf bazlı, IoU'ya göre
+// azalan greedy, eşik yok; aynı sınıftaki her çift, IoU 0 bile eşleşebilir; --iou altı weak satırı olur).
+// --engine-match: motorun sınıftan bağımsız eşleştirmesi (--match-iou altı eşleşmez, sınıfı tutmayan
+// eşleşme iki missing satırı olur) — betikle sayılar farklı olabilir.
+// --report: images.csv + classes.csv + statik index.html (sayfalı, ayrıntılar tembel yüklenir; comparereport.h);
+// CSV, özet ve rapor aynı motor sonucundan (seçilen eşleştirme) üretilir.
+// Çıkış kodu: 0 tamam, 1 --strict ile eksik/zayıf eşleşme var, 2 kullanım/G-Ç hatası.
+#include "labelcompare.h"
+#include "comparereport.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+namespace {
+
+bool parseFmt(const QString& s, AnnFmt* out)
+{
+    static const struct { const char* name; AnnFmt fmt; } kFmts[] = {
+        {"auto", AnnFmt::UNKNOWN}, {"yolo", AnnFmt::YOLO},
+        {"xyxy", AnnFmt::XYXY_NORM}, {"xyxy-pix", AnnFmt::XYXY_PIX},
+        {"xywh", AnnFmt::XYWH_NORM}, {"xywh-pix", AnnFmt::XYWH_PIX},
+    };
+    for (const auto& f : kFmts)
+        if (s.compare(QLatin1String(f.name), Qt::CaseInsensitive) == 0) { *out = f.fmt; return true; }
+    return false;
+}
+
+struct Totals
+{
+    qint64 strong = 0, weak = 0, missA = 0, missB = 0;
+    double iouSum = 0;
+    Totals& operator+=(const Totals& o)
+    {
+        strong += o.strong; weak += o.weak; missA += o.missA; missB += o.missB; iouSum += o.iouSum;
+        return *this;
+    }
+};
+
+// Motor eşleştirmesinden satırlar: strong, weak, missing_in_A, missing_in_B (PerClass'ta her grup sınıf
+// sırasında — betikle aynı); sınıfı tutmayan eşleşme (Greedy/Optimal) iki missing satırı olur
+Totals countImage(const LabelCompare::ImageResult& r, double strongIou, QByteArray* csv)
+{
+    Totals img;
+    const QByteArray stem = r.stem.toUtf8();
+    QByteArray strongRows, weakRows, missA, missB;
+    for (const BoxMatch& m : r.pairs) {
+        const int ca = m.a >= 0 ? r.a[m.a].cls : -1;
+        const int cb = m.b >= 0 ? r.b[m.b].cls : -1;
+        if (m.a >= 0 && m.b >= 0 && ca == cb) {
+            const bool strong = m.iou >= strongIou;
+            if (csv) (strong ? strongRows : weakRows) += stem + ',' + QByteArray::number(ca) + ",match,"
+                                                      + QByteArray::number(m.iou, 'f', 6)
+                                                      + (strong ? ",strong\n" : ",weak\n");
+            ++(strong ? img.strong : img.weak);
+            img.iouSum += m.iou;
+            continue;
+        }
+        if (m.b >= 0) { ++img.missA; if (csv) missA += stem + ',' + QByteArray::number(cb) + ",missing_in_A,,\n"; }
+        if (m.a >= 0) { ++img.missB; if (csv) missB += stem + ',' + QByteArray::number(ca) + ",missing_in_B,,\n"; }
+    }
+    if (csv) *csv += strongRows + weakRows + missA + missB;
+    return img;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("compare_labels");
+
+    QCommandLineParser cli;
+    cli.setApplicationDescription("Compare two label directories with the in-app engine (YOLO / XYXY / XYWH / VOC).");
+    cli.addHelpOption();
+    const QCommandLineOption optA    ("dirA",         "Label directory A.", "dir");
+    const QCommandLineOption optB    ("dirB",         "Label directory B.", "dir");
+    const QCommandLineOption optIou  ("iou",          "Strong match threshold (default 0.9).", "thr", "0.9");
+    const QCommandLineOption optEngine("engine-match", "Use the in-app class-agnostic matcher instead of the script's per-class matching.");
+    const QCommandLineOption optMatch("match-iou",    "Engine matcher: minimum IoU to pair two boxes (default 0.5).", "thr", "0.5");
+    const QCommandLineOption optCsv  ("csv",          "Write per-box CSV here.", "file");
+    const QCommandLineOption optFmtA ("fmt-a",        "Format of A .txt files: auto|yolo|xyxy|xyxy-pix|xywh|xywh-pix.", "fmt", "auto");
+    const QCommandLineOption optFmtB ("fmt-b",        "Format of B .txt files (same values).", "fmt", "auto");
+    const QCommandLineOption optImg  ("images",       "Image root for pixel formats.", "dir");
+    const QCommandLineOption optOpt  ("optimal",      "Engine matcher: optimal (Hungarian) assignment instead of greedy.");
+    const QCommandLineOption optFlat ("no-recursive", "Do not descend into subdirectories.");
+    const QCommandLineOption optJobs (QStringList{"j", "jobs"},    "Worker threads (default: all cores).", "n", "0");
+    const QCommandLineOption optVerb (QStringList{"v", "verbose"}, "Print one line per image.");
+    const QCommandLineOption optStrict("strict",      "Exit with 1 if any box is missing or weak.");
+    const QCommandLineOption optReport("report",      "Write per-image/per-class CSV and a static HTML report here.", "dir");
+    cli.addOptions({optA, optB, optIou, optEngine, optMatch, optCsv, optFmtA, optFmtB, optImg,
+                    optOpt, optFlat, optJobs, optVerb, optStrict, optReport});
+    cli.process(app);
+
+    QTextStream out(stdout), err(stderr);
+    if (!cli.isSet(optA) || !cli.isSet(optB)) {
+        err << "--dirA and --dirB are required\n";
+        return 2;
+    }
+
+    LabelCompare::Job job;
+    job.oursDir    = cli.value(optA);
+    job.otherDir   = cli.value(optB);
+    job.imagesRoot = normalizeImagesRoot(cli.value(optImg));
+    const bool engineMatch = cli.isSet(optEngine);
+    job.mode       = !engineMatch        ? MatchMode::PerClass
+                   : cli.isSet(optOpt)   ? MatchMode::Optimal : MatchMode::Greedy;
+    job.recursive  = !cli.isSet(optFlat);
+    job.keepBoxes  = true;
+    job.threads    = cli.value(optJobs).toInt();
+    bool okIou = false, okMatch = false;
+    const double strongIou = cli.value(optIou).toDouble(&okIou);
+    job.iouThr             = cli.value(optMatch).toDouble(&okMatch);
+    if (!okIou || !okMatch || !parseFmt(cli.value(optFmtA), &job.oursFmt) || !parseFmt(cli.value(optFmtB), &job.otherFmt)) {
+        err << "invalid --iou / --match-iou / --fmt-a / --fmt-b\n";
+        return 2;
+    }
+    for (const QString& d : {job.oursDir, job.otherDir}) {
+        if (!QFileInfo(d).isDir()) { err << "not a directory: " << d << "\n"; return 2; }
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount((job.threads > 0 ? job.threads : QThread::idealThreadCount()) + 1);
+    const LabelCompare::Report rep = LabelCompare::compare(job, nullptr, {}, &pool);
+
+    const bool wantCsv = cli.isSet(optCsv);
+    QByteArray csv;
+    if (wantCsv) csv = "image_stem,class_id,status,iou,strength\n";
+    Totals t;
+    for (const LabelCompare::ImageResult& r : rep.images) {
+        const Totals img = countImage(r, strongIou, wantCsv ? &csv : nullptr);
+        t += img;
+        if (cli.isSet(optVerb)) {
+            out << "[" << r.stem << "] A:" << r.ours << " B:" << r.other
+                << " strong:" << img.strong << " weak<" << strongIou << ":" << img.weak
+                << " missInA:" << img.missA << " missInB:" << img.missB << "\n";
+        }
+    }
+
+    const qint64 matches = t.strong + t.weak;
+    out << "\n=== SUMMARY ===\n";
+    out << "matches:" << matches << " strong:" << t.strong << " weak:" << t.weak
+        << " missing_in_A:" << t.missA << " missing_in_B:" << t.missB
+        << " meanIoU:" << QString::number(matches ? t.iouSum / matches : 0.0, 'f', 4) << "\n";
+    out << "images:" << rep.files << " mode:" << matchModeName(rep.mode);
+    if (engineMatch) out << " match-iou:" << job.iouThr;
+    out << " threads:" << (pool.maxThreadCount() - 1)
+        << " elapsed:" << rep.elapsedMs << " ms\n";
+
+    if (wantCsv) {
+        const QString path = cli.value(optCsv);
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QSaveFile f(path);
+        if (!f.open(QIODevice::WriteOnly) || f.write(csv) != csv.size() || !f.commit()) {
+            err << "cannot write " << path << ": " << f.errorString() << "\n";
+            return 2;
+        }
+        out << "CSV saved: " << path << "\n";
+    }
+
+    if (cli.isSet(optReport)) {
+        const QString dir = cli.value(optReport);
+        QString rerr;
+        if (!CompareReport::exportCsv(rep, dir, &rerr) || !CompareReport::exportHtml(rep, dir, &rerr)) {
+            err << "cannot write report: " << rerr << "\n";
+            return 2;
+        }
+        out << "Report saved: " << QDir(dir).filePath("index.html") << "\n";
+    }
+
+    const bool clean = t.weak == 0 && t.missA == 0 && t.missB == 0;
+    return (cli.isSet(optStrict) && !clean) ? 1 : 0;
+}
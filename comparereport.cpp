@@ -0,0 +1,399 @@
+// comparereport.cpp
+#include "comparereport.h"
+#include "label_serializer.h"
+#include "cocostream.h"          // cocoJsonString
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+const char* fmtName(AnnFmt f)
+{
+    switch (f) {
+    case AnnFmt::YOLO:      return "yolo";
+    case AnnFmt::XYXY_NORM: return "xyxy";
+    case AnnFmt::XYXY_PIX:  return "xyxy-pix";
+    case AnnFmt::XYWH_NORM: return "xywh";
+    case AnnFmt::XYWH_PIX:  return "xywh-pix";
+    case AnnFmt::VOC_XML:   return "voc";
+    case AnnFmt::UNKNOWN:   break;
+    }
+    return "unknown";
+}
+
+void appendCounts(QByteArray& out, const MatchCounts& c)
+{
+    LabelSerializer::appendInt(out, c.tp);  out += ',';
+    LabelSerializer::appendInt(out, c.mis); out += ',';
+    LabelSerializer::appendInt(out, c.fp);  out += ',';
+    LabelSerializer::appendInt(out, c.fn);  out += ',';
+    LabelSerializer::appendFixed(out, c.similarity(), 4);
+}
+
+// Kutu başına 7 sayı: cls,x1,y1,x2,y2,durum,iou  (durum 0 eşleşti, 1 sınıf tutmadı, 2 karşılıksız)
+void appendBoxes(QByteArray& out, const QVector<XYXY>& boxes, const std::vector<quint8>& state,
+                 const std::vector<float>& iou)
+{
+    out += '[';
+    for (int i = 0; i < boxes.size(); ++i) {
+        const XYXY& b = boxes[i];
+        if (i) out += ',';
+        LabelSerializer::appendInt(out, b.cls);     out += ',';
+        LabelSerializer::appendFixed(out, b.x1, 4); out += ',';
+        LabelSerializer::appendFixed(out, b.y1, 4); out += ',';
+        LabelSerializer::appendFixed(out, b.x2, 4); out += ',';
+        LabelSerializer::appendFixed(out, b.y2, 4); out += ',';
+        LabelSerializer::appendInt(out, state[i]);  out += ',';
+        LabelSerializer::appendFixed(out, iou[i], 3);
+    }
+    out += ']';
+}
+
+void appendDetail(QByteArray& out, const LabelCompare::ImageResult& r)
+{
+    std::vector<quint8> sa(size_t(r.a.size()), 2), sb(size_t(r.b.size()), 2);
+    std::vector<float>  ia(size_t(r.a.size()), 0.f), ib(size_t(r.b.size()), 0.f);
+    for (const BoxMatch& m : r.pairs) {
+        if (m.a < 0 || m.b < 0 || m.a >= r.a.size() || m.b >= r.b.size()) continue;
+        sa[size_t(m.a)] = sb[size_t(m.b)] = (r.a[m.a].cls == r.b[m.b].cls) ? 0 : 1;
+        ia[size_t(m.a)] = ib[size_t(m.b)] = float(m.iou);
+    }
+    out += '[';
+    appendBoxes(out, r.a, sa, ia);
+    out += ',';
+    appendBoxes(out, r.b, sb, ib);
+    out += ']';
+}
+
+// Sayfa iskeleti: /*@SUMMARY@*/ gömülü özetle değiştirilir. MSVC dizgi sınırı (16 KB) altında tutulmalı.
+const char kHtml[] = R"HTML(<!doctype html>
+<html lang="tr"><head><meta charset="utf-8"><title>Etiket karşılaştırma raporu</title>
+<style>
+body{font:14px system-ui,sans-serif;margin:20px;color:#222}
+h1{font-size:20px;margin:0 0 4px}h2{font-size:16px;margin:20px 0 4px}.muted{color:#777}
+.cards{display:flex;flex-wrap:wrap;gap:8px;margin:12px 0}
+.card{border:1px solid #ddd;border-radius:6px;padding:6px 12px;min-width:90px;color:#555}
+.card b{display:block;font-size:18px;color:#222}
+table{border-collapse:collapse;margin:6px 0}
+th,td{border-bottom:1px solid #eee;padding:3px 10px;text-align:right;white-space:nowrap}
+th:first-child,td:first-child{text-align:left}
+tr.row{cursor:pointer}tr.row:hover{background:#f2f6ff}
+tr.detail>td{background:#fafafa;text-align:left}
+.bar{display:flex;gap:8px;align-items:center;flex-wrap:wrap;margin:8px 0}
+.s0{color:#2a8a3e}.s1{color:#c07000}.s2{color:#d02020}
+svg{background:#222;border-radius:4px;margin-right:16px;vertical-align:top}
+</style></head><body>
+<h1>Etiket karşılaştırma raporu</h1>
+<div id="meta" class="muted"></div>
+<div id="cards" class="cards"></div>
+<h2>Sınıf bazında</h2>
+<table id="classes"><thead><tr><th>Sınıf</th><th>TP</th><th>Sınıf uyuşmazlığı</th><th>FP (A'da fazla)</th><th>FN (B'de fazla)</th><th>Benzerlik</th></tr></thead><tbody></tbody></table>
+<h2>Görseller</h2>
+<div class="bar">
+<input id="q" placeholder="stem ara" size="24">
+<label><input type="checkbox" id="only" checked> yalnız farklı</label>
+<select id="sort"><option value="dis">uyumsuzluk ↓</option><option value="stem">stem</option>
+<option value="mis">sınıf uyuşmazlığı ↓</option><option value="fp">FP ↓</option><option value="fn">FN ↓</option></select>
+<button id="prev">‹</button><span id="page"></span><button id="next">›</button>
+</div>
+<table id="images"><thead><tr><th>Stem</th><th>A</th><th>B</th><th>TP</th><th>Sınıf</th><th>FP</th><th>FN</th><th>Uyumsuzluk</th></tr></thead>
+<tbody><tr><td colspan="8" class="muted">Dizin yükleniyor…</td></tr></tbody></table>
+<script>
+"use strict";
+const S = /*@SUMMARY@*/null;
+const PAGE = 100, STATES = ['eşleşti', 'sınıf tutmadı', 'karşılıksız'];
+const COLORS = [['#3cc85a', '#4696ff'], ['#ffaa00', '#ffaa00'], ['#ff3232', '#ff3cdc']];
+let I = null, view = [], page = 0;
+const chunks = {}, waiting = {};
+
+function $(id) { return document.getElementById(id); }
+function el(tag, text, cls) {
+  const e = document.createElement(tag);
+  if (text !== undefined) e.textContent = String(text);
+  if (cls) e.className = cls;
+  return e;
+}
+function sim(tp, mis, fp, fn) { const d = tp + mis + fp + fn; return d ? tp / d : 1; }
+function pct(v) { return (v * 100).toFixed(1) + '%'; }
+function load(src) {
+  const s = document.createElement('script');
+  s.src = src;
+  s.onerror = () => { $('page').textContent = ' ' + src + ' yüklenemedi '; };
+  document.head.appendChild(s);
+}
+function message(text) {
+  const tr = el('tr'), td = el('td', text, 'muted');
+  td.colSpan = 8; tr.appendChild(td);
+  document.querySelector('#images tbody').replaceChildren(tr);
+}
+
+function header() {
+  $('meta').textContent = 'A: ' + S.oursDir + '  ·  B: ' + S.otherDir + '  ·  IoU ' + S.iouThr + '  ·  ' + S.mode
+    + '  ·  ' + S.created + (S.cancelled ? '  ·  İPTAL EDİLDİ (kısmi sonuç)' : '');
+  const t = S.total;
+  const cards = [['Görsel', S.files], ['Farklı görsel', S.differing], ['TP', t[0]], ['Sınıf uyuşmazlığı', t[1]],
+                 ['FP', t[2]], ['FN', t[3]], ['Benzerlik', pct(sim(t[0], t[1], t[2], t[3]))], ['Süre', S.elapsedMs + ' ms']];
+  if (S.greedy) cards.push(['Greedy TP', S.greedy[0]], ['Farklı sonuçlu (greedy)', S.changedImages]);
+  for (const [k, v] of cards) { const c = el('div', k, 'card'); c.appendChild(el('b', v)); $('cards').appendChild(c); }
+  const tb = document.querySelector('#classes tbody');
+  for (const c of S.classes) {
+    const tr = el('tr');
+    for (const v of [c[0], c[1], c[2], c[3], c[4], pct(sim(c[1], c[2], c[3], c[4]))]) tr.appendChild(el('td', v));
+    tb.appendChild(tr);
+  }
+}
+
+// data/index.js: cmpIndex({stems, ours, other, tp, mis, fp, fn}) — anlaşmazlık sırasıyla
+window.cmpIndex = function (idx) {
+  I = idx;
+  const n = I.stems.length;
+  I.dis = new Float32Array(n);
+  I.lower = new Array(n);
+  for (let i = 0; i < n; ++i) {
+    I.dis[i] = 1 - sim(I.tp[i], I.mis[i], I.fp[i], I.fn[i]);
+    I.lower[i] = I.stems[i].toLowerCase();
+  }
+  rebuild();
+};
+// data/detail_<k>.js: cmpDetail(k, [[A kutuları, B kutuları], ...]) — k. parçadaki görseller
+window.cmpDetail = function (k, rows) {
+  chunks[k] = rows;
+  for (const f of waiting[k] || []) f();
+  delete waiting[k];
+};
+function detail(i, cb) {
+  const k = Math.floor(i / S.chunk), at = () => cb(chunks[k][i % S.chunk]);
+  if (chunks[k]) return at();
+  if (!waiting[k]) { waiting[k] = []; load('data/detail_' + k + '.js'); }
+  waiting[k].push(at);
+}
+
+function rebuild() {
+  if (!I) return;
+  const q = $('q').value.trim().toLowerCase(), only = $('only').checked, key = $('sort').value;
+  const out = [];
+  for (let i = 0, n = I.stems.length; i < n; ++i) {
+    if (only && I.mis[i] + I.fp[i] + I.fn[i] === 0) continue;
+    if (q && I.lower[i].indexOf(q) < 0) continue;
+    out.push(i);
+  }
+  if (key === 'stem') out.sort((a, b) => (I.stems[a] < I.stems[b] ? -1 : I.stems[a] > I.stems[b] ? 1 : 0));
+  else if (key !== 'dis') out.sort((a, b) => I[key][b] - I[key][a] || a - b);
+  view = out;
+  page = 0;
+  render();
+}
+
+function render() {
+  const pages = Math.max(1, Math.ceil(view.length / PAGE));
+  page = Math.min(Math.max(page, 0), pages - 1);
+  $('page').textContent = ' ' + (page + 1) + ' / ' + pages + '  (' + view.length + ' görsel) ';
+  if (!view.length) return message('Görsel yok');
+  const frag = document.createDocumentFragment();
+  for (const i of view.slice(page * PAGE, (page + 1) * PAGE)) {
+    const tr = el('tr', undefined, 'row');
+    for (const v of [I.stems[i], I.ours[i], I.other[i], I.tp[i], I.mis[i], I.fp[i], I.fn[i], I.dis[i].toFixed(3)])
+      tr.appendChild(el('td', v));
+    tr.onclick = () => toggle(tr, i);
+    frag.appendChild(tr);
+  }
+  document.querySelector('#images tbody').replaceChildren(frag);
+}
+
+function toggle(tr, i) {
+  const next = tr.nextElementSibling;
+  if (next && next.classList.contains('detail')) { next.remove(); return; }
+  const row = el('tr', undefined, 'detail'), td = el('td', S.boxes ? 'Yükleniyor…' : 'Bu raporda kutu ayrıntısı yok');
+  td.colSpan = 8;
+  row.appendChild(td);
+  tr.after(row);
+  if (S.boxes) detail(i, rec => showDetail(td, rec, i));
+}
+
+// Normalize koordinatlar kare alana çizilir: A düz, B kesikli; renk eşleşme durumuna göre
+function showDetail(td, rec, i) {
+  if (!rec[0].length && !rec[1].length && I.ours[i] + I.other[i] > 0) {
+    td.textContent = 'Tam uyum — kutu ayrıntısı yalnız farklı görseller için tutuldu';
+    return;
+  }
+  const ns = 'http://www.w3.org/2000/svg', svg = document.createElementNS(ns, 'svg');
+  svg.setAttribute('width', 280); svg.setAttribute('height', 280); svg.setAttribute('viewBox', '0 0 1 1');
+  const list = el('table');
+  ['A', 'B'].forEach((side, s) => {
+    const f = rec[s];
+    for (let k = 0; k + 7 <= f.length; k += 7) {
+      const [cls, x1, y1, x2, y2, st, iou] = f.slice(k, k + 7);
+      const r = document.createElementNS(ns, 'rect');
+      for (const [a, v] of [['x', x1], ['y', y1], ['width', x2 - x1], ['height', y2 - y1], ['fill', 'none'],
+                            ['stroke', COLORS[st][s]], ['stroke-width', st ? 2.5 : 1.5], ['vector-effect', 'non-scaling-stroke']])
+        r.setAttribute(a, v);
+      if (s) r.setAttribute('stroke-dasharray', '4 3');
+      svg.appendChild(r);
+      const tr = el('tr', undefined, 's' + st);
+      for (const v of [side, 'cls ' + cls, STATES[st], st === 2 ? '' : iou.toFixed(3),
+                       x1.toFixed(3) + ', ' + y1.toFixed(3) + ' – ' + x2.toFixed(3) + ', ' + y2.toFixed(3)])
+        tr.appendChild(el('td', v));
+      list.appendChild(tr);
+    }
+  });
+  if (!list.firstChild) list.appendChild(el('tr')).appendChild(el('td', 'Kutu yok', 'muted'));
+  list.style.display = 'inline-table';
+  td.replaceChildren(svg, list);
+}
+
+let timer = 0;
+$('q').addEventListener('input', () => { clearTimeout(timer); timer = setTimeout(rebuild, 150); });
+$('only').addEventListener('change', rebuild);
+$('sort').addEventListener('change', rebuild);
+$('prev').addEventListener('click', () => { --page; render(); });
+$('next').addEventListener('click', () => { ++page; render(); });
+header();
+load('data/index.js');
+</script>
+</body></html>
+)HTML";
+
+} // namespace
+
+bool CompareReport::exportCsv(const LabelCompare::Report& rep, const QString& outDir, QString* err)
+{
+    if (!QDir().mkpath(outDir)) {
+        if (err) *err = QStringLiteral("cannot create %1").arg(outDir);
+        return false;
+    }
+
+    QByteArray csv = "stem,ours,other,tp,class_mismatch,fp,fn,similarity,fmt_a,fmt_b\n";
+    csv.reserve(int(rep.images.size()) * 64);
+    for (const LabelCompare::ImageResult& r : rep.images) {
+        csv += csvField(r.stem).toUtf8() + ',';
+        LabelSerializer::appendInt(csv, r.ours);  csv += ',';
+        LabelSerializer::appendInt(csv, r.other); csv += ',';
+        appendCounts(csv, r.c);
+        csv += ',';
+        csv += fmtName(r.fmtA);
+        csv += ',';
+        csv += fmtName(r.fmtB);
+        csv += '\n';
+    }
+    if (!LabelSerializer::writeFile(QDir(outDir).filePath("images.csv"), csv, err)) return false;
+
+    // tp/mis/fp: A'daki sınıf, fn: B'deki sınıf
+    csv = "class_id,tp,class_mismatch,fp,fn,similarity\n";
+    for (auto it = rep.perClass.cbegin(); it != rep.perClass.cend(); ++it) {
+        LabelSerializer::appendInt(csv, it.key());
+        csv += ',';
+        appendCounts(csv, it->c);
+        csv += '\n';
+    }
+    return LabelSerializer::writeFile(QDir(outDir).filePath("classes.csv"), csv, err);
+}
+
+bool CompareReport::exportHtml(const LabelCompare::Report& rep, const QString& outDir, QString* err)
+{
+    const QDir dir(outDir);
+    if (!dir.mkpath("data")) {
+        if (err) *err = QStringLiteral("cannot create %1").arg(dir.filePath("data"));
+        return false;
+    }
+
+    // Sıra: en çok anlaşmazlık önde, eşitlikte daha çok hatalı kutu (rapor stem sıralı → kararlı)
+    const int n = int(rep.images.size());
+    std::vector<int> order(size_t(n));
+    for (int i = 0; i < n; ++i) order[size_t(i)] = i;
+    std::stable_sort(order.begin(), order.end(), [&](int x, int y){
+        const MatchCounts& a = rep.images[x].c;
+        const MatchCounts& b = rep.images[y].c;
+        const double sa = a.similarity(), sb = b.similarity();
+        if (sa != sb) return sa < sb;
+        return a.mis + a.fp + a.fn > b.mis + b.fp + b.fn;
+    });
+
+    bool boxes = false;                        // keepBoxes ile üretilmiş mi?
+    int  differing = 0;
+    for (const LabelCompare::ImageResult& r : rep.images) {
+        boxes = boxes || !r.a.isEmpty() || !r.b.isEmpty();
+        if (r.c.mis || r.c.fp || r.c.fn) ++differing;
+    }
+
+    // Sütunlu dizin: görsel başına ~stem + 6 küçük tamsayı
+    QByteArray idx;
+    idx.reserve(n * 48 + 64);
+    idx += "cmpIndex({\"stems\":[";
+    for (int k = 0; k < n; ++k) {
+        if (k) idx += ',';
+        idx += cocoJsonString(rep.images[order[size_t(k)]].stem);
+    }
+    auto column = [&](const char* name, auto get) {
+        idx += "],\"";
+        idx += name;
+        idx += "\":[";
+        for (int k = 0; k < n; ++k) {
+            if (k) idx += ',';
+            LabelSerializer::appendInt(idx, get(rep.images[order[size_t(k)]]));
+        }
+    };
+    using IR = LabelCompare::ImageResult;
+    column("ours",  [](const IR& r){ return r.ours; });
+    column("other", [](const IR& r){ return r.other; });
+    column("tp",    [](const IR& r){ return r.c.tp; });
+    column("mis",   [](const IR& r){ return r.c.mis; });
+    column("fp",    [](const IR& r){ return r.c.fp; });
+    column("fn",    [](const IR& r){ return r.c.fn; });
+    idx += "]});\n";
+    if (!LabelSerializer::writeFile(dir.filePath("data/index.js"), idx, err)) return false;
+
+    // Ayrıntı parçaları: dizindeki sırayla kDetailChunk'lık
+    if (boxes) {
+        QByteArray chunk;
+        for (int c = 0; c * kDetailChunk < n; ++c) {
+            chunk.resize(0);                   // kapasite korunur
+            chunk += "cmpDetail(";
+            LabelSerializer::appendInt(chunk, c);
+            chunk += ",[";
+            for (int k = c * kDetailChunk, end = std::min(n, k + kDetailChunk); k < end; ++k) {
+                if (k > c * kDetailChunk) chunk += ",\n";
+                appendDetail(chunk, rep.images[order[size_t(k)]]);
+            }
+            chunk += "]);\n";
+            if (!LabelSerializer::writeFile(dir.filePath(QStringLiteral("data/detail_%1.js").arg(c)), chunk, err))
+                return false;
+        }
+    }
+
+    // Gömülü özet (küçük): sayfa dizin gelmeden çizilir
+    auto counts = [](const MatchCounts& c){ return QJsonArray{c.tp, c.mis, c.fp, c.fn}; };
+    QJsonObject s;
+    s["created"]   = QDateTime::currentDateTime().toString(Qt::ISODate);
+    s["oursDir"]   = QDir::toNativeSeparators(rep.oursDir);
+    s["otherDir"]  = QDir::toNativeSeparators(rep.otherDir);
+    s["files"]     = rep.files;
+    s["differing"] = differing;
+    s["iouThr"]    = rep.iouThr;
+    s["mode"]      = matchModeName(rep.mode);
+    s["elapsedMs"] = double(rep.elapsedMs);
+    s["cancelled"] = rep.cancelled;
+    s["total"]     = counts(rep.total);
+    if (rep.mode == MatchMode::Optimal) {
+        s["greedy"]        = counts(rep.totalGreedy);
+        s["changedImages"] = rep.changedImages;
+    }
+    QJsonArray classes;
+    for (auto it = rep.perClass.cbegin(); it != rep.perClass.cend(); ++it)
+        classes.append(QJsonArray{it.key(), it->c.tp, it->c.mis, it->c.fp, it->c.fn});
+    s["classes"] = classes;
+    s["chunk"]   = kDetailChunk;
+    s["boxes"]   = boxes;
+    QByteArray summary = QJsonDocument(s).toJson(QJsonDocument::Compact);
+    summary.replace("<", "\\u003c");           // satır içi <script> içinde "</script>" kapanmasın
+
+    QByteArray html(kHtml);
+    html.replace("/*@SUMMARY@*/null", summary);
+    return LabelSerializer::writeFile(dir.filePath("index.html"), html, err);
+}
@@ -0,0 +1,25 @@
+// comparereport.h
+#pragma once
+
+#include "labelcompare.h"
+
+#include <QString>
+
+// ---------------------------
+// Toplu karşılaştırma için paylaşılabilir çıktılar (outDir altına)
+//  - images.csv : görsel başına sayımlar (stem sırası); classes.csv: sınıf başına
+//  - index.html : statik rapor. Özet + sınıf tablosu sayfaya gömülü (anında görünür);
+//    görsel listesi data/index.js'ten (sütunlu, kompakt dizin) yüklenip sayfa sayfa çizilir;
+//    görsel ayrıntısı (kutular, eşleşme durumu) data/detail_<n>.js parçalarından yalnız açılınca okunur.
+//    Veri dosyaları <script src> ile yüklenir: file:// üzerinden de çalışır (fetch/XHR engeli yok)
+//  - Kutu ayrıntısı için rapor keepBoxes ile üretilmiş olmalı; değilse sadece sayımlar
+//    (keepDiffOnly ile tam uyumlu görsellerin ayrıntısı "tam uyum" notu olarak görünür)
+// ---------------------------
+class CompareReport
+{
+public:
+    static constexpr int kDetailChunk = 500;    // detay dosyası başına görsel (anlaşmazlık sırasıyla)
+
+    static bool exportCsv (const LabelCompare::Report& rep, const QString& outDir, QString* err=nullptr);
+    static bool exportHtml(const LabelCompare::Report& rep, const QString& outDir, QString* err=nullptr);
+};
@@ -0,0 +1,460 @@
+// detectioneval.cpp
+#include "detectioneval.h"
+#include "labelcompare.h"
+#include "ioukernel.h"
+#include "imagesizecache.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+using DE = DetectionEval;
+
+// COCO alan aralıkları (piksel², sınırlar dahil)
+constexpr double kAreaLo[DE::kAreas] = {0.0,  0.0,         32.0 * 32.0, 96.0 * 96.0};
+constexpr double kAreaHi[DE::kAreas] = {1e10, 32.0 * 32.0, 96.0 * 96.0, 1e10};
+
+// area < 0: görsel boyutu bilinmiyor → yalnız "all" kovasında
+inline bool inArea(double area, int a)
+{
+    if (a == DE::AreaAll) return true;
+    return area >= kAreaLo[a] && area <= kAreaHi[a];
+}
+
+// Tek tahmin: her kova için eşik bitleri (bit t → IoU eşiği t)
+struct DetRec {
+    float   score;
+    quint32 img;                        // stem indeksi (kararlı sıralama)
+    quint32 rank;                       // görsel içi skor sırası
+    quint16 tp[DE::kAreas];
+    quint16 ign[DE::kAreas];
+};
+
+struct ClassAcc {
+    std::vector<DetRec> dets;
+    qint64              gt[DE::kAreas] = {};
+};
+
+// Görsel × sınıf değerlendirmesi için yeniden kullanılan tamponlar
+struct Scratch {
+    std::vector<int>    g, d;           // sınıfın GT / tahmin indeksleri (d: skor sırası)
+    BoxesSoA            dBox, gBox;     // IoU çekirdeği girişi (d sırasıyla / g sırasıyla)
+    std::vector<float>  iou;            // |d| x |g|, tüm eşik ve kovalarda ortak
+    std::vector<int>    gOrder;         // ignore edilmeyen GT'ler önce
+    std::vector<char>   gIgn, gUsed;
+    std::vector<double> gArea, dArea;
+};
+
+// pycocotools evaluateImg ile aynı eşleştirme: tahminler skor sırasıyla, en yüksek IoU'lu boştaki GT;
+// ignore edilmeyen GT'ye eşleşme varken ignore GT'lere geçilmez. Eşleşmeyen tahmin kova dışındaysa ignore.
+void evalClass(const QVector<XYXY>& gt, const QVector<XYXY>& dt, quint32 img, Scratch& s, ClassAcc& acc)
+{
+    const int nG = int(s.g.size()), nD = int(s.d.size());
+    s.dBox.clear();
+    s.gBox.clear();
+    for (int d : s.d) s.dBox.push(float(dt[d].x1), float(dt[d].y1), float(dt[d].x2), float(dt[d].y2));
+    for (int g : s.g) s.gBox.push(float(gt[g].x1), float(gt[g].y1), float(gt[g].x2), float(gt[g].y2));
+    s.iou.resize(size_t(nD) * nG);
+    iouMatrix(s.dBox, s.gBox, s.iou.data());
+
+    const size_t base = acc.dets.size();
+    acc.dets.resize(base + nD);
+    for (int d = 0; d < nD; ++d) acc.dets[base + d] = DetRec{dt[s.d[d]].score, img, quint32(d), {}, {}};
+
+    for (int a = 0; a < DE::kAreas; ++a) {
+        s.gIgn.resize(nG);
+        s.gOrder.clear();
+        int npig = 0;
+        for (int g = 0; g < nG; ++g) {
+            s.gIgn[g] = !inArea(s.gArea[s.g[g]], a);
+            if (!s.gIgn[g]) { ++npig; s.gOrder.push_back(g); }
+        }
+        for (int g = 0; g < nG; ++g) if (s.gIgn[g]) s.gOrder.push_back(g);
+        acc.gt[a] += npig;
+
+        for (int t = 0; t < DE::kIouThrs; ++t) {
+            s.gUsed.assign(nG, 0);
+            const quint16 bit = quint16(1u << t);
+            for (int d = 0; d < nD; ++d) {
+                const float* row = s.iou.data() + size_t(d) * nG;
+                float  best = std::min(float(DE::iouThr(t)), 1.0f - 1e-7f);
+                int    m    = -1;
+                for (int g : s.gOrder) {
+                    if (s.gUsed[g]) continue;
+                    if (m >= 0 && !s.gIgn[m] && s.gIgn[g]) break;
+                    if (row[g] < best) continue;
+                    best = row[g];
+                    m = g;
+                }
+                DetRec& r = acc.dets[base + d];
+                if (m >= 0) {
+                    s.gUsed[m] = 1;
+                    if (s.gIgn[m]) r.ign[a] |= bit; else r.tp[a] |= bit;
+                } else if (!inArea(s.dArea[s.d[d]], a)) {
+                    r.ign[a] |= bit;
+                }
+            }
+        }
+    }
+}
+
+// Sınıfın tüm tahminleri bir kez sıralanır; her kova × eşik için tek geçişte PR eğrisi
+void accumulate(ClassAcc& acc, DE::ClassResult& out)
+{
+    std::sort(acc.dets.begin(), acc.dets.end(), [](const DetRec& l, const DetRec& r){
+        if (l.score != r.score) return l.score > r.score;
+        if (l.img != r.img)     return l.img < r.img;
+        return l.rank < r.rank;
+    });
+    out.dets = int(acc.dets.size());
+    out.precision.fill(-1.0f, DE::kAreas * DE::kIouThrs * DE::kRecall);
+
+    std::vector<double> rc, pr;
+    rc.reserve(acc.dets.size());
+    pr.reserve(acc.dets.size());
+    for (int a = 0; a < DE::kAreas; ++a) {
+        const qint64 npig = acc.gt[a];
+        out.gt[a] = int(npig);
+        for (int t = 0; t < DE::kIouThrs; ++t) {
+            if (npig == 0) { out.ap[a][t] = -1.0f; out.recall[a][t] = -1.0f; continue; }
+            const quint16 bit = quint16(1u << t);
+            rc.clear();
+            pr.clear();
+            qint64 tp = 0, fp = 0;
+            for (const DetRec& r : acc.dets) {
+                if (r.ign[a] & bit) continue;
+                if (r.tp[a] & bit) ++tp; else ++fp;
+                rc.push_back(double(tp) / npig);
+                pr.push_back(double(tp) / double(tp + fp));
+            }
+            for (size_t i = pr.size(); i > 1; --i) pr[i - 2] = std::max(pr[i - 2], pr[i - 1]);
+
+            float* curve = out.precision.data() + (a * DE::kIouThrs + t) * DE::kRecall;
+            double sum = 0;
+            size_t k = 0;
+            for (int r = 0; r < DE::kRecall; ++r) {
+                const double rt = r * 0.01;
+                while (k < rc.size() && rc[k] < rt) ++k;
+                const double q = (k < rc.size()) ? pr[k] : 0.0;
+                curve[r] = float(q);
+                sum += q;
+            }
+            out.ap[a][t]     = float(sum / DE::kRecall);
+            out.recall[a][t] = rc.empty() ? 0.0f : float(rc.back());
+        }
+    }
+}
+
+// Sınıflar (ve t < 0 ise tüm eşikler) üzerinden geçerli değerlerin ortalaması; yoksa -1
+double meanOver(const QVector<DE::ClassResult>& cls, bool recall, int area, int thr)
+{
+    double sum = 0;
+    int    n   = 0;
+    for (const DE::ClassResult& c : cls) {
+        for (int t = 0; t < DE::kIouThrs; ++t) {
+            if (thr >= 0 && t != thr) continue;
+            const float v = recall ? c.recall[area][t] : c.ap[area][t];
+            if (v < 0) continue;
+            sum += v;
+            ++n;
+        }
+    }
+    return n > 0 ? sum / n : -1.0;
+}
+
+inline double round4(double v) { return std::round(v * 1e4) / 1e4; }
+
+const char* const kStatKeys[DE::StatCount] = {"AP", "AP50", "AP75", "APs", "APm", "APl", "AR", "ARs", "ARm", "ARl"};
+
+} // namespace
+
+// ---------------------------
+// DetectionEval
+// ---------------------------
+const char* DetectionEval::areaName(int a)
+{
+    static const char* const names[kAreas] = {"all", "small", "medium", "large"};
+    return (a >= 0 && a < kAreas) ? names[a] : "?";
+}
+
+double DetectionEval::ClassResult::apMean(int area) const
+{
+    double sum = 0;
+    int    n   = 0;
+    for (int t = 0; t < kIouThrs; ++t) if (ap[area][t] >= 0) { sum += ap[area][t]; ++n; }
+    return n > 0 ? sum / n : -1.0;
+}
+
+DetectionEval::DetectionEval(QObject* parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<DetectionEval::Report>("DetectionEval::Report");
+}
+
+DetectionEval::~DetectionEval()
+{
+    m_runner.stop();
+}
+
+bool DetectionEval::start(const Job& job)
+{
+    return m_runner.start([this, job](const std::atomic_bool* cancel, QThreadPool* pool){
+        return evaluate(job, cancel, [this](int done, int total){ emit progress(done, total); }, pool);
+    }, [this](const Report& rep){ emit finished(rep); });
+}
+
+DetectionEval::Report DetectionEval::evaluate(const Job& job, const std::atomic_bool* cancel,
+                                              const std::function<void(int, int)>& progress, QThreadPool* pool)
+{
+    QElapsedTimer timer;
+    timer.start();
+    Report rep;
+    rep.gtDir   = job.gtDir;
+    rep.predDir = job.predDir;
+    rep.maxDets = std::max(1, job.maxDets);
+
+    // 1) Her klasör bir kez listelenir; GT'si olmayan görselin tahminleri FP sayılır
+    const QHash<QString, QString> G = listLabelFiles(job.gtDir);
+    const QHash<QString, QString> P = listLabelFiles(job.predDir);
+
+    // VOC adları → sınıf: her tarafın classes.txt'i; biri yoksa diğerininki
+    ClassIndex clsG = loadClassIndex(job.gtDir), clsP = loadClassIndex(job.predDir);
+    if (clsG.isEmpty()) clsG = clsP;
+    if (clsP.isEmpty()) clsP = clsG;
+
+    QStringList stems;
+    if (!job.onlyStems.isEmpty()) {
+        stems = job.onlyStems;
+    } else {
+        stems.reserve(G.size() + P.size());
+        for (auto it = G.cbegin(); it != G.cend(); ++it) stems << it.key();
+        for (auto it = P.cbegin(); it != P.cend(); ++it) if (!G.contains(it.key())) stems << it.key();
+    }
+    stems.sort();
+    stems.removeDuplicates();
+
+    // 2) Görseller paylaşılan sayaçla dağıtılır; sınıf birikimleri worker'da yerel
+    const int n = int(stems.size());
+    std::atomic_int next{0}, done{0}, sized{0};
+    std::atomic<qint64> gtBoxes{0}, detBoxes{0};
+    QHash<int, ClassAcc> merged;
+    QMutex mergeMutex;
+
+    const auto work = [&]{
+        QHash<int, ClassAcc> local;
+        Scratch s;
+        std::vector<int> classes;
+        qint64 nGt = 0, nDet = 0;
+        for (int i; (i = next.fetch_add(1)) < n; ) {
+            if (cancel && cancel->load()) break;
+            const QString& stem = stems[i];
+            const QString gp = G.value(stem), pp = P.value(stem);
+            if (!gp.isEmpty() || !pp.isEmpty()) {
+                const QSize sz = job.imagesRoot.isEmpty() ? QSize() : findImageSizeForStem(stem, job.imagesRoot);
+                if (!sz.isEmpty()) ++sized;
+                const auto imgSize = [sz]{ return sz; };
+                const QVector<XYXY> gt = readLabelBoxes(gp, &clsG, imgSize);
+                const QVector<XYXY> dt = readLabelBoxes(pp, &clsP, imgSize);
+                nGt += gt.size();
+
+                const double px = sz.isEmpty() ? -1.0 : double(sz.width()) * sz.height();
+                auto area = [px](const XYXY& b){ return px < 0 ? -1.0 : (b.x2 - b.x1) * (b.y2 - b.y1) * px; };
+                s.gArea.resize(gt.size());
+                s.dArea.resize(dt.size());
+                classes.clear();
+                for (int k = 0; k < gt.size(); ++k) { s.gArea[k] = area(gt[k]); classes.push_back(gt[k].cls); }
+                for (int k = 0; k < dt.size(); ++k) { s.dArea[k] = area(dt[k]); classes.push_back(dt[k].cls); }
+                std::sort(classes.begin(), classes.end());
+                classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+
+                for (int cls : classes) {
+                    s.g.clear();
+                    s.d.clear();
+                    for (int k = 0; k < gt.size(); ++k) if (gt[k].cls == cls) s.g.push_back(k);
+                    for (int k = 0; k < dt.size(); ++k) if (dt[k].cls == cls) s.d.push_back(k);
+                    std::stable_sort(s.d.begin(), s.d.end(), [&](int l, int r){ return dt[l].score > dt[r].score; });
+                    if (int(s.d.size()) > rep.maxDets) s.d.resize(rep.maxDets);
+                    nDet += qint64(s.d.size());
+                    evalClass(gt, dt, quint32(i), s, local[cls]);
+                }
+            }
+            const int d = ++done;
+            if (progress && ((d & 1023) == 0 || d == n)) progress(d, n);
+        }
+        gtBoxes  += nGt;
+        detBoxes += nDet;
+        QMutexLocker lk(&mergeMutex);
+        for (auto it = local.begin(); it != local.end(); ++it) {
+            ClassAcc& m = merged[it.key()];
+            if (m.dets.empty()) m.dets = std::move(it->dets);
+            else m.dets.insert(m.dets.end(), it->dets.begin(), it->dets.end());
+            for (int a = 0; a < kAreas; ++a) m.gt[a] += it->gt[a];
+        }
+    };
+
+    runParallel(pool, n, 64, work);
+
+    // 3) Sınıf başına sıralama + PR eğrileri (sınıflar da paralel)
+    QList<int> keys = merged.keys();
+    std::sort(keys.begin(), keys.end());
+    const int nCls = int(keys.size());
+    std::vector<ClassAcc*> accs;                        // eşzamanlı QHash erişimi yerine sabit işaretçiler
+    accs.reserve(nCls);
+    for (int k : std::as_const(keys)) accs.push_back(&merged[k]);
+    rep.classes.resize(nCls);
+    ClassResult* outs = rep.classes.data();
+    std::atomic_int nextCls{0};
+    runParallel(pool, nCls, 1, [&]{
+        for (int k; (k = nextCls.fetch_add(1)) < nCls; ) {
+            outs[k].cls = keys[k];
+            accumulate(*accs[k], outs[k]);
+        }
+    });
+
+    rep.images      = n;
+    rep.sizedImages = sized;
+    rep.gtBoxes     = gtBoxes;
+    rep.detBoxes    = detBoxes;
+    for (int a = 0; a < kAreas; ++a) {
+        rep.stats[StatAP + (a == AreaAll ? 0 : 2 + a)] = meanOver(rep.classes, false, a, -1);
+        rep.stats[StatAR + a]                          = meanOver(rep.classes, true,  a, -1);
+    }
+    rep.stats[StatAP50] = meanOver(rep.classes, false, AreaAll, 0);
+    rep.stats[StatAP75] = meanOver(rep.classes, false, AreaAll, 5);
+    rep.cancelled = cancel && cancel->load();
+    ImageSizeCache::instance().flush();
+    rep.elapsedMs = timer.elapsed();
+    return rep;
+}
+
+QString DetectionEval::summaryText(const Report& rep)
+{
+    struct Row { const char* title; const char* kind; const char* iou; int area; };
+    static const Row rows[StatCount] = {
+        {"Average Precision", "AP", "0.50:0.95", AreaAll},
+        {"Average Precision", "AP", "0.50     ", AreaAll},
+        {"Average Precision", "AP", "0.75     ", AreaAll},
+        {"Average Precision", "AP", "0.50:0.95", AreaSmall},
+        {"Average Precision", "AP", "0.50:0.95", AreaMedium},
+        {"Average Precision", "AP", "0.50:0.95", AreaLarge},
+        {"Average Recall   ", "AR", "0.50:0.95", AreaAll},
+        {"Average Recall   ", "AR", "0.50:0.95", AreaSmall},
+        {"Average Recall   ", "AR", "0.50:0.95", AreaMedium},
+        {"Average Recall   ", "AR", "0.50:0.95", AreaLarge},
+    };
+    QString out;
+    for (int i = 0; i < StatCount; ++i) {
+        const Row& r = rows[i];
+        out += QString(" %1  (%2) @[ IoU=%3 | area=%4 | maxDets=%5 ] = %6\n")
+                   .arg(QString::fromLatin1(r.title), QString::fromLatin1(r.kind), QString::fromLatin1(r.iou))
+                   .arg(QString::fromLatin1(areaName(r.area)), 6)
+                   .arg(rep.maxDets, 3)
+                   .arg(rep.stats[i], 0, 'f', 3);
+    }
+    return out;
+}
+
+bool DetectionEval::exportJson(const Report& rep, const QString& path, QString* err)
+{
+    QJsonObject root;
+    root["created"]     = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["gtDir"]       = rep.gtDir;
+    root["predDir"]     = rep.predDir;
+    root["images"]      = rep.images;
+    root["sizedImages"] = rep.sizedImages;
+    root["gtBoxes"]     = double(rep.gtBoxes);
+    root["detBoxes"]    = double(rep.detBoxes);
+    root["maxDets"]     = rep.maxDets;
+    root["elapsedMs"]   = double(rep.elapsedMs);
+    root["cancelled"]   = rep.cancelled;
+
+    QJsonObject stats;
+    for (int i = 0; i < StatCount; ++i) stats[kStatKeys[i]] = round4(rep.stats[i]);
+    root["summary"] = stats;
+
+    QJsonArray thrs;
+    for (int t = 0; t < kIouThrs; ++t) thrs.append(round4(iouThr(t)));
+    root["iouThrs"] = thrs;
+
+    QJsonArray classes;
+    for (const ClassResult& c : rep.classes) {
+        QJsonObject o;
+        o["cls"]  = c.cls;
+        o["dets"] = c.dets;
+        QJsonObject gt, ap, rec;
+        for (int a = 0; a < kAreas; ++a) {
+            QJsonArray apA, recA;
+            for (int t = 0; t < kIouThrs; ++t) { apA.append(round4(c.ap[a][t])); recA.append(round4(c.recall[a][t])); }
+            gt[areaName(a)]  = c.gt[a];
+            ap[areaName(a)]  = apA;
+            rec[areaName(a)] = recA;
+        }
+        o["gt"] = gt;
+        o["ap"] = ap;
+        o["recall"] = rec;
+        // PR eğrileri: area=all, her IoU eşiği için 101 recall noktasında precision
+        QJsonArray curves;
+        for (int t = 0; t < kIouThrs; ++t) {
+            QJsonArray curve;
+            for (int r = 0; r < kRecall; ++r) curve.append(round4(c.pr(AreaAll, t, r)));
+            curves.append(curve);
+        }
+        o["pr"] = curves;
+        classes.append(o);
+    }
+    root["classes"] = classes;
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) {
+        if (err) *err = f.errorString();
+        return false;
+    }
+    f.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!f.commit()) {
+        if (err) *err = f.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool DetectionEval::appendHistory(const Report& rep, const QString& csvPath, const QString& jsonPath, QString* err)
+{
+    QDir().mkpath(QFileInfo(csvPath).absolutePath());
+    QFile f(csvPath);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        if (err) *err = f.errorString();
+        return false;
+    }
+    QByteArray line;
+    if (f.size() == 0) {
+        line += "timestamp,images,gt_boxes,det_boxes";
+        for (const char* k : kStatKeys) line += QByteArray(",") + k;
+        line += ",elapsed_ms,gt_dir,pred_dir,json\n";
+    }
+    QStringList cols;
+    cols << QDateTime::currentDateTime().toString(Qt::ISODate)
+         << QString::number(rep.images) << QString::number(rep.gtBoxes) << QString::number(rep.detBoxes);
+    for (double v : rep.stats) cols << QString::number(v, 'f', 4);
+    cols << QString::number(rep.elapsedMs)
+         << csvField(rep.gtDir) << csvField(rep.predDir) << csvField(jsonPath);
+    line += cols.join(',').toUtf8() + '\n';
+    if (f.write(line) != line.size()) {
+        if (err) *err = f.errorString();
+        return false;
+    }
+    return true;
+}
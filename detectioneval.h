@@ -0,0 +1,99 @@
+// detectioneval.h
+#pragma once
+
+#include "labelcompare.h"   // EngineRunner
+
+#include <QObject>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// ---------------------------
+// COCO tarzı dedektör değerlendirmesi (tahmin ↔ ground truth)
+//  - AP/AR: IoU 0.50:0.05:0.95, alan kovaları all/small/medium/large (piksel², COCO sınırları)
+//  - Görsel × sınıf başına IoU matrisi bir kez hesaplanır, 10 eşik × 4 kova aynı matrisi kullanır
+//  - Görseller iş parçacıklarına paylaştırılır; sınıf başına skor dizisi bir kez sıralanıp
+//    her eşik/kova için tek geçişte PR eğrisi (101 recall noktası) çıkarılır
+// Tahminler: "cls cx cy w h conf" (YOLO save_conf) ya da labelcompare'in okuduğu diğer biçimler
+// (skor yoksa 1.0). Alan kovaları için görsel boyutu gerekir (imagesRoot); boyutu bilinmeyen
+// görseller yalnız "all" kovasına girer.
+// ---------------------------
+class DetectionEval : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr int kIouThrs = 10;            // 0.50, 0.55, ..., 0.95
+    static constexpr int kAreas   = 4;             // all, small, medium, large
+    static constexpr int kRecall  = 101;           // 0.00, 0.01, ..., 1.00
+    enum Area { AreaAll = 0, AreaSmall, AreaMedium, AreaLarge };
+
+    static double iouThr(int t) { return 0.50 + 0.05 * t; }
+    static const char* areaName(int a);
+
+    struct Job {
+        QString     gtDir, predDir;
+        QString     imagesRoot;                    // alan kovaları + piksel biçimleri için
+        int         maxDets = 100;                 // görsel × sınıf başına en yüksek skorlu N tahmin
+        QStringList onlyStems;                     // boş: iki klasörün birleşimi
+    };
+
+    struct ClassResult {
+        int            cls = 0;
+        int            gt[kAreas]   = {};          // kovadaki (ignore edilmeyen) GT sayısı
+        int            dets = 0;                   // maxDets sonrası tahmin sayısı
+        float          ap[kAreas][kIouThrs];       // -1: kovada GT yok
+        float          recall[kAreas][kIouThrs];   // -1: kovada GT yok
+        QVector<float> precision;                  // [kova][eşik][recall noktası], monoton PR eğrisi
+
+        float pr(int area, int thr, int r) const { return precision[(area * kIouThrs + thr) * kRecall + r]; }
+        double apMean(int area = AreaAll) const;   // 0.50:0.95 ortalaması, -1: GT yok
+    };
+
+    // COCO özet satırları: AP, AP50, AP75, APs, APm, APl, AR, ARs, ARm, ARl
+    enum Stat { StatAP = 0, StatAP50, StatAP75, StatAPs, StatAPm, StatAPl,
+                StatAR, StatARs, StatARm, StatARl, StatCount };
+
+    struct Report {
+        int                  images = 0, sizedImages = 0;
+        qint64               gtBoxes = 0, detBoxes = 0;
+        int                  maxDets = 100;
+        QVector<ClassResult> classes;              // sınıf indeksine göre sıralı
+        double               stats[StatCount] = {};// -1: hesaplanamadı
+        qint64               elapsedMs = 0;
+        bool                 cancelled = false;
+        QString              gtDir, predDir;
+    };
+
+    explicit DetectionEval(QObject* parent=nullptr);
+    ~DetectionEval() override;
+
+    bool start(const Job& job);                    // false: zaten çalışıyor
+    void cancel()          { m_runner.cancel(); }
+    bool isRunning() const { return m_runner.isRunning(); }
+
+    // Eşzamanlı çalıştır (CLI / testler). pool verilmezse geçici havuz kullanılır.
+    static Report evaluate(const Job& job, const std::atomic_bool* cancel = nullptr,
+                           const std::function<void(int done, int total)>& progress = {},
+                           QThreadPool* pool = nullptr);
+
+    // Koşular arası takip: tam rapor JSON'a, özet satırı CSV geçmişine (yoksa başlıkla oluşturulur)
+    static bool exportJson(const Report& rep, const QString& path, QString* err = nullptr);
+    static bool appendHistory(const Report& rep, const QString& csvPath, const QString& jsonPath,
+                              QString* err = nullptr);
+    static QString summaryText(const Report& rep); // pycocotools özet biçimi
+
+signals:
+    // Worker thread'den yayılır (alıcı GUI'deyse otomatik queued)
+    void progress(int done, int total);
+    void finished(const DetectionEval::Report& report);
+
+private:
+    EngineRunner m_runner;
+};
+
+Q_DECLARE_METATYPE(DetectionEval::Report)
@@ -0,0 +1,198 @@
+// dirscanner.cpp
+#include "dirscanner.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <algorithm>
+
+DirScanner& DirScanner::instance()
+{
+    static DirScanner s;
+    return s;
+}
+
+DirScanner::DirScanner(QObject* parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(2);   // aynı anda en fazla iki klasör; disk sırasını boğmasın
+}
+
+DirScanner::~DirScanner()
+{
+    {
+        QMutexLocker lk(&m_mutex);
+        for (const CancelFlag& f : std::as_const(m_active)) f->store(true);
+    }
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+bool DirScanner::isImageName(const QString& fileName)
+{
+    const int dot = fileName.lastIndexOf('.');
+    if (dot < 0) return false;
+    const QStringView ext = QStringView(fileName).mid(dot + 1);
+    for (const char* e : {"png","jpg","jpeg","bmp","tif","tiff"})
+        if (ext.compare(QLatin1String(e), Qt::CaseInsensitive) == 0) return true;
+    return false;
+}
+
+QStringList DirScanner::absolutePaths(const QString& dir, const QStringList& names)
+{
+    QStringList out;
+    out.reserve(names.size());
+    const QString root = dir.endsWith('/') ? dir : dir + '/';
+    for (const QString& n : names) out << root + n;
+    return out;
+}
+
+void DirScanner::sortNames(QStringList& names)
+{
+    std::sort(names.begin(), names.end(), [](const QString& a, const QString& b){
+        const int c = a.compare(b, Qt::CaseInsensitive);
+        return c != 0 ? c < 0 : a < b;
+    });
+}
+
+// ---------------------------
+// Önbellek (klasör mtime'ı ile doğrulanır)
+// ---------------------------
+bool DirScanner::cacheLookup(const QString& dir, const QDateTime& mtime, QStringList* names)
+{
+    QMutexLocker lk(&m_mutex);
+    auto it = m_cache.constFind(dir);
+    if (it == m_cache.cend() || !mtime.isValid() || it->mtime != mtime) return false;
+    *names = it->names;
+    m_cacheOrder.removeOne(dir);
+    m_cacheOrder.append(dir);
+    return true;
+}
+
+void DirScanner::cacheStore(const QString& dir, const QDateTime& mtime, const QStringList& names)
+{
+    if (!mtime.isValid()) return;
+    QMutexLocker lk(&m_mutex);
+    m_cache.insert(dir, CacheEntry{mtime, names});
+    m_cacheOrder.removeOne(dir);
+    m_cacheOrder.append(dir);
+    while (m_cacheOrder.size() > kMaxCached)
+        m_cache.remove(m_cacheOrder.takeFirst());
+}
+
+void DirScanner::invalidate(const QString& dir)
+{
+    const QString abs = QDir(dir).absolutePath();
+    QMutexLocker lk(&m_mutex);
+    m_cache.remove(abs);
+    m_cacheOrder.removeOne(abs);
+}
+
+// ---------------------------
+// Tarama (worker thread)
+// ---------------------------
+QStringList DirScanner::walk(const QString& dir, const CancelFlag& cancel, quint64 ticket)
+{
+    QStringList all;
+    QStringList batch;
+    QElapsedTimer t; t.start();
+
+    // Alt klasörlere inilmez (eski entryList davranışı); d_type sayesinde dosya başına stat yok
+    QDirIterator it(dir, QDir::Files | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        if (cancel && cancel->load()) return {};
+        it.next();
+        const QString name = it.fileName();
+        if (!isImageName(name)) continue;
+        all << name;
+        if (ticket) {
+            batch << name;
+            // İlk parça hızlı gelsin, sonrası büyük parçalar halinde
+            if (batch.size() >= kChunkSize || t.elapsed() >= 50) {
+                emit chunk(ticket, dir, batch);
+                batch.clear();
+                t.restart();
+            }
+        }
+    }
+    if (ticket && !batch.isEmpty()) emit chunk(ticket, dir, batch);
+
+    sortNames(all);
+    return all;
+}
+
+quint64 DirScanner::scan(const QString& dirIn)
+{
+    const QString dir    = QDir(dirIn).absolutePath();
+    const quint64 ticket = m_nextTicket.fetch_add(1);
+    CancelFlag cancel    = std::make_shared<std::atomic_bool>(false);
+    {
+        QMutexLocker lk(&m_mutex);
+        m_active.insert(ticket, cancel);
+    }
+
+    m_pool.start([this, dir, ticket, cancel]{
+        const QDateTime mtime = QFileInfo(dir).lastModified();
+        QStringList names;
+        bool cancelled = false;
+        if (cacheLookup(dir, mtime, &names)) {
+            emit chunk(ticket, dir, names);                 // tek parça, zaten sıralı
+        } else {
+            names = walk(dir, cancel, ticket);
+            cancelled = cancel->load();
+            if (!cancelled) cacheStore(dir, mtime, names);
+        }
+        {
+            QMutexLocker lk(&m_mutex);
+            m_active.remove(ticket);
+        }
+        emit finished(ticket, dir, cancelled ? QStringList() : names, cancelled);
+    });
+    return ticket;
+}
+
+void DirScanner::cancel(quint64 ticket)
+{
+    QMutexLocker lk(&m_mutex);
+    if (const CancelFlag f = m_active.value(ticket)) f->store(true);
+}
+
+quint64 DirScanner::listImagesAsync(const QString& dir, QObject* ctx,
+                                    std::function<void(const QStringList& paths)> done,
+                                    std::function<void(const QStringList& paths)> part)
+{
+    // Bağlantılar taramadan önce kurulur (sonuç worker'dan hemen gelebilir);
+    // bilet aynı thread'de, kuyruktaki çağrı işlenmeden önce yazılır.
+    auto ticket = std::make_shared<quint64>(0);
+    auto conn   = std::make_shared<QMetaObject::Connection>();
+    auto partConn = std::make_shared<QMetaObject::Connection>();
+    if (part) {
+        *partConn = connect(this, &DirScanner::chunk, ctx,
+                            [ticket, part](quint64 t, const QString& d, const QStringList& names){
+            if (t == *ticket) part(absolutePaths(d, names));
+        });
+    }
+    *conn = connect(this, &DirScanner::finished, ctx,
+                    [ticket, conn, partConn, done](quint64 t, const QString& d, const QStringList& names, bool cancelled){
+        if (t != *ticket) return;
+        QObject::disconnect(*conn);
+        QObject::disconnect(*partConn);
+        if (!cancelled && done) done(absolutePaths(d, names));
+    });
+    *ticket = scan(dir);
+    return *ticket;
+}
+
+QStringList DirScanner::listImages(const QString& dirIn)
+{
+    const QString   dir   = QDir(dirIn).absolutePath();
+    const QDateTime mtime = QFileInfo(dir).lastModified();
+    QStringList names;
+    if (!cacheLookup(dir, mtime, &names)) {
+        names = walk(dir, nullptr, 0);
+        cacheStore(dir, mtime, names);
+    }
+    return absolutePaths(dir, names);
+}
@@ -0,0 +1,71 @@
+// dirscanner.h
+#pragma once
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// Uygulama genelinde paylaşılan görsel klasörü tarayıcısı.
+//  - Tarama worker thread'de QDirIterator ile yapılır (GUI thread'de entryList/QFileInfo yok)
+//  - Bulunan dosya adları parça parça chunk() ile akar; finished() sıralı tam listeyi verir
+//  - Her tarama bir bilet (ticket) döndürür; cancel(ticket) ile durdurulur
+//  - Sonuç klasör mtime'ına göre önbelleklenir: klasör değişmediyse disk tekrar gezilmez
+class DirScanner : public QObject
+{
+    Q_OBJECT
+public:
+    static DirScanner& instance();
+
+    static bool isImageName(const QString& fileName);   // png/jpg/jpeg/bmp/tif/tiff (büyük/küçük harf fark etmez)
+    static QStringList absolutePaths(const QString& dir, const QStringList& names);
+    static void        sortNames(QStringList& names);        // ada göre (büyük/küçük harf duyarsız, sonra tam)
+
+    // Arka planda tara. Sinyaller alıcı thread'e kuyrukla gelir; bilet ile filtrelenmeli.
+    quint64 scan(const QString& dir);
+    void    cancel(quint64 ticket);
+
+    // Tek seferlik: tarama bitince done(mutlak yollar, ada göre sıralı) ctx thread'inde çağrılır.
+    // part verilirse bulunan dosyalar parça parça (sırasız, mutlak yol) önce ona gelir.
+    // ctx silinirse çağrılar düşer. İptal edilirse done çağrılmaz (kuyrukta kalan parça gelebilir).
+    quint64 listImagesAsync(const QString& dir, QObject* ctx,
+                            std::function<void(const QStringList& paths)> done,
+                            std::function<void(const QStringList& paths)> part = {});
+
+    // Eşzamanlı yardımcı: önbellek tazeyse anında, değilse çağıran thread'de tarar.
+    // Sadece worker thread'lerden (GUI thread'de listImagesAsync).
+    QStringList listImages(const QString& dir);          // mutlak yollar, ada göre sıralı
+
+    void invalidate(const QString& dir);
+
+signals:
+    void chunk(quint64 ticket, const QString& dir, const QStringList& fileNames);
+    void finished(quint64 ticket, const QString& dir, const QStringList& sortedNames, bool cancelled);
+
+private:
+    explicit DirScanner(QObject* parent=nullptr);
+    ~DirScanner() override;
+
+    struct CacheEntry { QDateTime mtime; QStringList names; };
+    using CancelFlag = std::shared_ptr<std::atomic_bool>;
+
+    static constexpr int kChunkSize = 512;
+    static constexpr int kMaxCached = 16;
+
+    bool cacheLookup(const QString& dir, const QDateTime& mtime, QStringList* names);
+    void cacheStore(const QString& dir, const QDateTime& mtime, const QStringList& names);
+    QStringList walk(const QString& dir, const CancelFlag& cancel, quint64 ticket);   // worker
+
+    QThreadPool                  m_pool;
+    mutable QMutex               m_mutex;
+    QHash<QString, CacheEntry>   m_cache;
+    QStringList                  m_cacheOrder;     // LRU: en eski başta
+    QHash<quint64, CancelFlag>   m_active;
+    std::atomic<quint64>         m_nextTicket{1};
+};
@@ -0,0 +1,143 @@
+// edgesnap.cpp
+#include "edgesnap.h"
+
+#include <QImageReader>
+#include <QVector>
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+int bandFor(const QRectF& box, const EdgeSnap::Params& p)
+{
+    if (p.band > 0) return p.band;
+    return std::clamp(int(std::min(box.width(), box.height()) * 0.08), 6, 24);
+}
+
+// Şerit (img koordinatında) → gri kopya; 1 px Sobel kenar payı dahil
+QImage grayStrip(const QImage& img, const QRect& r)
+{
+    const QRect c = r.intersected(img.rect());
+    if (c.width() < 3 || c.height() < 3) return {};
+    return img.copy(c).convertToFormat(QImage::Format_Grayscale8);
+}
+
+// Dikey kenar (sol/sağ): kolon başına Σ|Gx|. prof[i] → strip'in (i+1). kolonu
+void columnProfile(const QImage& g, QVector<int>* prof)
+{
+    const int w = g.width(), h = g.height();
+    prof->fill(0, w - 2);
+    QVector<qint16> v(w);
+    int* out = prof->data();
+    for (int y = 1; y < h - 1; ++y) {
+        const uchar* a = g.constScanLine(y - 1);
+        const uchar* b = g.constScanLine(y);
+        const uchar* c = g.constScanLine(y + 1);
+        qint16* vs = v.data();
+        for (int x = 0; x < w; ++x) vs[x] = qint16(a[x] + 2 * b[x] + c[x]);     // dikey yumuşatma
+        for (int x = 1; x < w - 1; ++x) out[x - 1] += std::abs(vs[x + 1] - vs[x - 1]);
+    }
+}
+
+// Yatay kenar (üst/alt): satır başına Σ|Gy|. prof[i] → strip'in (i+1). satırı
+void rowProfile(const QImage& g, QVector<int>* prof)
+{
+    const int w = g.width(), h = g.height();
+    prof->fill(0, h - 2);
+    QVector<qint16> prev(w), next(w);
+    const auto smooth = [w](const uchar* s, qint16* d){
+        d[0] = d[w - 1] = 0;
+        for (int x = 1; x < w - 1; ++x) d[x] = qint16(s[x - 1] + 2 * s[x] + s[x + 1]);   // yatay yumuşatma
+    };
+    for (int y = 1; y < h - 1; ++y) {
+        smooth(g.constScanLine(y - 1), prev.data());
+        smooth(g.constScanLine(y + 1), next.data());
+        const qint16* p = prev.constData();
+        const qint16* n = next.constData();
+        int sum = 0;
+        for (int x = 1; x < w - 1; ++x) sum += std::abs(n[x] - p[x]);
+        (*prof)[y - 1] = sum;
+    }
+}
+
+// Profilde tepe (alt piksel); belirgin değilse -1
+double peakOf(const QVector<int>& prof, double minPeak)
+{
+    if (prof.size() < 3) return -1;
+    const auto it = std::max_element(prof.cbegin(), prof.cend());
+    const int  i  = int(it - prof.cbegin());
+    double mean = 0;
+    for (int v : prof) mean += v;
+    mean /= prof.size();
+    if (*it <= 0 || *it < minPeak * mean) return -1;
+    if (i == 0 || i == prof.size() - 1) return i;
+    const double l = prof[i - 1], c = prof[i], r = prof[i + 1];
+    const double den = l - 2 * c + r;
+    return (den < 0) ? i + 0.5 * (l - r) / den : i;
+}
+
+} // namespace
+
+QRect EdgeSnap::searchRegion(const QRectF& box, const QSize& imageSize, const Params& p)
+{
+    const int band = bandFor(box, p) + 2;
+    return box.toAlignedRect().adjusted(-band, -band, band, band).intersected(QRect(QPoint(0, 0), imageSize));
+}
+
+QRectF EdgeSnap::refine(const QImage& img, const QPoint& origin, const QRectF& boxIn, const Params& p)
+{
+    if (img.isNull() || boxIn.width() < 4 || boxIn.height() < 4) return boxIn;
+    const QRectF box = boxIn.translated(-origin);       // img koordinatı
+    const int band = bandFor(box, p);
+
+    // Kenar boyunca köşelerden uzak dur: dik kenarların gradyanı profili bozmasın
+    const int x1 = int(box.left()), x2 = int(box.right());
+    const int y1 = int(box.top()),  y2 = int(box.bottom());
+    const int insetY = std::min(band, std::max(0, (y2 - y1) / 4));
+    const int insetX = std::min(band, std::max(0, (x2 - x1) / 4));
+
+    double left = boxIn.left(), right = boxIn.right(), top = boxIn.top(), bottom = boxIn.bottom();
+    QVector<int> prof;
+
+    // Sobel tepe kolonu c → kenar (c - 1 .. c + 1 geçişinin ortası) = c + 0.5
+    const auto vertical = [&](int xc, double* edge){
+        const QRect s(xc - band - 1, y1 + insetY, 2 * band + 3, (y2 - y1) - 2 * insetY);
+        const QRect c = s.intersected(img.rect());
+        const QImage g = grayStrip(img, s);
+        if (g.isNull()) return;
+        columnProfile(g, &prof);
+        const double k = peakOf(prof, p.minPeak);
+        if (k >= 0) *edge = c.x() + 1 + k + 0.5 + origin.x();
+    };
+    const auto horizontal = [&](int yc, double* edge){
+        const QRect s(x1 + insetX, yc - band - 1, (x2 - x1) - 2 * insetX, 2 * band + 3);
+        const QRect c = s.intersected(img.rect());
+        const QImage g = grayStrip(img, s);
+        if (g.isNull()) return;
+        rowProfile(g, &prof);
+        const double k = peakOf(prof, p.minPeak);
+        if (k >= 0) *edge = c.y() + 1 + k + 0.5 + origin.y();
+    };
+    vertical(x1, &left);
+    vertical(x2, &right);
+    horizontal(y1, &top);
+    horizontal(y2, &bottom);
+
+    const QRectF out(QPointF(left, top), QPointF(right, bottom));
+    // İki kenar aynı gradyana yapıştıysa (ince nesne / doku) vazgeç
+    if (out.width() < 3 || out.height() < 3) return boxIn;
+    return out;
+}
+
+QImage EdgeSnap::readRegion(const QString& path, const QRect& region)
+{
+    QImageReader r(path);
+    r.setAutoTransform(true);
+    if (r.transformation() == QImageIOHandler::TransformationNone
+        && r.supportsOption(QImageIOHandler::ClipRect)) {
+        r.setClipRect(region);
+        return r.read();
+    }
+    const QImage full = r.read();
+    return full.isNull() ? QImage() : full.copy(region);
+}
@@ -0,0 +1,32 @@
+// edgesnap.h
+#pragma once
+
+#include <QImage>
+#include <QPoint>
+#include <QRect>
+#include <QRectF>
+#include <QString>
+
+// Elle çizilmiş kutunun kenarlarını yakındaki en güçlü gradyana yapıştırır.
+//  - Sadece kutu kenarları çevresindeki şeritler griye çevrilir ve Sobel'den geçer
+//    (20 MP görselde bile birkaç ms); iç döngüler int16 satır dizileri, derleyici vektörleştirir
+//  - Kenar başına: şerit boyunca |G| toplam profili → en güçlü kolon/satır → parabolik alt piksel
+//  - Profil tepe değeri şerit ortalamasından belirgin değilse kenar yerinde kalır
+class EdgeSnap
+{
+public:
+    struct Params {
+        int    band     = 0;      // kenarın iki yanında aranacak px; 0: kutu boyuna göre (6..24)
+        double minPeak  = 1.6;    // tepe / profil ortalaması en az
+    };
+
+    // img: box ile aynı koordinatta bir parça, sol üstü origin (tam görsel için origin = 0,0)
+    static QRectF refine(const QImage& img, const QPoint& origin, const QRectF& box,
+                         const Params& p = Params());
+
+    // Gerekli arama bandı (refine'ın okuyacağı bölge) — tam görsel koordinatında
+    static QRect  searchRegion(const QRectF& box, const QSize& imageSize, const Params& p = Params());
+
+    // Dosyadan yalnız bölgeyi oku (JPEG'de clipRect; EXIF döndürmesi varsa tam decode + kırp)
+    static QImage readRegion(const QString& path, const QRect& region);
+};
@@ -0,0 +1,109 @@
+// image_size_bench.cpp
+// Görsel boyutu: eski yol (uzantı başına QFileInfo::exists + tam QImage decode) ile QImageReader::size(),
+// başlık okuyucu (ImageSizeCache::probe) ve önbellekli sizeForStem karşılaştırması.
+// Görseller geçici klasöre üretilir (JPEG/PNG/BMP/TIFF karışık).
+//   image_size_bench [görsel sayısı=400] [genişlik=1920] [yükseklik=1080]
+#include "imagesizecache.h"
+
+#include <QColor>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+namespace {
+
+// Önceki labelcompare findImageSizeForStem gövdesi
+QSize legacySize(const QString& stem, const QString& dir)
+{
+    const QDir d(dir);
+    for (const char* e : {"png","jpg","jpeg","bmp","tif","tiff"}) {
+        const QString p = d.absoluteFilePath(stem + "." + e);
+        if (QFileInfo::exists(p)) {
+            QImage img(p);
+            if (!img.isNull()) return img.size();
+        }
+    }
+    return {};
+}
+
+template <typename Fn>
+double bench(QTextStream& out, const char* name, const QStringList& stems, Fn fn, bool* ok, const QStringList& exts)
+{
+    QElapsedTimer t;
+    t.start();
+    for (int i = 0; i < stems.size(); ++i) {
+        const QSize sz = fn(stems[i], exts[i]);
+        *ok = *ok && !sz.isEmpty();
+    }
+    const double ms = t.nsecsElapsed() / 1e6;
+    out << QString("%1 %2 ms  %3 µs/görsel\n")
+               .arg(QString::fromLatin1(name), -26)
+               .arg(ms, 9, 'f', 1)
+               .arg(ms * 1000.0 / qMax(1, int(stems.size())), 9, 'f', 1);
+    out.flush();
+    return ms;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments().mid(1);
+    const int count = args.size() > 0 ? args[0].toInt() : 400;
+    const int W     = args.size() > 1 ? args[1].toInt() : 1920;
+    const int H     = args.size() > 2 ? args[2].toInt() : 1080;
+
+    QTemporaryDir tmp;
+    if (!tmp.isValid()) return 2;
+    const QDir dir(tmp.path());
+
+    const char* kinds[] = {"jpg", "png", "bmp", "tif"};
+    QImage img(W, H, QImage::Format_RGB32);
+    QStringList stems, exts;
+    for (int i = 0; i < count; ++i) {
+        img.fill(QColor::fromHsv((i * 37) % 360, 180, 200));
+        QString       ext  = QString::fromLatin1(kinds[i % 4]);
+        const QString stem = QString("img_%1").arg(i);
+        if (!img.save(dir.filePath(stem + '.' + ext))) {          // tiff eklentisi yoksa png
+            ext = QStringLiteral("png");
+            if (!img.save(dir.filePath(stem + '.' + ext))) return 2;
+        }
+        stems << stem;
+        exts  << ext;
+    }
+
+    QTextStream out(stdout);
+    out << "images=" << count << " size=" << W << "x" << H << "\n";
+
+    // Eşdeğerlik: başlık okuyucu QImageReader ile aynı boyutu vermeli
+    bool same = true;
+    for (int i = 0; i < count; ++i) {
+        const QString p = dir.filePath(stems[i] + '.' + exts[i]);
+        same = same && ImageSizeCache::probe(p) == QImageReader(p).size();
+    }
+    out << "identical sizes: " << (same ? "yes" : "NO") << "\n";
+
+    bool ok = true;
+    const QString root = dir.path();
+    const double tOld = bench(out, "exists + QImage (legacy)", stems,
+                              [&](const QString& s, const QString&){ return legacySize(s, root); }, &ok, exts);
+    bench(out, "QImageReader::size", stems,
+          [&](const QString& s, const QString& e){ return QImageReader(dir.filePath(s + '.' + e)).size(); }, &ok, exts);
+    const double tHdr = bench(out, "header probe", stems,
+          [&](const QString& s, const QString& e){ return ImageSizeCache::probe(dir.filePath(s + '.' + e)); }, &ok, exts);
+    const double tCold = bench(out, "sizeForStem (cold)", stems,
+          [&](const QString& s, const QString&){ return ImageSizeCache::instance().sizeForStem(root, s); }, &ok, exts);
+    const double tWarm = bench(out, "sizeForStem (cached)", stems,
+          [&](const QString& s, const QString&){ return ImageSizeCache::instance().sizeForStem(root, s); }, &ok, exts);
+    ImageSizeCache::instance().flush();
+
+    out << QString("speedup vs legacy: header %1x, cold %2x, cached %3x\n")
+               .arg(tOld / tHdr, 0, 'f', 0).arg(tOld / tCold, 0, 'f', 0).arg(tOld / tWarm, 0, 'f', 0);
+    return (same && ok) ? 0 : 1;
+}
@@ -0,0 +1,417 @@
+// imagelistmodel.cpp
+#include "imagelistmodel.h"
+#include "thumbnailcache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QColor>
+#include <QTimer>
+#include <QPair>
+#include <QMetaObject>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <utility>
+
+// ---------------------------
+// Yardımcı: etiket dosyasındaki kutu sayısı (worker thread)
+// ---------------------------
+static qint32 countBoxesInLabel(const QString& path, bool isXml)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return -1;   // dosya yok → etiketsiz
+    const QByteArray all = f.readAll();
+    f.close();
+
+    qint32 n = 0;
+    if (isXml) {
+        int from = 0;
+        while ((from = all.indexOf("<object>", from)) >= 0) { ++n; from += 8; }
+        return n;
+    }
+    // YOLO: boş olmayan satır sayısı
+    bool lineHasText = false;
+    for (char c : all) {
+        if (c == '\n') { if (lineHasText) ++n; lineHasText = false; }
+        else if (c != ' ' && c != '\t' && c != '\r') lineHasText = true;
+    }
+    if (lineHasText) ++n;
+    return n;
+}
+
+// ---------------------------
+// ImageListModel
+// ---------------------------
+ImageListModel::ImageListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+    m_pool.setMaxThreadCount(1);   // küçük dosyalar; tek worker disk sırasını korur
+}
+
+ImageListModel::~ImageListModel()
+{
+    m_pool.clear();
+    m_pool.waitForDone();          // hiçbir iş bu nesneden sonra sonuç göndermesin
+}
+
+void ImageListModel::clear()
+{
+    beginResetModel();
+    m_thumbRows.clear();
+    m_root.clear();
+    m_arena.clear();
+    m_offsets.clear();
+    m_boxCount.clear();
+    m_stateQueue.clear();
+    m_fetched = 0;
+    ++m_generation;
+    endResetModel();
+}
+
+void ImageListModel::setDirectoryFiles(const QString& dir, const QStringList& fileNames)
+{
+    beginResetModel();
+    m_thumbRows.clear();
+    m_root = QDir(dir).absolutePath();
+    if (!m_root.endsWith('/')) m_root += '/';
+    m_arena.clear();
+    m_offsets.clear();
+    m_boxCount.clear();
+    m_stateQueue.clear();
+    m_fetched = 0;
+    ++m_generation;
+    appendNames(fileNames);
+    m_fetched = qMin(totalCount(), kFetchBatch);
+    endResetModel();
+}
+
+void ImageListModel::appendFiles(const QStringList& fileNames)
+{
+    if (fileNames.isEmpty()) return;
+    const int oldFetched = m_fetched;
+    appendNames(fileNames);
+
+    // İlk parça gelirken view boşsa hemen göster; gerisi fetchMore ile
+    if (oldFetched < kFetchBatch) {
+        const int target = qMin(totalCount(), kFetchBatch);
+        if (target > oldFetched) {
+            beginInsertRows(QModelIndex(), oldFetched, target-1);
+            m_fetched = target;
+            endInsertRows();
+        }
+    }
+}
+
+void ImageListModel::setPaths(const QStringList& absPaths)
+{
+    beginResetModel();
+    m_thumbRows.clear();
+    m_root.clear();
+    m_arena.clear();
+    m_offsets.clear();
+    m_boxCount.clear();
+    m_stateQueue.clear();
+    m_fetched = 0;
+    ++m_generation;
+    appendNames(absPaths);
+    m_fetched = qMin(totalCount(), kFetchBatch);
+    endResetModel();
+}
+
+void ImageListModel::sortByName()
+{
+    const int n = totalCount();
+    if (n < 2) return;
+
+    QStringList names;
+    names.reserve(n);
+    for (int i = 0; i < n; ++i) names << nameAt(i);
+
+    const auto less = [&names](int a, int b){
+        const int c = names[a].compare(names[b], Qt::CaseInsensitive);
+        return c != 0 ? c < 0 : names[a] < names[b];
+    };
+    QVector<int> order(n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    if (std::is_sorted(order.begin(), order.end(), less)) return;   // önbellekten gelen liste zaten sıralı
+    std::sort(order.begin(), order.end(), less);
+
+    QVector<int> newRow(n);
+    for (int r = 0; r < n; ++r) newRow[order[r]] = r;
+
+    // Seçili satır yeni yerinde henüz view'a açılmamış olabilir → önce o kadar aç
+    int need = m_fetched;
+    for (const QModelIndex& i : persistentIndexList())
+        if (i.row() >= 0 && i.row() < n) need = qMax(need, newRow[i.row()] + 1);
+    if (need > m_fetched) {
+        beginInsertRows(QModelIndex(), m_fetched, need-1);
+        m_fetched = need;
+        endInsertRows();
+    }
+
+    emit layoutAboutToBeChanged();
+
+    QByteArray       arena;
+    QVector<quint32> offsets;
+    QVector<qint32>  counts;
+    arena.reserve(m_arena.size());
+    offsets.reserve(n);
+    counts.reserve(n);
+    for (int r = 0; r < n; ++r) {
+        const int o = order[r];
+        const quint32 b = m_offsets[o];
+        const quint32 e = (o+1 < n) ? m_offsets[o+1] : quint32(m_arena.size());
+        offsets.push_back(quint32(arena.size()));
+        arena.append(m_arena.constData() + b, int(e - b));
+        counts.push_back(m_boxCount[o] == kPending ? kUnknown : m_boxCount[o]);
+    }
+    m_arena.swap(arena);
+    m_offsets.swap(offsets);
+    m_boxCount.swap(counts);
+    m_stateQueue.clear();
+    m_thumbRows.clear();
+    ++m_generation;                      // satır numaraları değişti; uçuştaki sonuçlar geçersiz
+
+    const QModelIndexList from = persistentIndexList();
+    QModelIndexList to;
+    to.reserve(from.size());
+    for (const QModelIndex& i : from) {
+        const int r = (i.row() >= 0 && i.row() < n) ? newRow[i.row()] : -1;
+        to << (r >= 0 ? index(r) : QModelIndex());
+    }
+    changePersistentIndexList(from, to);
+
+    emit layoutChanged();
+}
+
+void ImageListModel::appendNames(const QStringList& names)
+{
+    m_offsets.reserve(m_offsets.size() + names.size());
+    for (const QString& n : names) {
+        m_offsets.push_back(quint32(m_arena.size()));
+        m_arena.append(n.toUtf8());
+    }
+    m_boxCount.resize(m_offsets.size());
+    std::fill(m_boxCount.begin() + (m_boxCount.size() - names.size()), m_boxCount.end(), kUnknown);
+}
+
+QString ImageListModel::nameAt(int row) const
+{
+    if (row < 0 || row >= m_offsets.size()) return {};
+    const quint32 b = m_offsets[row];
+    const quint32 e = (row+1 < m_offsets.size()) ? m_offsets[row+1] : quint32(m_arena.size());
+    return QString::fromUtf8(m_arena.constData() + b, int(e - b));
+}
+
+QString ImageListModel::pathAt(int row) const
+{
+    const QString n = nameAt(row);
+    if (n.isEmpty()) return {};
+    return m_root.isEmpty() ? n : m_root + n;
+}
+
+QString ImageListModel::fileNameAt(int row) const
+{
+    const QString n = nameAt(row);
+    if (!m_root.isEmpty()) return n;
+    const int slash = qMax(n.lastIndexOf('/'), n.lastIndexOf('\\'));
+    return slash >= 0 ? n.mid(slash+1) : n;
+}
+
+QStringList ImageListModel::allPaths() const
+{
+    QStringList out;
+    out.reserve(totalCount());
+    for (int i = 0; i < totalCount(); ++i) out << pathAt(i);
+    return out;
+}
+
+// ---------------------------
+// Etiket durumu
+// ---------------------------
+void ImageListModel::setLabelsDir(const QString& dir, const QString& ext)
+{
+    const QString d = dir.isEmpty() ? QString() : QDir(dir).absolutePath();
+    const QString x = ext.isEmpty() ? QStringLiteral("txt") : ext.toLower();
+    if (d == m_labelsDir && x == m_labelExt) return;
+
+    m_labelsDir = d;
+    m_labelExt  = x;
+    ++m_generation;                  // uçuştaki eski sonuçlar geçersiz
+    m_stateQueue.clear();
+    std::fill(m_boxCount.begin(), m_boxCount.end(), kUnknown);
+    if (m_fetched > 0)
+        emit dataChanged(index(0), index(m_fetched-1),
+                         {Qt::ForegroundRole, Qt::ToolTipRole, LabelStateRole, BoxCountRole});
+}
+
+void ImageListModel::refreshLabelState(const QString& stem)
+{
+    if (stem.isEmpty()) return;
+
+    // Arena üzerinde bayt karşılaştırma: "<stem>.<uzantı>" (uzantıda '.' yok)
+    const QByteArray key = (stem + '.').toUtf8();
+    for (int r = 0; r < m_fetched; ++r) {
+        const quint32 b0 = m_offsets[r];
+        const quint32 e  = (r+1 < m_offsets.size()) ? m_offsets[r+1] : quint32(m_arena.size());
+        quint32 b = b0;
+        if (m_root.isEmpty()) {                 // mutlak yol: dosya adı kısmına atla
+            for (quint32 k = b0; k < e; ++k)
+                if (m_arena[k] == '/' || m_arena[k] == '\\') b = k + 1;
+        }
+        const int len = int(e - b);
+        if (len <= key.size()) continue;
+        if (memcmp(m_arena.constData() + b, key.constData(), size_t(key.size())) != 0) continue;
+        if (memchr(m_arena.constData() + b + key.size(), '.', size_t(len - key.size()))) continue;
+        if (m_boxCount[r] == kPending) continue;   // zaten okunuyor
+        m_boxCount[r] = kUnknown;
+        emit dataChanged(index(r), index(r),
+                         {Qt::ForegroundRole, Qt::ToolTipRole, LabelStateRole, BoxCountRole});
+    }
+}
+
+void ImageListModel::requestState(int row) const
+{
+    if (m_labelsDir.isEmpty() || m_boxCount[row] != kUnknown) return;
+    m_boxCount[row] = kPending;
+    m_stateQueue.push_back(row);
+    if (!m_flushScheduled) {
+        m_flushScheduled = true;
+        // data() const içinden; aynı olay turundaki tüm görünür satırları tek işte topla
+        QTimer::singleShot(0, const_cast<ImageListModel*>(this), &ImageListModel::flushStateRequests);
+    }
+}
+
+void ImageListModel::flushStateRequests()
+{
+    m_flushScheduled = false;
+    if (m_stateQueue.isEmpty()) return;
+
+    QVector<QPair<int, QString>> jobs;
+    jobs.reserve(m_stateQueue.size());
+    for (int row : std::as_const(m_stateQueue)) {
+        const QString stem = QFileInfo(fileNameAt(row)).completeBaseName();
+        jobs.push_back({row, m_labelsDir + '/' + stem + '.' + m_labelExt});
+    }
+    m_stateQueue.clear();
+
+    const quint64 gen   = m_generation;
+    const bool    isXml = (m_labelExt == "xml");
+    m_pool.start([this, jobs, gen, isXml]{
+        QVector<QPair<int,qint32>> res;
+        res.reserve(jobs.size());
+        for (const auto& j : jobs) res.push_back({j.first, countBoxesInLabel(j.second, isXml)});
+        QMetaObject::invokeMethod(this, [this, gen, res]{ applyStates(gen, res); },
+                                  Qt::QueuedConnection);
+    });
+}
+
+void ImageListModel::applyStates(quint64 gen, const QVector<QPair<int,qint32>>& res)
+{
+    if (gen != m_generation) return;
+    int lo = INT_MAX, hi = -1;
+    for (const auto& r : res) {
+        if (r.first < 0 || r.first >= m_boxCount.size()) continue;
+        m_boxCount[r.first] = r.second;
+        lo = qMin(lo, r.first); hi = qMax(hi, r.first);
+    }
+    if (hi >= 0 && lo < m_fetched)
+        emit dataChanged(index(lo), index(qMin(hi, m_fetched-1)),
+                         {Qt::ForegroundRole, Qt::ToolTipRole, LabelStateRole, BoxCountRole});
+}
+
+// ---------------------------
+// Küçük resimler
+// ---------------------------
+void ImageListModel::setThumbnailCache(ThumbnailCache* cache)
+{
+    if (m_thumbs) disconnect(m_thumbs, nullptr, this, nullptr);
+    m_thumbs = cache;
+    if (m_thumbs)
+        connect(m_thumbs, &ThumbnailCache::thumbnailReady, this, &ImageListModel::onThumbnailReady);
+}
+
+void ImageListModel::setThumbnailsEnabled(bool on)
+{
+    if (on == m_thumbsOn) return;
+    m_thumbsOn = on;
+    m_thumbRows.clear();
+    if (m_thumbs && !on) m_thumbs->cancelPending();
+    if (m_fetched > 0)
+        emit dataChanged(index(0), index(m_fetched-1), {Qt::DecorationRole});
+}
+
+void ImageListModel::onThumbnailReady(const QString& path)
+{
+    const int row = m_thumbRows.value(path, -1);
+    m_thumbRows.remove(path);
+    if (row < 0 || row >= m_fetched) return;
+    if (pathAt(row) != path) return;     // arada sıralama/yeniden yükleme olduysa
+    emit dataChanged(index(row), index(row), {Qt::DecorationRole});
+}
+
+// ---------------------------
+// QAbstractListModel
+// ---------------------------
+int ImageListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_fetched;
+}
+
+bool ImageListModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && m_fetched < totalCount();
+}
+
+void ImageListModel::fetchMore(const QModelIndex& parent)
+{
+    if (parent.isValid()) return;
+    const int add = qMin(kFetchBatch, totalCount() - m_fetched);
+    if (add <= 0) return;
+    beginInsertRows(QModelIndex(), m_fetched, m_fetched + add - 1);
+    m_fetched += add;
+    endInsertRows();
+}
+
+QVariant ImageListModel::data(const QModelIndex& idx, int role) const
+{
+    if (!idx.isValid() || idx.row() >= m_fetched) return {};
+    const int row = idx.row();
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return fileNameAt(row);
+    case PathRole:
+        return pathAt(row);
+    case Qt::DecorationRole: {
+        if (!m_thumbsOn || !m_thumbs) return {};
+        const QString path = pathAt(row);
+        const QPixmap px = m_thumbs->thumbnail(path);
+        if (px.isNull()) { m_thumbRows.insert(path, row); return {}; }
+        return px;
+    }
+    case Qt::ForegroundRole:
+    case Qt::ToolTipRole:
+    case LabelStateRole:
+    case BoxCountRole: {
+        requestState(row);
+        const qint32 n = m_boxCount[row];
+        if (role == BoxCountRole)   return n >= 0 ? n : -1;
+        if (role == LabelStateRole) return int(n >= 0 ? StateLabeled
+                                             : n == kNoLabel ? StateUnlabeled : StateUnknown);
+        if (role == Qt::ForegroundRole) {
+            if (n > 0)         return QColor(120, 200, 120);   // etiketli
+            if (n == 0)        return QColor(220, 180, 80);    // dosya var ama boş
+            if (n == kNoLabel) return QColor(150, 150, 150);   // etiketsiz
+            return {};
+        }
+        // ToolTip
+        if (n >= 0)        return tr("%1 — %2 kutu").arg(pathAt(row)).arg(n);
+        if (n == kNoLabel) return tr("%1 — etiket yok").arg(pathAt(row));
+        return pathAt(row);
+    }
+    default:
+        return {};
+    }
+}
@@ -0,0 +1,91 @@
+// imagelistmodel.h
+#pragma once
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QHash>
+
+class ThumbnailCache;
+
+// Büyük klasörler için sanal dosya listesi modeli.
+//  - Yollar tek bir UTF-8 arena + offset dizisinde tutulur (satır başına QString/QListWidgetItem yok);
+//    klasörden gelen dosyalarda ortak kök bir kez saklanır, arena'ya sadece dosya adı yazılır.
+//  - Satırlar fetchMore ile parça parça açılır; QString sadece data() istendiğinde üretilir.
+//  - Satır başına etiket durumu (etiketli / etiketsiz / kutu sayısı) tembel hesaplanır:
+//    görünür satır sorulunca arka planda okunur ve dataChanged ile gelir.
+class ImageListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Roles {
+        PathRole       = Qt::UserRole,      // mutlak yol (eski QListWidgetItem::UserRole ile uyumlu)
+        LabelStateRole = Qt::UserRole + 1,  // LabelState
+        BoxCountRole   = Qt::UserRole + 2   // int (bilinmiyorsa -1)
+    };
+    enum LabelState { StateUnknown = 0, StateUnlabeled = 1, StateLabeled = 2 };
+
+    explicit ImageListModel(QObject* parent=nullptr);
+    ~ImageListModel() override;
+
+    // İçerik
+    void clear();
+    void setDirectoryFiles(const QString& dir, const QStringList& fileNames);  // ad listesi, ortak kök
+    void appendFiles(const QStringList& fileNames);                            // aynı köke ekle (akış)
+    void setPaths(const QStringList& absPaths);                                // karışık mutlak yollar
+    void sortByName();                                                         // akış bitince; seçim korunur
+
+    int         totalCount() const { return int(m_offsets.size()); }
+    QString     pathAt(int row) const;
+    QString     fileNameAt(int row) const;
+    QStringList allPaths() const;
+    QString     rootDir() const { return m_root; }
+
+    // Etiket durumu için kaynak klasör (ext: "txt" / "xml")
+    void setLabelsDir(const QString& dir, const QString& ext);
+    void refreshLabelState(const QString& stem);   // kayıttan sonra tek satırı yenile
+
+    // Küçük resim modu: DecorationRole önbellekten gelir (yoksa arka planda üretilir)
+    void setThumbnailCache(ThumbnailCache* cache);
+    void setThumbnailsEnabled(bool on);
+    bool thumbnailsEnabled() const { return m_thumbsOn; }
+
+    // QAbstractListModel
+    int      rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& idx, int role = Qt::DisplayRole) const override;
+    bool     canFetchMore(const QModelIndex& parent) const override;
+    void     fetchMore(const QModelIndex& parent) override;
+
+private:
+    static constexpr int     kFetchBatch = 4096;
+    static constexpr qint32  kUnknown    = -2;   // henüz sorulmadı
+    static constexpr qint32  kPending    = -3;   // arka planda okunuyor
+    static constexpr qint32  kNoLabel    = -1;   // etiket dosyası yok
+
+    void    appendNames(const QStringList& names);
+    QString nameAt(int row) const;               // arena'daki ham kayıt (kök hariç)
+    void    requestState(int row) const;         // görünür satır → arka plan kuyruğu
+    void    flushStateRequests();
+    void    applyStates(quint64 gen, const QVector<QPair<int,qint32>>& res);
+
+    QString             m_root;                  // "/abs/dir/" veya boş (setPaths)
+    QByteArray          m_arena;                 // UTF-8 adlar ardışık
+    QVector<quint32>    m_offsets;               // satır → arena başlangıcı
+    int                 m_fetched = 0;           // view'a açılmış satır sayısı
+
+    QString             m_labelsDir;
+    QString             m_labelExt = "txt";
+    mutable QVector<qint32> m_boxCount;          // satır → kutu sayısı / kUnknown / kPending / kNoLabel
+    mutable QVector<int>    m_stateQueue;        // okunacak satırlar
+    mutable bool            m_flushScheduled = false;
+    quint64             m_generation = 0;        // reset sonrası gelen eski sonuçları ele
+
+    ThumbnailCache*     m_thumbs   = nullptr;
+    bool                m_thumbsOn = false;
+    mutable QHash<QString, int> m_thumbRows;     // beklenen küçük resim → satır
+    void onThumbnailReady(const QString& path);
+    QThreadPool         m_pool;
+};
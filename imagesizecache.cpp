@@ -0,0 +1,370 @@
+// imagesizecache.cpp
+#include "imagesizecache.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QPair>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QVector>
+#include <QDebug>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr char kFileMagic[8] = {'Q','I','M','S','Z','0','0','2'};   // 002: EXIF yönü uygulanmış boyut
+constexpr int  kHeadBytes    = 4096;            // çoğu başlık burada biter; ötesi için seek
+
+quint64 fnv1a(const QByteArray& s)
+{
+    quint64 h = 1469598103934665603ULL;
+    for (char c : s) { h ^= quint8(c); h *= 1099511628211ULL; }
+    return h;
+}
+
+// Aynı stem'e birden çok görsel varsa öncelik (eski findImageSizeForStem sırası)
+int extRank(QStringView ext)
+{
+    int r = 0;
+    for (const char* e : {"png","jpg","jpeg","bmp","tif","tiff"}) {
+        if (ext.compare(QLatin1String(e), Qt::CaseInsensitive) == 0) return r;
+        ++r;
+    }
+    return -1;
+}
+
+// Dosyanın başı bellekte; daha uzak konumlar (JPEG'de büyük EXIF/ICC blokları) seek ile
+struct Src
+{
+    QFile&     f;
+    QByteArray head;
+
+    bool at(qint64 off, uchar* dst, int n)
+    {
+        if (off < 0) return false;
+        if (off + n <= head.size()) { memcpy(dst, head.constData() + off, size_t(n)); return true; }
+        return f.seek(off) && f.read(reinterpret_cast<char*>(dst), n) == n;
+    }
+};
+
+inline quint32 rd16(const uchar* p, bool be) { return be ? quint32(p[0] << 8 | p[1]) : quint32(p[1] << 8 | p[0]); }
+inline quint32 rd32(const uchar* p, bool be)
+{
+    return be ? (quint32(p[0]) << 24 | quint32(p[1]) << 16 | quint32(p[2]) << 8 | p[3])
+              : (quint32(p[3]) << 24 | quint32(p[2]) << 16 | quint32(p[1]) << 8 | p[0]);
+}
+
+QSize sized(quint32 w, quint32 h)
+{
+    constexpr quint32 kMax = quint32(std::numeric_limits<int>::max());
+    if (w == 0 || h == 0 || w > kMax || h > kMax) return {};
+    return QSize(int(w), int(h));
+}
+
+// EXIF/TIFF yönü 5..8: görsel 90° döndürülerek gösterilir → genişlik/yükseklik yer değiştirir.
+// Ekranda (QImageReader::setAutoTransform) ve dışa aktarımda aynı boyut görülsün.
+QSize oriented(QSize sz, quint32 orientation)
+{
+    return (orientation >= 5 && orientation <= 8) ? sz.transposed() : sz;
+}
+
+// TIFF başlığı (JPEG APP1 içinde "Exif\0\0" sonrası) bellekte: IFD0'daki Orientation (274)
+quint32 exifOrientation(const uchar* t, int n)
+{
+    if (n < 8) return 1;
+    const bool be = t[0] == 'M';
+    if (!((t[0] == 'I' && t[1] == 'I') || (t[0] == 'M' && t[1] == 'M')) || rd16(t + 2, be) != 42) return 1;
+    const quint32 ifd = rd32(t + 4, be);
+    if (ifd > quint32(n) - 2) return 1;
+    const int cnt = int(rd16(t + ifd, be));
+    for (int k = 0; k < cnt; ++k) {
+        const qint64 e = qint64(ifd) + 2 + qint64(k) * 12;
+        if (e + 12 > n) break;
+        if (rd16(t + e, be) == 274 && rd16(t + e + 2, be) == 3) return rd16(t + e + 8, be);
+    }
+    return 1;
+}
+
+// JPEG: SOI'den itibaren segmentler; ilk SOFn (C4 DHT, C8 JPG, CC DAC hariç) boyutu taşır.
+// SOF'tan önceki APP1 Exif bloğundan yön okunur
+QSize jpegSize(Src& s)
+{
+    qint64  off = 2;
+    quint32 orientation = 1;
+    for (int guard = 0; guard < 4096; ++guard) {
+        uchar m[2];
+        if (!s.at(off, m, 2) || m[0] != 0xFF) return {};
+        const uchar marker = m[1];
+        if (marker == 0xFF) { ++off; continue; }                         // dolgu baytı
+        off += 2;
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) continue;   // uzunluksuz işaretler
+        if (marker == 0xD9 || marker == 0xDA) return {};                 // SOF'tan önce EOI/SOS
+        uchar len[2];
+        if (!s.at(off, len, 2)) return {};
+        const quint32 L = rd16(len, true);
+        if (L < 2) return {};
+        if (marker == 0xE1 && L > 2 + 6 + 8 && orientation == 1) {
+            QByteArray app(int(L - 2), Qt::Uninitialized);               // en fazla 64 KB
+            uchar* a = reinterpret_cast<uchar*>(app.data());
+            if (s.at(off + 2, a, int(app.size())) && memcmp(a, "Exif\0\0", 6) == 0)
+                orientation = exifOrientation(a + 6, int(app.size()) - 6);
+        }
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            uchar sof[5];                                                // P, Y(2), X(2)
+            if (L < 7 || !s.at(off + 2, sof, 5)) return {};
+            return oriented(sized(rd16(sof + 3, true), rd16(sof + 1, true)), orientation);   // Y = 0 (DNL) → yedek yol
+        }
+        off += L;
+    }
+    return {};
+}
+
+// TIFF: ilk IFD'de ImageWidth (256) / ImageLength (257); SHORT ya da LONG. Orientation (274) uygulanır
+QSize tiffSize(Src& s, bool be)
+{
+    uchar b[4];
+    if (!s.at(4, b, 4)) return {};
+    const qint64 ifd = rd32(b, be);
+    if (!s.at(ifd, b, 2)) return {};
+    const int n = int(rd16(b, be));
+    if (n <= 0 || n > 4096) return {};
+    QByteArray entries(n * 12, Qt::Uninitialized);
+    uchar* e = reinterpret_cast<uchar*>(entries.data());
+    if (!s.at(ifd + 2, e, int(entries.size()))) return {};
+    quint32 w = 0, h = 0, orientation = 1;
+    for (int k = 0; k < n; ++k, e += 12) {
+        const quint32 tag  = rd16(e, be);
+        const quint32 type = rd16(e + 2, be);
+        if (tag == 274 && type == 3) { orientation = rd16(e + 8, be); continue; }
+        if (tag != 256 && tag != 257) continue;
+        const quint32 v = type == 3 ? rd16(e + 8, be) : type == 4 ? rd32(e + 8, be) : 0;
+        (tag == 256 ? w : h) = v;
+    }
+    return oriented(sized(w, h), orientation);
+}
+
+QSize headerSize(QFile& f)
+{
+    Src s{f, f.read(kHeadBytes)};
+    const QByteArray& h = s.head;
+    const uchar* p = reinterpret_cast<const uchar*>(h.constData());
+    const int n = int(h.size());
+
+    if (n >= 4 && p[0] == 0xFF && p[1] == 0xD8 && p[2] == 0xFF)
+        return jpegSize(s);
+    if (n >= 24 && memcmp(p, "\x89PNG\r\n\x1a\n", 8) == 0 && memcmp(p + 12, "IHDR", 4) == 0)
+        return sized(rd32(p + 16, true), rd32(p + 20, true));
+    if (n >= 26 && p[0] == 'B' && p[1] == 'M') {
+        const quint32 dib = rd32(p + 14, false);
+        if (dib == 12) return sized(rd16(p + 18, false), rd16(p + 20, false));   // BITMAPCOREHEADER
+        if (dib >= 40) {
+            const qint32 hh = qint32(rd32(p + 22, false));                       // negatif: yukarıdan aşağı
+            return sized(rd32(p + 18, false), hh < 0 ? quint32(-qint64(hh)) : quint32(hh));
+        }
+        return {};
+    }
+    if (n >= 8 && ((p[0] == 'I' && p[1] == 'I') || (p[0] == 'M' && p[1] == 'M'))) {
+        const bool be = p[0] == 'M';
+        if (rd16(p + 2, be) == 42) return tiffSize(s, be);                       // BigTIFF (43) → yedek yol
+    }
+    return {};
+}
+
+qint64 mtimeOf(const QFileInfo& fi)
+{
+    return fi.lastModified().toMSecsSinceEpoch();
+}
+
+} // namespace
+
+ImageSizeCache& ImageSizeCache::instance()
+{
+    static ImageSizeCache s;
+    return s;
+}
+
+ImageSizeCache::~ImageSizeCache()
+{
+    flush();
+}
+
+QSize ImageSizeCache::probe(const QString& path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return {};
+    const QSize sz = headerSize(f);
+    if (!sz.isEmpty()) return sz;
+    f.close();
+    // GIF/WebP/BigTIFF/bozuk başlık: eklenti okusun; yön, ekrandaki autoTransform ile aynı
+    QImageReader r(path);
+    r.setAutoTransform(true);
+    const QSize alt = r.size();
+    if (alt.isEmpty()) return {};
+    return (r.transformation() & QImageIOHandler::TransformationRotate90) ? alt.transposed() : alt;
+}
+
+QSize ImageSizeCache::sizeOf(const QString& path)
+{
+    const QFileInfo fi(path);
+    return sizeInDir(fi.absolutePath(), fi.fileName());
+}
+
+QSize ImageSizeCache::sizeForStem(const QString& imagesDir, const QString& stem)
+{
+    if (imagesDir.isEmpty() || stem.isEmpty()) return {};
+    const QFileInfo di(imagesDir);
+    if (!di.isDir()) return {};
+    const QString absDir   = di.absoluteFilePath();
+    const qint64  dirMtime = mtimeOf(di);
+
+    QString name;
+    {
+        QMutexLocker lk(&m_mutex);
+        DirCache& d = dirLocked(absDir);
+        if (d.dirMtime != dirMtime) {
+            // Klasör bir kez gezilir; diğer worker'lar bu sırada bekler (aynı listeyi tekrar kurmasınlar)
+            d.byStem.clear();
+            QHash<QString, int> rank;
+            QSet<QString>       present;
+            QDirIterator it(absDir, QDir::Files);
+            while (it.hasNext()) {
+                it.next();
+                const QString fn  = it.fileName();
+                const int     dot = fn.lastIndexOf('.');
+                const int     r   = dot > 0 ? extRank(QStringView(fn).mid(dot + 1)) : -1;
+                if (r < 0) continue;
+                present.insert(fn);
+                const QString st = fn.left(dot);
+                const auto    ri = rank.constFind(st);
+                if (ri != rank.constEnd() && *ri <= r) continue;
+                rank.insert(st, r);
+                d.byStem.insert(st, fn);
+            }
+            // Silinen görsellerin kayıtları kalıcı dosyada birikmesin
+            for (auto e = d.entries.begin(); e != d.entries.end(); ) {
+                if (!present.contains(e.key())) { e = d.entries.erase(e); d.dirty = true; }
+                else ++e;
+            }
+            d.dirMtime = dirMtime;
+        }
+        name = d.byStem.value(stem);
+    }
+    return name.isEmpty() ? QSize() : sizeInDir(absDir, name);
+}
+
+QSize ImageSizeCache::sizeInDir(const QString& absDir, const QString& fileName)
+{
+    const QFileInfo fi(QDir(absDir).filePath(fileName));
+    if (!fi.isFile()) return {};
+    const qint64 mtime = mtimeOf(fi), bytes = fi.size();
+    {
+        QMutexLocker lk(&m_mutex);
+        const DirCache& d = dirLocked(absDir);
+        const auto it = d.entries.constFind(fileName);
+        if (it != d.entries.constEnd() && it->mtime == mtime && it->bytes == bytes) return it->size;
+    }
+
+    const QSize sz = probe(fi.filePath());                // kilitsiz: worker'lar paralel okur
+    if (sz.isEmpty()) return {};
+
+    QMutexLocker lk(&m_mutex);
+    DirCache& d = dirLocked(absDir);
+    d.entries.insert(fileName, Entry{mtime, bytes, sz});
+    d.dirty = true;
+    return sz;
+}
+
+void ImageSizeCache::flush()
+{
+    QVector<QPair<QString, DirCache>> pending;
+    {
+        QMutexLocker lk(&m_mutex);
+        for (auto it = m_dirs.begin(); it != m_dirs.end(); ++it) {
+            if (!it->dirty) continue;
+            it->dirty = false;
+            pending.append({it.key(), *it});              // paylaşımlı kopya; yazma kilitsiz
+        }
+    }
+    for (const auto& p : std::as_const(pending)) {
+        if (!save(p.first, p.second)) {
+            QMutexLocker lk(&m_mutex);
+            m_dirs[p.first].dirty = true;                 // sonraki flush'ta tekrar dene
+        }
+    }
+}
+
+// ---------------------------
+// Kalıcı depo
+// ---------------------------
+ImageSizeCache::DirCache& ImageSizeCache::dirLocked(const QString& absDir)
+{
+    DirCache& d = m_dirs[absDir];
+    if (!d.loaded) {
+        d.loaded = true;
+        d.file   = storeFile(absDir);                     // uygulama yaşarken çözülür (çıkışta flush için)
+        load(absDir, &d);
+    }
+    return d;
+}
+
+QString ImageSizeCache::storeFile(const QString& absDir)
+{
+    const QString base = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    const QString dir  = QDir(base.isEmpty() ? QDir::tempPath() : base).filePath("imagesizes");
+    return QDir(dir).filePath(QString::number(fnv1a(absDir.toUtf8()), 16) + ".sizes");
+}
+
+void ImageSizeCache::load(const QString& absDir, DirCache* d)
+{
+    QFile f(d->file);
+    if (!f.open(QIODevice::ReadOnly)) return;
+    char magic[sizeof(kFileMagic)] = {};
+    if (f.read(magic, sizeof(magic)) != qint64(sizeof(magic)) || memcmp(magic, kFileMagic, sizeof(magic)) != 0)
+        return;                                            // başka sürüm → yok say, flush üzerine yazar
+
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_5_15);
+    QString dir;
+    quint32 count = 0;
+    ds >> dir >> count;
+    if (dir != absDir) return;                             // hash çakışması
+    d->entries.reserve(int(qMin<quint32>(count, 1u << 20)));
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; ++i) {
+        QString name;
+        Entry   e;
+        qint32  w = 0, h = 0;
+        ds >> name >> e.mtime >> e.bytes >> w >> h;
+        e.size = QSize(w, h);
+        if (ds.status() == QDataStream::Ok && !e.size.isEmpty()) d->entries.insert(name, e);
+    }
+    if (ds.status() != QDataStream::Ok) {
+        qWarning() << "[ImageSize] corrupt cache ignored:" << d->file;
+        d->entries.clear();
+    }
+}
+
+bool ImageSizeCache::save(const QString& absDir, const DirCache& d)
+{
+    if (d.file.isEmpty()) return false;
+    QDir().mkpath(QFileInfo(d.file).absolutePath());
+    QSaveFile f(d.file);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qWarning() << "[ImageSize] cannot write cache" << d.file << f.errorString();
+        return false;
+    }
+    f.write(kFileMagic, sizeof(kFileMagic));
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_5_15);
+    ds << absDir << quint32(d.entries.size());
+    for (auto it = d.entries.constBegin(); it != d.entries.constEnd(); ++it)
+        ds << it.key() << it->mtime << it->bytes << qint32(it->size.width()) << qint32(it->size.height());
+    return f.commit();
+}
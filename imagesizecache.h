@@ -0,0 +1,56 @@
+// imagesizecache.h
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+
+// Uygulama genelinde paylaşılan görsel boyutu servisi.
+//  - Boyut sadece dosya başlığından okunur: JPEG SOF, PNG IHDR, TIFF IFD (256/257), BMP DIB başlığı.
+//    Tanınmayan/bozuk başlıkta QImageReader::size() (yine decode yok)
+//  - EXIF/TIFF yönü 5..8 ise w/h yer değiştirir: boyut, autoTransform ile gösterilen görselinkidir
+//  - Klasör başına kalıcı önbellek: <cache>/imagesizes/<klasör hash>.sizes
+//      ad → (mtime, bayt, w, h); görsel değişirse (mtime/bayt) kayıt geçersiz, yeniden okunur
+//  - stem → dosya adı eşlemesi klasör başına bir kez kurulur (klasör mtime'ı değişince yenilenir);
+//    uzantı başına QFileInfo::exists denemesi yok
+//  - Thread-safe: kilit sadece tablo erişiminde tutulur, başlık okuma kilitsiz (worker'lardan paralel)
+class ImageSizeCache
+{
+public:
+    static ImageSizeCache& instance();
+
+    // Önbelleksiz tek okuma (başlık, gerekirse QImageReader)
+    static QSize probe(const QString& path);
+
+    QSize sizeOf(const QString& path);                              // mutlak/göreli yol
+    QSize sizeForStem(const QString& imagesDir, const QString& stem);   // png > jpg > jpeg > bmp > tif > tiff
+
+    void flush();                                                   // değişen klasörleri diske yaz
+
+private:
+    ImageSizeCache() = default;
+    ~ImageSizeCache();
+    ImageSizeCache(const ImageSizeCache&) = delete;
+    ImageSizeCache& operator=(const ImageSizeCache&) = delete;
+
+    struct Entry { qint64 mtime = 0; qint64 bytes = 0; QSize size; };
+    struct DirCache {
+        bool                     loaded   = false;
+        bool                     dirty    = false;
+        qint64                   dirMtime = -1;      // byStem bu mtime için kuruldu (-1: hiç)
+        QString                  file;               // kalıcı depo yolu
+        QHash<QString, QString>  byStem;             // stem → dosya adı
+        QHash<QString, Entry>    entries;            // dosya adı → boyut kaydı
+    };
+
+    DirCache& dirLocked(const QString& absDir);      // m_mutex tutulurken; ilk erişimde diskten yükler
+    QSize     sizeInDir(const QString& absDir, const QString& fileName);
+
+    static QString storeFile(const QString& absDir);
+    static void    load(const QString& absDir, DirCache* d);           // d->file'dan
+    static bool    save(const QString& absDir, const DirCache& d);
+
+    QMutex                     m_mutex;
+    QHash<QString, DirCache>   m_dirs;               // mutlak klasör yolu → önbellek
+};
@@ -0,0 +1,114 @@
+// iou_kernel_bench.cpp
+// IoU matrisi: eski yol (XYXY yapısı üzerinde double, çift başına iouXYXY) ile SoA çekirdeklerinin
+// (skaler / SSE2 / AVX2) karşılaştırması. N×M = 10×10 … 1000×1000.
+//   iou_kernel_bench [tekrar çarpanı=1]
+#include "ioukernel.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// Önceki labelcompare yerleşimi: sınıf koordinatlarla karışık, double
+struct XYXY { int cls; double x1, y1, x2, y2; };
+
+double iouXYXY(const XYXY& a, const XYXY& b)
+{
+    const double ix1 = std::max(a.x1,b.x1), iy1 = std::max(a.y1,b.y1);
+    const double ix2 = std::min(a.x2,b.x2), iy2 = std::min(a.y2,b.y2);
+    const double iw = std::max(0.0, ix2-ix1), ih = std::max(0.0, iy2-iy1);
+    const double inter = iw*ih;
+    const double areaA = std::max(0.0, a.x2-a.x1) * std::max(0.0, a.y2-a.y1);
+    const double areaB = std::max(0.0, b.x2-b.x1) * std::max(0.0, b.y2-b.y1);
+    const double uni = areaA + areaB - inter;
+    return uni>0 ? inter/uni : 0.0;
+}
+
+std::vector<XYXY> makeBoxes(int n, QRandomGenerator& rng)
+{
+    std::vector<XYXY> v(n);
+    for (XYXY& b : v) {
+        b.cls = int(rng.bounded(20));
+        b.x1  = rng.bounded(0.9);
+        b.y1  = rng.bounded(0.9);
+        b.x2  = b.x1 + 0.01 + rng.bounded(0.1);
+        b.y2  = b.y1 + 0.01 + rng.bounded(0.1);
+    }
+    return v;
+}
+
+BoxesSoA toSoA(const std::vector<XYXY>& v)
+{
+    BoxesSoA s;
+    s.reserve(int(v.size()));
+    for (const XYXY& b : v) s.push(float(b.x1), float(b.y1), float(b.x2), float(b.y2));
+    return s;
+}
+
+// ns / çift
+template <typename Fn>
+double timePerPair(int reps, qint64 pairs, Fn fn)
+{
+    QElapsedTimer t;
+    t.start();
+    for (int r = 0; r < reps; ++r) fn();
+    return double(t.nsecsElapsed()) / (double(reps) * pairs);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments().mid(1);
+    const int scale = std::max(1, args.size() > 0 ? args[0].toInt() : 1);
+
+    QTextStream out(stdout);
+    out << "selected kernel: " << iouKernelName(iouKernel()) << "\n";
+    out << QString("%1 %2 %3 %4 %5 %6  max|Δ|\n")
+               .arg("N×M", -11).arg("legacy", 9).arg("scalar", 9).arg("sse2", 9).arg("avx2", 9).arg("speedup", 8);
+
+    QRandomGenerator rng(42);
+    bool ok = true;
+    for (int n : {10, 50, 100, 250, 500, 1000}) {
+        const std::vector<XYXY> A = makeBoxes(n, rng), B = makeBoxes(n, rng);
+        const BoxesSoA sa = toSoA(A), sb = toSoA(B);
+        const qint64 pairs = qint64(n) * n;
+        const int reps = std::max(1, int(20000000 / pairs)) * scale;
+
+        std::vector<double> ref(size_t(pairs));
+        std::vector<float>  m(size_t(pairs));
+        volatile double sink = 0;
+        const double tLegacy = timePerPair(reps, pairs, [&]{
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < n; ++j) ref[size_t(i) * n + j] = iouXYXY(A[i], B[j]);
+            sink = sink + ref[0];
+        });
+
+        double t[3] = {-1, -1, -1};
+        float  maxDiff = 0;
+        for (IouKernel k : {IouKernel::Scalar, IouKernel::SSE2, IouKernel::AVX2}) {
+            if (!iouKernelSupported(k)) continue;
+            t[int(k)] = timePerPair(reps, pairs, [&]{ iouMatrix(k, sa, sb, m.data()); sink = sink + m[0]; });
+            for (qint64 p = 0; p < pairs; ++p) maxDiff = std::max(maxDiff, float(std::fabs(m[p] - ref[p])));
+        }
+        ok = ok && maxDiff < 1e-4f;
+
+        auto cell = [](double ns){ return ns < 0 ? QString("-") : QString::number(ns, 'f', 2); };
+        const double best = t[int(iouKernel())];
+        out << QString("%1 %2 %3 %4 %5 %6x  %7\n")
+                   .arg(QString("%1×%1").arg(n), -11)
+                   .arg(cell(tLegacy), 9).arg(cell(t[0]), 9).arg(cell(t[1]), 9).arg(cell(t[2]), 9)
+                   .arg(tLegacy / best, 7, 'f', 1)
+                   .arg(double(maxDiff), 0, 'g', 3);
+        out.flush();
+    }
+    out << "(ns/çift; speedup: legacy / seçilen çekirdek)\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,207 @@
+// ioukernel.cpp
+#include "ioukernel.h"
+
+#include <algorithm>
+#include <numeric>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define IOU_X86 1
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#    define IOU_TARGET_SSE2
+#    define IOU_TARGET_AVX2
+#  else
+#    define IOU_TARGET_SSE2 __attribute__((target("sse2")))
+#    define IOU_TARGET_AVX2 __attribute__((target("avx2")))
+#  endif
+#else
+#  define IOU_X86 0
+#endif
+
+// ---------------------------
+// BoxesSoA
+// ---------------------------
+void BoxesSoA::clear()
+{
+    x1.clear(); y1.clear(); x2.clear(); y2.clear(); area.clear();
+}
+
+void BoxesSoA::reserve(int n)
+{
+    x1.reserve(n); y1.reserve(n); x2.reserve(n); y2.reserve(n); area.reserve(n);
+}
+
+void BoxesSoA::push(float ax1, float ay1, float ax2, float ay2)
+{
+    x1.push_back(ax1); y1.push_back(ay1); x2.push_back(ax2); y2.push_back(ay2);
+    area.push_back(std::max(0.0f, ax2 - ax1) * std::max(0.0f, ay2 - ay1));
+}
+
+namespace {
+
+// Tek kutu ↔ b[j0, n): SIMD yollarının kuyruğu da bunu kullanır
+struct RowBox { float x1, y1, x2, y2, area; };
+
+inline void rowScalar(const RowBox& a, const BoxesSoA& b, int j0, float* out)
+{
+    const int n = b.size();
+    const float* bx1 = b.x1.data(); const float* by1 = b.y1.data();
+    const float* bx2 = b.x2.data(); const float* by2 = b.y2.data();
+    const float* ba  = b.area.data();
+    for (int j = j0; j < n; ++j) {
+        const float iw    = std::max(0.0f, std::min(a.x2, bx2[j]) - std::max(a.x1, bx1[j]));
+        const float ih    = std::max(0.0f, std::min(a.y2, by2[j]) - std::max(a.y1, by1[j]));
+        const float inter = iw * ih;
+        const float uni   = (a.area + ba[j]) - inter;
+        out[j] = uni > 0.0f ? inter / uni : 0.0f;
+    }
+}
+
+#if IOU_X86
+IOU_TARGET_SSE2 void rowSSE2(const RowBox& a, const BoxesSoA& b, float* out)
+{
+    const int n = b.size();
+    const __m128 X1 = _mm_set1_ps(a.x1), Y1 = _mm_set1_ps(a.y1);
+    const __m128 X2 = _mm_set1_ps(a.x2), Y2 = _mm_set1_ps(a.y2);
+    const __m128 AA = _mm_set1_ps(a.area), Z = _mm_setzero_ps();
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        const __m128 iw    = _mm_max_ps(Z, _mm_sub_ps(_mm_min_ps(X2, _mm_loadu_ps(&b.x2[j])),
+                                                      _mm_max_ps(X1, _mm_loadu_ps(&b.x1[j]))));
+        const __m128 ih    = _mm_max_ps(Z, _mm_sub_ps(_mm_min_ps(Y2, _mm_loadu_ps(&b.y2[j])),
+                                                      _mm_max_ps(Y1, _mm_loadu_ps(&b.y1[j]))));
+        const __m128 inter = _mm_mul_ps(iw, ih);
+        const __m128 uni   = _mm_sub_ps(_mm_add_ps(AA, _mm_loadu_ps(&b.area[j])), inter);
+        const __m128 valid = _mm_cmpgt_ps(uni, Z);                 // uni <= 0 → 0 (bölüm sonucu maskelenir)
+        _mm_storeu_ps(out + j, _mm_and_ps(valid, _mm_div_ps(inter, uni)));
+    }
+    rowScalar(a, b, j, out);
+}
+
+IOU_TARGET_AVX2 void rowAVX2(const RowBox& a, const BoxesSoA& b, float* out)
+{
+    const int n = b.size();
+    const __m256 X1 = _mm256_set1_ps(a.x1), Y1 = _mm256_set1_ps(a.y1);
+    const __m256 X2 = _mm256_set1_ps(a.x2), Y2 = _mm256_set1_ps(a.y2);
+    const __m256 AA = _mm256_set1_ps(a.area), Z = _mm256_setzero_ps();
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        const __m256 iw    = _mm256_max_ps(Z, _mm256_sub_ps(_mm256_min_ps(X2, _mm256_loadu_ps(&b.x2[j])),
+                                                            _mm256_max_ps(X1, _mm256_loadu_ps(&b.x1[j]))));
+        const __m256 ih    = _mm256_max_ps(Z, _mm256_sub_ps(_mm256_min_ps(Y2, _mm256_loadu_ps(&b.y2[j])),
+                                                            _mm256_max_ps(Y1, _mm256_loadu_ps(&b.y1[j]))));
+        const __m256 inter = _mm256_mul_ps(iw, ih);
+        const __m256 uni   = _mm256_sub_ps(_mm256_add_ps(AA, _mm256_loadu_ps(&b.area[j])), inter);
+        const __m256 valid = _mm256_cmp_ps(uni, Z, _CMP_GT_OQ);
+        _mm256_storeu_ps(out + j, _mm256_and_ps(valid, _mm256_div_ps(inter, uni)));
+    }
+    rowScalar(a, b, j, out);
+}
+#endif
+
+IouKernel detectKernel()
+{
+#if IOU_X86
+#  if defined(_MSC_VER) && !defined(__clang__)
+    int r[4];
+    __cpuid(r, 0);
+    const int maxLeaf = r[0];
+    __cpuid(r, 1);
+    const bool sse2    = (r[3] >> 26) & 1;
+    const bool osxsave = (r[2] >> 27) & 1;
+    const bool avx     = (r[2] >> 28) & 1;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {   // OS YMM durumunu saklıyor mu
+        __cpuidex(r, 7, 0);
+        avx2 = (r[1] >> 5) & 1;
+    }
+#  else
+    __builtin_cpu_init();
+    const bool avx2 = __builtin_cpu_supports("avx2");
+    const bool sse2 = __builtin_cpu_supports("sse2");
+#  endif
+    if (avx2) return IouKernel::AVX2;
+    if (sse2) return IouKernel::SSE2;
+#endif
+    return IouKernel::Scalar;
+}
+
+inline RowBox rowBox(const BoxesSoA& a, int i)
+{
+    return {a.x1[i], a.y1[i], a.x2[i], a.y2[i], a.area[i]};
+}
+
+inline void row(IouKernel k, const RowBox& a, const BoxesSoA& b, float* out)
+{
+#if IOU_X86
+    if (k == IouKernel::AVX2) { rowAVX2(a, b, out); return; }
+    if (k == IouKernel::SSE2) { rowSSE2(a, b, out); return; }
+#endif
+    (void)k;
+    rowScalar(a, b, 0, out);
+}
+
+} // namespace
+
+IouKernel iouKernel()
+{
+    static const IouKernel k = detectKernel();
+    return k;
+}
+
+bool iouKernelSupported(IouKernel k)
+{
+    return int(k) <= int(iouKernel());
+}
+
+const char* iouKernelName(IouKernel k)
+{
+    switch (k) {
+    case IouKernel::AVX2: return "avx2";
+    case IouKernel::SSE2: return "sse2";
+    default:              return "scalar";
+    }
+}
+
+void iouMatrix(IouKernel k, const BoxesSoA& a, const BoxesSoA& b, float* out)
+{
+    if (!iouKernelSupported(k)) k = iouKernel();
+    const int nA = a.size(), nB = b.size();
+    if (nB == 0) return;
+    for (int i = 0; i < nA; ++i) row(k, rowBox(a, i), b, out + size_t(i) * nB);
+}
+
+void iouMatrix(const BoxesSoA& a, const BoxesSoA& b, float* out)
+{
+    iouMatrix(iouKernel(), a, b, out);
+}
+
+void iouRow(const BoxesSoA& a, int i, const BoxesSoA& b, float* out)
+{
+    if (b.size() == 0) return;
+    row(iouKernel(), rowBox(a, i), b, out);
+}
+
+std::vector<int> nms(const BoxesSoA& boxes, const float* scores, float iouThr)
+{
+    const int n = boxes.size();
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [scores](int l, int r){ return scores[l] > scores[r]; });
+
+    std::vector<int>   keep;
+    std::vector<char>  dead(n, 0);
+    std::vector<float> ious(n);
+    for (int k = 0; k < n; ++k) {
+        const int i = order[k];
+        if (dead[i]) continue;
+        keep.push_back(i);
+        iouRow(boxes, i, boxes, ious.data());               // tutulan kutu ↔ hepsi, tek SIMD satırı
+        for (int m = k + 1; m < n; ++m) {
+            const int j = order[m];
+            if (ious[j] > iouThr) dead[j] = 1;
+        }
+    }
+    return keep;
+}
@@ -0,0 +1,36 @@
+// ioukernel.h
+#pragma once
+
+#include <vector>
+
+// ---------------------------
+// IoU matris çekirdeği (Qt'siz)
+//  - Kutular structure-of-arrays: her koordinat ayrı, ardışık float dizisi → SIMD ile 4/8 kutu birden
+//  - AVX2 / SSE2 / skaler; en iyisi çalışma anında CPU'ya göre bir kez seçilir
+//  - Tüm yollar aynı float işlemlerini aynı sırayla yapar (sonuçlar yollar arasında aynı)
+// ---------------------------
+struct BoxesSoA {
+    std::vector<float> x1, y1, x2, y2, area;      // area = max(0,w)*max(0,h), push ile hesaplanır
+
+    int  size() const { return int(x1.size()); }
+    void clear();
+    void reserve(int n);
+    void push(float ax1, float ay1, float ax2, float ay2);
+};
+
+enum class IouKernel { Scalar, SSE2, AVX2 };
+
+IouKernel   iouKernel();                          // bu CPU için seçilen yol
+bool        iouKernelSupported(IouKernel k);
+const char* iouKernelName(IouKernel k);
+
+// out[i * b.size() + j] = IoU(a[i], b[j]); out en az a.size() * b.size() float
+void iouMatrix(const BoxesSoA& a, const BoxesSoA& b, float* out);
+void iouMatrix(IouKernel k, const BoxesSoA& a, const BoxesSoA& b, float* out);   // ölçüm / karşılaştırma
+
+// Tek satır: a'nın i. kutusu ↔ b'nin tümü (out: b.size() float)
+void iouRow(const BoxesSoA& a, int i, const BoxesSoA& b, float* out);
+
+// Sınıfsız NMS: skor sırasıyla tutulan kutunun IoU > iouThr olduğu düşük skorlular elenir.
+// Tutulan indeksler (skor sırasında) döner. Sınıf bazlı için kutuları sınıfa göre gruplayıp çağırın.
+std::vector<int> nms(const BoxesSoA& boxes, const float* scores, float iouThr);
@@ -0,0 +1,345 @@
+// keyframes.cpp
+#include "keyframes.h"
+#include "label_serializer.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kMatchMaxCost = 0.35;   // normalize merkez mesafesi + boy farkı
+constexpr int    kMaxErrors    = 50;
+
+// kutu ↔ (cx, cy, w, h) — ara değer merkez ve boy üzerinde yapılır
+struct Vec4 { double v[4]; };
+
+Vec4 toVec(const QRectF& r)
+{
+    const QPointF c = r.center();
+    return {{c.x(), c.y(), r.width(), r.height()}};
+}
+
+QRectF fromVec(const Vec4& p)
+{
+    const double w = std::max(1e-4, p.v[2]), h = std::max(1e-4, p.v[3]);
+    return QRectF(p.v[0] - w / 2, p.v[1] - h / 2, w, h).intersected(QRectF(0, 0, 1, 1));
+}
+
+double matchCost(const QRectF& a, const QRectF& b)
+{
+    const QPointF d = a.center() - b.center();
+    return std::hypot(d.x(), d.y()) + std::abs(a.width() - b.width()) + std::abs(a.height() - b.height());
+}
+
+const KeyframeTracks::Key* findTrack(const KeyframeTracks::Frame& f, int track)
+{
+    for (const auto& k : f.keys)
+        if (k.track == track) return &k;
+    return nullptr;
+}
+
+// Tam boyut (EXIF döndürmesi dahil), decode etmeden
+QSize headerSize(const QString& path)
+{
+    QImageReader r(path);
+    r.setAutoTransform(true);
+    const QSize raw = r.size();
+    return (r.transformation() & QImageIOHandler::TransformationRotate90) ? raw.transposed() : raw;
+}
+
+} // namespace
+
+// ---------------------------
+// Anahtar kareler + track eşleştirme
+// ---------------------------
+void KeyframeTracks::setKeyframe(int frame, const QString& stem, QVector<Key> keys)
+{
+    // Komşu anahtar kareler: önce öncekiyle, kalanlar sonrakiyle eşleşir
+    QVector<const Frame*> neighbours;
+    auto it = m_frames.lowerBound(frame);
+    if (it != m_frames.begin()) neighbours << &std::prev(it).value();
+    if (it != m_frames.end() && it.key() == frame) ++it;
+    if (it != m_frames.end()) neighbours << &it.value();
+
+    QSet<int> used;
+    for (const Key& k : std::as_const(keys))
+        if (k.track >= 0) used.insert(k.track);
+
+    for (const Frame* nb : std::as_const(neighbours)) {
+        // Aday çiftler: aynı sınıf, maliyete göre artan (greedy)
+        struct Cand { double cost; int key; int track; };
+        QVector<Cand> cands;
+        for (int i = 0; i < keys.size(); ++i) {
+            if (keys[i].track >= 0) continue;
+            for (const Key& o : nb->keys) {
+                if (o.cls != keys[i].cls || used.contains(o.track)) continue;
+                const double c = matchCost(keys[i].rect, o.rect);
+                if (c <= kMatchMaxCost) cands.push_back({c, i, o.track});
+            }
+        }
+        std::sort(cands.begin(), cands.end(), [](const Cand& a, const Cand& b){ return a.cost < b.cost; });
+        for (const Cand& c : std::as_const(cands)) {
+            if (keys[c.key].track >= 0 || used.contains(c.track)) continue;
+            keys[c.key].track = c.track;
+            used.insert(c.track);
+        }
+    }
+
+    for (Key& k : keys) {
+        if (k.track < 0) k.track = m_nextTrack++;
+        m_nextTrack = std::max(m_nextTrack, k.track + 1);
+    }
+    m_frames[frame] = Frame{stem, std::move(keys)};
+    m_edited.remove(stem);                              // artık anahtar kare
+    m_generated.remove(stem);
+}
+
+int KeyframeTracks::frameOf(const QString& stem) const
+{
+    for (auto it = m_frames.cbegin(); it != m_frames.cend(); ++it)
+        if (it->stem == stem) return it.key();
+    return -1;
+}
+
+bool KeyframeTracks::removeKeyframe(int frame)
+{
+    return m_frames.remove(frame) > 0;
+}
+
+// ---------------------------
+// Ara değer
+// ---------------------------
+bool KeyframeTracks::boxesAt(int frame, Mode mode, QVector<Key>* out) const
+{
+    out->clear();
+    auto b = m_frames.lowerBound(frame);
+    if (b != m_frames.end() && b.key() == frame) { *out = b->keys; return true; }
+    if (b == m_frames.begin() || b == m_frames.end()) return false;
+    auto a = std::prev(b);
+
+    const double t1 = a.key(), t2 = b.key();
+    const double t  = (frame - t1) / (t2 - t1);
+    const auto   a0 = (a != m_frames.begin()) ? std::prev(a) : m_frames.end();
+    const auto   b1 = std::next(b);
+
+    for (const Key& ka : a->keys) {
+        const Key* kb = findTrack(b.value(), ka.track);
+        if (!kb) continue;                              // track bu aralıkta bitiyor/başlıyor
+        const Vec4 p1 = toVec(ka.rect), p2 = toVec(kb->rect);
+        Vec4 r;
+
+        if (mode == Mode::Linear) {
+            for (int c = 0; c < 4; ++c) r.v[c] = p1.v[c] + (p2.v[c] - p1.v[c]) * t;
+        } else {
+            // Hermite; teğetler komşu anahtar karelerden (düzensiz aralık için zaman ölçekli),
+            // komşuda track yoksa tek taraflı fark
+            const Key* k0 = (a0 != m_frames.end()) ? findTrack(a0.value(), ka.track) : nullptr;
+            const Key* k3 = (b1 != m_frames.end()) ? findTrack(b1.value(), ka.track) : nullptr;
+            const Vec4 p0 = k0 ? toVec(k0->rect) : p1;
+            const Vec4 p3 = k3 ? toVec(k3->rect) : p2;
+            const double t0 = k0 ? a0.key() : t1;
+            const double t3 = k3 ? b1.key() : t2;
+            const double h00 =  2*t*t*t - 3*t*t + 1, h10 = t*t*t - 2*t*t + t;
+            const double h01 = -2*t*t*t + 3*t*t,     h11 = t*t*t - t*t;
+            for (int c = 0; c < 4; ++c) {
+                const double m1 = k0 ? (p2.v[c] - p0.v[c]) / (t2 - t0) * (t2 - t1) : p2.v[c] - p1.v[c];
+                const double m2 = k3 ? (p3.v[c] - p1.v[c]) / (t3 - t1) * (t2 - t1) : p2.v[c] - p1.v[c];
+                r.v[c] = h00 * p1.v[c] + h10 * m1 + h01 * p2.v[c] + h11 * m2;
+            }
+        }
+        const QRectF rect = fromVec(r);
+        if (rect.isEmpty()) continue;                   // tamamen kare dışına çıktı
+        out->push_back({ka.track, ka.cls, rect});
+    }
+    return true;
+}
+
+void KeyframeTracks::reindex(const std::function<int(const QString&)>& indexOf)
+{
+    QMap<int, Frame> moved;
+    for (auto it = m_frames.cbegin(); it != m_frames.cend(); ++it) {
+        const int i = indexOf(it->stem);
+        if (i >= 0) moved.insert(i, it.value());
+        else        m_unresolved.insert(it->stem, it.value());
+    }
+    m_frames.swap(moved);
+    resolve(indexOf);
+}
+
+int KeyframeTracks::resolve(const std::function<int(const QString&)>& indexOf)
+{
+    int placed = 0;
+    for (auto it = m_unresolved.begin(); it != m_unresolved.end(); ) {
+        const int i = indexOf(it.key());
+        if (i < 0 || m_frames.contains(i)) { ++it; continue; }
+        m_frames.insert(i, it.value());
+        it = m_unresolved.erase(it);
+        ++placed;
+    }
+    return placed;
+}
+
+// ---------------------------
+// Kalıcılık: "stem\ttrack cls x1 y1 x2 y2"; boş anahtar kare "stem\t"
+// ---------------------------
+bool KeyframeTracks::save(const QString& path, QString* err) const
+{
+    if (m_loadFailed) {                                 // dosyadaki anahtar kareler elde yok → ezme
+        if (err) *err = QStringLiteral("%1: yüklenemedi, üzerine yazılmadı").arg(path);
+        return false;
+    }
+    QByteArray out("# keyframes: stem<TAB>track cls x1 y1 x2 y2 (0..1); stem<TAB>* elle düzeltilmiş ara kare\n");
+    QVector<const Frame*> frames;
+    frames.reserve(m_frames.size() + m_unresolved.size());
+    for (const Frame& f : m_frames)     frames << &f;
+    for (const Frame& f : m_unresolved) frames << &f;
+    for (const Frame* fp : std::as_const(frames)) {
+        const Frame& f = *fp;
+        const QByteArray stem = f.stem.toUtf8();
+        if (f.keys.isEmpty()) { out += stem; out += "\t\n"; continue; }
+        for (const Key& k : f.keys) {
+            out += stem; out += '\t';
+            LabelSerializer::appendInt(out, k.track);   out += ' ';
+            LabelSerializer::appendInt(out, k.cls);     out += ' ';
+            LabelSerializer::appendFixed(out, k.rect.left(), 6);   out += ' ';
+            LabelSerializer::appendFixed(out, k.rect.top(), 6);    out += ' ';
+            LabelSerializer::appendFixed(out, k.rect.right(), 6);  out += ' ';
+            LabelSerializer::appendFixed(out, k.rect.bottom(), 6); out += '\n';
+        }
+    }
+    for (const QString& stem : m_edited)    { out += stem.toUtf8(); out += "\t*\n"; }
+    for (const QString& stem : m_generated) { out += stem.toUtf8(); out += "\t~\n"; }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly) || f.write(out) != out.size() || !f.commit()) {
+        if (err) *err = QStringLiteral("%1: %2").arg(path, f.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool KeyframeTracks::load(const QString& path, const std::function<int(const QString&)>& indexOf, QString* err)
+{
+    clear();
+    QFile f(path);
+    if (!f.exists()) return true;                       // henüz anahtar kare yok
+    if (!f.open(QIODevice::ReadOnly)) {
+        m_loadFailed = true;
+        if (err) *err = QStringLiteral("%1: %2").arg(path, f.errorString());
+        return false;
+    }
+
+    while (!f.atEnd()) {
+        // readLine().trimmed() sondaki sekmeyi de siler: boş anahtar kare "stem\t" → "stem"
+        const QByteArray line = f.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) continue;
+        const int tab = int(line.indexOf('\t'));
+        const QString stem = QString::fromUtf8(tab < 0 ? line : line.left(tab));
+        const QByteArray rest = tab >= 0 ? line.mid(tab + 1).trimmed() : QByteArray();
+        if (rest == "*") { m_edited.insert(stem);    continue; }
+        if (rest == "~") { m_generated.insert(stem); continue; }
+
+        // Listede (henüz) yoksa çözülmemiş olarak tut: kayıtta kaybolmasın
+        const int frame = indexOf(stem);
+        Frame& fr = frame >= 0 ? m_frames[frame] : m_unresolved[stem];
+        fr.stem = stem;
+        if (tab < 0) continue;
+        const QList<QByteArray> p = line.mid(tab + 1).simplified().split(' ');
+        if (p.size() != 6) continue;
+        Key k;
+        k.track = p[0].toInt();
+        k.cls   = p[1].toInt();
+        k.rect  = QRectF(QPointF(p[2].toDouble(), p[3].toDouble()), QPointF(p[4].toDouble(), p[5].toDouble()));
+        fr.keys.push_back(k);
+        m_nextTrack = std::max(m_nextTrack, k.track + 1);
+    }
+    if (!m_unresolved.isEmpty() && err)
+        *err = QStringLiteral("%1 anahtar kare listede (henüz) olmayan görsele ait; korunuyor").arg(m_unresolved.size());
+    return true;
+}
+
+// ---------------------------
+// Toplu yazım (paralel)
+// ---------------------------
+KeyframeTracks::CommitReport KeyframeTracks::commit(const QStringList& images, int firstIndex, Mode mode, bool voc,
+                                                    const QString& outDir, const QStringList& classes,
+                                                    const QVector<int>& skip, const std::atomic_bool* cancel) const
+{
+    CommitReport rep;
+    QElapsedTimer timer;
+    timer.start();
+    if (m_frames.isEmpty() || images.isEmpty()) return rep;
+
+    const QSet<int> skipSet(skip.cbegin(), skip.cend());
+    const int lo = std::max(firstFrame(), firstIndex);
+    const int hi = std::min(lastFrame(), firstIndex + int(images.size()) - 1);
+    if (hi < lo) return rep;
+    const QDir dir(outDir);
+    const QString ext = voc ? QStringLiteral(".xml") : QStringLiteral(".txt");
+
+    // Kare başına yuva: worker'lar kilitsiz doldurur, sıra korunur
+    QVector<Output> outs(hi - lo + 1);
+    std::atomic_int next{lo}, skipped{0}, failed{0};
+    QMutex errMutex;
+
+    const auto work = [&]{
+        LabelSerializer ser;                            // worker başına tampon
+        QVector<LabelSerializer::Box> boxes;
+        QVector<Key> keys;
+        for (int frame; (frame = next.fetch_add(1)) <= hi; ) {
+            if (cancel && cancel->load()) break;
+            const QString img  = images[frame - firstIndex];
+            const QString stem = QFileInfo(img).completeBaseName();
+            const QString path = dir.filePath(stem + ext);
+            if (m_frames.contains(frame) || skipSet.contains(frame) || m_edited.contains(stem)
+                || (!m_generated.contains(stem) && QFileInfo::exists(path))   // track'ten önce etiketlenmiş
+                || !boxesAt(frame, mode, &keys)) { ++skipped; continue; }
+
+            boxes.resize(0);
+            for (const Key& k : std::as_const(keys))
+                boxes.push_back({k.cls, k.rect.left(), k.rect.top(), k.rect.right(), k.rect.bottom()});
+
+            Output& o = outs[frame - lo];
+            if (voc) {
+                const QSize sz = headerSize(img);
+                if (!sz.isValid()) {
+                    ++failed;
+                    QMutexLocker lock(&errMutex);
+                    if (rep.errors.size() < kMaxErrors) rep.errors << QStringLiteral("%1: görsel boyutu okunamadı").arg(img);
+                    continue;
+                }
+                o.content = ser.voc(boxes.constData(), int(boxes.size()), sz, classes, sz.width(), sz.height());
+            } else {
+                o.content = ser.yolo(boxes.constData(), int(boxes.size()));
+            }
+            o.stem = stem;
+            o.path = path;
+        }
+    };
+
+    QThreadPool pool;
+    const int workers = std::clamp(QThread::idealThreadCount(), 1, std::max(1, hi - lo + 1));
+    pool.setMaxThreadCount(workers);
+    for (int i = 1; i < workers; ++i) pool.start(work);
+    work();                                             // çağıran thread de pay alır
+    pool.waitForDone();
+
+    rep.outputs.reserve(outs.size());
+    for (Output& o : outs)
+        if (!o.path.isEmpty()) rep.outputs.push_back(std::move(o));
+    rep.skipped   = skipped;
+    rep.failed    = failed;
+    rep.elapsedMs = timer.elapsed();
+    return rep;
+}
@@ -0,0 +1,106 @@
+// keyframes.h
+#pragma once
+
+#include <QByteArray>
+#include <QMap>
+#include <QRectF>
+#include <QHash>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+// Görsel dizilerinde anahtar kare etiketleme.
+//  - Kullanıcı i ve j karelerini etiketler; aradaki kareler track ID eşleşmesiyle hesaplanır
+//  - Kutular 0..1 normalize (kare boyutu değişse de geçerli)
+//  - Ara kareler saklanmaz: gösterimde hesaplanır, kayıtta / toplu yazımda diske iner
+//  - Kalıcılık: <etiket klasörü>/keyframes.txt  ("stem track cls x1 y1 x2 y2" satırları)
+//  - Listede (henüz) olmayan stem'lerin anahtar kareleri atılmaz: çözülmemiş tutulur, kayıtta aynen
+//    yazılır, liste büyüyünce / yeniden sıralanınca resolve/reindex ile yerine oturur
+//  - Elle düzeltilmiş ara kareler ("stem\t*") kalıcıdır; toplu yazım onları ezmez
+//  - Toplu yazımın ürettiği kareler ("stem\t~") işaretlenir: diskte etiketi olan kare yalnız
+//    böyle üretilmişse yeniden yazılır (track'ten önce elle etiketlenmiş kareler korunur)
+// Değer tipi: toplu yazım için kopyası worker'a verilir.
+class KeyframeTracks
+{
+public:
+    enum class Mode { Linear, Spline };
+
+    struct Key {
+        int    track = -1;
+        int    cls   = 0;
+        QRectF rect;                   // normalize (0..1)
+    };
+    struct Frame {
+        QString      stem;
+        QVector<Key> keys;
+    };
+
+    bool isEmpty() const       { return m_frames.isEmpty(); }
+    int  count() const         { return int(m_frames.size()); }
+    bool isKeyframe(int frame) const { return m_frames.contains(frame); }
+    int  frameOf(const QString& stem) const;   // stem'in anahtar karesi (-1: yok); m_index'ten bağımsız
+    const QMap<int, Frame>& frames() const { return m_frames; }
+    int  firstFrame() const    { return m_frames.isEmpty() ? -1 : m_frames.firstKey(); }
+    int  lastFrame() const     { return m_frames.isEmpty() ? -1 : m_frames.lastKey(); }
+
+    // Anahtar kare ekle/güncelle. track < 0 olan kutulara en yakın anahtar karelerdeki
+    // aynı sınıftan kutularla eşleşerek ID verilir; eşleşmeyen yeni ID alır.
+    void setKeyframe(int frame, const QString& stem, QVector<Key> keys);
+    bool removeKeyframe(int frame);
+    void clear()
+    {
+        m_frames.clear(); m_unresolved.clear(); m_edited.clear(); m_generated.clear();
+        m_nextTrack = 0; m_loadFailed = false;
+    }
+
+    // Ara kare elle düzeltildi (kaydedildi): toplu yazım bu stem'i atlar. Anahtar kare olunca kalkar.
+    void markEdited(const QString& stem)         { m_edited.insert(stem); m_generated.remove(stem); }
+    bool isEdited(const QString& stem) const     { return m_edited.contains(stem); }
+    // Toplu yazımın ürettiği kareler: sonraki toplu yazım bunları ezebilir
+    void markGenerated(const QStringList& stems) { for (const QString& s : stems) m_generated.insert(s); }
+
+    int  unresolvedCount() const { return int(m_unresolved.size()); }
+
+    // frame için kutular: anahtar kareyse kendisi, iki anahtar kare arasındaysa ara değer.
+    // Sadece iki taraftaki anahtar karede de bulunan track'ler döner.
+    // Dönüş false: frame anahtar kare aralığında değil.
+    bool boxesAt(int frame, Mode mode, QVector<Key>* out) const;
+
+    // Liste yeniden sıralanınca: stem → yeni indeks (-1: listede yok → çözülmemişe geçer, kaybolmaz)
+    void reindex(const std::function<int(const QString& stem)>& indexOf);
+    // Sadece çözülmemişler (liste sona eklenerek büyürken; mevcut indeksler değişmez). Dönüş: yerleşen
+    int  resolve(const std::function<int(const QString& stem)>& indexOf);
+
+    bool load(const QString& path, const std::function<int(const QString& stem)>& indexOf, QString* err=nullptr);
+    bool save(const QString& path, QString* err=nullptr) const;   // yükleme başarısızsa üzerine yazmaz
+
+    // Toplu yazım: [ilk, son] anahtar kare aralığındaki ara kareler YOLO ya da VOC içeriği olarak üretilir
+    // (diske yazmaz: çağıran LabelWriter'a verir, tek atomik yazıcı). Atlananlar: anahtar kareler
+    // (annotator kendisi yazar), skip içindekiler, isEdited stem'ler ve outDir'de etiketi olup
+    // toplu yazımdan gelmeyenler. Serileştirme paralel; cancel ile durdurulabilir.
+    struct Output {
+        QString    stem, path;
+        QByteArray content;
+    };
+    struct CommitReport {
+        int             skipped = 0, failed = 0;
+        qint64          elapsedMs = 0;
+        QVector<Output> outputs;       // kare sırasıyla
+        QStringList     errors;        // ilk birkaç hata
+    };
+    CommitReport commit(const QStringList& images, int firstIndex, Mode mode, bool voc,
+                        const QString& outDir, const QStringList& classes,
+                        const QVector<int>& skip, const std::atomic_bool* cancel=nullptr) const;
+
+private:
+    QMap<int, Frame>       m_frames;       // kare indeksi → anahtar kare (sıralı)
+    QHash<QString, Frame>  m_unresolved;   // stem → listede henüz olmayan anahtar kare
+    QSet<QString>          m_edited;       // elle düzeltilmiş ara kareler (stem)
+    QSet<QString>          m_generated;    // toplu yazımla üretilmiş ara kareler (stem)
+    int                    m_nextTrack = 0;
+    bool                   m_loadFailed = false;
+};
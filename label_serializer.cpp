@@ -0,0 +1,118 @@
+// label_serializer.cpp
+#include "label_serializer.h"
+
+#include <QFile>
+#include <charconv>
+
+void LabelSerializer::reset()
+{
+    m_buf.resize(0);                              // Qt6: kapasite korunur (paylaşılmıyorsa)
+}
+
+void LabelSerializer::appendInt(QByteArray& out, qint64 v)
+{
+    char tmp[24];
+    const auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+    out.append(tmp, int(r.ptr - tmp));
+}
+
+void LabelSerializer::appendFixed(QByteArray& out, double v, int decimals)
+{
+    char tmp[64];
+    const auto r = std::to_chars(tmp, tmp + sizeof(tmp), v, std::chars_format::fixed, decimals);
+    if (r.ec != std::errc()) { out += QByteArray::number(v, 'f', decimals); return; }   // aşırı büyük değer
+    out.append(tmp, int(r.ptr - tmp));
+}
+
+void LabelSerializer::appendXmlEscaped(QByteArray& out, const QString& s)
+{
+    const QByteArray u = s.toUtf8();
+    for (char c : u) {
+        switch (c) {
+        case '<': out += "&lt;";   break;
+        case '>': out += "&gt;";   break;
+        case '&': out += "&amp;";  break;
+        case '"': out += "&quot;"; break;
+        default:  out += c;        break;
+        }
+    }
+}
+
+// ---------------------------
+// YOLO
+// ---------------------------
+const QByteArray& LabelSerializer::yolo(const Box* boxes, int n, double W, double H)
+{
+    reset();
+    for (int i = 0; i < n; ++i) {
+        const Box& b = boxes[i];
+        if (b.cls < 0) continue;                  // geçersiz sınıfı yazma
+        appendInt(m_buf, b.cls);
+        m_buf += ' ';
+        appendFixed(m_buf, (b.x1 + (b.x2 - b.x1) / 2) / W, 6);
+        m_buf += ' ';
+        appendFixed(m_buf, (b.y1 + (b.y2 - b.y1) / 2) / H, 6);
+        m_buf += ' ';
+        appendFixed(m_buf, (b.x2 - b.x1) / W, 6);
+        m_buf += ' ';
+        appendFixed(m_buf, (b.y2 - b.y1) / H, 6);
+        m_buf += '\n';
+    }
+    return m_buf;
+}
+
+// ---------------------------
+// Pascal VOC (QXmlStreamWriter + setAutoFormatting(true) çıktısıyla aynı düzen)
+// ---------------------------
+const QByteArray& LabelSerializer::voc(const Box* boxes, int n, const QSize& sz, const QStringList& classes,
+                                       double sx, double sy, const QString& fileName)
+{
+    const auto tag = [this](const char* indent, const char* name, auto writeValue){
+        m_buf += indent;
+        m_buf += '<';  m_buf += name;  m_buf += '>';
+        writeValue();
+        m_buf += "</"; m_buf += name;  m_buf += ">\n";
+    };
+    const auto intTag = [&](const char* indent, const char* name, qint64 v){
+        tag(indent, name, [&]{ appendInt(m_buf, v); });
+    };
+
+    reset();
+    m_buf += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<annotation>\n";
+    if (!fileName.isEmpty())
+        tag("    ", "filename", [&]{ appendXmlEscaped(m_buf, fileName); });
+    m_buf += "    <size>\n";
+    intTag("        ", "width",  sz.width());
+    intTag("        ", "height", sz.height());
+    m_buf += "        <depth>3</depth>\n    </size>\n";
+
+    for (int i = 0; i < n; ++i) {
+        const Box& b = boxes[i];
+        if (b.cls < 0) continue;
+        m_buf += "    <object>\n";
+        tag("        ", "name", [&]{
+            if (b.cls < classes.size()) appendXmlEscaped(m_buf, classes[b.cls]);
+            else { m_buf += "cls"; appendInt(m_buf, b.cls); }
+        });
+        m_buf += "        <bndbox>\n";
+        intTag("            ", "xmin", qint64(b.x1 * sx));
+        intTag("            ", "ymin", qint64(b.y1 * sy));
+        intTag("            ", "xmax", qint64(b.x2 * sx));
+        intTag("            ", "ymax", qint64(b.y2 * sy));
+        m_buf += "        </bndbox>\n    </object>\n";
+    }
+    m_buf += "</annotation>\n";
+    return m_buf;
+}
+
+// Toplu dışa aktarım için: tamponsuz aç, tek write (QFile ara tamponu yok)
+bool LabelSerializer::writeFile(const QString& path, const QByteArray& data, QString* err)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)
+        || f.write(data) != data.size()) {
+        if (err) *err = QStringLiteral("%1: %2").arg(path, f.errorString());
+        return false;
+    }
+    return true;
+}
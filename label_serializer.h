@@ -0,0 +1,44 @@
+// label_serializer.h
+#pragma once
+
+#include <QByteArray>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+
+// YOLO txt / Pascal VOC xml metnini tek bayt tamponuna üretir.
+//  - Sayılar std::to_chars ile (QString::arg / QLocale / UTF-16 dönüşümü yok)
+//  - Tampon nesne ömrü boyunca tekrar kullanılır: ısındıktan sonra dosya başına ayırma yok
+//  - VOC çıktısı QXmlStreamWriter(setAutoFormatting) ile bayt bayt aynı
+//  - writeFile(): tamponsuz QFile, tek write çağrısı
+// Annotator, AnnotationStore dışa aktarımı, LabelConverter ve label_serializer_bench ortak kullanır.
+class LabelSerializer
+{
+public:
+    // xyxy kutu; birim çağırana bağlı (piksel ya da 0..1), ölçek parametreleriyle çevrilir
+    struct Box { int cls = 0; double x1 = 0, y1 = 0, x2 = 0, y2 = 0; };
+
+    LabelSerializer() { m_buf.reserve(4096); }
+
+    // YOLO: "cls cx cy w h\n" (6 ondalık); koordinatlar W,H'ye bölünür (normalize kaynakta 1,1)
+    const QByteArray& yolo(const Box* boxes, int n, double W = 1.0, double H = 1.0);
+
+    // VOC: koordinatlar sx,sy ile çarpılıp tam sayıya kesilir (piksel kaynakta 1,1).
+    // cls < 0 olan kutular atlanır; ad yoksa "cls<N>".
+    const QByteArray& voc(const Box* boxes, int n, const QSize& imageSize, const QStringList& classes,
+                          double sx = 1.0, double sy = 1.0, const QString& fileName = QString());
+
+    const QByteArray& bytes() const { return m_buf; }
+
+    static bool writeFile(const QString& path, const QByteArray& data, QString* err=nullptr);
+
+    // Ortak sayı/metin yardımcıları (COCO yazıcısı da kullanır)
+    static void appendInt(QByteArray& out, qint64 v);
+    static void appendFixed(QByteArray& out, double v, int decimals);
+    static void appendXmlEscaped(QByteArray& out, const QString& s);
+
+private:
+    void reset();
+
+    QByteArray m_buf;
+};
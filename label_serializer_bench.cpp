@@ -0,0 +1,148 @@
+// label_serializer_bench.cpp
+// YOLO/VOC metin üretimi: eski yol (QString::arg / QXmlStreamWriter) ile LabelSerializer karşılaştırması.
+//   label_serializer_bench [görsel sayısı=100000] [görsel başına kutu=8] [--write <klasör>]
+// --write verilirse LabelSerializer çıktısı diske de yazılır (dosya başına tek write).
+#include "label_serializer.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <QXmlStreamWriter>
+
+namespace {
+
+using Box = LabelSerializer::Box;
+
+QVector<QVector<Box>> makeDataset(int images, int perImage, int W, int H)
+{
+    QRandomGenerator rng(42);
+    QVector<QVector<Box>> all(images);
+    for (auto& boxes : all) {
+        boxes.resize(perImage);
+        for (Box& b : boxes) {
+            b.cls = int(rng.bounded(20));
+            b.x1  = rng.bounded(double(W) * 0.8);
+            b.y1  = rng.bounded(double(H) * 0.8);
+            b.x2  = b.x1 + 8 + rng.bounded(double(W) * 0.2);
+            b.y2  = b.y1 + 8 + rng.bounded(double(H) * 0.2);
+        }
+    }
+    return all;
+}
+
+// Önceki AnnotatorWidget::saveYOLO gövdesi
+QByteArray legacyYOLO(const QVector<Box>& boxes, double W, double H)
+{
+    QString text;
+    for (const Box& b : boxes) {
+        text += QString("%1 %2 %3 %4 %5\n")
+                    .arg(b.cls)
+                    .arg((b.x1 + (b.x2 - b.x1) / 2) / W, 0, 'f', 6)
+                    .arg((b.y1 + (b.y2 - b.y1) / 2) / H, 0, 'f', 6)
+                    .arg((b.x2 - b.x1) / W, 0, 'f', 6)
+                    .arg((b.y2 - b.y1) / H, 0, 'f', 6);
+    }
+    return text.toUtf8();
+}
+
+// Önceki AnnotatorWidget::saveVOC gövdesi
+QByteArray legacyVOC(const QVector<Box>& boxes, const QSize& sz, const QStringList& classes)
+{
+    QByteArray bytes;
+    QBuffer buf(&bytes);
+    buf.open(QIODevice::WriteOnly);
+    QXmlStreamWriter xml(&buf);
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
+    xml.writeStartElement("annotation");
+    xml.writeStartElement("size");
+    xml.writeTextElement("width",  QString::number(sz.width()));
+    xml.writeTextElement("height", QString::number(sz.height()));
+    xml.writeTextElement("depth",  "3");
+    xml.writeEndElement();
+    for (const Box& b : boxes) {
+        xml.writeStartElement("object");
+        xml.writeTextElement("name", b.cls < classes.size() ? classes[b.cls] : QString("cls%1").arg(b.cls));
+        xml.writeStartElement("bndbox");
+        xml.writeTextElement("xmin", QString::number(int(b.x1)));
+        xml.writeTextElement("ymin", QString::number(int(b.y1)));
+        xml.writeTextElement("xmax", QString::number(int(b.x2)));
+        xml.writeTextElement("ymax", QString::number(int(b.y2)));
+        xml.writeEndElement();
+        xml.writeEndElement();
+    }
+    xml.writeEndElement();
+    xml.writeEndDocument();
+    buf.close();
+    return bytes;
+}
+
+template <typename Fn>
+void bench(QTextStream& out, const char* name, int images, Fn fn)
+{
+    QElapsedTimer t;
+    t.start();
+    qint64 bytes = 0;
+    for (int i = 0; i < images; ++i) bytes += fn(i);
+    const double ms = t.nsecsElapsed() / 1e6;
+    out << QString("%1 %2 ms  %3 MB/s  %4 img/s\n")
+               .arg(QString::fromLatin1(name), -24)
+               .arg(ms, 9, 'f', 1)
+               .arg(bytes / 1048576.0 / (ms / 1000.0), 8, 'f', 1)
+               .arg(images / (ms / 1000.0), 10, 'f', 0);
+    out.flush();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments().mid(1);
+    QString writeDir;
+    const int wi = int(args.indexOf("--write"));
+    if (wi >= 0 && wi + 1 < args.size()) { writeDir = args[wi + 1]; args.remove(wi, 2); }
+
+    const int images   = args.size() > 0 ? args[0].toInt() : 100000;
+    const int perImage = args.size() > 1 ? args[1].toInt() : 8;
+    const QSize sz(1920, 1080);
+    QStringList classes;
+    for (int c = 0; c < 20; ++c) classes << QString("class_%1").arg(c);
+
+    QTextStream out(stdout);
+    out << "images=" << images << " boxes/image=" << perImage << "\n";
+    const auto data = makeDataset(images, perImage, sz.width(), sz.height());
+
+    // Eşdeğerlik: aynı baytlar üretilmeli
+    LabelSerializer ser;
+    const QByteArray y0 = legacyYOLO(data[0], sz.width(), sz.height());
+    const QByteArray v0 = legacyVOC(data[0], sz, classes);
+    const bool sameY = ser.yolo(data[0].constData(), perImage, sz.width(), sz.height()) == y0;
+    const bool sameV = ser.voc(data[0].constData(), perImage, sz, classes) == v0;
+    out << "identical output: yolo=" << (sameY ? "yes" : "NO") << " voc=" << (sameV ? "yes" : "NO") << "\n";
+
+    bench(out, "yolo  QString::arg", images, [&](int i){ return legacyYOLO(data[i], sz.width(), sz.height()).size(); });
+    bench(out, "yolo  LabelSerializer", images, [&](int i){
+        return ser.yolo(data[i].constData(), perImage, sz.width(), sz.height()).size();
+    });
+    bench(out, "voc   QXmlStreamWriter", images, [&](int i){ return legacyVOC(data[i], sz, classes).size(); });
+    bench(out, "voc   LabelSerializer", images, [&](int i){
+        return ser.voc(data[i].constData(), perImage, sz, classes).size();
+    });
+
+    if (!writeDir.isEmpty()) {
+        QDir().mkpath(writeDir);
+        const QDir d(writeDir);
+        bench(out, "yolo  serialize+write", images, [&](int i){
+            const QByteArray& b = ser.yolo(data[i].constData(), perImage, sz.width(), sz.height());
+            LabelSerializer::writeFile(d.filePath(QString("img_%1.txt").arg(i)), b);
+            return b.size();
+        });
+    }
+    return (sameY && sameV) ? 0 : 1;
+}
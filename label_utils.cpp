@@ -69,6 +69,32 @@ QString autoFindOtherLabels(const QString& oursTrainDir)
     return bestGuess;
 }
 
+// Çok annotator'lu uyum analizi: bizimki + etiket içeren tüm labels_*/train kardeşleri
+// (konsensüs çıktısı hariç). Sıra: bizimki, sonra ada göre.
+QStringList autoFindAnnotatorLabels(const QString& oursTrainDir)
+{
+    QStringList out;
+    const QFileInfo inFi(oursTrainDir);
+    if (!inFi.exists() || !inFi.isDir()) return out;
+    out << QDir::toNativeSeparators(inFi.absoluteFilePath());
+
+    QDir trainDir(oursTrainDir);
+    if (trainDir.dirName().compare("train", Qt::CaseInsensitive) != 0) return out;
+    QDir labelsDir = trainDir; labelsDir.cdUp();
+    const QString ourBase = labelsDir.dirName();
+    QDir root = labelsDir; root.cdUp();
+
+    for (const QString& name : root.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+        if (!name.startsWith("labels_", Qt::CaseInsensitive)) continue;
+        if (name.compare(ourBase, Qt::CaseInsensitive) == 0) continue;
+        if (name.contains("consensus", Qt::CaseInsensitive)) continue;
+        const QString candTrain = QDir(root).filePath(name + "/train");
+        if (QDir(candTrain).exists() && hasLabels(candTrain))
+            out << QDir::toNativeSeparators(QFileInfo(candTrain).absoluteFilePath());
+    }
+    return out;
+}
+
 // ========================== eklenen yardımcılar ==========================
 namespace lu {
 
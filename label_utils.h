@@ -1,6 +1,7 @@
 // label_utils.h
 #pragma once
 #include <QString>
+#include <QStringList>
 
 // İleri bildirim (compile time’ı hafif tutmak için)
 class QPlainTextEdit;
@@ -43,3 +44,7 @@ QString autoFindOtherLabels(const QString& oursTrainDir);
 // kardeş etiket klasörünü (örn. labels_yolo_li/train) otomatik bulur.
 // İçinde .txt/.xml yoksa en iyi tahmini döndürür; bulunamazsa "" döner.
 QString autoFindOtherLabels(const QString& oursTrainDir);
+
+// Aynı kökteki tüm annotator klasörleri: bizimki (ilk) + etiket içeren labels_*/train kardeşleri
+// (labels_*consensus* hariç). Çok annotator'lu uyum analizi için.
+QStringList autoFindAnnotatorLabels(const QString& oursTrainDir);
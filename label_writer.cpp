@@ -0,0 +1,101 @@
+// label_writer.cpp
+#include "label_writer.h"
+
+#include <QThread>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QMutexLocker>
+#include <QMetaObject>
+
+LabelWriter::LabelWriter(QObject* parent)
+    : QObject(parent)
+{
+    m_thread = new QThread;
+    m_thread->setObjectName("LabelWriter");
+    m_worker = new QObject;
+    m_worker->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_thread->start(QThread::LowPriority);
+}
+
+LabelWriter::~LabelWriter()
+{
+    // Event loop'u durdur; kuyruğa girip işlenmemiş drain çağrıları düşebilir,
+    // bu yüzden kalanları burada (çağıran thread'de) yaz.
+    m_thread->quit();
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    m_worker = nullptr;
+
+    drain();
+}
+
+void LabelWriter::enqueue(const QString& outPath, const QByteArray& content)
+{
+    bool schedule = false;
+    {
+        QMutexLocker lk(&m_mutex);
+        m_pending.insert(outPath, content);       // aynı yol → üzerine yaz (coalesce)
+        if (!m_drainScheduled) {
+            m_drainScheduled = true;
+            schedule = true;
+        }
+    }
+    if (schedule && m_worker)
+        QMetaObject::invokeMethod(m_worker, [this]{ drain(); }, Qt::QueuedConnection);
+}
+
+int LabelWriter::pendingCount() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_pending.size();
+}
+
+void LabelWriter::drain()
+{
+    for (;;) {
+        QHash<QString, QByteArray> batch;
+        {
+            QMutexLocker lk(&m_mutex);
+            batch.swap(m_pending);
+            if (batch.isEmpty()) { m_drainScheduled = false; return; }
+        }
+        for (auto it = batch.cbegin(); it != batch.cend(); ++it) {
+            QString err;
+            const bool ok = writeOne(it.key(), it.value(), &err);
+            emit written(it.key(), ok, err);
+        }
+    }
+}
+
+bool LabelWriter::writeOne(const QString& path, const QByteArray& data, QString* err)
+{
+    const QString parent = QFileInfo(path).absolutePath();
+    if (!m_madeDirs.contains(parent)) {
+        if (!QDir().mkpath(parent)) {
+            if (err) *err = QStringLiteral("mkpath failed: %1").arg(parent);
+            return false;
+        }
+        m_madeDirs.insert(parent);
+    }
+
+    QSaveFile f(path);
+    f.setDirectWriteFallback(false);              // rename yapılamıyorsa yerinde yazma
+    if (!f.open(QIODevice::WriteOnly)) {
+        m_madeDirs.remove(parent);                // klasör dışarıdan silinmiş olabilir
+        if (err) *err = f.errorString();
+        return false;
+    }
+    if (f.write(data) != data.size()) {
+        if (err) *err = f.errorString();
+        f.cancelWriting();
+        return false;
+    }
+    if (!f.commit()) {                            // temp → hedef (atomik)
+        if (err) *err = f.errorString();
+        return false;
+    }
+    return true;
+}
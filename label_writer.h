@@ -0,0 +1,47 @@
+// label_writer.h
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QByteArray>
+#include <QString>
+
+class QThread;
+
+// Arka plan etiket yazıcısı (tek worker thread).
+//  - GUI thread sadece içeriği (QByteArray) kuyruğa bırakır, diske dokunmaz.
+//  - Aynı hedef yola worker yetişmeden gelen kayıtlar birleştirilir (son içerik kazanır).
+//  - Yazma QSaveFile ile: geçici dosya + atomik rename → çökme anında yarım dosya kalmaz.
+//  - mkpath sonucu klasör başına bir kez önbelleğe alınır.
+class LabelWriter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LabelWriter(QObject* parent=nullptr);
+    ~LabelWriter() override;   // bekleyen kayıtları yazmadan kapanmaz
+
+    // Thread-safe; anında döner
+    void enqueue(const QString& outPath, const QByteArray& content);
+
+    // Bekleyen (henüz diske inmemiş) hedef sayısı
+    int  pendingCount() const;
+
+signals:
+    // Worker thread'den yayılır (alıcı GUI'deyse otomatik queued)
+    void written(const QString& path, bool ok, const QString& error);
+
+private:
+    void drain();                                   // worker thread'de çalışır
+    bool writeOne(const QString& path, const QByteArray& data, QString* err);
+
+    QThread*                   m_thread = nullptr;
+    QObject*                   m_worker = nullptr;  // m_thread'e taşınan bağlam nesnesi
+
+    mutable QMutex             m_mutex;
+    QHash<QString, QByteArray> m_pending;           // hedef yol → son içerik
+    bool                       m_drainScheduled = false;
+
+    QSet<QString>              m_madeDirs;          // yalnız worker erişir
+};
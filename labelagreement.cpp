@@ -0,0 +1,304 @@
+// labelagreement.cpp
+#include "labelagreement.h"
+#include "ioukernel.h"
+#include "imagesizecache.h"
+#include "label_serializer.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// .../labels_ali/train → labels_ali (klasör adı tek başına anlamsızsa üst klasör)
+QString annotatorName(const QString& dir)
+{
+    const QFileInfo fi(QDir::cleanPath(dir));
+    if (fi.fileName().compare("train", Qt::CaseInsensitive) == 0
+        || fi.fileName().compare("val", Qt::CaseInsensitive) == 0)
+        return QFileInfo(fi.absolutePath()).fileName();
+    return fi.fileName();
+}
+
+// Konsensüs kümesi: ortalama kutu + annotator oy maskesi
+struct Cluster {
+    int     cls   = 0;
+    double  sx1 = 0, sy1 = 0, sx2 = 0, sy2 = 0;   // koordinat toplamları
+    int     votes = 0;
+    quint64 mask  = 0;
+};
+
+// Worker başına tekrar kullanılan tamponlar
+struct Scratch {
+    std::vector<QVector<XYXY>> boxes;              // görsel başına kutu önbelleği: annotator → kutular
+    QVector<BoxMatch>          pairs;
+    std::vector<Cluster>       clusters;
+    BoxesSoA                   fused, one;         // küme ortalamaları / sorgu kutusu
+    std::vector<float>         ious;
+    QVector<LabelSerializer::Box> out;
+    LabelSerializer            ser;
+};
+
+// Kutu füzyonu: annotator sırasıyla her kutu, aynı sınıftan ve o annotator'ın henüz oy vermediği
+// en yüksek IoU'lu kümeye (IoU >= thr) katılır; yoksa yeni küme açar. IoU küme ortalamasına göre.
+void fuse(Scratch& s, double thr)
+{
+    s.clusters.clear();
+    s.fused.clear();
+    const float thrF = std::max(float(thr), 1e-9f);
+    for (size_t a = 0; a < s.boxes.size(); ++a) {
+        const quint64 bit = quint64(1) << a;
+        for (const XYXY& b : s.boxes[a]) {
+            int best = -1;
+            float bestIoU = thrF;
+            const int nc = int(s.clusters.size());
+            if (nc > 0) {
+                s.one.clear();
+                s.one.push(float(b.x1), float(b.y1), float(b.x2), float(b.y2));
+                s.ious.resize(size_t(nc));
+                iouRow(s.one, 0, s.fused, s.ious.data());
+                for (int k = 0; k < nc; ++k) {
+                    const Cluster& c = s.clusters[k];
+                    if (c.cls != b.cls || (c.mask & bit) || s.ious[k] < bestIoU) continue;
+                    if (best < 0 || s.ious[k] > bestIoU) { best = k; bestIoU = s.ious[k]; }
+                }
+            }
+            if (best < 0) {
+                s.clusters.push_back({b.cls, b.x1, b.y1, b.x2, b.y2, 1, bit});
+                s.fused.push(float(b.x1), float(b.y1), float(b.x2), float(b.y2));
+                continue;
+            }
+            Cluster& c = s.clusters[best];
+            c.sx1 += b.x1; c.sy1 += b.y1; c.sx2 += b.x2; c.sy2 += b.y2;
+            ++c.votes;
+            c.mask |= bit;
+            const float x1 = float(c.sx1 / c.votes), y1 = float(c.sy1 / c.votes);
+            const float x2 = float(c.sx2 / c.votes), y2 = float(c.sy2 / c.votes);
+            s.fused.x1[best] = x1; s.fused.y1[best] = y1; s.fused.x2[best] = x2; s.fused.y2[best] = y2;
+            s.fused.area[best] = std::max(0.0f, x2 - x1) * std::max(0.0f, y2 - y1);
+        }
+    }
+}
+
+} // namespace
+
+LabelAgreement::LabelAgreement(QObject* parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<LabelAgreement::Report>("LabelAgreement::Report");
+}
+
+LabelAgreement::~LabelAgreement()
+{
+    m_runner.stop();
+}
+
+bool LabelAgreement::start(const Job& job)
+{
+    return m_runner.start([this, job](const std::atomic_bool* cancel, QThreadPool* pool){
+        return analyze(job, cancel, [this](int done, int total){ emit progress(done, total); }, pool);
+    }, [this](const Report& rep){ emit finished(rep); });
+}
+
+LabelAgreement::Report LabelAgreement::analyze(const Job& job, const std::atomic_bool* cancel,
+                                               const std::function<void(int, int)>& progress, QThreadPool* pool)
+{
+    QElapsedTimer timer;
+    timer.start();
+    Report rep;
+    rep.dirs         = job.dirs;
+    rep.iouThr       = job.iouThr;
+    rep.mode         = job.mode;
+    rep.consensusDir = job.consensusDir;
+
+    const int N = int(job.dirs.size());
+    if (N < 2 || N > kMaxAnnotators) {
+        rep.errors << QString("annotator count must be 2..%1 (got %2)").arg(kMaxAnnotators).arg(N);
+        return rep;
+    }
+    for (int a = 0; a < N; ++a)
+        rep.names << (a < job.names.size() && !job.names[a].isEmpty() ? job.names[a] : annotatorName(job.dirs[a]));
+    rep.minVotes = job.minVotes > 0 ? std::min(job.minVotes, N) : N / 2 + 1;
+    rep.pairs.resize(N * N);
+
+    // 1) Her klasör bir kez listelenir; sınıf adları: kendi classes.txt'i, yoksa ilk bulunan
+    std::vector<QHash<QString, QString>> files(N);
+    std::vector<ClassIndex> classes(N);
+    ClassIndex anyClasses;
+    QStringList stems;
+    for (int a = 0; a < N; ++a) {
+        files[a]   = listLabelFiles(job.dirs[a]);
+        classes[a] = loadClassIndex(job.dirs[a]);
+        if (anyClasses.isEmpty()) anyClasses = classes[a];
+        for (auto it = files[a].cbegin(); it != files[a].cend(); ++it) stems << it.key();
+    }
+    for (ClassIndex& c : classes) if (c.isEmpty()) c = anyClasses;
+    stems.sort();
+    stems.removeDuplicates();
+
+    const bool writeConsensus = !job.consensusDir.isEmpty();
+    if (writeConsensus) {
+        if (!QDir().mkpath(job.consensusDir)) {
+            rep.errors << "mkpath failed: " + job.consensusDir;
+            return rep;
+        }
+        // Sınıf adları konsensüs klasörüne de (VOC girdilerde indeksler bu sıraya göre)
+        for (int a = 0; a < N; ++a) {
+            const QDir d(job.dirs[a]);
+            const QString src = QFile::exists(d.filePath("classes.txt")) ? d.filePath("classes.txt")
+                                                                          : d.filePath("../classes.txt");
+            if (!QFile::exists(src)) continue;
+            const QString dst = QDir(job.consensusDir).filePath("classes.txt");
+            QFile::remove(dst);
+            QFile::copy(src, dst);
+            break;
+        }
+    }
+
+    // 2) Görseller paylaşılan sayaçla; çift istatistikleri worker'da yerel
+    const int n = int(stems.size());
+    QVector<ImageScore> results(n);
+    ImageScore* out = results.data();
+    std::atomic_int next{0}, done{0};
+    std::atomic<qint64> totalBoxes{0}, consensusBoxes{0}, contested{0};
+    QMutex mergeMutex;
+
+    const auto work = [&]{
+        std::vector<PairStats> local(size_t(N) * N);
+        Scratch s;
+        s.boxes.resize(size_t(N));
+        qint64 nBoxes = 0, nCons = 0, nContested = 0;
+        QStringList errors;
+        for (int i; (i = next.fetch_add(1)) < n; ) {
+            if (cancel && cancel->load()) break;
+            const QString& stem = stems.at(i);
+            ImageScore& r = out[i];
+            r.stem = stem;
+            r.boxes.resize(N);
+
+            // Görsel başına kutu önbelleği: her annotator'ın dosyası bir kez okunur
+            for (int a = 0; a < N; ++a) {
+                s.boxes[a] = readLabelBoxes(files[a].value(stem), &classes[a],
+                                            [&]{ return findImageSizeForStem(stem, job.imagesRoot); });
+                r.boxes[a] = int(s.boxes[a].size());
+                nBoxes += r.boxes[a];
+            }
+
+            // Çiftler: i < j hesaplanır, ters yön fp/fn yer değiştirerek
+            double simSum = 0;
+            for (int a = 0; a < N; ++a) {
+                for (int b = a + 1; b < N; ++b) {
+                    const QVector<XYXY>& A = s.boxes[a];
+                    const QVector<XYXY>& B = s.boxes[b];
+                    if (A.isEmpty() && B.isEmpty()) { simSum += 1.0; continue; }
+                    const MatchCounts c = matchBoxes(job.mode, A, B, job.iouThr, &s.pairs);
+                    double iouSum = 0;
+                    for (const BoxMatch& m : std::as_const(s.pairs))
+                        if (m.a >= 0 && m.b >= 0 && A[m.a].cls == B[m.b].cls) iouSum += m.iou;
+                    PairStats& ab = local[size_t(a) * N + b];
+                    PairStats& ba = local[size_t(b) * N + a];
+                    ab.c += c;
+                    ab.iouSum += iouSum;
+                    MatchCounts rc = c;
+                    std::swap(rc.fp, rc.fn);
+                    ba.c += rc;
+                    ba.iouSum += iouSum;
+                    simSum += c.similarity();
+                }
+            }
+            r.disagreement = float(1.0 - simSum / (N * (N - 1) / 2));
+
+            // Konsensüs
+            fuse(s, job.iouThr);
+            s.out.clear();
+            for (const Cluster& c : s.clusters) {
+                if (c.votes < rep.minVotes) { ++r.contested; continue; }
+                s.out.push_back({c.cls, c.sx1 / c.votes, c.sy1 / c.votes, c.sx2 / c.votes, c.sy2 / c.votes});
+            }
+            r.consensus = int(s.out.size());
+            nCons      += r.consensus;
+            nContested += r.contested;
+            if (writeConsensus) {
+                QString err;
+                const QByteArray& text = s.ser.yolo(s.out.constData(), int(s.out.size()));
+                if (!LabelSerializer::writeFile(QDir(job.consensusDir).filePath(stem + ".txt"), text, &err)
+                    && errors.size() < 20)
+                    errors << err;
+            }
+
+            const int d = ++done;
+            if (progress && ((d & 1023) == 0 || d == n)) progress(d, n);
+        }
+        totalBoxes     += nBoxes;
+        consensusBoxes += nCons;
+        contested      += nContested;
+        QMutexLocker lk(&mergeMutex);
+        for (size_t k = 0; k < local.size(); ++k) {
+            rep.pairs[int(k)].c      += local[k].c;
+            rep.pairs[int(k)].iouSum += local[k].iouSum;
+        }
+        rep.errors += errors;
+    };
+
+    runParallel(pool, n, 64, work);
+
+    // 3) İnceleme sırası: anlaşmazlık azalan, eşitlikte kutu sayısı çok olan önce
+    rep.cancelled = cancel && cancel->load();
+    rep.ranked.reserve(n);
+    for (int i = 0; i < n; ++i) if (!results[i].stem.isEmpty()) rep.ranked.push_back(std::move(results[i]));
+    const auto total = [](const ImageScore& r){ int t = 0; for (int b : r.boxes) t += b; return t; };
+    std::stable_sort(rep.ranked.begin(), rep.ranked.end(), [&](const ImageScore& l, const ImageScore& r){
+        if (l.disagreement != r.disagreement) return l.disagreement > r.disagreement;
+        return total(l) > total(r);
+    });
+    rep.images            = int(rep.ranked.size());
+    rep.boxes             = totalBoxes;
+    rep.consensusBoxes    = consensusBoxes;
+    rep.contestedClusters = contested;
+    ImageSizeCache::instance().flush();
+    rep.elapsedMs = timer.elapsed();
+    return rep;
+}
+
+bool LabelAgreement::exportCsv(const Report& rep, const QString& path, QString* err)
+{
+    QByteArray csv = "stem,disagreement";
+    for (const QString& name : rep.names) csv += ',' + csvField(name).toUtf8();
+    csv += ",consensus,contested\n";
+    for (const ImageScore& r : rep.ranked) {
+        csv += csvField(r.stem).toUtf8() + ',';
+        LabelSerializer::appendFixed(csv, r.disagreement, 4);
+        for (int b : r.boxes) { csv += ','; LabelSerializer::appendInt(csv, b); }
+        csv += ','; LabelSerializer::appendInt(csv, r.consensus);
+        csv += ','; LabelSerializer::appendInt(csv, r.contested);
+        csv += '\n';
+    }
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    return LabelSerializer::writeFile(path, csv, err);
+}
+
+QString LabelAgreement::matrixText(const Report& rep)
+{
+    const int N = int(rep.names.size());
+    QStringList lines;
+    lines << "--- Uyum matrisi (benzerlik TP/(TP+MIS+FP+FN) | ortalama IoU) ---";
+    for (int a = 0; a < N; ++a) lines << QString("[%1] %2").arg(a).arg(rep.names[a]);
+    QString head(6, ' ');
+    for (int b = 0; b < N; ++b) head += QString("[%1]").arg(b).rightJustified(14);
+    lines << head;
+    for (int a = 0; a < N; ++a) {
+        QString row = QString("[%1]").arg(a).leftJustified(6);
+        for (int b = 0; b < N; ++b) {
+            if (a == b) { row += QString("-").rightJustified(14); continue; }
+            const PairStats& p = rep.pair(a, b);
+            row += QString("%1 | %2").arg(p.agreement(), 0, 'f', 3).arg(p.meanIou(), 0, 'f', 2).rightJustified(14);
+        }
+        lines << row;
+    }
+    return lines.join('\n');
+}
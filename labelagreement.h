@@ -0,0 +1,97 @@
+// labelagreement.h
+#pragma once
+
+#include "labelcompare.h"
+
+#include <QObject>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// ---------------------------
+// Çok annotator'lu uyum analizi (N etiket klasörü)
+//  - Her klasör bir kez listelenir; görsel başına N dosya bir kez okunur (görsel başına kutu önbelleği),
+//    tüm N·(N-1)/2 çift ve konsensüs aynı kutular üzerinden hesaplanır
+//  - Çift bazında LabelCompare eşleştirmesi (greedy / optimal) → uyum matrisi
+//  - Görsel başına anlaşmazlık = 1 - ortalama çift benzerliği; inceleme için azalan sırada
+//  - Konsensüs: kutu füzyonu (aynı sınıf, IoU >= eşik, annotator başına bir oy; koordinat ortalaması),
+//    en az minVotes oy alan kümeler YOLO olarak yazılır
+// ---------------------------
+class LabelAgreement : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr int kMaxAnnotators = 64;   // küme başına oy maskesi: quint64
+
+    struct Job {
+        QStringList dirs;                       // en az 2
+        QStringList names;                      // boş: klasör adları (train ise üst klasör)
+        QString     imagesRoot;                 // piksel biçimleri için görsel boyutu
+        double      iouThr   = 0.50;            // eşleştirme ve füzyon eşiği
+        MatchMode   mode     = MatchMode::Greedy;
+        int         minVotes = 0;               // 0: çoğunluk (oy·2 > N)
+        QString     consensusDir;               // boş değilse konsensüs etiketleri (YOLO) buraya
+    };
+
+    struct PairStats {
+        MatchCounts c;                          // a = satır annotator'ı, b = sütun
+        double      iouSum = 0;                 // TP çiftlerinin IoU toplamı
+        double agreement() const { return c.similarity(); }
+        double meanIou()   const { return c.tp > 0 ? iouSum / c.tp : 0.0; }
+    };
+
+    struct ImageScore {
+        QString      stem;
+        float        disagreement = 0;          // 0: herkes aynı, 1: hiçbir kutu uyuşmuyor
+        QVector<int> boxes;                     // annotator başına kutu sayısı
+        int          consensus = 0;             // yazılan konsensüs kutusu
+        int          contested = 0;             // oy yetmeyen küme
+    };
+
+    struct Report {
+        QStringList         dirs, names;
+        int                 images = 0;
+        qint64              boxes  = 0;
+        QVector<PairStats>  pairs;              // N×N satır-ana (simetrik; köşegen boş)
+        QVector<ImageScore> ranked;             // anlaşmazlığa göre azalan
+        qint64              consensusBoxes = 0, contestedClusters = 0;
+        int                 minVotes = 0;       // uygulanan (çoğunluk çözülmüş)
+        double              iouThr = 0.50;
+        MatchMode           mode = MatchMode::Greedy;
+        QString             consensusDir;
+        QStringList         errors;
+        qint64              elapsedMs = 0;
+        bool                cancelled = false;
+
+        const PairStats& pair(int i, int j) const { return pairs[i * int(names.size()) + j]; }
+    };
+
+    explicit LabelAgreement(QObject* parent=nullptr);
+    ~LabelAgreement() override;
+
+    bool start(const Job& job);                 // false: zaten çalışıyor
+    void cancel()          { m_runner.cancel(); }
+    bool isRunning() const { return m_runner.isRunning(); }
+
+    static Report analyze(const Job& job, const std::atomic_bool* cancel = nullptr,
+                          const std::function<void(int done, int total)>& progress = {},
+                          QThreadPool* pool = nullptr);
+
+    // İnceleme kuyruğu: stem,disagreement,<annotator kutu sayıları...>,consensus,contested
+    static bool    exportCsv(const Report& rep, const QString& path, QString* err=nullptr);
+    static QString matrixText(const Report& rep);   // log için uyum / ortalama IoU matrisi
+
+signals:
+    void progress(int done, int total);
+    void finished(const LabelAgreement::Report& report);
+
+private:
+    EngineRunner m_runner;
+};
+
+Q_DECLARE_METATYPE(LabelAgreement::Report)
@@ -0,0 +1,767 @@
+// labelcompare.cpp
+#include "labelcompare.h"
+#include "ioukernel.h"
+#include "imagesizecache.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <QSemaphore>
+#include <QThread>
+#include <QXmlStreamReader>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// ---------------------------
+// Bayt düzeyinde satır/token ayrıştırma (QString / regex yok; yerel ayardan bağımsız)
+// ---------------------------
+struct Tok { const char* p; const char* e; };
+
+constexpr int kMaxTok = 8;                      // sadece ilk 5 token kullanılır; sayım tam tutulur
+
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+
+// [b, e) satırını boşluklardan böl; toplam token sayısı döner, ilk kMaxTok tanesi t'ye
+int tokenize(const char* b, const char* e, Tok* t)
+{
+    int n = 0;
+    while (b < e) {
+        while (b < e && isSpace(*b)) ++b;
+        if (b == e) break;
+        const char* s = b;
+        while (b < e && !isSpace(*b)) ++b;
+        if (n < kMaxTok) t[n] = {s, b};
+        ++n;
+    }
+    return n;
+}
+
+// QString::toInt gibi: tüm token tamsayı olmalı
+bool tokInt(const Tok& t, int* v)
+{
+    const char* p = t.p;
+    if (p < t.e && *p == '+') ++p;
+    int x = 0;
+    const auto r = std::from_chars(p, t.e, x);
+    if (r.ec != std::errc() || r.ptr != t.e) { *v = 0; return false; }
+    *v = x;
+    return true;
+}
+
+// QString::toDouble gibi: tüm token sayı olmalı, değilse 0
+double tokDouble(const Tok& t, bool* ok = nullptr)
+{
+    const char* p = t.p;
+    if (p < t.e && *p == '+') ++p;
+    double x = 0;
+    const auto r = std::from_chars(p, t.e, x);
+    const bool good = (r.ec == std::errc() && r.ptr == t.e);
+    if (ok) *ok = good;
+    return good ? x : 0.0;
+}
+
+inline int tokIntOr0(const Tok& t) { int v; tokInt(t, &v); return v; }
+
+inline bool looksNormalized(double v) { return v >= 0.0 && v <= 1.0; }
+
+AnnFmt detectLine(const char* b, const char* e)
+{
+    Tok t[kMaxTok];
+    const int n = tokenize(b, e, t);
+    if (n == 0) return AnnFmt::UNKNOWN;
+
+    // YOLO: 5+ token ve ilk token integer sınıf
+    int c0;
+    if (tokInt(t[0], &c0) && n >= 5) return AnnFmt::YOLO;
+
+    // XY* varyantları: en az 4 sayı (sınıf başta/sonda olabilir)
+    int numCnt = 0;
+    for (int i = 0; i < std::min(n, kMaxTok); ++i) { bool ok; tokDouble(t[i], &ok); if (ok) ++numCnt; }
+    if (numCnt >= 4 && n >= 4) {
+        const double a = tokDouble(t[0]), b2 = tokDouble(t[1]), c = tokDouble(t[2]), d = tokDouble(t[3]);
+        const bool allNorm = looksNormalized(a) && looksNormalized(b2) && looksNormalized(c) && looksNormalized(d);
+        if (c > a && d > b2) return allNorm ? AnnFmt::XYXY_NORM : AnnFmt::XYXY_PIX;  // x2>x1, y2>y1
+        return allNorm ? AnnFmt::XYWH_NORM : AnnFmt::XYWH_PIX;                       // x,y,w,h
+    }
+    return AnnFmt::UNKNOWN;
+}
+
+// Satır satır gez: fn(b, e)
+template <typename Fn>
+void forEachLine(const QByteArray& data, Fn fn)
+{
+    const char* p   = data.constData();
+    const char* end = p + data.size();
+    while (p < end) {
+        const char* nl = static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+        const char* le = nl ? nl : end;
+        fn(p, le);
+        p = nl ? nl + 1 : end;
+    }
+}
+
+QByteArray readAll(const QString& path)
+{
+    QFile f(path);
+    return f.open(QIODevice::ReadOnly) ? f.readAll() : QByteArray();
+}
+
+void toSoA(const QVector<XYXY>& v, BoxesSoA& out)
+{
+    out.clear();
+    out.reserve(int(v.size()));
+    for (const XYXY& b : v) out.push(float(b.x1), float(b.y1), float(b.x2), float(b.y2));
+}
+
+// A × B IoU matrisi (satır-ana). Tamponlar thread başına tekrar kullanılır:
+// dönen işaretçi aynı thread'deki bir sonraki çağrıya kadar geçerli.
+const float* iouMatrixOf(const QVector<XYXY>& A, const QVector<XYXY>& B)
+{
+    thread_local BoxesSoA sa, sb;
+    thread_local std::vector<float> m;
+    toSoA(A, sa);
+    toSoA(B, sb);
+    m.resize(size_t(A.size()) * size_t(B.size()));
+    iouMatrix(sa, sb, m.data());
+    return m.data();
+}
+
+} // namespace
+
+// ---------------------------
+// Biçim tespit / okuma
+// ---------------------------
+AnnFmt detectFormatFromLine(const QString& line)
+{
+    const QByteArray u = line.toUtf8();
+    return detectLine(u.constData(), u.constData() + u.size());
+}
+
+AnnFmt detectFormatFromBytes(const QByteArray& data, bool isXml)
+{
+    if (isXml) return AnnFmt::VOC_XML;
+    AnnFmt fmt = AnnFmt::UNKNOWN;
+    bool found = false;
+    forEachLine(data, [&](const char* b, const char* e){
+        if (found) return;
+        Tok t[kMaxTok];
+        if (tokenize(b, e, t) == 0) return;
+        fmt = detectLine(b, e);
+        found = true;
+    });
+    return fmt;
+}
+
+QString normalizeImagesRoot(const QString& leImagesText)
+{
+    if (leImagesText.isEmpty()) return {};
+    QFileInfo fi(leImagesText);
+    if (fi.isFile()) return fi.absolutePath();
+    return fi.absoluteFilePath();
+}
+
+QSize findImageSizeForStem(const QString& stem, const QString& imagesRootDir)
+{
+    return ImageSizeCache::instance().sizeForStem(imagesRootDir, stem);
+}
+
+// classes.txt → ad/indeks (annotator ile aynı kurallar: boş ve '#' satırlar atlanır)
+ClassIndex loadClassIndex(const QString& labelDir)
+{
+    if (labelDir.isEmpty()) return {};
+    const QDir d(labelDir);
+    for (const QString& p : {d.filePath("classes.txt"), d.filePath("../classes.txt")}) {
+        QFile f(p);
+        if (!f.open(QIODevice::ReadOnly)) continue;
+        ClassIndex m;
+        int i = 0;
+        for (const QByteArray& raw : f.readAll().split('\n')) {
+            const QString line = QString::fromUtf8(raw).trimmed();
+            if (line.isEmpty() || line.startsWith('#')) continue;
+            m.insert(line, i++);
+        }
+        return m;
+    }
+    return {};
+}
+
+// VOC XML → XYXY (0..1). Tek geçiş (QXmlStreamReader); <part> altındaki kutular
+// (VOC person layout) nesneye karışmaz. <name> sınıf haritasından, yoksa tamsayı addan; değilse -1.
+bool parseVOCxml(const QByteArray& bytes, VOCDoc* doc, QString* err)
+{
+    VOCObject cur;
+    double W = 0, H = 0;
+    bool inObj = false, inBox = false;
+    int  partDepth = 0;
+
+    QXmlStreamReader xml(bytes);
+    while (!xml.atEnd()) {
+        const QXmlStreamReader::TokenType tok = xml.readNext();
+        if (tok == QXmlStreamReader::StartElement) {
+            const auto tag = xml.name();
+            if (partDepth) { if (tag == u"part") ++partDepth; continue; }
+            if (tag == u"object")      { inObj = true; cur = VOCObject{}; }
+            else if (!inObj) {
+                if      (tag == u"width")    W = xml.readElementText().trimmed().toDouble();
+                else if (tag == u"height")   H = xml.readElementText().trimmed().toDouble();
+                else if (tag == u"filename") doc->fileName = xml.readElementText().trimmed();
+            }
+            else if (tag == u"part")   partDepth = 1;
+            else if (tag == u"name")   cur.name = xml.readElementText().trimmed();
+            else if (tag == u"bndbox") inBox = true;
+            else if (inBox) {
+                double* v = tag == u"xmin" ? &cur.x1 : tag == u"ymin" ? &cur.y1
+                          : tag == u"xmax" ? &cur.x2 : tag == u"ymax" ? &cur.y2 : nullptr;
+                if (v) *v = xml.readElementText().trimmed().toDouble();
+            }
+        } else if (tok == QXmlStreamReader::EndElement) {
+            const auto tag = xml.name();
+            if (partDepth) { if (tag == u"part") --partDepth; continue; }
+            if      (tag == u"bndbox") inBox = false;
+            else if (tag == u"object") { inObj = false; doc->objects.push_back(cur); }
+        }
+    }
+    if (W > 0 && H > 0) doc->size = QSize(qRound(W), qRound(H));
+    if (xml.hasError()) {
+        if (err) *err = "XML: " + xml.errorString();
+        return false;
+    }
+    return true;
+}
+
+QVector<XYXY> parseVOCxmlNorm(const QByteArray& bytes, const ClassIndex* classes)
+{
+    QVector<XYXY> out;
+    VOCDoc doc;
+    parseVOCxml(bytes, &doc);                           // hatalı dosyada okunabilen kısım kullanılır
+    if (doc.size.isEmpty()) return out;
+
+    auto classOf = [classes](const QString& name){
+        if (classes) {
+            const auto it = classes->constFind(name);
+            if (it != classes->cend()) return it.value();
+        }
+        bool ok = false;
+        const int v = name.toInt(&ok);
+        return ok ? v : -1;
+    };
+
+    const double W = doc.size.width(), H = doc.size.height();
+    out.reserve(int(doc.objects.size()));
+    for (const VOCObject& o : std::as_const(doc.objects)) {
+        if (!(o.x2 > o.x1 && o.y2 > o.y1)) continue;
+        out.push_back(XYXY{classOf(o.name), o.x1 / W, o.y1 / H, o.x2 / W, o.y2 / H});
+    }
+    return out;
+}
+
+QVector<XYXY> readVOCxmlNorm(const QString& xmlPath, const ClassIndex* classes)
+{
+    return parseVOCxmlNorm(readAll(xmlPath), classes);
+}
+
+// TXT → XYXY (0..1): YOLO / XYXY / XYWH (norm veya piksel)
+QVector<XYXY> parseGenericNorm(const QByteArray& data, AnnFmt fmt, const QSize& imgSzIfNeeded,
+                               const ClassIndex* classes)
+{
+    QVector<XYXY> out;
+    if (fmt == AnnFmt::VOC_XML) return parseVOCxmlNorm(data, classes);
+
+    float score = 1.0f;
+    auto pushXYXY = [&](int cls, double x1,double y1,double x2,double y2){
+        XYXY b{cls,
+               std::max(0.0, std::min(1.0, x1)),
+               std::max(0.0, std::min(1.0, y1)),
+               std::max(0.0, std::min(1.0, x2)),
+               std::max(0.0, std::min(1.0, y2)),
+               score};
+        if (b.x2>b.x1 && b.y2>b.y1) out.push_back(b);
+    };
+
+    forEachLine(data, [&](const char* lb, const char* le){
+        Tok t[kMaxTok];
+        const int n = tokenize(lb, le, t);
+        if (n == 0) return;
+        // Tam 6 token: tahmin dosyası, sondaki değer güven skoru ("cls ... conf")
+        score = (n == 6) ? float(tokDouble(t[5])) : 1.0f;
+
+        if (fmt == AnnFmt::YOLO) {
+            if (n < 5) return;
+            const int cls = tokIntOr0(t[0]);
+            const double cx=tokDouble(t[1]), cy=tokDouble(t[2]), w=tokDouble(t[3]), h=tokDouble(t[4]);
+            pushXYXY(cls, cx-w/2.0, cy-h/2.0, cx+w/2.0, cy+h/2.0);
+        } else if (fmt == AnnFmt::XYXY_NORM || fmt == AnnFmt::XYXY_PIX
+                   || fmt == AnnFmt::XYWH_NORM || fmt == AnnFmt::XYWH_PIX) {
+            if (n < 4) return;
+
+            // sınıf nerede? [cls a b c d] ya da [a b c d cls]
+            int cls = 0, c0;
+            double a, b, c, d;
+            if (n >= 5 && tokInt(t[0], &c0)) {
+                cls = c0;
+                a = tokDouble(t[1]); b = tokDouble(t[2]); c = tokDouble(t[3]); d = tokDouble(t[4]);
+            } else {
+                a = tokDouble(t[0]); b = tokDouble(t[1]); c = tokDouble(t[2]); d = tokDouble(t[3]);
+                if (n >= 5) cls = tokIntOr0(t[4]);
+            }
+
+            const bool pix = (fmt == AnnFmt::XYXY_PIX || fmt == AnnFmt::XYWH_PIX);
+            if (pix) {
+                if (imgSzIfNeeded.isEmpty()) return;
+                a/=imgSzIfNeeded.width();  c/=imgSzIfNeeded.width();
+                b/=imgSzIfNeeded.height(); d/=imgSzIfNeeded.height();
+            }
+            // XYWH'yi sol-üst köşe kabul edip XYXY üret
+            if (fmt == AnnFmt::XYXY_NORM || fmt == AnnFmt::XYXY_PIX) pushXYXY(cls, a, b, c, d);
+            else                                                      pushXYXY(cls, a, b, a + c, b + d);
+        }
+    });
+    return out;
+}
+
+QVector<XYXY> readGenericNorm(const QString& annPath, AnnFmt fmt, const QSize& imgSzIfNeeded,
+                              const ClassIndex* classes)
+{
+    if (annPath.isEmpty()) return {};
+    return parseGenericNorm(readAll(annPath), fmt, imgSzIfNeeded, classes);
+}
+
+// Klasördeki etiketler: stem → yol (.txt varsa .xml'e tercih edilir; classes.txt hariç)
+QHash<QString, QString> listLabelFiles(const QString& dir, bool recursive)
+{
+    QHash<QString, QString> m;
+    if (dir.isEmpty()) return m;
+    QDirIterator it(dir, QStringList{"*.txt", "*.xml"}, QDir::Files,
+                    recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        const QString p = it.next();
+        const QFileInfo fi = it.fileInfo();
+        if (fi.fileName() == QLatin1String("classes.txt")) continue;
+        const QString stem = fi.completeBaseName();
+        auto f = m.find(stem);
+        if (f == m.end()) m.insert(stem, p);
+        else if (p.endsWith(".txt", Qt::CaseInsensitive)) *f = p;
+    }
+    return m;
+}
+
+// IoU (XYXY norm)
+double iouXYXY(const XYXY& a, const XYXY& b)
+{
+    const double ix1 = std::max(a.x1,b.x1), iy1 = std::max(a.y1,b.y1);
+    const double ix2 = std::min(a.x2,b.x2), iy2 = std::min(a.y2,b.y2);
+    const double iw = std::max(0.0, ix2-ix1), ih = std::max(0.0, iy2-iy1);
+    const double inter = iw*ih;
+    const double areaA = std::max(0.0, a.x2-a.x1) * std::max(0.0, a.y2-a.y1);
+    const double areaB = std::max(0.0, b.x2-b.x1) * std::max(0.0, b.y2-b.y1);
+    const double uni = areaA + areaB - inter;
+    return uni>0 ? inter/uni : 0.0;
+}
+
+MatchCounts matchGreedy(const QVector<XYXY>& A, const QVector<XYXY>& B, double thr, QVector<BoxMatch>* pairs)
+{
+    MatchCounts c;
+    if (pairs) pairs->resize(0);
+    const int nB = int(B.size());
+    const float* M = iouMatrixOf(A, B);
+    const float thrF = float(thr);
+    QVector<bool> usedB(nB, false);
+    for (int i = 0; i < A.size(); ++i) {
+        const float* row = M + size_t(i) * nB;
+        int best = -1; float bestIoU = -1.0f;
+        for (int j = 0; j < nB; ++j) {
+            if (usedB[j]) continue;
+            if (row[j] > bestIoU) { bestIoU = row[j]; best = j; }
+        }
+        if (best >= 0 && bestIoU >= thrF) {
+            usedB[best] = true;
+            if (A[i].cls == B[best].cls) ++c.tp; else ++c.mis;
+            if (pairs) pairs->push_back({i, best, bestIoU});
+        } else {
+            ++c.fp;
+            if (pairs) pairs->push_back({i, -1, std::max(0.0f, bestIoU)});
+        }
+    }
+    for (int j = 0; j < B.size(); ++j) {
+        if (usedB[j]) continue;
+        ++c.fn;
+        if (pairs) pairs->push_back({-1, j, 0.0});
+    }
+    return c;
+}
+
+namespace {
+
+// ---------------------------
+// Optimal atama yardımcıları
+// ---------------------------
+struct Edge { int a, b; double iou; };
+
+// Dikdörtgen atama (r <= c), potansiyelli Hungarian (JV tarzı en kısa artırma yolu), O(r²·c)
+// cost: r x c satır-ana; rowToCol[i] = atanan sütun
+void solveAssignment(const std::vector<double>& cost, int r, int c, std::vector<int>& rowToCol)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    std::vector<double> u(r + 1, 0.0), v(c + 1, 0.0), minv(c + 1);
+    std::vector<int>    p(c + 1, 0), way(c + 1, 0);
+    std::vector<char>   used(c + 1);
+    for (int i = 1; i <= r; ++i) {
+        p[0] = i;
+        int j0 = 0;
+        std::fill(minv.begin(), minv.end(), INF);
+        std::fill(used.begin(), used.end(), 0);
+        do {
+            used[j0] = 1;
+            const int i0 = p[j0];
+            const double* row = cost.data() + size_t(i0 - 1) * c;
+            double delta = INF;
+            int    j1    = 0;
+            for (int j = 1; j <= c; ++j) {
+                if (used[j]) continue;
+                const double cur = row[j - 1] - u[i0] - v[j];
+                if (cur < minv[j]) { minv[j] = cur; way[j] = j0; }
+                if (minv[j] < delta) { delta = minv[j]; j1 = j; }
+            }
+            for (int j = 0; j <= c; ++j) {
+                if (used[j]) { u[p[j]] += delta; v[j] -= delta; }
+                else         minv[j] -= delta;
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+        do { const int j1 = way[j0]; p[j0] = p[j1]; j0 = j1; } while (j0);
+    }
+    rowToCol.assign(r, -1);
+    for (int j = 1; j <= c; ++j) if (p[j]) rowToCol[p[j] - 1] = j - 1;
+}
+
+int findRoot(std::vector<int>& parent, int x)
+{
+    while (parent[x] != x) { parent[x] = parent[parent[x]]; x = parent[x]; }
+    return x;
+}
+
+// Kenarlar (IoU >= eşik) üzerinde önce en çok eşleşme, eşitlikte en yüksek toplam IoU.
+// Kenarsız kutular hiç matrise girmez; graf bağlı bileşenlere bölünüp her biri ayrı çözülür
+// (kalabalık sahnelerde bile bileşenler küçük kalır).
+void assignEdges(const std::vector<Edge>& edges, int nA, int nB,
+                 std::vector<int>& aToB, std::vector<double>& aIoU)
+{
+    if (edges.empty()) return;
+    std::vector<int> parent(nA + nB);
+    for (int i = 0; i < nA + nB; ++i) parent[i] = i;
+    for (const Edge& e : edges) {
+        const int ra = findRoot(parent, e.a), rb = findRoot(parent, nA + e.b);
+        if (ra != rb) parent[ra] = rb;
+    }
+
+    // Bileşen → kenar listesi
+    QHash<int, std::vector<int>> comps;
+    for (int k = 0; k < int(edges.size()); ++k) comps[findRoot(parent, edges[k].a)].push_back(k);
+
+    std::vector<double> cost;
+    std::vector<int>    rowToCol, rows, cols;
+    QHash<int, int>     rowOf, colOf;
+    for (auto it = comps.cbegin(); it != comps.cend(); ++it) {
+        const std::vector<int>& ek = it.value();
+        if (ek.size() == 1) {                       // tek kenar: doğrudan
+            const Edge& e = edges[ek.front()];
+            aToB[e.a] = e.b; aIoU[e.a] = e.iou;
+            continue;
+        }
+        rows.clear(); cols.clear(); rowOf.clear(); colOf.clear();
+        for (int k : ek) {
+            const Edge& e = edges[k];
+            if (!rowOf.contains(e.a)) { rowOf.insert(e.a, int(rows.size())); rows.push_back(e.a); }
+            if (!colOf.contains(e.b)) { colOf.insert(e.b, int(cols.size())); cols.push_back(e.b); }
+        }
+        // Satır sayısı <= sütun sayısı olacak şekilde (gerekirse transpoze)
+        const bool tr = rows.size() > cols.size();
+        const int  r  = int(tr ? cols.size() : rows.size());
+        const int  c  = int(tr ? rows.size() : cols.size());
+        // Kenarsız hücre maliyeti, tüm kenar maliyetlerinin toplamından (<= r) büyük → önce kardinalite
+        const double forbidden = r + 1.0;
+        cost.assign(size_t(r) * c, forbidden);
+        for (int k : ek) {
+            const Edge& e = edges[k];
+            const int ra = rowOf.value(e.a), cb = colOf.value(e.b);
+            cost[tr ? size_t(cb) * c + ra : size_t(ra) * c + cb] = 1.0 - e.iou;
+        }
+        solveAssignment(cost, r, c, rowToCol);
+        for (int i = 0; i < r; ++i) {
+            const int j = rowToCol[i];
+            if (j < 0) continue;
+            const double cc = cost[size_t(i) * c + j];
+            if (cc >= forbidden) continue;          // kenar değil: eşleşme yok
+            const int a = tr ? rows[j] : rows[i];
+            const int b = tr ? cols[i] : cols[j];
+            aToB[a] = b; aIoU[a] = 1.0 - cc;
+        }
+    }
+}
+
+} // namespace
+
+MatchCounts matchOptimal(const QVector<XYXY>& A, const QVector<XYXY>& B, double thr, QVector<BoxMatch>* pairs)
+{
+    MatchCounts c;
+    if (pairs) pairs->resize(0);
+    const int nA = int(A.size()), nB = int(B.size());
+    const float t = std::max(float(thr), 1e-9f);    // IoU=0 çiftleri hiçbir zaman eşleşmez
+
+    // Aday kenarlar: tek SIMD IoU matrisinden eşiği geçen çiftler
+    const float* M = iouMatrixOf(A, B);
+    std::vector<Edge>   all;
+    std::vector<double> bestIoU(nA, 0.0);
+    for (int i = 0; i < nA; ++i) {
+        const float* row = M + size_t(i) * nB;
+        for (int j = 0; j < nB; ++j) {
+            const float d = row[j];
+            if (d > bestIoU[i]) bestIoU[i] = d;
+            if (d >= t) all.push_back({i, j, d});
+        }
+    }
+
+    // 1) Sınıf içi: TP sayısını en çoklar
+    std::vector<int>    aToB(nA, -1);
+    std::vector<double> aIoU(nA, 0.0);
+    std::vector<Edge>   part;
+    part.reserve(all.size());
+    for (const Edge& e : all) if (A[e.a].cls == B[e.b].cls) part.push_back(e);
+    assignEdges(part, nA, nB, aToB, aIoU);
+
+    // 2) Kalanlar arasında sınıflar arası (mis)
+    std::vector<char> usedB(nB, 0);
+    for (int i = 0; i < nA; ++i) if (aToB[i] >= 0) usedB[aToB[i]] = 1;
+    part.clear();
+    for (const Edge& e : all) if (aToB[e.a] < 0 && !usedB[e.b]) part.push_back(e);
+    assignEdges(part, nA, nB, aToB, aIoU);
+
+    std::fill(usedB.begin(), usedB.end(), 0);
+    for (int i = 0; i < nA; ++i) {
+        const int b = aToB[i];
+        if (b >= 0) {
+            usedB[b] = 1;
+            if (A[i].cls == B[b].cls) ++c.tp; else ++c.mis;
+            if (pairs) pairs->push_back({i, b, aIoU[i]});
+        } else {
+            ++c.fp;
+            if (pairs) pairs->push_back({i, -1, bestIoU[i]});
+        }
+    }
+    for (int j = 0; j < nB; ++j) {
+        if (usedB[j]) continue;
+        ++c.fn;
+        if (pairs) pairs->push_back({-1, j, 0.0});
+    }
+    return c;
+}
+
+MatchCounts matchPerClass(const QVector<XYXY>& A, const QVector<XYXY>& B, QVector<BoxMatch>* pairs)
+{
+    MatchCounts c;
+    if (pairs) pairs->resize(0);
+    const int nA = int(A.size()), nB = int(B.size());
+    const float* M = iouMatrixOf(A, B);
+
+    // Sınıf → kutu indeksleri (sınıf sırası; sınıf içinde dosya sırası korunur)
+    QMap<int, QPair<QVector<int>, QVector<int>>> byCls;
+    for (int i = 0; i < nA; ++i) byCls[A[i].cls].first  << i;
+    for (int j = 0; j < nB; ++j) byCls[B[j].cls].second << j;
+
+    std::vector<Edge> cand;
+    std::vector<char> usedA(nA, 0), usedB(nB, 0);
+    for (auto it = byCls.cbegin(); it != byCls.cend(); ++it) {
+        const QVector<int>& ia = it->first;
+        const QVector<int>& ib = it->second;
+        cand.clear();
+        for (int i : ia) {
+            const float* row = M + size_t(i) * nB;
+            for (int j : ib) cand.push_back({i, j, row[j]});
+        }
+        std::stable_sort(cand.begin(), cand.end(), [](const Edge& p, const Edge& q){ return p.iou > q.iou; });
+        for (const Edge& e : cand) {
+            if (usedA[e.a] || usedB[e.b]) continue;
+            usedA[e.a] = usedB[e.b] = 1;
+            ++c.tp;
+            if (pairs) pairs->push_back({e.a, e.b, iouXYXY(A[e.a], B[e.b])});
+        }
+        for (int i : ia) if (!usedA[i]) { ++c.fp; if (pairs) pairs->push_back({i, -1, 0.0}); }
+        for (int j : ib) if (!usedB[j]) { ++c.fn; if (pairs) pairs->push_back({-1, j, 0.0}); }
+    }
+    return c;
+}
+
+// ---------------------------
+// Motorlar için ortak
+// ---------------------------
+QVector<XYXY> readLabelBoxes(const QString& path, const ClassIndex* classes,
+                             const std::function<QSize()>& imgSize, AnnFmt fixed, AnnFmt* fmtOut)
+{
+    if (path.isEmpty()) return {};
+    const QByteArray data = readAll(path);
+    const bool xml = path.endsWith(".xml", Qt::CaseInsensitive);
+    const AnnFmt fmt = (xml || fixed == AnnFmt::UNKNOWN) ? detectFormatFromBytes(data, xml) : fixed;
+    if (fmtOut) *fmtOut = fmt;
+    QSize sz;
+    if ((fmt == AnnFmt::XYXY_PIX || fmt == AnnFmt::XYWH_PIX) && imgSize) sz = imgSize();
+    return parseGenericNorm(data, fmt, sz, classes);
+}
+
+QString csvField(const QString& s)
+{
+    QString q = s;
+    q.replace('"', "\"\"");
+    return '"' + q + '"';
+}
+
+void runParallel(QThreadPool* pool, int items, int minPerWorker, const std::function<void()>& fn, int threads)
+{
+    QThreadPool localPool;
+    QThreadPool* p = pool ? pool : &localPool;
+    const int want    = threads > 0 ? threads : QThread::idealThreadCount();
+    const int workers = std::clamp(want, 1, std::max(1, items / std::max(1, minPerWorker)));
+    QSemaphore finished;
+    for (int i = 1; i < workers; ++i) p->start([&]{ fn(); finished.release(); });
+    fn();                                               // koordinatör de pay alır
+    finished.acquire(workers - 1);
+}
+
+// ---------------------------
+// LabelCompare
+// ---------------------------
+LabelCompare::LabelCompare(QObject* parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<LabelCompare::Report>("LabelCompare::Report");
+}
+
+LabelCompare::~LabelCompare()
+{
+    m_runner.stop();
+}
+
+bool LabelCompare::start(const Job& job)
+{
+    return m_runner.start([this, job](const std::atomic_bool* cancel, QThreadPool* pool){
+        return compare(job, cancel, [this](int done, int total){ emit progress(done, total); }, pool);
+    }, [this](const Report& rep){ emit finished(rep); });
+}
+
+LabelCompare::Report LabelCompare::compare(const Job& job, const std::atomic_bool* cancel,
+                                           const std::function<void(int, int)>& progress, QThreadPool* pool)
+{
+    QElapsedTimer timer;
+    timer.start();
+    Report rep;
+    rep.iouThr   = job.iouThr;
+    rep.mode     = job.mode;
+    rep.oursDir  = job.oursDir;
+    rep.otherDir = job.otherDir;
+
+    // 1) Her klasör bir kez listelenir
+    const QHash<QString, QString> A = listLabelFiles(job.oursDir, job.recursive);
+    const QHash<QString, QString> B = listLabelFiles(job.otherDir, job.recursive);
+
+    // VOC adları → sınıf: her tarafın classes.txt'i; biri yoksa diğerininki
+    ClassIndex clsA = loadClassIndex(job.oursDir), clsB = loadClassIndex(job.otherDir);
+    if (clsA.isEmpty()) clsA = clsB;
+    if (clsB.isEmpty()) clsB = clsA;
+
+    QStringList stems;
+    if (!job.onlyStems.isEmpty()) {
+        stems = job.onlyStems;
+    } else {
+        stems.reserve(A.size() + B.size());
+        for (auto it = A.cbegin(); it != A.cend(); ++it) stems << it.key();
+        for (auto it = B.cbegin(); it != B.cend(); ++it) if (!A.contains(it.key())) stems << it.key();
+    }
+    stems.sort();
+    stems.removeDuplicates();
+
+    // 2) Stem'ler paylaşılan sayaçla dağıtılır; sonuçlar indeksine yazılır (kilitsiz)
+    const int n = int(stems.size());
+    QVector<ImageResult> results(n);
+    QVector<char>        present(n, 0);
+    ImageResult* outRes  = results.data();
+    char*        outHave = present.data();
+    std::atomic_int next{0}, done{0};
+    QMutex mergeMutex;
+
+    const auto work = [&]{
+        QMap<int, ClassStats> local;
+        QVector<BoxMatch> pairs;
+        for (int i; (i = next.fetch_add(1)) < n; ) {
+            if (cancel && cancel->load()) break;
+            const QString& s  = stems[i];
+            const QString  pa = A.value(s), pb = B.value(s);
+            if (!pa.isEmpty() || !pb.isEmpty()) {
+                outHave[i] = 1;
+                ImageResult& r = outRes[i];
+                r.stem = s;
+
+                // Biçim: .xml → VOC; .txt → Job'daki biçim ya da (UNKNOWN) içerikten tespit
+                const auto imgSize = [&]{ return findImageSizeForStem(s, job.imagesRoot); };
+                QVector<XYXY> va = readLabelBoxes(pa, &clsA, imgSize, job.oursFmt,  &r.fmtA);
+                QVector<XYXY> vb = readLabelBoxes(pb, &clsB, imgSize, job.otherFmt, &r.fmtB);
+                r.ours  = int(va.size());
+                r.other = int(vb.size());
+
+                if (!va.isEmpty() || !vb.isEmpty()) {
+                    r.c = matchBoxes(job.mode, va, vb, job.iouThr, &pairs);
+                    if (job.mode == MatchMode::Optimal) r.greedy = matchGreedy(va, vb, job.iouThr);
+                    for (const BoxMatch& m : std::as_const(pairs)) {
+                        if (m.a >= 0 && m.b >= 0) {
+                            MatchCounts& cs = local[va[m.a].cls].c;
+                            if (va[m.a].cls == vb[m.b].cls) ++cs.tp; else ++cs.mis;
+                        } else if (m.a >= 0) {
+                            ++local[va[m.a].cls].c.fp;
+                        } else {
+                            ++local[vb[m.b].cls].c.fn;
+                        }
+                    }
+                }
+                if (job.keepBoxes && (!job.keepDiffOnly || r.c.mis || r.c.fp || r.c.fn)) {
+                    if (r.ours || r.other) r.pairs = pairs;     // ikisi de boşsa pairs önceki görselden kalır
+                    r.a     = std::move(va);
+                    r.b     = std::move(vb);
+                }
+            }
+            const int d = ++done;
+            if (progress && ((d & 1023) == 0 || d == n)) progress(d, n);
+        }
+        QMutexLocker lk(&mergeMutex);
+        for (auto it = local.cbegin(); it != local.cend(); ++it) rep.perClass[it.key()].c += it->c;
+    };
+
+    runParallel(pool, n, 64, work, job.threads);
+
+    // 3) Birleştir (stem sırası korunur)
+    rep.images.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        if (!present[i]) continue;
+        ++rep.files;
+        const ImageResult& r = results[i];
+        rep.total += r.c;
+        if (rep.mode == MatchMode::Optimal) {
+            rep.totalGreedy += r.greedy;
+            if (r.greedy.tp != r.c.tp || r.greedy.mis != r.c.mis || r.greedy.fp != r.c.fp)
+                ++rep.changedImages;
+        }
+        rep.images.push_back(std::move(results[i]));
+    }
+    rep.cancelled = cancel && cancel->load();
+    ImageSizeCache::instance().flush();
+    rep.elapsedMs = timer.elapsed();
+    return rep;
+}
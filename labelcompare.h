@@ -0,0 +1,225 @@
+// labelcompare.h
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QMetaType>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// ---------------------------
+// Etiket okuma (karşılaştırma için ortak): her şey normalize XYXY'ye (0..1)
+// ---------------------------
+enum class AnnFmt { YOLO, XYXY_NORM, XYXY_PIX, XYWH_NORM, XYWH_PIX, VOC_XML, UNKNOWN };
+
+struct XYXY { int cls; double x1,y1,x2,y2; float score = 1.0f; };   // score: tahminlerde güven
+
+// İlk dolu satırdan biçim tahmini (YOLO / XYXY / XYWH, normalize ya da piksel)
+AnnFmt  detectFormatFromLine(const QString& line);
+// Dosyanın biçimi: .xml → VOC, değilse ilk dolu satır
+AnnFmt  detectFormatFromBytes(const QByteArray& data, bool isXml);
+// Görsel kök klasörü (dosya verilirse klasörü)
+QString normalizeImagesRoot(const QString& leImagesText);
+QSize   findImageSizeForStem(const QString& stem, const QString& imagesRootDir);   // ImageSizeCache üzerinden
+
+// Klasördeki etiketler: stem → yol (.txt varsa .xml'e tercih edilir; classes.txt hariç)
+QHash<QString, QString> listLabelFiles(const QString& dir, bool recursive=false);
+
+// VOC <name> → sınıf indeksi (classes.txt sırası)
+using ClassIndex = QHash<QString, int>;
+// labelDir/classes.txt, yoksa üst klasördeki; hiçbiri yoksa boş
+ClassIndex loadClassIndex(const QString& labelDir);
+
+// VOC XML, piksel uzayında ham okuma — tek VOC ayrıştırıcısı (parseVOCxmlNorm, LabelConverter,
+// AnnotationStore bunun üstünde). Nesne </object>'te eklenir, <part> alt kutuları atlanır.
+// <size> yoksa size boş kalır. false: XML hatası (o ana kadar okunanlar *doc'ta kalır)
+struct VOCObject { QString name; double x1 = 0, y1 = 0, x2 = 0, y2 = 0; };
+struct VOCDoc    { QString fileName; QSize size; QVector<VOCObject> objects; };
+bool parseVOCxml(const QByteArray& xml, VOCDoc* doc, QString* err=nullptr);
+
+// VOC XML → XYXY (0..1). Ad haritada yoksa tamsayı ad kullanılır, o da değilse cls = -1.
+QVector<XYXY> readVOCxmlNorm(const QString& xmlPath, const ClassIndex* classes=nullptr);
+QVector<XYXY> parseVOCxmlNorm(const QByteArray& xml, const ClassIndex* classes=nullptr);
+// TXT → XYXY (0..1): YOLO / XYXY / XYWH (piksel biçimlerde imgSzIfNeeded gerekir)
+// 6 token'lı satırlarda son değer skor olarak okunur (YOLO save_conf çıktısı)
+QVector<XYXY> readGenericNorm(const QString& annPath, AnnFmt fmt, const QSize& imgSzIfNeeded,
+                              const ClassIndex* classes=nullptr);
+QVector<XYXY> parseGenericNorm(const QByteArray& data, AnnFmt fmt, const QSize& imgSzIfNeeded,
+                               const ClassIndex* classes=nullptr);
+
+double iouXYXY(const XYXY& a, const XYXY& b);   // tek çift; çoklu eşleştirmede ioukernel.h matrisi
+
+// Greedy eşleştirme (bizim sırayla; her kutu için en yüksek IoU'lu boştaki karşı kutu)
+struct MatchCounts {
+    int tp = 0, mis = 0, fp = 0, fn = 0;       // mis: IoU tuttu, sınıf tutmadı
+    MatchCounts& operator+=(const MatchCounts& o) { tp += o.tp; mis += o.mis; fp += o.fp; fn += o.fn; return *this; }
+    double similarity() const { const int d = tp + mis + fp + fn; return d > 0 ? double(tp) / d : 1.0; }
+};
+struct BoxMatch {
+    int    a = -1, b = -1;                     // -1: karşılığı yok
+    double iou = 0;
+};
+MatchCounts matchGreedy(const QVector<XYXY>& a, const QVector<XYXY>& b, double iouThr,
+                        QVector<BoxMatch>* pairs=nullptr);
+
+// Optimal atama (sıradan bağımsız): önce sınıf içi en çok TP, kalanlar arasında en çok mis;
+// eşitlikte toplam IoU en yüksek. IoU < eşik çiftleri baştan elenir, örtüşme grafiği
+// bileşenlerine bölünüp her biri Hungarian ile çözülür. pairs biçimi matchGreedy ile aynı.
+MatchCounts matchOptimal(const QVector<XYXY>& a, const QVector<XYXY>& b, double iouThr,
+                         QVector<BoxMatch>* pairs=nullptr);
+
+// Sınıf bazlı, eşiksiz greedy (python/compare_labels.py ile aynı): her sınıfta aynı sınıftan tüm çiftler
+// IoU'ya göre azalan (kararlı) sırada eşleşir, IoU 0 bile; mis hiç oluşmaz. pairs sınıf sırasıyla:
+// her sınıfın eşleşmeleri (IoU double, betikle aynı değer), sonra eşsiz A, sonra eşsiz B.
+MatchCounts matchPerClass(const QVector<XYXY>& a, const QVector<XYXY>& b, QVector<BoxMatch>* pairs=nullptr);
+
+enum class MatchMode { Greedy, Optimal, PerClass };     // değerler inceleme kuyruğu dosyasında saklanır
+
+inline const char* matchModeName(MatchMode mode)
+{
+    return mode == MatchMode::Optimal ? "optimal" : mode == MatchMode::PerClass ? "per-class" : "greedy";
+}
+
+inline MatchCounts matchBoxes(MatchMode mode, const QVector<XYXY>& a, const QVector<XYXY>& b,
+                              double iouThr, QVector<BoxMatch>* pairs=nullptr)
+{
+    switch (mode) {
+    case MatchMode::Optimal:  return matchOptimal(a, b, iouThr, pairs);
+    case MatchMode::PerClass: return matchPerClass(a, b, pairs);          // iouThr kullanılmaz
+    default:                  return matchGreedy(a, b, iouThr, pairs);
+    }
+}
+
+// ---------------------------
+// Veri seti motorları için ortak parçalar (LabelCompare / DetectionEval / LabelAgreement)
+// ---------------------------
+// Etiket dosyası → XYXY (0..1), tek okuma. .xml her zaman VOC; .txt için fixed, UNKNOWN ise içerikten
+// tespit. imgSize yalnız piksel biçimlerde çağrılır. fmtOut: kullanılan biçim
+QVector<XYXY> readLabelBoxes(const QString& path, const ClassIndex* classes,
+                             const std::function<QSize()>& imgSize = {},
+                             AnnFmt fixed = AnnFmt::UNKNOWN, AnnFmt* fmtOut = nullptr);
+
+QString csvField(const QString& s);             // çift tırnaklı, içteki " ikilenir
+
+// Koordinatörlü paralel döngü: fn çağıran thread'de bir kez, havuzda workers-1 kez çalışır
+// (workers: threads (<= 0: idealThreadCount), en çok items / minPerWorker, en az 1). Çağıran aynı
+// havuzun worker'ı olabilir (waitForDone kendini beklerdi) → bitişler semaforla. pool null: geçici havuz.
+void runParallel(QThreadPool* pool, int items, int minPerWorker, const std::function<void()>& fn, int threads = 0);
+
+// Arka plan motoru iskeleti: tek iş, iş başına iptal bayrağı, koordinatör için +1 thread'li havuz.
+// Sahibi kendi yıkıcısında stop() çağırır (sinyaller yıkılmış alt sınıftan yayılmasın).
+class EngineRunner
+{
+public:
+    EngineRunner()  { m_pool.setMaxThreadCount(QThread::idealThreadCount() + 1); }   // +1: koordinatör
+    ~EngineRunner() { stop(); }
+
+    // run(cancel, pool) havuzda raporu üretir; isRunning() düştükten sonra publish(rapor).
+    // false: zaten çalışıyor
+    template <typename Run, typename Publish>
+    bool start(Run run, Publish publish)
+    {
+        if (m_running) return false;
+        m_cancel  = std::make_shared<std::atomic_bool>(false);
+        m_running = true;
+        auto flag = m_cancel;
+        m_pool.start([this, flag, run, publish]{
+            const auto rep = run(flag.get(), &m_pool);
+            m_running = false;
+            publish(rep);
+        });
+        return true;
+    }
+    void cancel()          { if (m_cancel) *m_cancel = true; }
+    void stop()            { cancel(); m_pool.waitForDone(); }
+    bool isRunning() const { return m_running; }
+
+private:
+    QThreadPool                       m_pool;
+    std::atomic_bool                  m_running{false};
+    std::shared_ptr<std::atomic_bool> m_cancel;
+};
+
+// ---------------------------
+// Veri seti genelinde paralel karşılaştırma
+//  - İki klasör birer kez listelenir (stem → dosya), görsel başına dosya yoklaması yok
+//  - Stem'ler iş parçacıklarına paylaştırılır; her dosya bir kez okunur, biçim bellekte tespit edilir
+//  - Görsel ve sınıf kırılımları worker'larda yerel tutulur, sonda birleştirilir
+// ---------------------------
+class LabelCompare : public QObject
+{
+    Q_OBJECT
+public:
+    struct Job {
+        QString     oursDir, otherDir;
+        QString     imagesRoot;                // piksel biçimleri için görsel boyutu
+        double      iouThr = 0.90;             // PerClass: eşleştirmede kullanılmaz (yalnız raporda)
+        MatchMode   mode   = MatchMode::Greedy;
+        QStringList onlyStems;                 // boş: iki klasörün birleşimi
+        AnnFmt      oursFmt  = AnnFmt::YOLO;   // .txt biçimi; UNKNOWN: dosya içeriğinden tespit
+        AnnFmt      otherFmt = AnnFmt::UNKNOWN;//   (.xml her zaman VOC)
+        bool        recursive = false;         // alt klasörlerdeki etiketler de
+        bool        keepBoxes = false;         // ImageResult.a/b/pairs doldurulsun (CSV, inceleme)
+        bool        keepDiffOnly = false;      //   yalnız farkı olan (mis/fp/fn) görsellerde (büyük veri seti)
+        int         threads   = 0;             // 0: idealThreadCount
+    };
+
+    struct ImageResult {
+        QString     stem;
+        int         ours = 0, other = 0;       // kutu sayıları
+        AnnFmt      fmtA = AnnFmt::UNKNOWN;
+        AnnFmt      fmtB = AnnFmt::UNKNOWN;
+        MatchCounts c;
+        MatchCounts greedy;                    // mode == Optimal: aynı görselin greedy sonucu
+        QVector<XYXY>     a, b;                // keepBoxes: okunan kutular (normalize)
+        QVector<BoxMatch> pairs;               // keepBoxes: a/b indeksleri, matchBoxes çıktısı
+    };
+
+    struct ClassStats {
+        MatchCounts c;                         // tp/mis/fp: bizim sınıf, fn: karşı sınıf
+    };
+
+    struct Report {
+        int                     files = 0;     // en az bir tarafta etiketi olan stem
+        MatchCounts             total;
+        MatchMode               mode = MatchMode::Greedy;
+        MatchCounts             totalGreedy;   // mode == Optimal: fark raporu için
+        int                     changedImages = 0;  // greedy ile sayıları farklı görsel
+        QVector<ImageResult>    images;        // stem sırasıyla
+        QMap<int, ClassStats>   perClass;
+        double                  iouThr = 0.90;
+        qint64                  elapsedMs = 0;
+        bool                    cancelled = false;
+        QString                 oursDir, otherDir;
+    };
+
+    explicit LabelCompare(QObject* parent=nullptr);
+    ~LabelCompare() override;
+
+    bool start(const Job& job);                // false: zaten çalışıyor
+    void cancel()          { m_runner.cancel(); }
+    bool isRunning() const { return m_runner.isRunning(); }
+
+    // Eşzamanlı çalıştır (CLI / testler). pool verilmezse geçici havuz kullanılır.
+    static Report compare(const Job& job, const std::atomic_bool* cancel = nullptr,
+                          const std::function<void(int done, int total)>& progress = {},
+                          QThreadPool* pool = nullptr);
+
+signals:
+    // Worker thread'den yayılır (alıcı GUI'deyse otomatik queued)
+    void progress(int done, int total);
+    void finished(const LabelCompare::Report& report);
+
+private:
+    EngineRunner m_runner;
+};
+
+Q_DECLARE_METATYPE(LabelCompare::Report)
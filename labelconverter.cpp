@@ -0,0 +1,504 @@
+// labelconverter.cpp
+#include "labelconverter.h"
+#include "dirscanner.h"
+#include "cocostream.h"
+#include "label_serializer.h"
+#include "imagesizecache.h"
+#include "labelcompare.h"       // parseVOCxml
+
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QScopeGuard>
+#include <QSemaphore>
+#include <cstring>
+#include <QSize>
+#include <QThread>
+#include <QVector>
+#include <QDebug>
+#include <functional>
+
+namespace {
+
+// Ara temsil: normalize xyxy (0..1) + piksel boyutu (bilinmiyorsa 0x0)
+struct Obj  { int cls = 0; float x1 = 0, y1 = 0, x2 = 0, y2 = 0; };
+struct Item { QString stem; QString fileName; QSize size; QVector<Obj> objs; };
+
+} // namespace
+
+// Tek dönüştürme işinin paylaşılan durumu (koordinatör + worker'lar)
+struct LabelConverter::Run
+{
+    Job                               job;
+    Format                            from = Format::Unknown;
+    std::shared_ptr<std::atomic_bool> cancel;
+    QElapsedTimer                     timer;
+
+    // Kaynaklar (başlamadan önce hazırlanır, sonra salt okunur)
+    QStringList               files;           // YOLO/VOC kaynak dosyaları
+    QVector<Item>             cocoItems;       // COCO kaynağı: görsel başına üst bilgi (kutusuz)
+    QVector<qint64>           cocoStart;       // cocoItems[i] kutuları: cocoObjs[start[i] .. start[i+1])
+    QFile                     cocoSorted;      // görsele göre sıralı kutular (mmap)
+    const Obj*                cocoObjs = nullptr;
+    QHash<QString, QString>   imageByStem;     // stem → görsel yolu
+    int                       total = 0;
+
+    std::atomic<int>          next{0}, done{0}, converted{0}, failed{0}, boxes{0};
+
+    // Sınıf kaydı (VOC/COCO adları yeni sınıf getirebilir)
+    QMutex                    classMutex;
+    QStringList               classes;
+    QHash<QString, int>       classIndex;
+
+    QMutex                    errMutex;
+    QStringList               errors;
+
+    // COCO çıktısı: kimlikler yazma sırasında verilir
+    QMutex                    cocoMutex;
+    CocoWriter                coco;
+
+    QSemaphore                workersDone;
+
+    int classOf(const QString& name)
+    {
+        QMutexLocker lk(&classMutex);
+        auto it = classIndex.constFind(name);
+        if (it != classIndex.cend()) return *it;
+        classes << name;
+        classIndex.insert(name, int(classes.size()) - 1);
+        return int(classes.size()) - 1;
+    }
+    void ensureClass(int c)                    // YOLO indeksi listede yoksa yer tutucu ad
+    {
+        QMutexLocker lk(&classMutex);
+        while (classes.size() <= c) {
+            const QString n = QString("cls%1").arg(classes.size());
+            classIndex.insert(n, int(classes.size()));
+            classes << n;
+        }
+    }
+    void addError(const QString& stem, const QString& msg)
+    {
+        QMutexLocker lk(&errMutex);
+        if (errors.size() < kMaxErrors) errors << stem + ": " + msg;
+    }
+};
+
+namespace {
+
+// ---------------------------
+// Okuyucular
+// ---------------------------
+bool readYOLO(const QString& path, Item* it, QString* err)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) { *err = f.errorString(); return false; }
+    const QByteArray all = f.readAll();
+    for (const QByteArray& line : all.split('\n')) {
+        const QList<QByteArray> t = line.simplified().split(' ');
+        if (t.size() < 5) continue;
+        bool ok[5];
+        const int   c  = t[0].toInt(&ok[0]);
+        const float cx = t[1].toFloat(&ok[1]), cy = t[2].toFloat(&ok[2]);
+        const float w  = t[3].toFloat(&ok[3]), h  = t[4].toFloat(&ok[4]);
+        if (!(ok[0] && ok[1] && ok[2] && ok[3] && ok[4]) || c < 0) continue;
+        it->objs.push_back({c, cx - w/2, cy - h/2, cx + w/2, cy + h/2});
+    }
+    return true;
+}
+
+// Ayrıştırma labelcompare'in tek VOC okuyucusunda; burada sınıf eşleme + boyut yedeği
+template <typename ClassOf, typename Probe>
+bool readVOC(const QString& path, Item* it, ClassOf classOf, Probe probe, QString* err)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) { *err = f.errorString(); return false; }
+
+    VOCDoc doc;
+    if (!parseVOCxml(f.readAll(), &doc, err)) return false;
+    it->fileName = doc.fileName;
+    it->size = !doc.size.isEmpty() ? doc.size : probe(it->stem);   // <size> yoksa başlıktan
+    if (it->size.isEmpty() && !doc.objects.isEmpty()) { *err = "image size unknown"; return false; }
+    const double W = it->size.width(), H = it->size.height();
+    for (const VOCObject& o : std::as_const(doc.objects)) {
+        it->objs.push_back({classOf(o.name),
+                            float(o.x1 / W), float(o.y1 / H),
+                            float(o.x2 / W), float(o.y2 / H)});
+    }
+    return true;
+}
+
+// ---------------------------
+// Yazıcılar (LabelSerializer: tekrar kullanılan tampon + tek write)
+// ---------------------------
+void toSerializerBoxes(const Item& it, QVector<LabelSerializer::Box>* out)
+{
+    out->resize(it.objs.size());
+    for (int k = 0; k < it.objs.size(); ++k) {
+        const Obj& o = it.objs[k];
+        (*out)[k] = {o.cls, o.x1, o.y1, o.x2, o.y2};
+    }
+}
+
+} // namespace
+
+// ---------------------------
+// COCO kaynağı
+// ---------------------------
+// JSON akışla bir kez okunur; kutular ham haliyle yan dosyaya dökülür, sonra görsele göre
+// disk üzerinde sayma sıralaması yapılır. Bellek: görsel başına sabit (annotation sayısından bağımsız).
+bool LabelConverter::prepareCocoSource(Run& r, const QString& tmpDir, QString* err)
+{
+    struct Raw { qint64 imageId; qint64 catId; float b[4]; };
+    static_assert(sizeof(Raw) == 32, "Raw layout");
+
+    QFile in(r.job.src);
+    if (!in.open(QIODevice::ReadOnly)) { *err = in.errorString(); return false; }
+
+    QFile spool(QDir(tmpDir).filePath(".coco_import.spool"));
+    if (!spool.open(QIODevice::ReadWrite | QIODevice::Truncate)) { *err = spool.errorString(); return false; }
+    const auto dropSpool = qScopeGuard([&spool]{ spool.close(); spool.remove(); });
+
+    QHash<qint64, int> imageRow, catToClass;
+    QByteArray chunk;
+    bool spoolOk = true;
+
+    CocoReader reader;
+    reader.cancelled  = [&r]{ return r.cancel->load(); };
+    reader.onCategory = [&](const CocoCategory& c){ catToClass.insert(c.id, r.classOf(c.name)); };
+    reader.onImage    = [&](const CocoImage& im){
+        Item it;
+        it.fileName = im.fileName;
+        it.stem     = QFileInfo(im.fileName).completeBaseName();
+        it.size     = QSize(im.width, im.height);
+        imageRow.insert(im.id, int(r.cocoItems.size()));
+        r.cocoItems.push_back(std::move(it));
+    };
+    reader.onAnnotation = [&](const CocoAnnotation& a){
+        const Raw raw{a.imageId, a.categoryId,
+                      {float(a.bbox[0]), float(a.bbox[1]), float(a.bbox[2]), float(a.bbox[3])}};
+        chunk.append(reinterpret_cast<const char*>(&raw), sizeof(raw));
+        if (chunk.size() >= (1 << 20)) { spoolOk = spoolOk && spool.write(chunk) == chunk.size(); chunk.clear(); }
+    };
+    if (!reader.read(&in, err)) return false;
+    if (!chunk.isEmpty()) spoolOk = spoolOk && spool.write(chunk) == chunk.size();
+    if (!spoolOk || !spool.flush()) { *err = spool.errorString(); return false; }
+
+    // JSON'da boyutu olmayan görseller: başlıktan
+    for (Item& it : r.cocoItems) {
+        if (!it.size.isEmpty()) continue;
+        const QString img = r.imageByStem.value(it.stem);
+        if (!img.isEmpty()) it.size = ImageSizeCache::instance().sizeOf(img);
+    }
+
+    const int    nImg = int(r.cocoItems.size());
+    const qint64 nRaw = spool.size() / qint64(sizeof(Raw));
+    const uchar* raw  = nRaw ? spool.map(0, nRaw * qint64(sizeof(Raw))) : nullptr;
+    if (nRaw && !raw) { *err = "mmap: " + spool.errorString(); return false; }
+    const auto rawAt = [raw](qint64 k){ Raw x; memcpy(&x, raw + k * qint64(sizeof(Raw)), sizeof(Raw)); return x; };
+    const auto rowOf = [&](const Raw& x){
+        const int row = imageRow.value(x.imageId, -1);
+        return (row >= 0 && !r.cocoItems[row].size.isEmpty()) ? row : -1;
+    };
+
+    // 1) görsel başına say → başlangıç ofsetleri
+    QVector<qint64> count(nImg, 0);
+    qint64 kept = 0, orphans = 0;
+    for (qint64 k = 0; k < nRaw; ++k) {
+        const int row = rowOf(rawAt(k));
+        if (row < 0) { ++orphans; continue; }
+        ++count[row];
+        ++kept;
+    }
+    r.cocoStart.resize(nImg + 1);
+    r.cocoStart[0] = 0;
+    for (int i = 0; i < nImg; ++i) r.cocoStart[i + 1] = r.cocoStart[i] + count[i];
+
+    // 2) yerleştir (mmap edilmiş hedefe doğrudan)
+    r.cocoSorted.setFileName(QDir(tmpDir).filePath(".coco_import.sorted"));
+    if (!r.cocoSorted.open(QIODevice::ReadWrite | QIODevice::Truncate)
+        || !r.cocoSorted.resize(kept * qint64(sizeof(Obj)))) {
+        *err = r.cocoSorted.errorString();
+        releaseCocoSource(r);
+        return false;
+    }
+    uchar* dst = kept ? r.cocoSorted.map(0, kept * qint64(sizeof(Obj))) : nullptr;
+    if (kept && !dst) { *err = "mmap: " + r.cocoSorted.errorString(); releaseCocoSource(r); return false; }
+
+    QVector<qint64> cursor(r.cocoStart.cbegin(), r.cocoStart.cend() - 1);
+    for (qint64 k = 0; k < nRaw; ++k) {
+        const Raw x   = rawAt(k);
+        const int row = rowOf(x);
+        if (row < 0) continue;
+        const double W = r.cocoItems[row].size.width(), H = r.cocoItems[row].size.height();
+        const int    c = catToClass.contains(x.catId) ? catToClass.value(x.catId)
+                                                      : r.classOf(QString("cat%1").arg(x.catId));
+        const Obj o{c, float(x.b[0] / W), float(x.b[1] / H),
+                       float((x.b[0] + x.b[2]) / W), float((x.b[1] + x.b[3]) / H)};
+        memcpy(dst + cursor[row]++ * qint64(sizeof(Obj)), &o, sizeof(Obj));
+    }
+    if (raw) spool.unmap(const_cast<uchar*>(raw));
+    r.cocoObjs = reinterpret_cast<const Obj*>(dst);
+
+    if (orphans)
+        r.addError("COCO", QString("%1 annotations skipped (unknown image_id or image size)").arg(orphans));
+    return true;
+}
+
+void LabelConverter::releaseCocoSource(Run& r)
+{
+    if (r.cocoObjs) r.cocoSorted.unmap(reinterpret_cast<uchar*>(const_cast<Obj*>(r.cocoObjs)));
+    r.cocoObjs = nullptr;
+    if (r.cocoSorted.isOpen()) { r.cocoSorted.close(); r.cocoSorted.remove(); }
+}
+
+LabelConverter::LabelConverter(QObject* parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<LabelConverter::Report>("LabelConverter::Report");
+    m_pool.setMaxThreadCount(QThread::idealThreadCount() + 1);   // +1: koordinatör
+}
+
+LabelConverter::~LabelConverter()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+LabelConverter::Format LabelConverter::detectFormat(const QString& src)
+{
+    const QFileInfo fi(src);
+    if (fi.isFile()) return fi.suffix().compare("json", Qt::CaseInsensitive) == 0 ? Format::COCO
+                                                                               : Format::Unknown;
+    if (!fi.isDir()) return Format::Unknown;
+    QDirIterator it(src, QStringList{"*.xml", "*.txt"}, QDir::Files);
+    while (it.hasNext()) {
+        it.next();
+        if (it.fileName().endsWith(".xml", Qt::CaseInsensitive)) return Format::VOC;
+        if (it.fileName() != QLatin1String("classes.txt"))      return Format::YOLO;
+    }
+    return Format::Unknown;
+}
+
+QString LabelConverter::formatName(Format f)
+{
+    switch (f) {
+    case Format::YOLO: return "YOLO";
+    case Format::VOC:  return "PascalVOC";
+    case Format::COCO: return "COCO";
+    default:           return "?";
+    }
+}
+
+bool LabelConverter::start(const Job& job)
+{
+    if (m_running || job.src.isEmpty() || job.dst.isEmpty()) return false;
+    if (QFileInfo(job.src).absoluteFilePath() == QFileInfo(job.dst).absoluteFilePath()) return false;
+
+    auto run = std::make_shared<Run>();
+    run->job    = job;
+    m_cancel    = std::make_shared<std::atomic_bool>(false);
+    run->cancel = m_cancel;
+    m_running   = true;
+    m_pool.start([this, run]{ runJob(run); });
+    return true;
+}
+
+void LabelConverter::cancel()
+{
+    if (m_cancel) *m_cancel = true;
+}
+
+// ---------------------------
+// Koordinatör
+// ---------------------------
+void LabelConverter::runJob(std::shared_ptr<Run> run)
+{
+    Run& r = *run;
+    r.timer.start();
+    Report rep;
+    rep.dst = r.job.dst;
+
+    const auto fail = [&](const QString& msg){
+        rep.errors << msg;
+        rep.failed    = qMax(1, r.failed.load());
+        rep.elapsedMs = r.timer.elapsed();
+        m_running = false;
+        emit finished(rep);
+    };
+
+    r.from = (r.job.from == Format::Unknown) ? detectFormat(r.job.src) : r.job.from;
+    if (r.from == Format::Unknown || r.job.to == Format::Unknown)
+        return fail("source format unknown: " + r.job.src);
+
+    for (const QString& c : r.job.classes) r.classOf(c);
+    if (!r.job.imagesDir.isEmpty()) {
+        for (const QString& p : DirScanner::instance().listImages(r.job.imagesDir))
+            r.imageByStem.insert(QFileInfo(p).completeBaseName(), p);
+    }
+
+    // Kaynak listesi
+    const QString outDir = (r.job.to == Format::COCO) ? QFileInfo(r.job.dst).absolutePath() : r.job.dst;
+    if (!QDir().mkpath(outDir)) return fail("mkpath failed: " + outDir);
+
+    if (r.from == Format::COCO) {
+        if (r.job.to == Format::COCO) return fail("COCO → COCO: nothing to convert");
+        QString err;
+        if (!prepareCocoSource(r, outDir, &err)) return fail(r.job.src + ": " + err);
+        r.total = int(r.cocoItems.size());
+    } else {
+        QDirIterator it(r.job.src, QStringList{ r.from == Format::VOC ? "*.xml" : "*.txt" }, QDir::Files);
+        while (it.hasNext()) {
+            it.next();
+            if (r.from == Format::YOLO && it.fileName() == QLatin1String("classes.txt")) continue;
+            r.files << it.filePath();
+        }
+        r.total = int(r.files.size());
+    }
+
+    // COCO hedefi: images doğrudan, annotations yan dosyaya akar
+    if (r.job.to == Format::COCO) {
+        QString err;
+        if (!r.coco.open(r.job.dst, &err)) return fail(r.job.dst + ": " + err);
+    }
+
+    emit progress(0, r.total);
+
+    // Worker'lar: koordinatör de bir pay alır
+    const int workers = qBound(1, QThread::idealThreadCount(), qMax(1, r.total / 64));
+    for (int i = 1; i < workers; ++i)
+        m_pool.start([this, run]{ work(*run); run->workersDone.release(); });
+    work(r);
+    r.workersDone.acquire(workers - 1);
+    releaseCocoSource(r);
+
+    rep.cancelled = *r.cancel;
+    rep.total     = r.total;
+    rep.converted = r.converted;
+    rep.failed    = r.failed;
+    rep.boxes     = r.boxes;
+    {
+        QMutexLocker lk(&r.classMutex);
+        rep.classes = r.classes;
+    }
+
+    // Sonlandırma
+    if (r.job.to == Format::COCO) {
+        QString err;
+        if (rep.cancelled)                          r.coco.abort();
+        else if (!r.coco.finish(rep.classes, &err)) rep.errors << r.job.dst + ": " + err;
+    } else if (r.job.to == Format::YOLO && !rep.classes.isEmpty()) {
+        QString err;
+        if (!LabelSerializer::writeFile(QDir(outDir).filePath("classes.txt"), rep.classes.join('\n').toUtf8() + '\n', &err))
+            rep.errors << err;
+    }
+
+    {
+        QMutexLocker lk(&r.errMutex);
+        rep.errors = r.errors + rep.errors;
+    }
+    if (rep.failed > 0) {
+        QString err;
+        LabelSerializer::writeFile(QDir(outDir).filePath("convert_errors.txt"), rep.errors.join('\n').toUtf8() + '\n', &err);
+    }
+
+    ImageSizeCache::instance().flush();
+    rep.elapsedMs = r.timer.elapsed();
+    qDebug() << "[Convert]" << formatName(r.from) << "->" << formatName(r.job.to)
+             << rep.converted << "/" << rep.total << "in" << rep.elapsedMs << "ms, failed" << rep.failed;
+    m_running = false;
+    emit finished(rep);
+}
+
+// ---------------------------
+// Worker
+// ---------------------------
+void LabelConverter::work(Run& r)
+{
+    const Format to  = r.job.to;
+    const QDir   out(to == Format::COCO ? QFileInfo(r.job.dst).absolutePath() : r.job.dst);
+    const auto   classOf = [&r](const QString& n){ return r.classOf(n); };
+    LabelSerializer               ser;        // worker başına; ısındıktan sonra ayırma yok
+    QVector<LabelSerializer::Box> boxes;
+    const auto   probe   = [&r](const QString& stem){
+        const QString img = r.imageByStem.value(stem);
+        return img.isEmpty() ? QSize() : ImageSizeCache::instance().sizeOf(img);
+    };
+
+    for (;;) {
+        if (*r.cancel) return;
+        const int i = r.next.fetch_add(1);
+        if (i >= r.total) return;
+
+        Item it;
+        QString err;
+        bool ok = true;
+        if (r.from == Format::COCO) {
+            it = r.cocoItems[i];
+            it.objs = QVector<Obj>(r.cocoObjs + r.cocoStart[i], r.cocoObjs + r.cocoStart[i + 1]);
+        } else {
+            const QString& path = r.files[i];
+            it.stem = QFileInfo(path).completeBaseName();
+            ok = (r.from == Format::YOLO) ? readYOLO(path, &it, &err)
+                                          : readVOC(path, &it, classOf, probe, &err);
+        }
+
+        // Piksel boyutu: YOLO dışı çıktılar ister; sadece başlık okunur
+        if (ok && to != Format::YOLO && it.size.isEmpty()) {
+            it.size = probe(it.stem);
+            if (it.size.isEmpty()) { ok = false; err = "image size unknown"; }
+        }
+        if (ok && it.fileName.isEmpty()) {
+            const QString img = r.imageByStem.value(it.stem);
+            it.fileName = img.isEmpty() ? it.stem + ".jpg" : QFileInfo(img).fileName();
+        }
+        if (ok && r.from == Format::YOLO && to != Format::YOLO) {
+            int maxCls = -1;
+            for (const Obj& o : std::as_const(it.objs)) maxCls = qMax(maxCls, o.cls);
+            if (maxCls >= 0) r.ensureClass(maxCls);
+        }
+
+        if (ok) {
+            switch (to) {
+            case Format::YOLO:
+                toSerializerBoxes(it, &boxes);
+                ok = LabelSerializer::writeFile(out.filePath(it.stem + ".txt"),
+                                                ser.yolo(boxes.constData(), int(boxes.size())), &err);
+                break;
+            case Format::VOC: {
+                QStringList names;
+                {
+                    QMutexLocker lk(&r.classMutex);
+                    names = r.classes;                 // paylaşımlı kopya (O(1))
+                }
+                toSerializerBoxes(it, &boxes);
+                ok = LabelSerializer::writeFile(out.filePath(it.stem + ".xml"),
+                                                ser.voc(boxes.constData(), int(boxes.size()), it.size, names,
+                                                        it.size.width(), it.size.height(), it.fileName), &err);
+                break;
+            }
+            case Format::COCO: {
+                const double W = it.size.width(), H = it.size.height();
+                QMutexLocker lk(&r.cocoMutex);
+                const qint64 imageId = r.coco.addImage(it.fileName, it.size);
+                for (const Obj& o : std::as_const(it.objs))
+                    r.coco.addAnnotation(imageId, o.cls + 1,
+                                         QRectF(o.x1 * W, o.y1 * H, (o.x2 - o.x1) * W, (o.y2 - o.y1) * H));
+                break;
+            }
+            default: ok = false; err = "unsupported target"; break;
+            }
+        }
+
+        if (ok) { ++r.converted; r.boxes += int(it.objs.size()); }
+        else    { ++r.failed;    r.addError(it.stem, err); }
+
+        const int d = ++r.done;
+        if ((d & 255) == 0 || d == r.total) emit progress(d, r.total);
+    }
+}
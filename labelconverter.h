@@ -0,0 +1,76 @@
+// labelconverter.h
+#pragma once
+
+#include <QObject>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+
+// Veri seti genelinde etiket biçimi dönüştürücü (YOLO txt ↔ Pascal VOC xml ↔ COCO json).
+//  - Kaynak dosyalar worker havuzunda paralel okunur/yazılır (dosya başına iş, paylaşılan sayaç)
+//  - Piksel boyutu gerekirse sadece görsel başlığı okunur (QImageReader::size, decode yok)
+//  - YOLO/VOC: dosya başına doğrudan akış yazımı; COCO: CocoWriter ile akış (cocostream.h)
+//  - COCO kaynağı: JsonPull ile parça parça okunur, kutular diskte görsele göre sıralanır
+//    (milyonlarca annotation'da bile bellek görsel sayısıyla sınırlı)
+//  - progress() ara sıra, finished() bitince özet + hata listesi ile gelir
+class LabelConverter : public QObject
+{
+    Q_OBJECT
+public:
+    enum class Format { YOLO, VOC, COCO, Unknown };
+
+    struct Job {
+        Format      from = Format::Unknown;   // Unknown: kaynaktan tespit et
+        Format      to   = Format::YOLO;
+        QString     src;                      // klasör (YOLO/VOC) veya .json (COCO)
+        QString     dst;                      // klasör (YOLO/VOC) veya .json (COCO)
+        QString     imagesDir;                // boyut yoklaması + COCO file_name
+        QStringList classes;                  // YOLO sınıf sırası (VOC/COCO adları eksikse eklenir)
+    };
+
+    struct Report {
+        int         total     = 0;            // kaynak görsel/etiket sayısı
+        int         converted = 0;
+        int         failed    = 0;
+        int         boxes     = 0;
+        qint64      elapsedMs = 0;
+        bool        cancelled = false;
+        QString     dst;
+        QStringList classes;                  // çıktıda kullanılan son sınıf listesi
+        QStringList errors;                   // ilk kMaxErrors hata ("stem: neden")
+    };
+
+    static constexpr int kMaxErrors = 500;
+
+    explicit LabelConverter(QObject* parent=nullptr);
+    ~LabelConverter() override;
+
+    bool start(const Job& job);               // false: zaten çalışıyor / geçersiz iş
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+    static Format  detectFormat(const QString& src);
+    static QString formatName(Format f);
+
+signals:
+    // Worker thread'den yayılır (alıcı GUI'deyse otomatik queued)
+    void progress(int done, int total);
+    void finished(const LabelConverter::Report& report);
+
+private:
+    struct Run;
+
+    void runJob(std::shared_ptr<Run> run);    // koordinatör (havuz thread'i)
+    void work(Run& run);                      // worker: sıradaki kaynakları işle
+    static bool prepareCocoSource(Run& run, const QString& tmpDir, QString* err);
+    static void releaseCocoSource(Run& run);
+
+    QThreadPool                       m_pool;
+    std::atomic_bool                  m_running{false};
+    std::shared_ptr<std::atomic_bool> m_cancel;
+};
+
+Q_DECLARE_METATYPE(LabelConverter::Report)
@@ -0,0 +1,210 @@
+// labelcounter.cpp
+#include "labelcounter.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QMetaObject>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <QSocketNotifier>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+LabelCounter::LabelCounter(QObject* parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(1);
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(300);
+    connect(&m_debounce, &QTimer::timeout, this, &LabelCounter::rescan);
+}
+
+LabelCounter::~LabelCounter()
+{
+    stopWatch();
+    ++m_generation;
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+bool LabelCounter::isWatching() const
+{
+#ifdef Q_OS_LINUX
+    if (m_notifier) return true;
+#endif
+    return m_watcher != nullptr;
+}
+
+bool LabelCounter::matches(const QString& name) const
+{
+    return name.size() > m_ext.size() + 1
+        && name.at(name.size() - m_ext.size() - 1) == '.'
+        && name.endsWith(m_ext, Qt::CaseInsensitive);
+}
+
+void LabelCounter::setDirectory(const QString& dirIn, const QString& extIn)
+{
+    const QString dir = dirIn.trimmed().isEmpty() ? QString() : QDir(dirIn.trimmed()).absolutePath();
+    const QString ext = extIn.isEmpty() ? QStringLiteral("txt") : extIn.toLower();
+    if (dir == m_dir && ext == m_ext) return;
+
+    m_dir = dir;
+    m_ext = ext;
+    rescan();
+}
+
+// ---------------------------
+// Seed: tek seferlik arka plan tarama
+// ---------------------------
+void LabelCounter::rescan()
+{
+    stopWatch();
+    m_debounce.stop();
+    m_names.clear();
+    m_ready = false;
+    m_rescanAfterSeed = false;
+    const quint64 gen = ++m_generation;
+
+    if (m_dir.isEmpty() || !QFileInfo(m_dir).isDir()) {
+        // Klasör yoksa 0; oluşturulunca çağıran rescan() ile yeniden bağlar
+        m_ready = true;
+        emit countChanged(0);
+        return;
+    }
+
+    startWatch();                  // önce izle, sonra tara: aradaki olaylar kaybolmasın
+    emit countChanged(-1);
+
+    const QString dir = m_dir;
+    const QString ext = m_ext;
+    m_pool.start([this, gen, dir, ext]{
+        QSet<QString> names;
+        const QStringList filter{ "*." + ext };
+        QDirIterator it(dir, filter, QDir::Files);
+        while (it.hasNext()) {
+            it.next();
+            names.insert(it.fileName());
+        }
+        QMetaObject::invokeMethod(this, [this, gen, names]{ applySeed(gen, names); },
+                                  Qt::QueuedConnection);
+    });
+}
+
+void LabelCounter::applySeed(quint64 gen, const QSet<QString>& names)
+{
+    if (gen != m_generation) return;   // bu arada klasör değişti
+    m_names = names;
+    m_ready = true;
+#ifdef Q_OS_LINUX
+    // Tarama sırasında gelen olaylar: ekle/sil idempotent, sırayla uygula
+    for (const auto& ev : std::as_const(m_early)) {
+        if (ev.first) m_names.insert(ev.second);
+        else          m_names.remove(ev.second);
+    }
+    m_early.clear();
+#endif
+    if (m_rescanAfterSeed) { m_debounce.start(); }
+    emit countChanged(int(m_names.size()));
+}
+
+// ---------------------------
+// İzleme
+// ---------------------------
+void LabelCounter::startWatch()
+{
+#ifdef Q_OS_LINUX
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd >= 0) {
+        const QByteArray p = QFile::encodeName(m_dir);
+        const int wd = inotify_add_watch(m_inotifyFd, p.constData(),
+                                         IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                                         | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+        if (wd >= 0) {
+            m_notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+            connect(m_notifier, &QSocketNotifier::activated, this, &LabelCounter::onInotifyReadable);
+            return;
+        }
+        qWarning() << "[LabelCounter] inotify_add_watch failed for" << m_dir << "errno" << errno;
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+#endif
+    // Yedek yol: klasör değişti bildirimi → gecikmeli yeniden tarama
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &LabelCounter::onDirectoryChanged);
+    m_watcher->addPath(m_dir);
+}
+
+void LabelCounter::stopWatch()
+{
+    // deleteLater: kendi sinyalinin içinden (ör. klasör silindi → rescan) çağrılabilir
+#ifdef Q_OS_LINUX
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+        m_notifier->disconnect(this);
+        m_notifier->deleteLater();
+        m_notifier = nullptr;
+    }
+    if (m_inotifyFd >= 0) { ::close(m_inotifyFd); m_inotifyFd = -1; }
+    m_early.clear();
+#endif
+    if (m_watcher) {
+        m_watcher->disconnect(this);
+        m_watcher->deleteLater();
+        m_watcher = nullptr;
+    }
+}
+
+void LabelCounter::onDirectoryChanged()
+{
+    // Hangi dosyanın değiştiği bilinmiyor; olaylar durulunca bir kez say
+    if (!m_ready) { m_rescanAfterSeed = true; return; }
+    m_debounce.start();
+}
+
+#ifdef Q_OS_LINUX
+void LabelCounter::onInotifyReadable()
+{
+    alignas(inotify_event) char buf[16 * 1024];
+    bool changed = false, overflow = false, gone = false;
+
+    for (;;) {
+        const ssize_t len = ::read(m_inotifyFd, buf, sizeof(buf));
+        if (len <= 0) break;                          // EAGAIN: okunacak olay kalmadı
+        for (char* p = buf; p < buf + len; ) {
+            const auto* ev = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW)                 { overflow = true; continue; }
+            if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) { gone = true; continue; }
+            if (ev->len == 0 || (ev->mask & IN_ISDIR))    continue;
+
+            const QString name = QFile::decodeName(ev->name);
+            if (!matches(name)) continue;              // QSaveFile geçici dosyaları ("x.txt.AbCdEf") elenir
+            const bool added = ev->mask & (IN_CREATE | IN_MOVED_TO);
+
+            if (!m_ready) { m_early.push_back({added, name}); continue; }
+            if (added) m_names.insert(name);           // üzerine yazan rename çift sayılmaz
+            else       m_names.remove(name);
+            changed = true;
+        }
+    }
+
+    if (gone) {                                        // klasör silindi / taşındı
+        rescan();
+        return;
+    }
+    if (overflow) {                                    // çekirdek kuyruğu taştı: olaylar eksik
+        qWarning() << "[LabelCounter] inotify queue overflow, rescanning" << m_dir;
+        rescan();
+        return;
+    }
+    if (changed) emit countChanged(int(m_names.size()));
+}
+#endif
@@ -0,0 +1,62 @@
+// labelcounter.h
+#pragma once
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+#include <QPair>
+
+class QFileSystemWatcher;
+class QSocketNotifier;
+
+// Etiket klasöründeki dosya sayısını (ör. *.txt / *.xml) artımlı tutar.
+//  - Klasör değişince bir kez arka planda taranır (seed)
+//  - Sonrası dosya sistemi bildirimleriyle güncellenir:
+//      Linux  : inotify (oluştur/sil/taşı olayları, dosya başına +1/-1)
+//      Diğer  : QFileSystemWatcher (klasör değişti → gecikmeli arka plan tarama)
+//  - Boştayken hiçbir iş yapmaz (zamanlayıcı / periyodik tarama yok)
+class LabelCounter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LabelCounter(QObject* parent=nullptr);
+    ~LabelCounter() override;
+
+    void    setDirectory(const QString& dir, const QString& ext);   // aynıysa no-op
+    void    rescan();                                               // ör. klasör sonradan oluşturulduysa
+    QString directory() const { return m_dir; }
+    int     count() const     { return m_ready ? int(m_names.size()) : -1; }   // -1: sayılıyor
+    bool    isWatching() const;
+
+signals:
+    void countChanged(int n);
+
+private:
+    bool matches(const QString& name) const;
+    void startWatch();
+    void stopWatch();
+    void applySeed(quint64 gen, const QSet<QString>& names);
+    void onDirectoryChanged();     // QFileSystemWatcher yolu
+#ifdef Q_OS_LINUX
+    void onInotifyReadable();
+#endif
+
+    QString        m_dir;
+    QString        m_ext;
+    QSet<QString>  m_names;        // eşleşen dosya adları (üzerine yazma çift sayılmasın)
+    bool           m_ready = false;
+    quint64        m_generation = 0;
+    QThreadPool    m_pool;
+
+#ifdef Q_OS_LINUX
+    int                           m_inotifyFd = -1;
+    QSocketNotifier*              m_notifier  = nullptr;
+    QVector<QPair<bool,QString>>  m_early;   // seed sürerken gelen olaylar (true: eklendi)
+#endif
+    QFileSystemWatcher*           m_watcher   = nullptr;
+    QTimer                        m_debounce;   // watcher olaylarını toplar
+    bool                          m_rescanAfterSeed = false;
+};
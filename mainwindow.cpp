@@ -2,6 +2,14 @@
 #include "mainwindow.h"
 #include "annotatorwidget.h"
 #include "ui_mainwindow.h"
+#include "imagelistmodel.h"
+#include "dirscanner.h"
+#include "labelcounter.h"
+#include "thumbnailcache.h"
+#include "annotationstore.h"
+#include "labelconverter.h"
+#include "preannotator.h"
+#include "reviewqueue.h"
 
 #include <QCamera>
 #include <QCameraDevice>
@@ -38,13 +46,17 @@
 #include <QLineEdit>
 #include <QMenu>
 #include <QAction>
+#include <QActionGroup>
 #include <QTextStream>
 #include <QToolButton>
 #include <QListWidget>
+#include <QListView>
+#include <QItemSelectionModel>
 #include <QPlainTextEdit>
 #include <QCheckBox>
 #include <QPointer>
 #include <QDoubleSpinBox>
+#include <QThreadPool>
 
 #include <QSet>
 #include <QRegularExpression>
@@ -148,19 +160,6 @@ QStringList MainWindow::getOpenFileNamesSafe(QWidget* parent, const QString& tit
 }
 // ------------------------------------------------------
 
-QStringList MainWindow::listImagesCaseInsensitive(const QString& dir) const
-{
-    QStringList out;
-    QDir d(dir);
-    const QStringList files = d.entryList(QDir::Files, QDir::Name);
-    for (const QString& f : files) {
-        const QString ext = QFileInfo(f).suffix().toLower();
-        if (QStringList{"png","jpg","jpeg","bmp","tif","tiff"}.contains(ext))
-            out << d.absoluteFilePath(f);
-    }
-    return out;
-}
-
 QStringList MainWindow::loadImageListTxt(const QString& txtFile) const
 {
     QStringList out;
@@ -361,10 +360,24 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->btnLoadModel, &QPushButton::clicked, this, &MainWindow::loadModel);
     connect(ui->btnPredict,   &QPushButton::clicked, this, &MainWindow::predict);
 
+    // ---- Batch Tahmin: klasör arka planda listelenir, bitince kuyruk başlar
+    auto predictFromDir = [this](const QString& dir, const QString& startMsg){
+        DirScanner::instance().listImagesAsync(dir, this, [this, startMsg](const QStringList& imgs){
+            if (imgs.isEmpty()) {
+                QMessageBox::information(this, tr("Boş klasör"), tr("Bu klasörde görsel yok."));
+                return;
+            }
+            g_predQueue = imgs;
+            if (ui->txtPredLog)
+                ui->txtPredLog->appendPlainText(startMsg.arg(g_predQueue.size()));
+            startInferProcess(g_predQueue.takeFirst());
+        });
+    };
+
     // ---- Batch Tahmin: sağ tık menüsü
     if (ui->btnPredict) {
         ui->btnPredict->setContextMenuPolicy(Qt::CustomContextMenu);
-        connect(ui->btnPredict, &QPushButton::customContextMenuRequested, this, [this](const QPoint& pos){
+        connect(ui->btnPredict, &QPushButton::customContextMenuRequested, this, [this, predictFromDir](const QPoint& pos){
             QMenu menu(this);
             QAction* actFromDir   = menu.addAction(tr("Klasörden Tahmin (Batch)"));
             QAction* actFromMulti = menu.addAction(tr("Çoklu Dosyadan Tahmin (Batch)"));
@@ -377,15 +390,7 @@ MainWindow::MainWindow(QWidget *parent)
                     m_saveDir.isEmpty() ? QDir::homePath() : m_saveDir);
                 if (dir.isEmpty()) return;
 
-                QStringList imgs = listImagesCaseInsensitive(dir);
-                if (imgs.isEmpty()) {
-                    QMessageBox::information(this, tr("Boş klasör"), tr("Bu klasörde görsel yok."));
-                    return;
-                }
-                g_predQueue = imgs;
-                if (ui->txtPredLog)
-                    ui->txtPredLog->appendPlainText(tr("Batch başladı (%1 görsel).").arg(g_predQueue.size()));
-                startInferProcess(g_predQueue.takeFirst());
+                predictFromDir(dir, tr("Batch başladı (%1 görsel)."));
             } else if (chosen == actFromMulti) {
                 QStringList chosenFiles = getOpenFileNamesSafe(
                     this, tr("Tahmin için görselleri seç"),
@@ -409,7 +414,7 @@ MainWindow::MainWindow(QWidget *parent)
 
     // ---- Tahmin bölümüne iki buton
     if (ui->btnPredFromDir) {
-        connect(ui->btnPredFromDir, &QPushButton::clicked, this, [this]{
+        connect(ui->btnPredFromDir, &QPushButton::clicked, this, [this, predictFromDir]{
             if (m_modelPath.isEmpty()) { QMessageBox::warning(this, tr("Model yok"), tr("Önce modeli yükleyin.")); return; }
 
             const QString dir = getExistingDirectorySafe(
@@ -417,15 +422,7 @@ MainWindow::MainWindow(QWidget *parent)
                 m_saveDir.isEmpty() ? QDir::homePath() : m_saveDir);
             if (dir.isEmpty()) return;
 
-            QStringList imgs = listImagesCaseInsensitive(dir);
-            if (imgs.isEmpty()) {
-                QMessageBox::information(this, tr("Boş klasör"), tr("Bu klasörde görsel yok."));
-                return;
-            }
-            g_predQueue = imgs;
-            if (ui->txtPredLog)
-                ui->txtPredLog->appendPlainText(tr("Batch başladı (%1 görsel) [Klasör].").arg(g_predQueue.size()));
-            startInferProcess(g_predQueue.takeFirst());
+            predictFromDir(dir, tr("Batch başladı (%1 görsel) [Klasör]."));
         });
     }
 
@@ -474,11 +471,24 @@ MainWindow::MainWindow(QWidget *parent)
     if (ui->leLabels) {
         connect(ui->leLabels, &QLineEdit::textChanged, this, [this](const QString& s){
             if (ui->annotView) ui->annotView->setSaveDir(s.trimmed());
+            updateLabelCount();
         });
     }
 
-    connect(&m_labelCountTimer, &QTimer::timeout, this, &MainWindow::updateLabelCount);
-    m_labelCountTimer.start(1000);
+    // Etiket sayacı: bir kez arka planda sayılır, sonra dosya bildirimleriyle güncellenir
+    m_labelCounter = new LabelCounter(this);
+    connect(m_labelCounter, &LabelCounter::countChanged, this, [this](int n){
+        if (!ui->lblLabelCount) return;
+        ui->lblLabelCount->setText(n < 0 ? QString("Etiket dosyası: sayılıyor…")
+                                         : QString("Etiket dosyası: %1").arg(n));
+    });
+    if (ui->annotView) {
+        // Klasör ilk kayıtta oluşturulduysa izlemeyi şimdi başlat
+        connect(ui->annotView, &AnnotatorWidget::labelSaved, this, [this]{
+            if (m_labelCounter && !m_labelCounter->isWatching()) m_labelCounter->rescan();
+        });
+    }
+    updateLabelCount();
 
     if (m_dirLabel) m_dirLabel->setText("Kayıt klasörü (dataset kökü): " + makeSavePath());
     populateLabelsFromDir();
@@ -612,29 +622,76 @@ MainWindow::MainWindow(QWidget *parent)
     if (ui->chkUseDefault)
         connect(ui->chkUseDefault, &QCheckBox::toggled, this, [=]{ applyActiveClass(); });
 
+    // ==== Files sekmesi: sanal liste modeli ====
+    m_fileModel = new ImageListModel(this);
+    if (ui->listFiles) {
+        ui->listFiles->setModel(m_fileModel);
+        ui->listFiles->setUniformItemSizes(true);              // 500k satırda ölçüm yok
+        ui->listFiles->setLayoutMode(QListView::Batched);
+        ui->listFiles->setSelectionMode(QAbstractItemView::SingleSelection);
+    }
+
+    // Küçük resim (filmstrip) modu: kalıcı önbellekten, arka planda üretilir
+    m_thumbCache = new ThumbnailCache(this);
+    m_fileModel->setThumbnailCache(m_thumbCache);
+    if (ui->listFiles && ui->chkThumbs) {
+        connect(ui->chkThumbs, &QCheckBox::toggled, this, [this](bool on){
+            QListView* v = ui->listFiles;
+            if (on) {
+                m_thumbCache->setDataset(m_fileModel->rootDir());
+                const int s = ThumbnailCache::kSize;
+                v->setViewMode(QListView::IconMode);
+                v->setIconSize(QSize(s, s));
+                v->setGridSize(QSize(s + 16, s + 24));        // sabit ızgara → satır ölçümü yok
+                v->setResizeMode(QListView::Adjust);
+                v->setMovement(QListView::Static);
+                v->setWrapping(true);
+            } else {
+                v->setViewMode(QListView::ListMode);
+                v->setIconSize(QSize());
+                v->setGridSize(QSize());
+                v->setWrapping(false);
+            }
+            v->setUniformItemSizes(true);
+            m_fileModel->setThumbnailsEnabled(on);
+            if (v->currentIndex().isValid()) v->scrollTo(v->currentIndex());
+        });
+    }
+
+    // Etiket durumu (etiketli/etiketsiz/kutu sayısı) için kaynak klasör
+    auto syncLabelState = [this]{
+        if (!m_fileModel) return;
+        const QString dir = ui->leLabels ? ui->leLabels->text().trimmed() : QString();
+        const bool isVOC  = (ui->cbFormat && ui->cbFormat->currentText() == "PascalVOC");
+        m_fileModel->setLabelsDir(dir, isVOC ? "xml" : "txt");
+    };
+    if (ui->leLabels) connect(ui->leLabels, &QLineEdit::textChanged, this, syncLabelState);
+    if (ui->cbFormat) connect(ui->cbFormat, &QComboBox::currentTextChanged, this, syncLabelState);
+    if (ui->annotView) {
+        connect(ui->annotView, &AnnotatorWidget::labelSaved, this, [this](const QString& p){
+            if (m_fileModel) m_fileModel->refreshLabelState(QFileInfo(p).completeBaseName());
+        });
+    }
+
     // ==== Lifetime güvenli yerel lambda'lar ====
     QPointer<MainWindow> self(this);
 
     auto updateCounter = [self]{
         if (!self) return;
         auto ui = self->ui;
-        if (!ui || !ui->lblCounter || !ui->listFiles) return;
-        const int total = ui->listFiles->count();
-        const int idx   = ui->listFiles->currentRow();
+        if (!ui || !ui->lblCounter || !ui->listFiles || !self->m_fileModel) return;
+        const int total = self->m_fileModel->totalCount();
+        const int idx   = ui->listFiles->currentIndex().row();
         ui->lblCounter->setText(QString("%1 / %2").arg(total ? idx+1 : 0).arg(total));
     };
 
     auto showImageForRow = [self](int row){
         if (!self) return;
         auto ui = self->ui;
-        if (!ui || !ui->listFiles) return;
-        if (row < 0 || row >= ui->listFiles->count()) return;
-
-        QListWidgetItem* item = ui->listFiles->item(row);
-        if (!item) return;
-        QString path = item->data(Qt::UserRole).toString();
-        if (path.isEmpty()) path = item->text();
+        if (!ui || !ui->listFiles || !self->m_fileModel) return;
+        if (row < 0 || row >= self->m_fileModel->totalCount()) return;
 
+        const QString path = self->m_fileModel->pathAt(row);
         if (!path.isEmpty()) {
             if (ui->annotView) ui->annotView->loadImage(path);
             if (ui->lblAnnotInfo) ui->lblAnnotInfo->setText(QFileInfo(path).fileName() + " yüklendi");
@@ -642,65 +699,61 @@ MainWindow::MainWindow(QWidget *parent)
         }
     };
 
-    if (ui->listFiles) {
-        connect(ui->listFiles, &QListWidget::currentRowChanged, this, [=](int r){
-            updateCounter();
-            showImageForRow(r);
-        });
+    if (ui->listFiles && ui->listFiles->selectionModel()) {
+        connect(ui->listFiles->selectionModel(), &QItemSelectionModel::currentRowChanged,
+                this, [=](const QModelIndex& cur, const QModelIndex&){
+                    updateCounter();
+                    showImageForRow(cur.row());
+                });
     }
 
-    auto loadImagesFromDirLambda = [this, &updateCounter, &showImageForRow](const QString& dir){
-        if (!ui->listFiles) return;
-        QDir d(dir);
-        const QStringList exts = {"*.jpg","*.jpeg","*.png","*.bmp","*.tif","*.tiff",
-                                  "*.JPG","*.JPEG","*.PNG","*.TIF","*.TIFF"};
-        const QStringList files = d.entryList(exts, QDir::Files, QDir::Name);
-
-        bool prev = ui->listFiles->blockSignals(true);
-        ui->listFiles->clear();
-        for (const QString& f : files) {
-            auto* it = new QListWidgetItem(f);
-            it->setData(Qt::UserRole, d.absoluteFilePath(f));
-            ui->listFiles->addItem(it);
-        }
-        ui->listFiles->blockSignals(prev);
-
-        if (!files.isEmpty()) {
-            ui->listFiles->setCurrentRow(0);
-
-            QPointer<QListWidget> list    = ui->listFiles;
-            QPointer<QLabel>      counter = ui->lblCounter;
-            QPointer<AnnotatorWidget> annot = ui->annotView;
-            QPointer<QLabel>      info    = ui->lblAnnotInfo;
-            QPointer<QPlainTextEdit> log  = ui->txtLog;
+    // Klasör taraması arka planda akar: parçalar geldikçe listeye eklenir,
+    // bitince ada göre sıralanır ve (seçim yoksa) ilk görsel açılır.
+    connect(&DirScanner::instance(), &DirScanner::chunk, this,
+            [this, updateCounter](quint64 ticket, const QString&, const QStringList& names){
+                if (ticket != m_scanTicket || !m_fileModel) return;
+                m_fileModel->appendFiles(names);
+                updateCounter();
+            });
+    connect(&DirScanner::instance(), &DirScanner::finished, this,
+            [this, updateCounter, showImageForRow](quint64 ticket, const QString& dir,
+                                                   const QStringList&, bool cancelled){
+                if (ticket != m_scanTicket) return;
+                m_scanTicket = 0;
+                const auto done = std::move(m_scanDone);
+                m_scanDone = nullptr;
+                if (cancelled || !m_fileModel || !ui->listFiles) return;
+
+                m_fileModel->sortByName();
+                const int total = m_fileModel->totalCount();
+                if (total > 0 && !ui->listFiles->currentIndex().isValid()) {
+                    QItemSelectionModel* sel = ui->listFiles->selectionModel();
+                    const bool prev = sel ? sel->blockSignals(true) : false;
+                    ui->listFiles->setCurrentIndex(m_fileModel->index(0));
+                    if (sel) sel->blockSignals(prev);
+                    if (!done) showImageForRow(0);      // done varsa annotator'ı o kurar
+                }
+                updateCounter();
 
-            QMetaObject::invokeMethod(this, [list, counter, annot, info, log]{
-                if (!list) return;
-                const int r = list->currentRow();
+                if (ui->txtPredLog)
+                    ui->txtPredLog->appendPlainText(QString("Loaded %1 images from %2").arg(total).arg(dir));
+                if (done) done(total);
+            });
 
-                if (counter) {
-                    const int total = list->count();
-                    counter->setText(QString("%1 / %2").arg(total ? r+1 : 0).arg(total));
-                }
+    auto loadImagesFromDirLambda = [this, updateCounter](const QString& dir, std::function<void(int)> onDone){
+        if (!ui->listFiles || !m_fileModel) return;
+        DirScanner& scanner = DirScanner::instance();
+        if (m_scanTicket) scanner.cancel(m_scanTicket);   // önceki tarama hâlâ sürüyorsa bırak
 
-                if (r >= 0) {
-                    if (QListWidgetItem* item = list->item(r)) {
-                        QString path = item->data(Qt::UserRole).toString();
-                        if (path.isEmpty()) path = item->text();
-                        if (!path.isEmpty()) {
-                            if (annot) annot->loadImage(path);
-                            if (info)  info->setText(QFileInfo(path).fileName() + " yüklendi");
-                            if (log)   log->appendPlainText("Loaded image: " + path);
-                        }
-                    }
-                }
-            }, Qt::QueuedConnection);
-        } else {
-            updateCounter();
-        }
+        QItemSelectionModel* sel = ui->listFiles->selectionModel();
+        const bool prev = sel ? sel->blockSignals(true) : false;
+        m_fileModel->setDirectoryFiles(dir, {});
+        if (sel) sel->blockSignals(prev);
+        if (m_thumbCache && m_fileModel->thumbnailsEnabled()) m_thumbCache->setDataset(dir);
+        updateCounter();
 
-        if (ui->txtPredLog)
-            ui->txtPredLog->appendPlainText(QString("Loaded %1 images from %2").arg(files.size()).arg(dir));
+        m_scanDone   = std::move(onDone);
+        m_scanTicket = scanner.scan(dir);
     };
 
     // Annotator hızlı komutlar
@@ -730,18 +783,6 @@ MainWindow::MainWindow(QWidget *parent)
             }
         };
 
-        auto listImages = [](const QString& dir){
-            QStringList out;
-            QDir d(dir);
-            const QStringList filters = {
-                "*.png","*.jpg","*.jpeg","*.bmp","*.tif","*.tiff",
-                "*.PNG","*.JPG","*.JPEG","*.BMP","*.TIF","*.TIFF"
-            };
-            for (const QString& f : d.entryList(filters, QDir::Files, QDir::Name))
-                out << d.absoluteFilePath(f);
-            return out;
-        };
-
         if (ui->btnAnnotOpen) {
             connect(ui->btnAnnotOpen, &QPushButton::clicked, this, [this, annot, ensureSaveDir]{
                 if (!annot) return;
@@ -758,20 +799,18 @@ MainWindow::MainWindow(QWidget *parent)
 
                 if (ui->lblAnnotInfo) ui->lblAnnotInfo->setText(QFileInfo(path).fileName());
 
-                if (ui->listFiles) {
-                    bool prev = ui->listFiles->blockSignals(true);
-                    ui->listFiles->clear();
-                    auto* it = new QListWidgetItem(QFileInfo(path).fileName());
-                    it->setData(Qt::UserRole, path);
-                    ui->listFiles->addItem(it);
-                    ui->listFiles->setCurrentRow(0);
-                    ui->listFiles->blockSignals(prev);
+                if (ui->listFiles && m_fileModel) {
+                    QItemSelectionModel* sel = ui->listFiles->selectionModel();
+                    const bool prev = sel ? sel->blockSignals(true) : false;
+                    m_fileModel->setPaths(QStringList{path});
+                    ui->listFiles->setCurrentIndex(m_fileModel->index(0));
+                    if (sel) sel->blockSignals(prev);
                 }
             });
         }
 
         if (ui->btnAnnotOpenDir) {
-            connect(ui->btnAnnotOpenDir, &QPushButton::clicked, this, [this, annot, listImages, ensureSaveDir, loadImagesFromDirLambda]{
+            connect(ui->btnAnnotOpenDir, &QPushButton::clicked, this, [this, annot, ensureSaveDir, loadImagesFromDirLambda]{
                 if (!annot) {
                     QMessageBox::warning(this, tr("Annotator yok"), tr("Annotator widget bulunamadı."));
                     return;
@@ -779,36 +818,37 @@ MainWindow::MainWindow(QWidget *parent)
                 const QString dir = getExistingDirectorySafe(this, tr("Görüntü klasörü seç"), QDir::homePath());
                 if (dir.isEmpty()) return;
 
-                const QStringList imgs = listImages(dir);
-                if (imgs.isEmpty()) {
-                    QMessageBox::information(this, tr("Boş klasör"),
-                                             tr("Bu klasörde desteklenen görsel bulunamadı."));
-                    return;
-                }
+                // Tarama arka planda; liste dolarken arayüz donmaz. Kurulum tarama bitince.
+                QPointer<AnnotatorWidget> A = annot;
+                loadImagesFromDirLambda(dir, [this, A, dir, ensureSaveDir](int total){
+                    if (!A) return;
+                    if (total == 0) {
+                        QMessageBox::information(this, tr("Boş klasör"),
+                                                 tr("Bu klasörde desteklenen görsel bulunamadı."));
+                        return;
+                    }
 
-                if (ui->leImages)
-                    ui->leImages->setText(QDir::toNativeSeparators(dir));
+                    if (ui->leImages)
+                        ui->leImages->setText(QDir::toNativeSeparators(dir));
 
-                if (ui->cbFormat) annot->setFormat(ui->cbFormat->currentText());
+                    if (ui->cbFormat) A->setFormat(ui->cbFormat->currentText());
 
-                QString out;
-                if (ui->cbFormat) {
-                    const bool isVOC = (ui->cbFormat->currentText()=="PascalVOC");
-                    out = QDir(dir).filePath(isVOC ? "labels_voc/train" : "labels_yolo/train");
-                    QDir().mkpath(out);
-                    annot->setSaveDir(out);
-                    if (ui->leLabels) ui->leLabels->setText(QDir::toNativeSeparators(out));
-                }
-                ensureSaveDir(annot);
+                    if (ui->cbFormat) {
+                        const bool isVOC = (ui->cbFormat->currentText()=="PascalVOC");
+                        const QString out = QDir(dir).filePath(isVOC ? "labels_voc/train" : "labels_yolo/train");
+                        QDir().mkpath(out);
+                        A->setSaveDir(out);
+                        if (ui->leLabels) ui->leLabels->setText(QDir::toNativeSeparators(out));
+                    }
+                    ensureSaveDir(A);
 
-                annot->setImageList(imgs, 0);
-                annot->loadImage(imgs.first());
+                    // Liste ve annotator aynı modeli paylaşır (yol listesi kopyalanmaz)
+                    const int row = ui->listFiles ? qMax(0, ui->listFiles->currentIndex().row()) : 0;
+                    A->setImageModel(m_fileModel, row);
 
-                if (ui->lblAnnotInfo) ui->lblAnnotInfo->setText(QFileInfo(imgs.first()).fileName());
+                    if (ui->lblAnnotInfo) ui->lblAnnotInfo->setText(QFileInfo(A->currentImage()).fileName());
+                });
 
-                if (ui->listFiles) {
-                    loadImagesFromDirLambda(dir);
-                }
                 if (ui->tabWidget && ui->tab_3) {
                     ui->tabWidget->setCurrentWidget(ui->tab_3);
                 }
@@ -841,6 +881,302 @@ MainWindow::MainWindow(QWidget *parent)
                 }
             });
         }
+
+        // Burst: kutuları sonraki kareye taşı (öneri olarak; Enter kabul, Esc at)
+        if (ui->barTop && ui->barTop->layout()) {
+            auto *btnTrack = new QToolButton(ui->barTop);
+            btnTrack->setText(tr("Sonraki kareye taşı (T)"));
+            btnTrack->setToolTip(tr("Kutuları şablon takibiyle bir sonraki kareye öneri olarak taşır"));
+            ui->barTop->layout()->addWidget(btnTrack);
+            connect(btnTrack, &QToolButton::clicked, annot, &AnnotatorWidget::propagateToNext);
+
+            // Anahtar kareler: aradakiler doğrusal / spline ara değerle, track ID eşleşmesiyle
+            auto *btnKey = new QToolButton(ui->barTop);
+            btnKey->setText(tr("Anahtar kare"));
+            btnKey->setPopupMode(QToolButton::InstantPopup);
+            ui->barTop->layout()->addWidget(btnKey);
+            auto *kmenu = new QMenu(btnKey);
+            connect(kmenu->addAction(tr("Anahtar kare yap (K)")), &QAction::triggered, annot, &AnnotatorWidget::markKeyframe);
+            connect(kmenu->addAction(tr("Anahtar kareyi kaldır (Shift+K)")), &QAction::triggered, annot, &AnnotatorWidget::unmarkKeyframe);
+            kmenu->addSeparator();
+            auto *grp = new QActionGroup(kmenu);
+            auto *actLinear = kmenu->addAction(tr("Doğrusal"));
+            auto *actSpline = kmenu->addAction(tr("Spline"));
+            for (QAction* a : {actLinear, actSpline}) { a->setCheckable(true); grp->addAction(a); }
+            actLinear->setChecked(annot->interpolationMode() == KeyframeTracks::Mode::Linear);
+            actSpline->setChecked(annot->interpolationMode() == KeyframeTracks::Mode::Spline);
+            connect(actLinear, &QAction::triggered, annot, [annot]{ annot->setInterpolationMode(KeyframeTracks::Mode::Linear); });
+            connect(actSpline, &QAction::triggered, annot, [annot]{ annot->setInterpolationMode(KeyframeTracks::Mode::Spline); });
+            kmenu->addSeparator();
+            connect(kmenu->addAction(tr("Ara kareleri yaz")), &QAction::triggered, annot, &AnnotatorWidget::commitInterpolated);
+            btnKey->setMenu(kmenu);
+
+            // Çizim bitince kutuyu kenarlara yapıştır (R ile elle de)
+            auto *chkSnap = new QCheckBox(tr("Kenara yapıştır"), ui->barTop);
+            chkSnap->setToolTip(tr("Yeni kutunun kenarlarını en yakın güçlü kenara oturtur (R: seçili kutu)"));
+            chkSnap->setChecked(annot->autoSnap());
+            ui->barTop->layout()->addWidget(chkSnap);
+            connect(chkSnap, &QCheckBox::toggled, annot, &AnnotatorWidget::setAutoSnap);
+
+            // Ön etiketleme: dedektör sonraki K görsel için arka planda öneri üretir
+            m_preannotator = new PreAnnotator(this);
+            annot->setPreAnnotator(m_preannotator);
+            auto *btnPre = new QToolButton(ui->barTop);
+            btnPre->setText(tr("Ön etiket"));
+            btnPre->setPopupMode(QToolButton::InstantPopup);
+            ui->barTop->layout()->addWidget(btnPre);
+            auto *pmenu = new QMenu(btnPre);
+            auto *pgrp  = new QActionGroup(pmenu);
+            auto *actOff    = pmenu->addAction(tr("Kapalı"));
+            auto *actPython = pmenu->addAction(tr("Python dedektörü (python/detect_worker.py)"));
+            for (QAction* a : {actOff, actPython}) { a->setCheckable(true); pgrp->addAction(a); }
+            actOff->setChecked(true);
+            connect(actOff, &QAction::triggered, this, [this]{ m_preannotator->setBackend(nullptr); });
+            connect(actPython, &QAction::triggered, this, [this, annot]{
+                const QString py     = venvPythonPath();
+                const QString script = scriptPath("python/detect_worker.py");
+                if (!QFileInfo::exists(script)) {
+                    if (statusBar()) statusBar()->showMessage(tr("Dedektör betiği bulunamadı: %1").arg(script), 4000);
+                    return;
+                }
+                // Eğitilmiş dedektör varsa o, yoksa COCO ön eğitimli ağırlıklar
+                QStringList args{script};
+                const QString model   = QDir::toNativeSeparators(projectRoot() + "/model_out/detector_best.pth");
+                const QString classes = QDir::toNativeSeparators(projectRoot() + "/classes.txt");
+                if (QFileInfo::exists(model)) {
+                    args << "--model" << model;
+                    if (QFileInfo::exists(classes)) args << "--classes" << classes;
+                }
+                m_preannotator->setBackend(std::make_shared<ProcessDetector>(py, args, makePythonEnv(), projectRoot()));
+                annot->setPreAnnotator(m_preannotator);      // mevcut pencereyi hemen iste
+            });
+            pmenu->addSeparator();
+            auto *kgrp = new QActionGroup(pmenu);
+            for (int k : {2, 4, 8, 16}) {
+                auto *a = pmenu->addAction(tr("İleri bakış: %1 görsel").arg(k));
+                a->setCheckable(true);
+                a->setChecked(k == m_preannotator->lookAhead());
+                kgrp->addAction(a);
+                connect(a, &QAction::triggered, this, [this, k]{ m_preannotator->setLookAhead(k); });
+            }
+            btnPre->setMenu(pmenu);
+            connect(m_preannotator, &PreAnnotator::proposalsReady, this, [this](const QString& path, int n){
+                if (statusBar()) statusBar()->showMessage(tr("Öneri hazır: %1 (%2)").arg(QFileInfo(path).fileName()).arg(n), 1500);
+            });
+
+            // Karşılaştırma inceleme kuyruğu: eval/review_*.review (toplu karşılaştırma sonunda yazılır)
+            auto *btnReview = new QToolButton(ui->barTop);
+            btnReview->setText(tr("İnceleme"));
+            btnReview->setPopupMode(QToolButton::InstantPopup);
+            ui->barTop->layout()->addWidget(btnReview);
+            auto *rmenu = new QMenu(btnReview);
+            rmenu->addAction(tr("Kayıtlı kuyruğu aç…"), this, [this]{
+                const QString path = QFileDialog::getOpenFileName(this, tr("İnceleme kuyruğu"), projectRoot() + "/eval",
+                                                                  tr("İnceleme kuyruğu (*.review)"));
+                if (path.isEmpty()) return;
+                ReviewQueue queue;
+                QString err;
+                if (!queue.load(path, &err)) {
+                    if (ui->txtLog) ui->txtLog->appendPlainText(QString("[review] %1 açılamadı: %2").arg(path, err));
+                    return;
+                }
+                openReview(queue);
+            });
+            connect(rmenu->addAction(tr("İncelemeden çık")), &QAction::triggered, annot, &AnnotatorWidget::stopReview);
+            btnReview->setMenu(rmenu);
+        }
+
+        // Oto-kaydet: görsel değişirken kaydedilmemiş kutular arka planda yazılır
+        if (ui->barTop && ui->barTop->layout()) {
+            auto *chkAutosave = new QCheckBox(tr("Oto-kaydet"), ui->barTop);
+            chkAutosave->setObjectName("chkAutosave");
+            chkAutosave->setChecked(annot->autosave());
+            ui->barTop->layout()->addWidget(chkAutosave);
+            ui->barTop->resize(ui->barTop->width(), ui->barTop->sizeHint().height());
+            connect(chkAutosave, &QCheckBox::toggled, annot, &AnnotatorWidget::setAutosave);
+
+            // Tek dosya deposu: <labels>/annotations.annstore (+ .wal). Etiket dosyaları yine yazılır.
+            m_annStore = new AnnotationStore(this);
+            auto *chkStore = new QCheckBox(tr("Tek dosya deposu"), ui->barTop);
+            chkStore->setObjectName("chkAnnStore");
+            chkStore->setToolTip(tr("Kutuları veri seti genelinde tek sütunlu dosyada da tut (WAL ile)"));
+            auto *btnStore = new QToolButton(ui->barTop);
+            btnStore->setText(tr("Depo…"));
+            btnStore->setPopupMode(QToolButton::InstantPopup);
+            btnStore->setEnabled(false);
+            ui->barTop->layout()->addWidget(chkStore);
+            ui->barTop->layout()->addWidget(btnStore);
+            ui->barTop->resize(ui->barTop->width(), ui->barTop->sizeHint().height());
+
+            auto logLine = [this](const QString& line){
+                if (ui && ui->txtLog) ui->txtLog->appendPlainText(line);
+            };
+            // Depo işleri kendi thread'lerinde; sonuçlar buraya döner (depo yıkılırken işleri bekler)
+            connect(m_annStore, &AnnotationStore::exported, this, [=](const QString& out, bool ok, const QString& err){
+                logLine(ok ? QString("[store] Dışa aktarıldı: %1").arg(out)
+                           : QString("[store] Dışa aktarım hatası (%1): %2").arg(out, err));
+            });
+            connect(m_annStore, &AnnotationStore::compacted, this, [=](bool ok, const QString& err){
+                if (ok) logLine("[store] WAL tabana katıldı");
+                else    logLine(QString("[store] Sıkıştırma hatası: %1").arg(err));
+            });
+            auto storeInputs = [this](QString* labels, bool* voc, QString* images, QStringList* classes){
+                *labels = ui->leLabels ? ui->leLabels->text().trimmed() : QString();
+                *voc    = (ui->cbFormat && ui->cbFormat->currentText() == "PascalVOC");
+                const QString img = ui->leImages ? ui->leImages->text().trimmed() : QString();
+                *images = QFileInfo(img).isDir() ? img : QString();
+                classes->clear();
+                QFile f(ui->leClasses ? ui->leClasses->text().trimmed() : QString());
+                if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                    while (!f.atEnd()) {
+                        const QString c = QString::fromUtf8(f.readLine()).trimmed();
+                        if (!c.isEmpty()) *classes << c;
+                    }
+                }
+            };
+            auto storePath = [this]{
+                const QString labels = ui->leLabels ? ui->leLabels->text().trimmed() : QString();
+                return labels.isEmpty() ? QString() : QDir(labels).filePath("annotations.annstore");
+            };
+
+            // Arka planda etiket klasöründen taban üret → GUI'de aç
+            auto buildAndOpen = [=](bool rebuild){
+                QString labels, images; bool voc = false; QStringList classes;
+                storeInputs(&labels, &voc, &images, &classes);
+                const QString path = storePath();
+                if (path.isEmpty() || !QFileInfo(labels).isDir()) {
+                    logLine("[store] Etiket klasörü yok; depo açılmadı");
+                    chkStore->setChecked(false);
+                    return;
+                }
+                annot->setAnnotationStore(nullptr);
+                m_annStore->close();
+                btnStore->setEnabled(false);
+
+                const bool needBuild = rebuild || !QFileInfo::exists(path);
+                if (needBuild && rebuild) QFile::remove(path + ".wal");   // eski WAL yeni tabana oynatılmasın
+                QPointer<MainWindow> self(this);
+                QThreadPool::globalInstance()->start([=]{
+                    QString err;
+                    const bool ok = !needBuild
+                        || AnnotationStore::buildFromLabels(labels, voc, images, classes, path, &err);
+                    QMetaObject::invokeMethod(self, [=]{
+                        if (!self || !chkStore->isChecked()) return;
+                        QString openErr;
+                        if (!ok || !m_annStore->open(path, &openErr)) {
+                            logLine(QString("[store] Açılamadı: %1").arg(ok ? openErr : err));
+                            chkStore->setChecked(false);
+                            return;
+                        }
+                        annot->setAnnotationStore(m_annStore);
+                        btnStore->setEnabled(true);
+                        logLine(QString("[store] %1 (%2 görsel)")
+                                    .arg(QDir::toNativeSeparators(path)).arg(m_annStore->imageCount()));
+                    }, Qt::QueuedConnection);
+                });
+            };
+
+            connect(chkStore, &QCheckBox::toggled, this, [=](bool on){
+                if (on) { buildAndOpen(false); return; }
+                annot->setAnnotationStore(nullptr);
+                m_annStore->close();
+                btnStore->setEnabled(false);
+            });
+
+            auto *menu = new QMenu(btnStore);
+            menu->addAction(tr("Etiket klasöründen yeniden kur"), this, [=]{ buildAndOpen(true); });
+            menu->addAction(tr("YOLO olarak dışa aktar…"), this, [=]{
+                const QString out = QFileDialog::getExistingDirectory(this, tr("YOLO çıktı klasörü"));
+                if (out.isEmpty()) return;
+                m_annStore->exportAsync(out, false, QString());
+            });
+            menu->addAction(tr("PascalVOC olarak dışa aktar…"), this, [=]{
+                const QString out = QFileDialog::getExistingDirectory(this, tr("VOC çıktı klasörü"));
+                if (out.isEmpty()) return;
+                QString labels, images; bool voc = false; QStringList classes;
+                storeInputs(&labels, &voc, &images, &classes);
+                m_annStore->exportAsync(out, true, images);
+            });
+            menu->addAction(tr("Sıkıştır (WAL → taban)"), this, [=]{
+                logLine("[store] Sıkıştırılıyor…");
+                m_annStore->compactAsync();
+            });
+            btnStore->setMenu(menu);
+
+            // Biçim dönüştürücü: etiket klasörü (ya da seçilen COCO json) → hedef biçim
+            m_converter = new LabelConverter(this);
+            auto *btnConvert = new QToolButton(ui->barTop);
+            btnConvert->setText(tr("Dönüştür…"));
+            btnConvert->setPopupMode(QToolButton::InstantPopup);
+            ui->barTop->layout()->addWidget(btnConvert);
+            ui->barTop->resize(ui->barTop->width(), ui->barTop->sizeHint().height());
+
+            auto startConvert = [=](LabelConverter::Format to){
+                if (m_converter->isRunning()) { logLine("[convert] Önceki dönüştürme sürüyor"); return; }
+                QString labels, images; bool voc = false; QStringList classes;
+                storeInputs(&labels, &voc, &images, &classes);
+
+                LabelConverter::Job job;
+                job.to        = to;
+                job.imagesDir = images;
+                job.classes   = classes;
+                job.src       = labels;
+                if (!QFileInfo(labels).isDir() || LabelConverter::detectFormat(labels) == LabelConverter::Format::Unknown)
+                    job.src = getOpenFileNameSafe(this, tr("Kaynak COCO json"), labels, "COCO (*.json)");
+                if (job.src.isEmpty()) return;
+
+                if (to == LabelConverter::Format::COCO)
+                    job.dst = QFileDialog::getSaveFileName(this, tr("COCO çıktı dosyası"),
+                                                           QDir(labels).filePath("instances.json"), "COCO (*.json)");
+                else
+                    job.dst = QFileDialog::getExistingDirectory(this, tr("%1 çıktı klasörü")
+                                                                          .arg(LabelConverter::formatName(to)));
+                if (job.dst.isEmpty()) return;
+                if (!m_converter->start(job)) { logLine("[convert] Başlatılamadı (kaynak = hedef?)"); return; }
+                logLine(QString("[convert] %1 → %2 (%3)").arg(QDir::toNativeSeparators(job.src),
+                                                              LabelConverter::formatName(to),
+                                                              QDir::toNativeSeparators(job.dst)));
+            };
+            auto *cmenu = new QMenu(btnConvert);
+            cmenu->addAction(tr("→ YOLO"),      this, [=]{ startConvert(LabelConverter::Format::YOLO); });
+            cmenu->addAction(tr("→ PascalVOC"), this, [=]{ startConvert(LabelConverter::Format::VOC); });
+            cmenu->addAction(tr("→ COCO"),      this, [=]{ startConvert(LabelConverter::Format::COCO); });
+            cmenu->addSeparator();
+            cmenu->addAction(tr("COCO içe aktar…"), this, [=]{
+                if (m_converter->isRunning()) { logLine("[convert] Önceki dönüştürme sürüyor"); return; }
+                QString labels, images; bool voc = false; QStringList classes;
+                storeInputs(&labels, &voc, &images, &classes);
+                if (labels.isEmpty()) { logLine("[convert] Önce etiket klasörünü seçin"); return; }
+
+                LabelConverter::Job job;
+                job.from      = LabelConverter::Format::COCO;
+                job.to        = voc ? LabelConverter::Format::VOC : LabelConverter::Format::YOLO;
+                job.src       = getOpenFileNameSafe(this, tr("COCO instances.json"), labels, "COCO (*.json)");
+                job.dst       = labels;
+                job.imagesDir = images;
+                job.classes   = classes;
+                if (job.src.isEmpty()) return;
+                if (!m_converter->start(job)) { logLine("[convert] Başlatılamadı"); return; }
+                logLine(QString("[convert] COCO içe aktarılıyor → %1 (%2)")
+                            .arg(QDir::toNativeSeparators(labels), LabelConverter::formatName(job.to)));
+            });
+            cmenu->addAction(tr("Durdur"), m_converter, &LabelConverter::cancel);
+            btnConvert->setMenu(cmenu);
+
+            connect(m_converter, &LabelConverter::progress, this, [this](int done, int total){
+                if (statusBar()) statusBar()->showMessage(tr("Dönüştürülüyor: %1 / %2").arg(done).arg(total));
+            });
+            connect(m_converter, &LabelConverter::finished, this, [=](const LabelConverter::Report& r){
+                const QString head = QString("[convert] %1/%2 görsel, %3 kutu, %4 hata, %5 ms%6")
+                                         .arg(r.converted).arg(r.total).arg(r.boxes).arg(r.failed)
+                                         .arg(r.elapsedMs).arg(r.cancelled ? " (iptal)" : "");
+                logLine(head);
+                for (int i = 0; i < qMin(20, int(r.errors.size())); ++i) logLine("  " + r.errors[i]);
+                if (r.errors.size() > 20)
+                    logLine(QString("  … (%1 hata daha, convert_errors.txt)").arg(r.errors.size() - 20));
+                if (statusBar()) statusBar()->showMessage(head.mid(10), 5000);
+            });
+        }
     }
 }
 
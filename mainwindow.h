@@ -7,6 +7,7 @@
 #include <QFileDialog>          // QFileDialog::Options
 #include <QProcessEnvironment>  // makePythonEnv() dönüş tipi
 #include <QStandardPaths>       // projectRoot() için
+#include <functional>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class btnLoadClasses; }  // .ui içindeki <class>btnLoadClasses</class> ile eşleşir
@@ -23,6 +24,18 @@ class QProcess;
 class QResizeEvent;
 
 class QListWidget;
+class QListView;
+class ImageListModel;
+class LabelCounter;
+class ThumbnailCache;
+class AnnotationStore;
+class LabelConverter;
+class PreAnnotator;
+class LabelCompare;
+class DetectionEval;
+class LabelAgreement;
+class ReviewQueue;
+enum class MatchMode;                 // labelcompare.h
 class QComboBox;
 class QLineEdit;
 class QCheckBox;
@@ -74,14 +87,26 @@ private slots:
     // --- Karşılaştırma yardımcı slotu ---
     void compareCurrentImageAgainstLabelImg();      // ← yalnız deklarasyon
 
+    // --- Dedektör değerlendirmesi (COCO mAP) ---
+    void on_btnEvalMap_clicked();
+
+    // --- Çok annotator'lu uyum analizi ---
+    void on_btnAgreement_clicked();
+
 private:
     // -------- Yardımcılar --------
     QString makeSavePath() const;
     QString makeFileName() const;
     QString classDir() const;
     void    populateLabelsFromDir();
+    MatchMode compareMatchMode() const;             // cmbMatchMode → Greedy/Optimal/PerClass
+    void    openReview(const ReviewQueue& queue);   // annotator'da anlaşmazlık sırasıyla inceleme
+    // leImages girdisi (dosya / klasör / ';' listesi) → ilk görsel; klasör arka planda taranır,
+    // then GUI thread'de çağrılır (bulunamazsa boş yol). Yeni çağrı bekleyen taramayı iptal eder.
+    void    withFirstImage(const QString& src, std::function<void(const QString& path)> then);
+    void    startLabelingWith(const QString& openArg);
+    void    startLabelImgWith(const QString& openArg);
     void    startInferProcess(const QString& imagePath);
-    int     countLabelFiles(const QString& dirPath, const QStringList& exts) const;
     void    updateLabelCount();
 
     // ====== Dosya diyalogları (SAFE) — SADECE ana imzalar ======
@@ -109,7 +134,6 @@ private:
         ) const;
 
     // ====== Görsel listeleri ======
-    QStringList listImagesCaseInsensitive(const QString& dirPath) const;
     QStringList loadImageListTxt(const QString& listTxtPath) const;
 
     // ====== Python / Proje yolları ve ortam ======
@@ -163,8 +187,21 @@ private:
     QProcess* m_trainProc = nullptr;
     QProcess* m_inferProc = nullptr;
 
-    // Sayaç
-    QTimer    m_labelCountTimer;
+    // Sayaç: etiket klasörü bildirimlerle izlenir (periyodik tarama yok)
+    LabelCounter* m_labelCounter = nullptr;
+
+    // Files sekmesi: sanal dosya listesi modeli (listFiles)
+    ImageListModel* m_fileModel = nullptr;
+    ThumbnailCache* m_thumbCache = nullptr;          // Files: küçük resim modu
+    AnnotationStore* m_annStore  = nullptr;          // Annotator: isteğe bağlı tek dosya deposu
+    LabelConverter*  m_converter = nullptr;          // YOLO ↔ VOC ↔ COCO toplu dönüştürme
+    PreAnnotator*    m_preannotator = nullptr;       // Annotator: dedektör önerileri (ileri bakış)
+    LabelCompare*    m_compare   = nullptr;          // LabelImg karşılaştırması: veri seti geneli, paralel
+    DetectionEval*   m_eval      = nullptr;          // tahmin ↔ GT mAP değerlendirmesi
+    LabelAgreement*  m_agreement = nullptr;          // N annotator uyumu + konsensüs
+    quint64                   m_scanTicket = 0;   // DirScanner: listFiles'ı dolduran aktif tarama
+    std::function<void(int)>  m_scanDone;         // tarama bitince (toplam görsel sayısı)
+    quint64                   m_firstImageScan = 0;   // DirScanner: withFirstImage taraması
 
     // Video genişlik kilidi durumu
     int       m_lockedVideoW = -1;   // -1: kilit yok, >=0: kilitli genişlik (px)
@@ -5,6 +5,14 @@
 #include "annotatorwidget.h"
 #include "ui_mainwindow.h"
 #include "label_utils.h"        // <<< EKLENDİ
+#include "imagelistmodel.h"
+#include "dirscanner.h"
+#include "labelcounter.h"
+#include "labelcompare.h"
+#include "detectioneval.h"
+#include "labelagreement.h"
+#include "reviewqueue.h"
+#include "comparereport.h"
 
 #include <QFileDialog>
 #include <QFileInfo>
@@ -17,12 +25,14 @@
 #include <QTimer>
 #include <QDateTime>
 #include <QListWidget>
+#include <QListView>
 #include <QPlainTextEdit>
 #include <QComboBox>
 #include <QLineEdit>
 #include <QCheckBox>
 #include <QLabel>
 #include <QPointer>
+#include <QThreadPool>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QSet>
@@ -74,11 +84,7 @@ void MainWindow::on_btnStartLabel_clicked()
     // “Ben durdurmadan durmasın” → yeniden tıklamayı engelle
     if (ui->btnStartLabel) ui->btnStartLabel->setEnabled(false);
 
-    if (ui->leLabels && ui->lblLabelCount && !ui->leLabels->text().isEmpty()) {
-        QDir d(ui->leLabels->text());
-        const int n = d.entryList(QStringList() << "*.txt", QDir::Files).size();
-        ui->lblLabelCount->setText(QString("Etiket dosyası: %1").arg(n));
-    }
+    updateLabelCount();
 }
 
 // ======================================================================
@@ -142,46 +148,42 @@ void MainWindow::chooseLabelsDir()
 // ======================================================================
 // 3) LabelImg Akışı: startLabeling + launchLabelImg
 // ======================================================================
-// Yardımcı: klasörden görsel listele (case-insensitive) ve mutlak yollar döndür
-static QStringList listImagesCI(const QString& dir)
+// Yardımcı: kullanıcı girişi (dosya/klasör/; ile liste) → ilk geçerli görsel.
+// Klasör GUI thread'de gezilmez: paylaşılan tarayıcı (önbellekli) bitince ada göre ilk görsel
+void MainWindow::withFirstImage(const QString& src, std::function<void(const QString& path)> then)
 {
-    QStringList out;
-    QDir d(dir);
-    const QStringList files = d.entryList(QDir::Files, QDir::Name);
-    for (const QString& f : files) {
-        const QString ext = QFileInfo(f).suffix().toLower();
-        if (QStringList{"png","jpg","jpeg","bmp","tif","tiff"}.contains(ext))
-            out << QDir(dir).absoluteFilePath(f);
-    }
-    return out;
-}
+    if (m_firstImageScan) DirScanner::instance().cancel(m_firstImageScan);
+    m_firstImageScan = 0;
 
-// Yardımcı: kullanıcı girişi (dosya/klasör/; ile liste) → ilk geçerli görsel
-static QString firstImageFromInput(const QString& src)
-{
     if (src.contains(';')) {
         const QStringList parts = src.split(';', Qt::SkipEmptyParts);
         for (const QString& p : parts) {
             QFileInfo fi(p.trimmed());
-            if (fi.exists() && fi.isFile()) return QDir::toNativeSeparators(fi.absoluteFilePath());
+            if (fi.exists() && fi.isFile()) { then(QDir::toNativeSeparators(fi.absoluteFilePath())); return; }
         }
     }
     QFileInfo fi(src);
-    if (fi.isFile()) return QDir::toNativeSeparators(fi.absoluteFilePath());
-    if (fi.isDir()) {
-        const QStringList imgs = listImagesCI(fi.absoluteFilePath());
-        if (!imgs.isEmpty()) return QDir::toNativeSeparators(QFileInfo(imgs.first()).absoluteFilePath());
-    }
-    return {};
+    if (fi.isFile()) { then(QDir::toNativeSeparators(fi.absoluteFilePath())); return; }
+    if (!fi.isDir()) { then(QString()); return; }
+
+    if (statusBar()) statusBar()->showMessage(tr("Taranıyor: %1").arg(QDir::toNativeSeparators(fi.absoluteFilePath())));
+    auto ticket = std::make_shared<quint64>(0);
+    *ticket = m_firstImageScan = DirScanner::instance().listImagesAsync(fi.absoluteFilePath(), this,
+        [this, ticket, then](const QStringList& imgs){
+            if (m_firstImageScan != *ticket) return;
+            m_firstImageScan = 0;
+            if (statusBar()) statusBar()->clearMessage();
+            then(imgs.isEmpty() ? QString() : QDir::toNativeSeparators(imgs.first()));
+        });
 }
 
 // Listedeki seçili öğeden mutlak dosya yolu üret
-static QString currentFromList(QListWidget* list)
+static QString currentFromList(QListView* list)
 {
-    if (!list || !list->currentItem()) return {};
-    auto *it = list->currentItem();
-    QString p = it->data(Qt::UserRole).toString();
-    if (p.isEmpty()) p = it->text();
+    if (!list || !list->currentIndex().isValid()) return {};
+    const QModelIndex it = list->currentIndex();
+    QString p = it.data(ImageListModel::PathRole).toString();
+    if (p.isEmpty()) p = it.data(Qt::DisplayRole).toString();
     if (p.isEmpty()) return {};
     return QDir::toNativeSeparators(QFileInfo(p).absoluteFilePath());
 }
@@ -200,9 +202,14 @@ void MainWindow::startLabeling()
             QMessageBox::warning(this, tr("Eksik bilgi"), tr("Görüntü veya klasör seçin."));
             return;
         }
-        openArg = firstImageFromInput(src);
+        withFirstImage(src, [this](const QString& first){ startLabelingWith(first); });
+        return;
     }
+    startLabelingWith(openArg);
+}
 
+void MainWindow::startLabelingWith(const QString& openArg)
+{
     const QString classesTxt = ui->leClasses ? ui->leClasses->text().trimmed() : QString();
     const QString labelsDir  = ui->leLabels  ? ui->leLabels->text().trimmed()  : QString();
     const QString format     = ui->cbFormat  ? ui->cbFormat->currentText()     : QString("YOLO");
@@ -343,23 +350,13 @@ void MainWindow::launchLabelImg(const QString& imagesDir,
 // ======================================================================
 // 4) Etiket Dosyası Sayacı
 // ======================================================================
-int MainWindow::countLabelFiles(const QString& dirPath, const QStringList& exts) const
-{
-    QDir d(dirPath); int total = 0;
-    for (const auto& e : exts)
-        total += d.entryList({ "*."+e }, QDir::Files).size();
-    return total;
-}
-
 void MainWindow::updateLabelCount()
 {
-    if (!ui->lblLabelCount) return;
+    // Sayım LabelCounter'da; burada sadece izlenecek klasör/uzantı güncellenir
+    if (!m_labelCounter) return;
     const QString out = ui->leLabels ? ui->leLabels->text().trimmed() : QString();
-    if (out.isEmpty()) { ui->lblLabelCount->setText("Etiket dosyası: 0"); return; }
-
-    const bool isVOC = (ui->cbFormat && ui->cbFormat->currentText() == "PascalVOC");
-    const int n = countLabelFiles(out, isVOC ? QStringList{"xml"} : QStringList{"txt"});
-    ui->lblLabelCount->setText(QString("Etiket dosyası: %1").arg(n));
+    const bool isVOC  = (ui->cbFormat && ui->cbFormat->currentText() == "PascalVOC");
+    m_labelCounter->setDirectory(out, isVOC ? "xml" : "txt");
 }
 
 // ======================================================================
@@ -411,6 +408,7 @@ void MainWindow::openAnnotatorInNewWindow()
     QPushButton *bPrev   = new QPushButton(tr("← Önceki"), bar);
     QPushButton *bNext   = new QPushButton(tr("Sonraki →"), bar);
     QPushButton *bSave   = new QPushButton(tr("Kaydet"), bar);
+    QCheckBox   *cAuto   = new QCheckBox(tr("Oto-kaydet"), bar);
     QPushButton *bBack   = new QPushButton(tr("← Geri Dön"), bar);
     QLabel      *infoLbl = new QLabel(tr("Hazır"), bar);
 
@@ -421,6 +419,7 @@ void MainWindow::openAnnotatorInNewWindow()
     hb->addWidget(bNext);
     hb->addSpacing(10);
     hb->addWidget(bSave);
+    hb->addWidget(cAuto);
     hb->addStretch(1);
     hb->addWidget(infoLbl);
     hb->addSpacing(10);
@@ -455,20 +454,10 @@ void MainWindow::openAnnotatorInNewWindow()
         A->setSaveDir(outDir);
     }
 
-    if (ui->listFiles && ui->listFiles->count() > 0) {
-        QStringList imgs;
-        imgs.reserve(ui->listFiles->count());
-        for (int i=0;i<ui->listFiles->count();++i) {
-            auto *it = ui->listFiles->item(i);
-            QString p = it->data(Qt::UserRole).toString();
-            if (p.isEmpty()) p = it->text();
-            if (!p.isEmpty()) imgs << QDir::toNativeSeparators(QFileInfo(p).absoluteFilePath());
-        }
-        if (!imgs.isEmpty()) {
-            A->setImageList(imgs, qMax(0, ui->listFiles->currentRow()));
-            A->loadImage(imgs.value(qMax(0, ui->listFiles->currentRow())));
-            infoLbl->setText(QFileInfo(A->currentImage()).fileName());
-        }
+    if (ui->listFiles && m_fileModel && m_fileModel->totalCount() > 0) {
+        // Yol listesi kopyalanmaz: pencere ana listeyle aynı modeli paylaşır
+        A->setImageModel(m_fileModel, qMax(0, ui->listFiles->currentIndex().row()));
+        infoLbl->setText(QFileInfo(A->currentImage()).fileName());
     } else if (ui->annotView && !ui->annotView->currentImage().isEmpty()) {
         const QString cur = ui->annotView->currentImage();
         A->setImageList(QStringList{cur}, 0);
@@ -508,12 +497,13 @@ void MainWindow::openAnnotatorInNewWindow()
             w, tr("Görüntü klasörü seç"), QDir::homePath(), QFileDialog::Options()
             );
         if (dir.isEmpty()) return;
-        const QStringList imgs = listImagesCI(dir);
-        if (imgs.isEmpty()) return;
-        A->setImageList(imgs, 0);
-        A->loadImage(imgs.first());
-        ensureSaveDir(A, dir);
-        infoLbl->setText(QFileInfo(imgs.first()).fileName());
+        infoLbl->setText(tr("Taranıyor: %1").arg(QDir::toNativeSeparators(dir)));
+        DirScanner::instance().listImagesAsync(dir, A, [=](const QStringList& imgs){
+            if (imgs.isEmpty()) { infoLbl->setText(tr("Görsel yok")); return; }
+            A->setImageList(imgs, 0);       // ilk görseli de yükler
+            ensureSaveDir(A, dir);
+            infoLbl->setText(QFileInfo(imgs.first()).fileName());
+        });
     });
 
     QObject::connect(bPrev, &QPushButton::clicked, w, [=]{
@@ -530,6 +520,7 @@ void MainWindow::openAnnotatorInNewWindow()
         else
             infoLbl->setText(tr("Kaydedildi: %1").arg(QFileInfo(A->currentImage()).completeBaseName()));
     });
+    QObject::connect(cAuto, &QCheckBox::toggled, A, &AnnotatorWidget::setAutosave);
     QObject::connect(bBack, &QPushButton::clicked, w, [w]{ w->close(); });
 
     w->show();
@@ -642,9 +633,14 @@ void MainWindow::on_btnStartLabelImg_clicked()
             QMessageBox::warning(this, tr("Uyarı"), tr("Önce görsel veya klasör seçin."));
             return;
         }
-        openArg = firstImageFromInput(src);
+        withFirstImage(src, [this](const QString& first){ startLabelImgWith(first); });
+        return;
     }
+    startLabelImgWith(openArg);
+}
 
+void MainWindow::startLabelImgWith(const QString& openArg)
+{
     if (openArg.isEmpty()) {
         QMessageBox::warning(this, tr("Uyarı"), tr("Açılacak uygun görsel bulunamadı."));
         return;
@@ -672,12 +668,13 @@ void MainWindow::on_btnStartLabelImg_clicked()
     if (ui->leLabels && QDir::cleanPath(ui->leLabels->text()) != QDir::cleanPath(P.saveDir))
         ui->leLabels->setText(P.saveDir);
 
-    // Klasörde en az 2 görsel var mı? (uyarı—akışı kesmek istemiyorsan return koyma)
-    if (!lu::hasAtLeastNImages(P.imagesDir, 2)) {
-        QMessageBox::warning(this, "LabelImg",
-                             "Bu klasörde geçiş yapacak kadar görsel yok.\n\nKlasör: " + P.imagesDir);
-        // return; // istersen burada kesebilirsin
-    }
+    // Klasörde en az 2 görsel var mı? (yalnız uyarı, akışı kesmez → tarama arka planda, başlatma beklemez)
+    const QString imagesDir = P.imagesDir;
+    DirScanner::instance().listImagesAsync(imagesDir, this, [this, imagesDir](const QStringList& imgs){
+        if (imgs.size() < 2)
+            QMessageBox::warning(this, "LabelImg",
+                                 "Bu klasörde geçiş yapacak kadar görsel yok.\n\nKlasör: " + imagesDir);
+    });
 
     // --- Teşhis logları ---
     lu::logLaunch3(ui->txtPredLog, P); // imagesDir/classes/saveDir
@@ -696,200 +693,7 @@ void MainWindow::on_btnStartLabelImg_clicked()
 // 9) (GÜNCEL) YOLO ↔ XYXY/XYWH/VOC karşılaştırma (IoU)
 // ======================================================================
 
-// --- Biçim tespit/okuma yardımcıları ---
-enum class AnnFmt { YOLO, XYXY_NORM, XYXY_PIX, XYWH_NORM, XYWH_PIX, VOC_XML, UNKNOWN };
-
-static inline bool looksNormalized(double v) { return v >= 0.0 && v <= 1.0; }
-
-static AnnFmt detectFormatFromLine(const QString& line)
-{
-    const QString ln = line.trimmed();
-    if (ln.isEmpty()) return AnnFmt::UNKNOWN;
-    const QStringList t = ln.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-    if (t.isEmpty()) return AnnFmt::UNKNOWN;
-
-    // YOLO: 5+ token ve ilk token integer sınıf
-    bool okc=false; t[0].toInt(&okc);
-    if (okc && t.size() >= 5) return AnnFmt::YOLO;
-
-    // XY* varyantları: en az 4 sayı (sınıf başta/sonda olabilir)
-    int numCnt = 0;
-    for (const auto& s : t) { bool ok=false; s.toDouble(&ok); if (ok) ++numCnt; }
-    if (numCnt >= 4) {
-        double a=t[0].toDouble(), b=t[1].toDouble(), c=t[2].toDouble(), d=t[3].toDouble();
-        const bool allNorm = looksNormalized(a)&&looksNormalized(b)&&looksNormalized(c)&&looksNormalized(d);
-        if (c > a && d > b) return allNorm ? AnnFmt::XYXY_NORM : AnnFmt::XYXY_PIX; // x2>x1, y2>y1
-        return allNorm ? AnnFmt::XYWH_NORM : AnnFmt::XYWH_PIX;                     // x,y,w,h
-    }
-    return AnnFmt::UNKNOWN;
-}
-
-// Görsel kök klasörü (leImages dosya ise klasörü al)
-static QString normalizeImagesRoot(const QString& leImagesText)
-{
-    if (leImagesText.isEmpty()) return {};
-    QFileInfo fi(leImagesText);
-    if (fi.isFile()) return fi.absolutePath();
-    return fi.absoluteFilePath();
-}
-
-static QSize findImageSizeForStem(const QString& stem, const QString& imagesRootDir)
-{
-    if (imagesRootDir.isEmpty()) return {};
-    QDir d(imagesRootDir);
-    if (!d.exists()) return {};
-    const QStringList exts = {"png","jpg","jpeg","bmp","tif","tiff"};
-    for (const auto& e : exts) {
-        const QString p = d.absoluteFilePath(stem + "." + e);
-        if (QFileInfo::exists(p)) {
-            QImage img(p);
-            if (!img.isNull()) return img.size();
-        }
-    }
-    return {};
-}
-
-struct XYXY { int cls; double x1,y1,x2,y2; };
-
-// VOC XML → XYXY (0..1)
-static QVector<XYXY> readVOCxmlNorm(const QString& xmlPath)
-{
-    QVector<XYXY> out;
-    QFile f(xmlPath);
-    if (!f.open(QIODevice::ReadOnly|QIODevice::Text)) return out;
-    const QString xml = QString::fromUtf8(f.readAll());
-    f.close();
-
-    auto getTag = [&](const QString& tag)->QString{
-        QRegularExpression rx(QString("<%1>([^<]+)</%1>").arg(tag));
-        auto m = rx.match(xml);
-        return m.hasMatch() ? m.captured(1).trimmed() : QString();
-    };
-    const int W = getTag("width").toInt();
-    const int H = getTag("height").toInt();
-    if (W<=0 || H<=0) return out;
-
-    QRegularExpression rxObj("<object>([\\s\\S]*?)</object>");
-    auto it = rxObj.globalMatch(xml);
-    while (it.hasNext()) {
-        const QString seg = it.next().captured(1);
-        auto val = [&](const char* tag)->int{
-            QRegularExpression rr(QString("<%1>([^<]+)</%1>").arg(tag));
-            auto mm = rr.match(seg);
-            return mm.hasMatch() ? mm.captured(1).toInt() : 0;
-        };
-        const int xmin = val("xmin"), ymin = val("ymin"), xmax = val("xmax"), ymax = val("ymax");
-        if (xmax>xmin && ymax>ymin) {
-            XYXY b;
-            b.cls = 0; // sınıf haritası yoksa 0
-            b.x1 = double(xmin)/W; b.y1 = double(ymin)/H;
-            b.x2 = double(xmax)/W; b.y2 = double(ymax)/H;
-            out.push_back(b);
-        }
-    }
-    return out;
-}
-
-// TXT → XYXY (0..1): YOLO / XYXY / XYWH (norm veya piksel)
-static QVector<XYXY> readGenericNorm(const QString& annPath,
-                                     AnnFmt fmt,
-                                     const QSize& imgSzIfNeeded)
-{
-    QVector<XYXY> out;
-    if (fmt == AnnFmt::VOC_XML) return readVOCxmlNorm(annPath);
-
-    QFile f(annPath);
-    if (!f.open(QIODevice::ReadOnly|QIODevice::Text)) return out;
-    QTextStream ts(&f);
-
-    auto pushXYXY = [&](int cls, double x1,double y1,double x2,double y2){
-        XYXY b{cls,
-               std::max(0.0, std::min(1.0, x1)),
-               std::max(0.0, std::min(1.0, y1)),
-               std::max(0.0, std::min(1.0, x2)),
-               std::max(0.0, std::min(1.0, y2))};
-        if (b.x2>b.x1 && b.y2>b.y1) out.push_back(b);
-    };
-
-    while (!ts.atEnd()) {
-        const QString ln = ts.readLine().trimmed();
-        if (ln.isEmpty()) continue;
-        const QStringList t = ln.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-        if (t.isEmpty()) continue;
-
-        if (fmt == AnnFmt::YOLO) {
-            if (t.size() < 5) continue;
-            int cls = t[0].toInt();
-            double cx=t[1].toDouble(), cy=t[2].toDouble(), w=t[3].toDouble(), h=t[4].toDouble();
-            double x1=cx-w/2.0, y1=cy-h/2.0, x2=cx+w/2.0, y2=cy+h/2.0;
-            pushXYXY(cls,x1,y1,x2,y2);
-        } else if (fmt == AnnFmt::XYXY_NORM || fmt == AnnFmt::XYXY_PIX) {
-            if (t.size() < 4) continue;
-
-            // sınıf nerede? [cls x1 y1 x2 y2] ya da [x1 y1 x2 y2 cls]
-            int cls = 0;
-            double x1,y1,x2,y2;
-            bool firstIsInt=false; t[0].toInt(&firstIsInt);
-            if (t.size()>=5 && firstIsInt) {
-                cls = t[0].toInt();
-                x1  = t[1].toDouble(); y1 = t[2].toDouble();
-                x2  = t[3].toDouble(); y2 = t[4].toDouble();
-            } else {
-                x1  = t[0].toDouble(); y1 = t[1].toDouble();
-                x2  = t[2].toDouble(); y2 = t[3].toDouble();
-                if (t.size()>=5) cls = t[4].toInt();
-            }
-
-            if (fmt == AnnFmt::XYXY_PIX) {
-                if (imgSzIfNeeded.isEmpty()) continue;
-                x1/=imgSzIfNeeded.width();  x2/=imgSzIfNeeded.width();
-                y1/=imgSzIfNeeded.height(); y2/=imgSzIfNeeded.height();
-            }
-            pushXYXY(cls,x1,y1,x2,y2);
-        } else if (fmt == AnnFmt::XYWH_NORM || fmt == AnnFmt::XYWH_PIX) {
-            if (t.size() < 4) continue;
-
-            // XYWH için de [cls x y w h] ya da [x y w h cls] ihtimali
-            int cls = 0;
-            double x,y,w,h;
-            bool firstIsInt = false;
-            t[0].toInt(&firstIsInt);   // <<< DÜZELTME: sadece &firstIsInt kullan
-
-            if (t.size()>=5 && firstIsInt) {
-                cls = t[0].toInt();
-                x   = t[1].toDouble(); y = t[2].toDouble();
-                w   = t[3].toDouble(); h = t[4].toDouble();
-            } else {
-                x   = t[0].toDouble(); y = t[1].toDouble();
-                w   = t[2].toDouble(); h = t[3].toDouble();
-                if (t.size()>=5) cls = t[4].toInt();
-            }
-
-            if (fmt == AnnFmt::XYWH_PIX) {
-                if (imgSzIfNeeded.isEmpty()) continue;
-                x/=imgSzIfNeeded.width();  w/=imgSzIfNeeded.width();
-                y/=imgSzIfNeeded.height(); h/=imgSzIfNeeded.height();
-            }
-            // XYWH'yi sol-üst köşe kabul edip XYXY üret
-            double x1=x, y1=y, x2=x+w, y2=y+h;
-            pushXYXY(cls,x1,y1,x2,y2);
-        }
-    }
-    return out;
-}
-
-// IoU (XYXY norm)
-static double iouXYXY(const XYXY& a, const XYXY& b)
-{
-    const double ix1 = std::max(a.x1,b.x1), iy1 = std::max(a.y1,b.y1);
-    const double ix2 = std::min(a.x2,b.x2), iy2 = std::min(a.y2,b.y2);
-    const double iw = std::max(0.0, ix2-ix1), ih = std::max(0.0, iy2-iy1);
-    const double inter = iw*ih;
-    const double areaA = std::max(0.0, a.x2-a.x1) * std::max(0.0, a.y2-a.y1);
-    const double areaB = std::max(0.0, b.x2-b.x1) * std::max(0.0, b.y2-b.y1);
-    const double uni = areaA + areaB - inter;
-    return uni>0 ? inter/uni : 0.0;
-}
+// Biçim tespit/okuma, IoU ve eşleştirme: labelcompare.h
 
 // ---- TEK-GÖRSEL Karşılaştırma (Annotator'da açık olan) ----
 void MainWindow::compareCurrentImageAgainstLabelImg()
@@ -971,23 +775,13 @@ void MainWindow::compareCurrentImageAgainstLabelImg()
     }
 
     // 5) Biçimleri algıla + pikselse görsel boyutu
-    AnnFmt fmtA = pa.endsWith(".xml", Qt::CaseInsensitive) ? AnnFmt::VOC_XML : AnnFmt::YOLO;
-    AnnFmt fmtB = AnnFmt::UNKNOWN;
-    if (pb.endsWith(".xml", Qt::CaseInsensitive)) {
-        fmtB = AnnFmt::VOC_XML;
-    } else {
+    const AnnFmt fmtA = pa.endsWith(".xml", Qt::CaseInsensitive) ? AnnFmt::VOC_XML : AnnFmt::YOLO;
+    QByteArray bytesB;
+    {
         QFile fb(pb);
-        if (fb.open(QIODevice::ReadOnly|QIODevice::Text)) {
-            QTextStream ts(&fb);
-            QString firstLine;
-            while (!ts.atEnd() && firstLine.isEmpty()) {
-                const QString ln = ts.readLine().trimmed();
-                if (!ln.isEmpty()) firstLine = ln;
-            }
-            fb.close();
-            fmtB = detectFormatFromLine(firstLine);
-        }
+        if (fb.open(QIODevice::ReadOnly)) bytesB = fb.readAll();
     }
+    const AnnFmt fmtB = detectFormatFromBytes(bytesB, pb.endsWith(".xml", Qt::CaseInsensitive));
 
     QSize imgSz;
     // Eğer karşı taraf piksel formatıysa, doğrudan açık görselin boyutunu kullan
@@ -997,34 +791,33 @@ void MainWindow::compareCurrentImageAgainstLabelImg()
     }
 
     // 6) Kutuları oku (normalize XYXY)
-    QVector<XYXY> A = readGenericNorm(pa, fmtA, {});        // bizim
-    QVector<XYXY> B = readGenericNorm(pb, fmtB, imgSz);     // labelimg
-
-    // 7) Greedy eşleştirme (IoU)
+    ClassIndex clsA = loadClassIndex(QFileInfo(pa).absolutePath());
+    ClassIndex clsB = loadClassIndex(QFileInfo(pb).absolutePath());   // VOC adları → sınıf
+    if (clsA.isEmpty()) clsA = clsB;
+    if (clsB.isEmpty()) clsB = clsA;
+    QVector<XYXY> A = readGenericNorm(pa, fmtA, {}, &clsA);          // bizim
+    QVector<XYXY> B = parseGenericNorm(bytesB, fmtB, imgSz, &clsB);  // labelimg
+
+    // 7) Eşleştirme (IoU): greedy, optimal atama ya da sınıf bazlı (eşiksiz)
     QDoubleSpinBox* sb = this->findChild<QDoubleSpinBox*>("sbIou");
     const double thr = (sb && sb->value()>0.0) ? sb->value() : 0.90;
+    const MatchMode mode = compareMatchMode();
 
-    QVector<bool> usedB(B.size(), false);
-    int TP=0, MIS=0, FP=0, FN=0;
+    QVector<BoxMatch> pairs;
+    const MatchCounts mc = matchBoxes(mode, A, B, thr, &pairs);
+    const MatchCounts greedy = (mode == MatchMode::Optimal) ? matchGreedy(A, B, thr) : mc;
+    const int TP = mc.tp, MIS = mc.mis, FP = mc.fp, FN = mc.fn;
     QStringList detail;
-
-    for (int i=0;i<A.size();++i) {
-        int best=-1; double bestIoU=-1.0;
-        for (int j=0;j<B.size();++j) {
-            if (usedB[j]) continue;
-            double d = iouXYXY(A[i], B[j]);
-            if (d > bestIoU) { bestIoU = d; best = j; }
+    for (const BoxMatch& m : std::as_const(pairs)) {
+        if (m.a >= 0 && m.b >= 0) {
+            detail << (A[m.a].cls == B[m.b].cls ? QString("✓ match  iou=%1") : QString("∆ class-mismatch iou=%1"))
+                          .arg(QString::number(m.iou, 'f', 3));
+        } else {
+            detail << (m.a >= 0 ? "× only-ours" : "× only-labelimg");
         }
-        if (best>=0 && bestIoU>=thr) {
-            usedB[best] = true;
-            if (A[i].cls == B[best].cls) { TP++; detail << QString("✓ match  iou=%1").arg(QString::number(bestIoU, 'f', 3)); }
-            else { MIS++; detail << QString("∆ class-mismatch iou=%1").arg(QString::number(bestIoU, 'f', 3)); }
-        } else { FP++; detail << "× only-ours"; }
     }
-    for (int j=0;j<B.size();++j) if (!usedB[j]) { FN++; detail << "× only-labelimg"; }
 
-    const int denom = TP + MIS + FP + FN;
-    const double sim = (denom>0) ? double(TP)/double(denom) : 1.0;
+    const double sim = mc.similarity();
 
     // 8) Çıktı
     if (ui->txtLog) {
@@ -1036,20 +829,101 @@ void MainWindow::compareCurrentImageAgainstLabelImg()
                                         .arg(TP).arg(MIS).arg(FP).arg(FN)
                                         .arg(QString::number(thr, 'f', 2))
                                         .arg(QString::number(sim*100.0, 'f', 1)));
+        if (mode == MatchMode::Optimal)
+            ui->txtLog->appendPlainText(QString("Greedy: TP=%1  MIS=%2  FP=%3  FN=%4  (optimal TP farkı: %5)")
+                                            .arg(greedy.tp).arg(greedy.mis).arg(greedy.fp).arg(greedy.fn)
+                                            .arg(TP - greedy.tp));
         for (const auto& ln : detail) ui->txtLog->appendPlainText("  - " + ln);
         ui->txtLog->appendPlainText("");
     }
 
-    QMessageBox::information(this, tr("Karşılaştırma"),
-                             QString("Görsel: %1\nTP: %2\nClassMismatch: %3\nFP: %4\nFN: %5\nIoU eşik: %6\nSimilarity: %7 (%8%%)")
-                                 .arg(QFileInfo(imgPath).fileName())
-                                 .arg(TP).arg(MIS).arg(FP).arg(FN)
-                                 .arg(thr,0,'f',2)
-                                 .arg(sim,0,'f',3).arg(qRound(sim*100)));
+    QString msg = QString("Görsel: %1\nTP: %2\nClassMismatch: %3\nFP: %4\nFN: %5\nIoU eşik: %6\nSimilarity: %7 (%8%%)")
+                      .arg(QFileInfo(imgPath).fileName())
+                      .arg(TP).arg(MIS).arg(FP).arg(FN)
+                      .arg(thr,0,'f',2)
+                      .arg(sim,0,'f',3).arg(qRound(sim*100));
+    if (mode == MatchMode::Optimal)
+        msg += QString("\nEşleştirme: optimal (greedy TP: %1)").arg(greedy.tp);
+    QMessageBox::information(this, tr("Karşılaştırma"), msg);
+}
+
+// Karşılaştırma eşleştirme modu (tabInternal: cmbMatchMode; öğe sırası MatchMode ile aynı)
+MatchMode MainWindow::compareMatchMode() const
+{
+    const int i = ui->cmbMatchMode ? ui->cmbMatchMode->currentIndex() : 0;
+    return (i == int(MatchMode::Optimal) || i == int(MatchMode::PerClass)) ? MatchMode(i) : MatchMode::Greedy;
+}
+
+// Toplu karşılaştırma raporunu log'a yazar; özet metni döner
+static QString logCompareReport(QPlainTextEdit* log, const LabelCompare::Report& rep)
+{
+    const MatchCounts& t = rep.total;
+
+    if (log) {
+        // Görsel başına: yalnız farkı olanlar (çok büyük setlerde log'u boğmamak için ilk 200)
+        constexpr int kMaxListed = 200;
+        int listed = 0, differing = 0;
+        for (const LabelCompare::ImageResult& r : rep.images) {
+            if (r.c.mis == 0 && r.c.fp == 0 && r.c.fn == 0) continue;
+            if (++differing > kMaxListed) continue;
+            ++listed;
+            log->appendPlainText(
+                QString("[%1] %2  TP=%3  ClassMismatch=%4  FP=%5  FN=%6  (ours=%7, other=%8)  [fmtB=%9]")
+                    .arg(listed).arg(r.stem).arg(r.c.tp).arg(r.c.mis).arg(r.c.fp).arg(r.c.fn)
+                    .arg(r.ours).arg(r.other).arg(int(r.fmtB)));
+        }
+        if (differing > listed)
+            log->appendPlainText(QString("... +%1 farklı görsel daha").arg(differing - listed));
+
+        // Sınıf kırılımı
+        log->appendPlainText("--- Sınıf bazında ---");
+        for (auto it = rep.perClass.cbegin(); it != rep.perClass.cend(); ++it) {
+            const MatchCounts& c = it->c;
+            log->appendPlainText(
+                QString("cls %1  TP=%2  ClassMismatch=%3  FP=%4  FN=%5  Similarity=%6")
+                    .arg(it.key()).arg(c.tp).arg(c.mis).arg(c.fp).arg(c.fn)
+                    .arg(c.similarity(), 0, 'f', 3));
+        }
+    }
+
+    // Özet
+    const double similarity = t.similarity();
+    QString summary = QString(
+                          "Dosya: %1\nTP: %2\nClassMismatch: %3\nFP (bizde fazla): %4\n"
+                          "FN (karşı tarafta fazla): %5\nIoU eşik: %6\nSimilarity: %7 (%8%%)")
+                          .arg(rep.files).arg(t.tp).arg(t.mis).arg(t.fp).arg(t.fn)
+                          .arg(rep.iouThr,0,'f',2)
+                          .arg(similarity,0,'f',3)
+                          .arg(qRound(similarity*100));
+    if (rep.mode == MatchMode::PerClass)
+        summary += QStringLiteral("\nEşleştirme: sınıf bazlı (eşiksiz, betikle aynı)");
+    if (rep.mode == MatchMode::Optimal) {
+        const MatchCounts& g = rep.totalGreedy;
+        summary += QString("\nEşleştirme: optimal\nGreedy TP: %1 → optimal TP: %2 (%3%4)\nFarklı sonuçlu görsel: %5")
+                       .arg(g.tp).arg(t.tp).arg(t.tp >= g.tp ? "+" : "").arg(t.tp - g.tp)
+                       .arg(rep.changedImages);
+        if (log)
+            log->appendPlainText(QString("--- Greedy ↔ Optimal ---\nGreedy  : TP=%1  ClassMismatch=%2  FP=%3  FN=%4  Similarity=%5\n"
+                                         "Optimal : TP=%6  ClassMismatch=%7  FP=%8  FN=%9  Similarity=%10")
+                                     .arg(g.tp).arg(g.mis).arg(g.fp).arg(g.fn).arg(g.similarity(), 0, 'f', 3)
+                                     .arg(t.tp).arg(t.mis).arg(t.fp).arg(t.fn).arg(t.similarity(), 0, 'f', 3));
+    }
+    summary += QString("\nSüre: %1 ms").arg(rep.elapsedMs);
+    if (rep.cancelled) summary += "\n(İPTAL EDİLDİ — kısmi sonuç)";
+
+    if (log) log->appendPlainText("--- Özet ---\n" + summary + "\n");
+    return summary;
 }
 
 void MainWindow::on_btnCompareLI_clicked()
 {
+    // Toplu karşılaştırma sürüyorsa ikinci tık iptal eder
+    if (m_compare && m_compare->isRunning()) {
+        m_compare->cancel();
+        if (statusBar()) statusBar()->showMessage(tr("Karşılaştırma iptal ediliyor..."), 2000);
+        return;
+    }
+
     // Önce tek-görsel (o an açık) karşılaştırmayı yap
     compareCurrentImageAgainstLabelImg();
 
@@ -1093,138 +967,259 @@ void MainWindow::on_btnCompareLI_clicked()
     }
 
     // Görüntü kökü (XY* piksel ise gerekli)
-    const QString leImagesTxt   = ui->leImages ? ui->leImages->text().trimmed() : QString();
-    const QString imagesRootDir = normalizeImagesRoot(leImagesTxt);
-
-    QDir A(oursDir), B(otherDir);
-    const QStringList Af = A.entryList({"*.txt","*.xml"}, QDir::Files, QDir::Name);
-    const QStringList Bf = B.entryList({"*.txt","*.xml"}, QDir::Files, QDir::Name);
-
-    // --- DÜZENLEME: Stem kümesini yalnızca aktif görsele daralt ---
-    QString onlyStem;
-    if (ui->annotView && !ui->annotView->currentImage().isEmpty()) {
-        onlyStem = QFileInfo(ui->annotView->currentImage()).completeBaseName();
-    } else if (ui->listFiles && ui->listFiles->currentItem()) {
-        onlyStem = QFileInfo(currentFromList(ui->listFiles)).completeBaseName();
-    }
-    // annotView/listFiles boşsa leLabels .txt'ten stem al
-    if (onlyStem.isEmpty()) {
-        const QString lbl = ui->leLabels ? ui->leLabels->text().trimmed() : QString();
-        if (!lbl.isEmpty() && lbl.endsWith(".txt", Qt::CaseInsensitive))
-            onlyStem = QFileInfo(lbl).completeBaseName();
-    }
+    const QString leImagesTxt = ui->leImages ? ui->leImages->text().trimmed() : QString();
+
+    // Veri seti geneli: iki klasörün tüm stem'leri arka planda, paralel
+    LabelCompare::Job job;
+    job.oursDir    = oursDir;
+    job.otherDir   = otherDir;
+    job.imagesRoot = normalizeImagesRoot(leImagesTxt);
+    job.iouThr     = iouThr;
+    job.mode       = compareMatchMode();
+    job.keepBoxes  = true;                 // inceleme kuyruğu kutuları da ister,
+    job.keepDiffOnly = true;               //   yalnız farklı görsellerinkini (100k görselde bellek)
+
+    if (!m_compare) {
+        m_compare = new LabelCompare(this);
+        connect(m_compare, &LabelCompare::progress, this, [this](int done, int total){
+            if (statusBar()) statusBar()->showMessage(tr("Karşılaştırılıyor: %1 / %2").arg(done).arg(total));
+        });
+        connect(m_compare, &LabelCompare::finished, this, [this](const LabelCompare::Report& rep){
+            if (statusBar()) statusBar()->clearMessage();
+            const QString summary = logCompareReport(ui->txtLog, rep);
+            const QString stamp   = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
+
+            // Paylaşılabilir çıktılar arka planda: eval/compare_<zaman>/{images.csv, classes.csv, index.html}
+            const QString reportDir = projectRoot() + "/eval/compare_" + stamp;
+            QPointer<MainWindow> self(this);
+            QThreadPool::globalInstance()->start([self, rep, reportDir]{
+                QString err;
+                const bool ok = CompareReport::exportCsv(rep, reportDir, &err)
+                                && CompareReport::exportHtml(rep, reportDir, &err);
+                QMetaObject::invokeMethod(self, [self, ok, err, reportDir]{
+                    if (!self || !self->ui->txtLog) return;
+                    self->ui->txtLog->appendPlainText(ok ? QString("[compare] Rapor: %1").arg(QDir(reportDir).filePath("index.html"))
+                                                         : QString("[compare] Rapor yazılamadı: %1").arg(err));
+                }, Qt::QueuedConnection);
+            });
 
-    QSet<QString> stems;
-    if (!onlyStem.isEmpty()) {
-        stems.insert(onlyStem);   // SADECE açık görsel
-    } else {
-        // ESKİ DAVRANIŞ: tüm ortak stem’ler
-        for (const auto& f : Af) stems.insert(QFileInfo(f).completeBaseName());
-        for (const auto& f : Bf) stems.insert(QFileInfo(f).completeBaseName());
+            // Farklı görseller anlaşmazlığa göre: eval/review_<zaman>.review (sonradan da açılabilir)
+            const ReviewQueue queue = ReviewQueue::fromReport(rep);
+            if (queue.isEmpty()) {
+                QMessageBox::information(this, tr("Karşılaştırma Özeti"), summary);
+                return;
+            }
+            const QString path = projectRoot() + "/eval/review_" + stamp + ".review";
+            QString err;
+            if (ui->txtLog)
+                ui->txtLog->appendPlainText(queue.save(path, &err)
+                                                ? QString("[compare] İnceleme kuyruğu: %1 görsel → %2").arg(queue.size()).arg(path)
+                                                : QString("[compare] İnceleme kuyruğu yazılamadı: %1").arg(err));
+            const auto answer = QMessageBox::question(
+                this, tr("Karşılaştırma Özeti"),
+                summary + tr("\n\n%1 görselde fark var. Anlaşmazlık sırasıyla annotator'da incelensin mi?\n"
+                             "(D: sonraki, A: önceki, O: katmanı gizle)").arg(queue.size()));
+            if (answer == QMessageBox::Yes) openReview(queue);
+        });
     }
-
-    int files=0, tp=0, clsMis=0, fp=0, fn=0;
-
     if (ui->txtLog) {
         ui->txtLog->appendPlainText("=== Kutu Karşılaştırma (YOLO ↔ XYXY/XYWH/VOC) ===");
         ui->txtLog->appendPlainText("[compare] oursDir  = " + oursDir);
         ui->txtLog->appendPlainText("[compare] otherDir = " + otherDir);
     }
+    m_compare->start(job);
+}
 
-    for (const QString& s : stems) {
-        const QString paTxt = A.absoluteFilePath(s + ".txt");
-        const QString paXml = A.absoluteFilePath(s + ".xml");
-        const QString pbTxt = B.absoluteFilePath(s + ".txt");
-        const QString pbXml = B.absoluteFilePath(s + ".xml");
-
-        QString pa, pb;
-        if (QFile::exists(paTxt)) pa = paTxt;
-        else if (QFile::exists(paXml)) pa = paXml;
-        if (QFile::exists(pbTxt)) pb = pbTxt;
-        else if (QFile::exists(pbXml)) pb = pbXml;
-
-        if (pa.isEmpty() && pb.isEmpty()) continue;
-        ++files;
-
-        // Bizim taraf format
-        AnnFmt fmtA = pa.endsWith(".xml", Qt::CaseInsensitive) ? AnnFmt::VOC_XML : AnnFmt::YOLO;
-
-        // Karşı taraf format algıla
-        AnnFmt fmtB = AnnFmt::UNKNOWN;
-        if (!pb.isEmpty()) {
-            if (pb.endsWith(".xml", Qt::CaseInsensitive)) {
-                fmtB = AnnFmt::VOC_XML;
-            } else {
-                QFile fb(pb);
-                if (fb.open(QIODevice::ReadOnly|QIODevice::Text)) {
-                    QTextStream ts(&fb);
-                    QString firstNonEmpty;
-                    while (!ts.atEnd() && firstNonEmpty.isEmpty()) {
-                        const QString ln = ts.readLine().trimmed();
-                        if (!ln.isEmpty()) firstNonEmpty = ln;
-                    }
-                    fb.close();
-                    fmtB = detectFormatFromLine(firstNonEmpty);
-                }
-            }
-        }
+// Kuyruktaki stem'ler önce annotator'ın açık listesinden, yoksa leImages klasöründen çözülür
+void MainWindow::openReview(const ReviewQueue& queue)
+{
+    AnnotatorWidget* annot = ui->annotView;
+    if (!annot) return;
+    const QString images = normalizeImagesRoot(ui->leImages ? ui->leImages->text().trimmed() : QString());
+    if (!annot->startReview(queue, images)) return;            // görsel klasörü taranıyorsa kuyruk sonra açılır
+    if (ui->lblAnnotInfo) ui->lblAnnotInfo->setText(tr("İnceleme: %1 görsel").arg(queue.size()));
+    if (ui->tabWidget && ui->tab_3) ui->tabWidget->setCurrentWidget(ui->tab_3);
+    annot->setFocus();
+}
 
-        // Görüntü boyutu gerekebilir
-        QSize imgSz;
-        if (fmtB==AnnFmt::XYXY_PIX || fmtB==AnnFmt::XYWH_PIX) {
-            imgSz = findImageSizeForStem(s, imagesRootDir);
-        }
+// ---- Dedektör değerlendirmesi: tahmin klasörü ↔ etiket klasörü (COCO mAP) ----
+void MainWindow::on_btnEvalMap_clicked()
+{
+    // Sürüyorsa ikinci tık iptal eder
+    if (m_eval && m_eval->isRunning()) {
+        m_eval->cancel();
+        if (statusBar()) statusBar()->showMessage(tr("Değerlendirme iptal ediliyor..."), 2000);
+        return;
+    }
 
-        QVector<XYXY> va = readGenericNorm(pa, fmtA, {});
-        QVector<XYXY> vb = readGenericNorm(pb, fmtB, imgSz);
+    const QString gtDir = ui->leLabels ? ui->leLabels->text().trimmed() : QString();
+    if (gtDir.isEmpty() || !QDir(gtDir).exists()) {
+        QMessageBox::warning(this, tr("Uyarı"), tr("Önce ground truth etiket klasörünü (leLabels) seçin."));
+        return;
+    }
+    const QString predDir = getExistingDirectorySafe(this, tr("Tahmin etiket klasörü (cls cx cy w h conf)"), gtDir);
+    if (predDir.isEmpty()) return;
+
+    DetectionEval::Job job;
+    job.gtDir      = gtDir;
+    job.predDir    = predDir;
+    job.imagesRoot = normalizeImagesRoot(ui->leImages ? ui->leImages->text().trimmed() : QString());
+
+    if (!m_eval) {
+        m_eval = new DetectionEval(this);
+        connect(m_eval, &DetectionEval::progress, this, [this](int done, int total){
+            if (statusBar()) statusBar()->showMessage(tr("Değerlendiriliyor: %1 / %2").arg(done).arg(total));
+        });
+        connect(m_eval, &DetectionEval::finished, this, [this](const DetectionEval::Report& rep){
+            if (statusBar()) statusBar()->clearMessage();
+            const QString summary = DetectionEval::summaryText(rep);
+
+            // Koşular arası takip: eval/map_<zaman>.json + eval/map_history.csv
+            const QString evalDir = projectRoot() + "/eval";
+            const QString json = evalDir + "/map_" + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".json";
+            QString err;
+            const bool saved = !rep.cancelled
+                               && DetectionEval::exportJson(rep, json, &err)
+                               && DetectionEval::appendHistory(rep, evalDir + "/map_history.csv", json, &err);
+
+            if (ui->txtLog) {
+                ui->txtLog->appendPlainText(QString("--- Sınıf bazında AP (IoU 0.50:0.95 / 0.50) ---"));
+                for (const DetectionEval::ClassResult& c : rep.classes)
+                    ui->txtLog->appendPlainText(QString("cls %1  GT=%2  Det=%3  AP=%4  AP50=%5")
+                                                    .arg(c.cls).arg(c.gt[DetectionEval::AreaAll]).arg(c.dets)
+                                                    .arg(c.apMean(), 0, 'f', 3)
+                                                    .arg(c.ap[DetectionEval::AreaAll][0], 0, 'f', 3));
+                ui->txtLog->appendPlainText(summary);
+                ui->txtLog->appendPlainText(QString("Görsel: %1 (boyutu bilinen: %2)  GT: %3  Tahmin: %4  Süre: %5 ms%6")
+                                                .arg(rep.images).arg(rep.sizedImages)
+                                                .arg(rep.gtBoxes).arg(rep.detBoxes).arg(rep.elapsedMs)
+                                                .arg(rep.cancelled ? QString("  (İPTAL — kısmi, kaydedilmedi)") : QString()));
+                if (saved)                ui->txtLog->appendPlainText("[eval] " + json);
+                else if (!err.isEmpty())  ui->txtLog->appendPlainText("[eval] kaydedilemedi: " + err);
+            }
+            QMessageBox::information(this, tr("mAP Değerlendirme"),
+                                     QString("mAP@[.50:.95]: %1\nmAP@.50: %2\nmAP@.75: %3\nGörsel: %4")
+                                         .arg(rep.stats[DetectionEval::StatAP], 0, 'f', 3)
+                                         .arg(rep.stats[DetectionEval::StatAP50], 0, 'f', 3)
+                                         .arg(rep.stats[DetectionEval::StatAP75], 0, 'f', 3)
+                                         .arg(rep.images));
+        });
+    }
 
-        if (va.isEmpty() && vb.isEmpty()) continue;
+    if (ui->txtLog) {
+        ui->txtLog->appendPlainText("=== mAP Değerlendirme (COCO) ===");
+        ui->txtLog->appendPlainText("[eval] gtDir   = " + gtDir);
+        ui->txtLog->appendPlainText("[eval] predDir = " + predDir);
+    }
+    m_eval->start(job);
+}
 
-        QVector<bool> usedB(vb.size(), false);
-        int tp_i=0, mis_i=0, fp_i=0, fn_i=0;
+// ---- Çok annotator'lu uyum: labels_*/train kardeşleri (ve elle eklenenler) arasında ----
+void MainWindow::on_btnAgreement_clicked()
+{
+    // Sürüyorsa ikinci tık iptal eder
+    if (m_agreement && m_agreement->isRunning()) {
+        m_agreement->cancel();
+        if (statusBar()) statusBar()->showMessage(tr("Uyum analizi iptal ediliyor..."), 2000);
+        return;
+    }
 
-        // Greedy eşleştirme (IoU)
-        for (int i=0;i<va.size();++i){
-            int best=-1; double bestIoU=-1.0;
-            for (int j=0;j<vb.size();++j){
-                if (usedB[j]) continue;
-                const double d = iouXYXY(va[i], vb[j]);
-                if (d > bestIoU) { bestIoU = d; best = j; }
-            }
-            if (best>=0 && bestIoU>=iouThr) {
-                usedB[best] = true;
-                if (va[i].cls == vb[best].cls) tp_i++;
-                else mis_i++;
-            } else {
-                fp_i++;
-            }
+    const QString oursDir = ui->leLabels ? ui->leLabels->text().trimmed() : QString();
+    if (oursDir.isEmpty() || !QDir(oursDir).exists()) {
+        QMessageBox::warning(this, tr("Uyarı"), tr("Önce kendi etiket klasörünü (leLabels) seçin."));
+        return;
+    }
+
+    // Annotator klasörleri: otomatik bulunanlar + kullanıcının ekledikleri
+    QStringList dirs = autoFindAnnotatorLabels(oursDir);
+    for (;;) {
+        if (dirs.size() >= 2) {
+            const auto ans = QMessageBox::question(
+                this, tr("Annotator Uyumu"),
+                tr("%1 etiket klasörü:\n\n%2\n\nBaşka klasör eklensin mi?").arg(dirs.size()).arg(dirs.join('\n')),
+                QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+            if (ans != QMessageBox::Yes) break;
+        }
+        const QString d = getExistingDirectorySafe(this, tr("Annotator etiket klasörü ekle"),
+                                                   QFileInfo(oursDir).absolutePath());
+        if (d.isEmpty()) {
+            if (dirs.size() < 2) return;
+            break;
         }
-        for (int j=0;j<vb.size();++j) if (!usedB[j]) fn_i++;
+        const QString nd = QDir::toNativeSeparators(QFileInfo(d).absoluteFilePath());
+        if (!dirs.contains(nd)) dirs << nd;
+        if (dirs.size() >= LabelAgreement::kMaxAnnotators) break;
+    }
 
-        tp += tp_i; clsMis += mis_i; fp += fp_i; fn += fn_i;
+    // Konsensüs: veri seti kökünde labels_consensus/train (train yapısı yoksa bizimkinin yanında)
+    QDir base(oursDir);
+    QString consensusDir;
+    if (base.dirName().compare("train", Qt::CaseInsensitive) == 0 && base.cdUp() && base.cdUp())
+        consensusDir = base.filePath("labels_consensus/train");
+    else
+        consensusDir = QDir::cleanPath(oursDir) + "_consensus";
+
+    QDoubleSpinBox* sb = findChild<QDoubleSpinBox*>("sbIou");
+    LabelAgreement::Job job;
+    job.dirs         = dirs;
+    job.imagesRoot   = normalizeImagesRoot(ui->leImages ? ui->leImages->text().trimmed() : QString());
+    job.iouThr       = (sb && sb->value() > 0.0) ? sb->value() : 0.50;
+    job.mode         = compareMatchMode();
+    job.consensusDir = QDir::toNativeSeparators(consensusDir);
+
+    if (!m_agreement) {
+        m_agreement = new LabelAgreement(this);
+        connect(m_agreement, &LabelAgreement::progress, this, [this](int done, int total){
+            if (statusBar()) statusBar()->showMessage(tr("Uyum analizi: %1 / %2").arg(done).arg(total));
+        });
+        connect(m_agreement, &LabelAgreement::finished, this, [this](const LabelAgreement::Report& rep){
+            if (statusBar()) statusBar()->clearMessage();
+            if (!rep.errors.isEmpty() && rep.names.isEmpty()) {
+                QMessageBox::warning(this, tr("Annotator Uyumu"), rep.errors.join('\n'));
+                return;
+            }
 
-        if (ui->txtLog) {
-            ui->txtLog->appendPlainText(
-                QString("[%1] %2  TP=%3  ClassMismatch=%4  FP=%5  FN=%6  (ours=%7, other=%8)  [fmtB=%9]")
-                    .arg(files).arg(s).arg(tp_i).arg(mis_i).arg(fp_i).arg(fn_i)
-                    .arg(va.size()).arg(vb.size())
-                    .arg(int(fmtB))
-                );
-        }
+            // İnceleme kuyruğu: eval/agreement_<zaman>.csv
+            const QString csv = projectRoot() + "/eval/agreement_"
+                                + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".csv";
+            QString err;
+            const bool saved = !rep.cancelled && LabelAgreement::exportCsv(rep, csv, &err);
+
+            QString summary = QString("Annotator: %1\nGörsel: %2\nKutu: %3\nKonsensüs kutusu: %4 (en az %5 oy)\n"
+                                      "Oy yetmeyen küme: %6\nIoU eşik: %7\nSüre: %8 ms")
+                                  .arg(rep.names.size()).arg(rep.images).arg(rep.boxes)
+                                  .arg(rep.consensusBoxes).arg(rep.minVotes).arg(rep.contestedClusters)
+                                  .arg(rep.iouThr, 0, 'f', 2).arg(rep.elapsedMs);
+            if (rep.cancelled) summary += "\n(İPTAL EDİLDİ — kısmi sonuç)";
+
+            if (ui->txtLog) {
+                ui->txtLog->appendPlainText(LabelAgreement::matrixText(rep));
+                constexpr int kMaxListed = 50;
+                ui->txtLog->appendPlainText(QString("--- En çok anlaşmazlık (ilk %1) ---").arg(kMaxListed));
+                for (int i = 0; i < std::min(kMaxListed, int(rep.ranked.size())); ++i) {
+                    const LabelAgreement::ImageScore& r = rep.ranked[i];
+                    if (r.disagreement <= 0.0f) break;
+                    QStringList counts;
+                    for (int b : r.boxes) counts << QString::number(b);
+                    ui->txtLog->appendPlainText(QString("[%1] %2  anlaşmazlık=%3  kutular=%4  konsensüs=%5  çekişmeli=%6")
+                                                    .arg(i + 1).arg(r.stem).arg(r.disagreement, 0, 'f', 3)
+                                                    .arg(counts.join('/')).arg(r.consensus).arg(r.contested));
+                }
+                ui->txtLog->appendPlainText("--- Özet ---\n" + summary);
+                if (!rep.consensusDir.isEmpty()) ui->txtLog->appendPlainText("[agreement] konsensüs = " + rep.consensusDir);
+                if (saved)               ui->txtLog->appendPlainText("[agreement] " + csv);
+                else if (!err.isEmpty()) ui->txtLog->appendPlainText("[agreement] kaydedilemedi: " + err);
+                for (const QString& e : rep.errors) ui->txtLog->appendPlainText("[agreement] hata: " + e);
+                ui->txtLog->appendPlainText("");
+            }
+            QMessageBox::information(this, tr("Annotator Uyumu"), summary);
+        });
     }
 
-    // Özet
-    const int denom = tp + clsMis + fp + fn;
-    const double similarity = (denom > 0) ? double(tp) / double(denom) : 1.0;
-
-    const QString summary = QString(
-                                "Dosya: %1\nTP: %2\nClassMismatch: %3\nFP (bizde fazla): %4\n"
-                                "FN (karşı tarafta fazla): %5\nIoU eşik: %6\nSimilarity: %7 (%8%%)")
-                                .arg(files).arg(tp).arg(clsMis).arg(fp).arg(fn)
-                                .arg(iouThr,0,'f',2)
-                                .arg(similarity,0,'f',3)
-                                .arg(qRound(similarity*100));
-
-    if (ui->txtLog) ui->txtLog->appendPlainText("--- Özet ---\n" + summary + "\n");
-    QMessageBox::information(this, tr("Karşılaştırma Özeti"), summary);
+    if (ui->txtLog) {
+        ui->txtLog->appendPlainText("=== Annotator Uyumu (N klasör) ===");
+        for (int i = 0; i < dirs.size(); ++i)
+            ui->txtLog->appendPlainText(QString("[agreement] [%1] %2").arg(i).arg(dirs[i]));
+    }
+    m_agreement->start(job);
 }
@@ -0,0 +1,301 @@
+// preannotator.cpp
+#include "preannotator.h"
+#include "ioukernel.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QThread>
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+constexpr float kNmsIou = 0.7f;
+
+// Etiket bazlı NMS: arka uç kendi bastırmasını yapmasa da (ör. FunctionDetector)
+// aynı nesneye üst üste öneri düşmez. Sıra korunur.
+QVector<Proposal> suppressOverlaps(const QVector<Proposal>& props)
+{
+    if (props.size() < 2) return props;
+    QHash<QString, QVector<int>> byLabel;
+    for (int i = 0; i < props.size(); ++i) byLabel[props[i].label].push_back(i);
+
+    std::vector<char>  keep(props.size(), 0);
+    BoxesSoA           boxes;
+    std::vector<float> scores;
+    for (auto it = byLabel.cbegin(); it != byLabel.cend(); ++it) {
+        const QVector<int>& idx = it.value();
+        boxes.clear();
+        scores.clear();
+        for (int i : idx) {
+            const QRectF& r = props[i].rect;
+            boxes.push(float(r.left()), float(r.top()), float(r.right()), float(r.bottom()));
+            scores.push_back(props[i].score);
+        }
+        for (int k : nms(boxes, scores.data(), kNmsIou)) keep[idx[k]] = 1;
+    }
+    QVector<Proposal> out;
+    out.reserve(props.size());
+    for (int i = 0; i < props.size(); ++i) if (keep[i]) out.push_back(props[i]);
+    return out;
+}
+
+} // namespace
+
+// ---------------------------
+// ProcessDetector (Python worker)
+// ---------------------------
+ProcessDetector::ProcessDetector(const QString& program, const QStringList& args,
+                                 const QProcessEnvironment& env, const QString& workDir, int timeoutMs)
+    : m_program(program), m_args(args), m_env(env), m_workDir(workDir), m_timeoutMs(timeoutMs)
+{
+}
+
+ProcessDetector::~ProcessDetector()
+{
+    if (m_proc && m_proc->state() != QProcess::NotRunning) {
+        m_proc->closeWriteChannel();                  // worker stdin EOF ile çıkar
+        if (!m_proc->waitForFinished(2000)) m_proc->kill();
+        m_proc->waitForFinished(1000);
+    }
+}
+
+bool ProcessDetector::ensureStarted(QString* err)
+{
+    if (m_proc && m_proc->state() == QProcess::Running) return true;
+    m_proc = std::make_unique<QProcess>();
+    m_proc->setProgram(m_program);
+    m_proc->setArguments(m_args);
+    m_proc->setProcessEnvironment(m_env);
+    if (!m_workDir.isEmpty()) m_proc->setWorkingDirectory(m_workDir);
+    m_proc->setProcessChannelMode(QProcess::ForwardedErrorChannel);   // teşhis çıktısı konsola
+    m_proc->start();
+    if (!m_proc->waitForStarted(15000)) {
+        if (err) *err = QStringLiteral("detector start failed: %1").arg(m_proc->errorString());
+        m_proc.reset();
+        return false;
+    }
+    return true;
+}
+
+bool ProcessDetector::readLine(QByteArray* line, QString* err)
+{
+    QElapsedTimer waited;
+    waited.start();
+    while (!m_proc->canReadLine()) {
+        // Tek uzun bekleme yerine dilimler: cancel() kapanışı m_timeoutMs kadar bekletmesin
+        if (m_proc->waitForReadyRead(kPollMs)) continue;
+        const bool running = (m_proc->state() == QProcess::Running);
+        if (running && !m_cancel && waited.elapsed() < m_timeoutMs) continue;
+        if (err) *err = m_cancel ? QStringLiteral("detector cancelled")
+                      : running  ? QStringLiteral("detector timeout (%1 ms)").arg(m_timeoutMs)
+                                 : QStringLiteral("detector exited: %1").arg(m_proc->errorString());
+        m_proc->kill();                               // protokol senkronu kayboldu → yeniden başlat
+        m_proc->waitForFinished(1000);
+        m_proc.reset();
+        return false;
+    }
+    *line = m_proc->readLine().trimmed();
+    return true;
+}
+
+bool ProcessDetector::detect(const QString& imagePath, QVector<Proposal>* out, QString* err)
+{
+    out->clear();
+    if (m_cancel) { if (err) *err = QStringLiteral("detector cancelled"); return false; }
+    if (!ensureStarted(err)) return false;
+    m_proc->write(imagePath.toUtf8() + '\n');
+
+    // Protokol dışı satırlar (kütüphane uyarıları vb.) atlanır
+    QByteArray line;
+    for (;;) {
+        if (!readLine(&line, err)) return false;
+        if (line.startsWith("ERR")) { if (err) *err = QString::fromUtf8(line.mid(3).trimmed()); return false; }
+        if (line.startsWith("OK ")) break;
+    }
+
+    const int n = line.mid(3).trimmed().toInt();
+    out->reserve(n);
+    for (int i = 0; i < n; ++i) {
+        if (!readLine(&line, err)) return false;
+        // "<sınıf> <skor> <x1> <y1> <x2> <y2>" — sınıf adı boşluk içerebilir, sayılar sondan
+        const QList<QByteArray> f = line.split(' ');
+        if (f.size() < 6) continue;
+        const int k = int(f.size()) - 5;
+        Proposal p;
+        p.label = QString::fromUtf8(f.mid(0, k).join(' '));
+        bool isInt = false;
+        const int cls = p.label.toInt(&isInt);
+        if (isInt) p.cls = cls;
+        p.score = f[k].toFloat();
+        p.rect  = QRectF(QPointF(f[k+1].toDouble(), f[k+2].toDouble()),
+                         QPointF(f[k+3].toDouble(), f[k+4].toDouble())).normalized();
+        out->push_back(p);
+    }
+    return true;
+}
+
+// ---------------------------
+// PreAnnotator
+// ---------------------------
+PreAnnotator::PreAnnotator(QObject* parent)
+    : QObject(parent)
+{
+    m_thread = new QThread;
+    m_thread->setObjectName("PreAnnotator");
+    m_worker = new QObject;
+    m_worker->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_thread->start(QThread::LowPriority);
+}
+
+PreAnnotator::~PreAnnotator()
+{
+    std::shared_ptr<DetectorBackend> running;
+    {
+        QMutexLocker lk(&m_mutex);
+        m_queue.clear();                              // çalışan istek bitince drain döner
+        running = m_current;
+    }
+    if (running) running->cancel();                   // dedektör yanıtı (60 sn'ye kadar) beklenmesin
+    // Arka uç (QProcess) kendi thread'inde kapansın
+    QMetaObject::invokeMethod(m_worker, [this]{ m_backend.reset(); }, Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    m_worker = nullptr;
+}
+
+void PreAnnotator::setBackend(std::shared_ptr<DetectorBackend> backend)
+{
+    std::shared_ptr<DetectorBackend> previous;
+    {
+        QMutexLocker lk(&m_mutex);
+        previous  = std::exchange(m_current, backend);
+        m_queue.clear();
+        m_cache.clear();
+        m_lru.clear();
+        ++m_generation;
+        m_enabled     = bool(backend);
+        m_backendName = backend ? backend->name() : QString();
+    }
+    if (previous && previous != backend) previous->cancel();   // eski sonuç zaten atılacak
+    // Worker sırasına girer: çalışan drain bittikten sonra uygulanır
+    QMetaObject::invokeMethod(m_worker, [this, backend]{ m_backend = backend; }, Qt::QueuedConnection);
+}
+
+bool PreAnnotator::hasBackend() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_enabled;
+}
+
+QString PreAnnotator::backendName() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_backendName;
+}
+
+void PreAnnotator::setLookAhead(int k)
+{
+    QMutexLocker lk(&m_mutex);
+    m_lookAhead = qBound(0, k, 64);
+}
+
+int PreAnnotator::lookAhead() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_lookAhead;
+}
+
+void PreAnnotator::setMinScore(float s)
+{
+    QMutexLocker lk(&m_mutex);
+    m_minScore = s;
+}
+
+void PreAnnotator::request(const QStringList& paths)
+{
+    bool schedule = false;
+    {
+        QMutexLocker lk(&m_mutex);
+        if (!m_enabled) return;
+        m_queue.clear();                              // yeni pencere: eski ileri bakışlar düşer
+        for (const QString& p : paths) {
+            const QString stem = QFileInfo(p).completeBaseName();
+            if (p.isEmpty() || m_cache.contains(stem) || stem == m_running) continue;
+            m_queue << p;
+        }
+        if (!m_queue.isEmpty() && !m_drainScheduled) {
+            m_drainScheduled = true;
+            schedule = true;
+        }
+    }
+    if (schedule && m_worker)
+        QMetaObject::invokeMethod(m_worker, [this]{ drain(); }, Qt::QueuedConnection);
+}
+
+bool PreAnnotator::take(const QString& stem, QVector<Proposal>* out)
+{
+    QMutexLocker lk(&m_mutex);
+    auto it = m_cache.find(stem);
+    if (it == m_cache.end()) return false;
+    *out = std::move(it.value());
+    m_cache.erase(it);
+    m_lru.removeOne(stem);
+    return true;
+}
+
+void PreAnnotator::remember(const QString& stem, QVector<Proposal> props)
+{
+    m_cache.insert(stem, std::move(props));
+    m_lru.removeOne(stem);
+    m_lru.push_back(stem);
+    while (m_lru.size() > kMaxCached)
+        m_cache.remove(m_lru.takeFirst());
+}
+
+void PreAnnotator::drain()
+{
+    for (;;) {
+        QString path;
+        quint64 gen;
+        float   minScore;
+        {
+            QMutexLocker lk(&m_mutex);
+            if (m_queue.isEmpty() || !m_backend) {
+                m_running.clear();
+                m_drainScheduled = false;
+                return;
+            }
+            path       = m_queue.takeFirst();
+            m_running  = QFileInfo(path).completeBaseName();
+            gen        = m_generation;
+            minScore   = m_minScore;
+        }
+
+        QVector<Proposal> props;
+        QString err;
+        const bool ok = m_backend->detect(path, &props, &err);
+        props.erase(std::remove_if(props.begin(), props.end(),
+                                   [minScore](const Proposal& p){ return p.score < minScore || p.rect.isEmpty(); }),
+                    props.end());
+        props = suppressOverlaps(props);
+        const int count = int(props.size());
+
+        {
+            QMutexLocker lk(&m_mutex);
+            const QString stem = m_running;
+            m_running.clear();
+            if (gen != m_generation) continue;        // arka uç bu arada değişti
+            if (ok) remember(stem, std::move(props));
+        }
+        if (ok) emit proposalsReady(path, count);
+        else    emit failed(path, err);
+    }
+}
@@ -0,0 +1,139 @@
+// preannotator.h
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QProcessEnvironment>
+#include <QRectF>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class QThread;
+class QProcess;
+
+// Dedektörün tek görsel için önerisi (tam çözünürlük px)
+struct Proposal {
+    int     cls   = -1;        // sınıf indeksi; -1 ise label adından eşlenir
+    QString label;
+    float   score = 0;
+    QRectF  rect;
+};
+
+// Dedektör arka ucu. Sadece PreAnnotator'ın worker thread'inde çağrılır (thread-safe olması gerekmez).
+class DetectorBackend
+{
+public:
+    virtual ~DetectorBackend() = default;
+    virtual QString name() const = 0;
+    virtual bool    detect(const QString& imagePath, QVector<Proposal>* out, QString* err) = 0;
+    // Her thread'den çağrılabilir: çalışan ve sonraki detect() mümkünse hemen false döner.
+    // Arka uç bırakılırken çağrılır (kapanış / arka uç değişimi); sonra yeniden kullanılmaz.
+    virtual void    cancel() {}
+};
+
+// Kalıcı Python worker: stdin'e görsel yolu (satır), stdout'tan
+//   "OK <n>" + n satır "<sınıf> <skor> <x1> <y1> <x2> <y2>"   ya da   "ERR <mesaj>"
+// Süreç ilk istekte başlar, çökerse sonraki istekte yeniden başlatılır. Yanıt kısa dilimlerle
+// beklenir: cancel() en geç bir dilimde süreci öldürüp detect()'i bitirir.
+class ProcessDetector : public DetectorBackend
+{
+public:
+    ProcessDetector(const QString& program, const QStringList& args,
+                    const QProcessEnvironment& env, const QString& workDir, int timeoutMs = 60000);
+    ~ProcessDetector() override;
+
+    QString name() const override { return QStringLiteral("python"); }
+    bool    detect(const QString& imagePath, QVector<Proposal>* out, QString* err) override;
+    void    cancel() override { m_cancel = true; }
+
+private:
+    static constexpr int kPollMs = 100;
+
+    bool ensureStarted(QString* err);
+    bool readLine(QByteArray* line, QString* err);
+
+    QString                   m_program;
+    QStringList               m_args;
+    QProcessEnvironment       m_env;
+    QString                   m_workDir;
+    int                       m_timeoutMs;
+    std::unique_ptr<QProcess> m_proc;        // worker thread'de oluşturulur
+    std::atomic_bool          m_cancel{false};
+};
+
+// Süreç içi dedektör (ör. C++ model çalıştırıcısı)
+class FunctionDetector : public DetectorBackend
+{
+public:
+    using Fn = std::function<bool(const QString& imagePath, QVector<Proposal>* out, QString* err)>;
+    FunctionDetector(const QString& name, Fn fn) : m_name(name), m_fn(std::move(fn)) {}
+
+    QString name() const override { return m_name; }
+    bool    detect(const QString& imagePath, QVector<Proposal>* out, QString* err) override
+    { return m_fn(imagePath, out, err); }
+
+private:
+    QString m_name;
+    Fn      m_fn;
+};
+
+// Ön etiketleme: sıradaki K görsel için dedektörü arka planda (tek worker thread) çalıştırır,
+// önerileri stem başına önbellekte tutar.
+//  - request() GUI'yi bloklamaz: kuyruğu yeni pencereyle değiştirir (eski ileri bakışlar düşer)
+//  - Çalışan istek yarıda kesilmez; sonucu yine önbelleğe girer
+//  - Önbellek LRU sınırlı; take() öneriyi alır ve önbellekten çıkarır
+class PreAnnotator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PreAnnotator(QObject* parent=nullptr);
+    ~PreAnnotator() override;
+
+    // Arka ucu değiştir (nullptr: kapat). Kuyruk ve önbellek temizlenir.
+    void setBackend(std::shared_ptr<DetectorBackend> backend);
+    bool hasBackend() const;
+    QString backendName() const;
+
+    void setLookAhead(int k);
+    int  lookAhead() const;
+    void setMinScore(float s);
+
+    // Öncelik sırasıyla görseller (genelde mevcut + sonraki K). Thread-safe; anında döner.
+    void request(const QStringList& paths);
+
+    // stem için hazır öneri varsa al (önbellekten çıkar)
+    bool take(const QString& stem, QVector<Proposal>* out);
+
+signals:
+    // Worker thread'den yayılır (alıcı GUI'deyse otomatik queued)
+    void proposalsReady(const QString& imagePath, int count);
+    void failed(const QString& imagePath, const QString& error);
+
+private:
+    void drain();                                     // worker thread'de çalışır
+    void remember(const QString& stem, QVector<Proposal> props);   // m_mutex tutulurken
+
+    static constexpr int kMaxCached = 256;
+
+    QThread*  m_thread = nullptr;
+    QObject*  m_worker = nullptr;
+    std::shared_ptr<DetectorBackend> m_backend;        // yalnız worker erişir
+    std::shared_ptr<DetectorBackend> m_current;        // son atanan (m_mutex); yalnız cancel() için
+
+    mutable QMutex                      m_mutex;
+    QStringList                         m_queue;          // bekleyen yollar (öncelik sırası)
+    QString                             m_running;        // şu an dedektördeki stem
+    QHash<QString, QVector<Proposal>>   m_cache;          // stem → öneriler
+    QStringList                         m_lru;            // en son eklenen sonda
+    bool                                m_drainScheduled = false;
+    bool                                m_enabled  = false;
+    QString                             m_backendName;
+    quint64                             m_generation = 0; // arka uç değişince eski sonuçlar atılır
+    int                                 m_lookAhead = 4;
+    float                               m_minScore  = 0.3f;
+};
@@ -1,4 +1,8 @@
 # compare_labels.py  — YOLO txt etiketlerini IoU ile karşılaştırma
+# Not: büyük veri setleri için C++ `compare_labels` hedefi (aynı CSV şeması, çok iş parçacıklı,
+# tüm AnnFmt biçimleri + VOC) tercih edilmeli. Varsayılanı bu betiğin eşleştirmesidir (motorda
+# MatchMode::PerClass: sınıf bazlı, eşiksiz greedy); uygulamanın eşik + sınıftan bağımsız
+# eşleştirmesi için --engine-match.
 import argparse, csv
 from pathlib import Path
 from typing import List, Tuple, Dict
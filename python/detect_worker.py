@@ -0,0 +1,68 @@
+# detect_worker.py — ön etiketleme için kalıcı dedektör süreci (PreAnnotator / ProcessDetector)
+#
+# Protokol (satır tabanlı, UTF-8):
+#   stdin : görsel yolu
+#   stdout: "OK <n>" + n satır "<sınıf> <skor> <x1> <y1> <x2> <y2>"  (tam çözünürlük piksel)
+#           ya da "ERR <mesaj>"
+# stdin kapanınca çıkar. Teşhis çıktısı stderr'e.
+import argparse
+import sys
+
+import torch
+from PIL import Image, ImageOps
+from torchvision.models import detection
+from torchvision.transforms import functional as TF
+
+
+def parse():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--model", default="", help="Faster R-CNN checkpoint (boşsa COCO ön eğitimli)")
+    ap.add_argument("--classes", default="", help="Sınıf adları (satır başına bir); checkpoint için")
+    ap.add_argument("--min-score", type=float, default=0.3)
+    ap.add_argument("--device", default="cuda" if torch.cuda.is_available() else "cpu")
+    return ap.parse_args()
+
+
+def load_model(args):
+    if args.model:
+        names = [l.strip() for l in open(args.classes, encoding="utf-8") if l.strip()] if args.classes else []
+        ckpt = torch.load(args.model, map_location="cpu")
+        state = ckpt.get("model_state", ckpt) if isinstance(ckpt, dict) else ckpt
+        names = ckpt.get("classes", names) if isinstance(ckpt, dict) else names
+        m = detection.fasterrcnn_resnet50_fpn(weights=None, num_classes=len(names) + 1)
+        m.load_state_dict(state, strict=True)
+        labels = ["__background__"] + list(names)
+    else:
+        w = detection.FasterRCNN_ResNet50_FPN_Weights.DEFAULT
+        m = detection.fasterrcnn_resnet50_fpn(weights=w)
+        labels = w.meta["categories"]
+    return m.eval().to(args.device), labels
+
+
+def main():
+    args = parse()
+    model, labels = load_model(args)
+    print(f"detect_worker: {len(labels) - 1} sınıf, device={args.device}", file=sys.stderr, flush=True)
+
+    for line in sys.stdin:
+        path = line.strip()
+        if not path:
+            continue
+        try:
+            img = ImageOps.exif_transpose(Image.open(path)).convert("RGB")   # annotator ile aynı yön
+            with torch.no_grad():
+                out = model([TF.to_tensor(img).to(args.device)])[0]
+            rows = []
+            for box, lab, score in zip(out["boxes"].tolist(), out["labels"].tolist(), out["scores"].tolist()):
+                if score < args.min_score:
+                    continue
+                x1, y1, x2, y2 = box
+                rows.append(f"{labels[lab]} {score:.4f} {x1:.1f} {y1:.1f} {x2:.1f} {y2:.1f}")
+            sys.stdout.write("".join(f"{r}\n" for r in [f"OK {len(rows)}"] + rows))
+            sys.stdout.flush()
+        except Exception as e:
+            print(f"ERR {e}".replace("\n", " "), flush=True)
+
+
+if __name__ == "__main__":
+    main()
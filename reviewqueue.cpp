@@ -0,0 +1,150 @@
+// reviewqueue.cpp
+#include "reviewqueue.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr char kFileMagic[8] = {'Q','R','E','V','Q','0','0','1'};
+
+QVector<ReviewQueue::Box> toBoxes(const QVector<XYXY>& in)
+{
+    QVector<ReviewQueue::Box> out(in.size());
+    for (int i = 0; i < in.size(); ++i) {
+        const XYXY& s = in[i];
+        ReviewQueue::Box& d = out[i];
+        d.x1 = float(s.x1); d.y1 = float(s.y1); d.x2 = float(s.x2); d.y2 = float(s.y2);
+        d.cls = s.cls;
+    }
+    return out;
+}
+
+void writeBoxes(QDataStream& ds, const QVector<ReviewQueue::Box>& boxes)
+{
+    ds << quint32(boxes.size());
+    for (const ReviewQueue::Box& b : boxes)
+        ds << b.x1 << b.y1 << b.x2 << b.y2 << qint32(b.cls) << quint8(b.state) << b.iou;
+}
+
+bool readBoxes(QDataStream& ds, QVector<ReviewQueue::Box>* boxes)
+{
+    quint32 n = 0;
+    ds >> n;
+    if (ds.status() != QDataStream::Ok || n > (1u << 16)) return false;   // görsel başına makul üst sınır
+    boxes->resize(int(n));
+    for (ReviewQueue::Box& b : *boxes) {
+        qint32 cls = 0;
+        quint8 st  = 0;
+        ds >> b.x1 >> b.y1 >> b.x2 >> b.y2 >> cls >> st >> b.iou;
+        if (st > quint8(ReviewQueue::State::Unmatched)) return false;
+        b.cls   = cls;
+        b.state = ReviewQueue::State(st);
+    }
+    return ds.status() == QDataStream::Ok;
+}
+
+} // namespace
+
+ReviewQueue ReviewQueue::fromReport(const LabelCompare::Report& rep)
+{
+    ReviewQueue q;
+    q.oursDir  = rep.oursDir;
+    q.otherDir = rep.otherDir;
+    q.iouThr   = rep.iouThr;
+    q.mode     = rep.mode;
+
+    for (const LabelCompare::ImageResult& r : rep.images) {
+        if (r.c.mis == 0 && r.c.fp == 0 && r.c.fn == 0) continue;     // tam uyum: incelenecek bir şey yok
+        Item it;
+        it.stem         = r.stem;
+        it.c            = r.c;
+        it.disagreement = float(1.0 - r.c.similarity());
+        it.ours         = toBoxes(r.a);
+        it.other        = toBoxes(r.b);
+        for (const BoxMatch& m : r.pairs) {
+            if (m.a < 0 || m.b < 0 || m.a >= it.ours.size() || m.b >= it.other.size()) continue;
+            const State st = (it.ours[m.a].cls == it.other[m.b].cls) ? State::Match : State::ClassMismatch;
+            it.ours[m.a].state  = it.other[m.b].state = st;
+            it.ours[m.a].iou    = it.other[m.b].iou   = float(m.iou);
+        }
+        q.items.push_back(std::move(it));
+    }
+
+    // En çok anlaşmazlık önde; eşitlikte daha çok hatalı kutu, sonra stem (kararlı sıra)
+    std::sort(q.items.begin(), q.items.end(), [](const Item& x, const Item& y){
+        if (x.disagreement != y.disagreement) return x.disagreement > y.disagreement;
+        const int ex = x.c.mis + x.c.fp + x.c.fn, ey = y.c.mis + y.c.fp + y.c.fn;
+        if (ex != ey) return ex > ey;
+        return x.stem < y.stem;
+    });
+    return q;
+}
+
+bool ReviewQueue::save(const QString& path, QString* err) const
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) {
+        if (err) *err = f.errorString();
+        return false;
+    }
+    f.write(kFileMagic, sizeof(kFileMagic));
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_5_15);
+    ds << oursDir << otherDir << iouThr << qint32(mode) << quint32(items.size());
+    for (const Item& it : items) {
+        ds << it.stem << it.disagreement
+           << qint32(it.c.tp) << qint32(it.c.mis) << qint32(it.c.fp) << qint32(it.c.fn);
+        writeBoxes(ds, it.ours);
+        writeBoxes(ds, it.other);
+    }
+    if (!f.commit()) {
+        if (err) *err = f.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool ReviewQueue::load(const QString& path, QString* err)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        if (err) *err = f.errorString();
+        return false;
+    }
+    char magic[sizeof(kFileMagic)] = {};
+    if (f.read(magic, sizeof(magic)) != qint64(sizeof(magic)) || memcmp(magic, kFileMagic, sizeof(magic)) != 0) {
+        if (err) *err = QStringLiteral("not a review queue file");
+        return false;
+    }
+
+    QDataStream ds(&f);
+    ds.setVersion(QDataStream::Qt_5_15);
+    ReviewQueue q;
+    qint32  mode  = 0;
+    quint32 count = 0;
+    ds >> q.oursDir >> q.otherDir >> q.iouThr >> mode >> count;
+    q.mode = (mode == qint32(MatchMode::Optimal) || mode == qint32(MatchMode::PerClass)) ? MatchMode(mode)
+                                                                                      : MatchMode::Greedy;
+    q.items.reserve(int(qMin<quint32>(count, 1u << 20)));
+    for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; ++i) {
+        Item   it;
+        qint32 tp = 0, mis = 0, fp = 0, fn = 0;
+        ds >> it.stem >> it.disagreement >> tp >> mis >> fp >> fn;
+        it.c.tp = tp; it.c.mis = mis; it.c.fp = fp; it.c.fn = fn;
+        if (!readBoxes(ds, &it.ours) || !readBoxes(ds, &it.other)) break;
+        q.items.push_back(std::move(it));
+    }
+    if (ds.status() != QDataStream::Ok || quint32(q.items.size()) != count) {
+        if (err) *err = QStringLiteral("corrupt review queue (%1 / %2 items)").arg(q.items.size()).arg(count);
+        return false;
+    }
+    *this = std::move(q);
+    return true;
+}
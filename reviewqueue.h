@@ -0,0 +1,47 @@
+// reviewqueue.h
+#pragma once
+
+#include "labelcompare.h"
+
+#include <QString>
+#include <QVector>
+
+// ---------------------------
+// Karşılaştırma sonrası inceleme kuyruğu
+//  - LabelCompare raporundan (keepBoxes) yalnız farkı olan görseller, anlaşmazlığa göre azalan
+//  - Görsel başına iki kutu seti (normalize) + kutu durumu: eşleşti / sınıf tutmadı / karşılıksız
+//  - Kalıcı: eval/review_<zaman>.review (QDataStream); annotator inceleme modu buradan okur
+// ---------------------------
+class ReviewQueue
+{
+public:
+    enum class State : quint8 { Match, ClassMismatch, Unmatched };
+
+    struct Box {
+        float x1 = 0, y1 = 0, x2 = 0, y2 = 0;  // normalize (0..1)
+        int   cls = 0;
+        State state = State::Unmatched;
+        float iou = 0;                          // eşleştiyse karşı kutuyla IoU
+    };
+
+    struct Item {
+        QString      stem;
+        float        disagreement = 0;          // 1 - similarity
+        MatchCounts  c;
+        QVector<Box> ours, other;
+    };
+
+    QString        oursDir, otherDir;
+    double         iouThr = 0.90;
+    MatchMode      mode   = MatchMode::Greedy;
+    QVector<Item>  items;                       // anlaşmazlığa göre azalan
+
+    bool isEmpty() const { return items.isEmpty(); }
+    int  size() const    { return int(items.size()); }
+
+    // Eşleşme bilgisi yoksa (keepBoxes kapalı) kutular boş kalır, sıralama yine sayılardan
+    static ReviewQueue fromReport(const LabelCompare::Report& rep);
+
+    bool save(const QString& path, QString* err=nullptr) const;
+    bool load(const QString& path, QString* err=nullptr);
+};
@@ -0,0 +1,346 @@
+// thumbnailcache.cpp
+#include "thumbnailcache.h"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr char    kFileMagic[8] = {'Q','T','H','U','M','B','0','1'};
+constexpr quint32 kRecMagic     = 0x544D4252;   // "RBMT"
+
+// Diskteki kayıt başlığı (32 byte, dolgu yok)
+struct RecHeader
+{
+    quint32 magic;
+    quint32 len;      // JPEG bayt sayısı
+    quint64 key;      // yol hash'i
+    qint64  mtime;    // kaynak görselin mtime'ı (ms)
+    quint16 w, h;
+    quint32 reserved;
+};
+static_assert(sizeof(RecHeader) == 32, "RecHeader layout");
+
+// FNV-1a 64: yol → anahtar (hızlı, kriptografik olması gerekmiyor)
+quint64 fnv1a(const QByteArray& s)
+{
+    quint64 h = 1469598103934665603ULL;
+    for (char c : s) { h ^= quint8(c); h *= 1099511628211ULL; }
+    return h;
+}
+
+} // namespace
+
+ThumbnailCache::ThumbnailCache(QObject* parent)
+    : QObject(parent)
+{
+    m_mem.setMaxCost(48 * 1024);                   // KB cinsinden (~48 MB)
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+    m_pool.setThreadPriority(QThread::LowPriority);  // etiketleme akışını yavaşlatmasın
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    ++m_generation;
+    cancelPending();
+    m_pool.waitForDone();
+    closeStore();
+}
+
+// ---------------------------
+// Veri seti / depo dosyası
+// ---------------------------
+void ThumbnailCache::setDataset(const QString& rootDir)
+{
+    const QString root = rootDir.isEmpty() ? QString() : QDir(rootDir).absolutePath();
+    if (m_store.isOpen() && root == m_root) return;
+
+    // Beklemeden geç: uçuştaki işler eski nesilde kalır, depoya dokunmaz, sonuçları atılır
+    {
+        QMutexLocker lk(&m_queueMutex);
+        ++m_generation;
+        for (const QString& p : std::as_const(m_queue)) m_requested.remove(p);
+        m_queue.clear();
+        m_root = root;
+    }
+    m_mem.clear();
+
+    closeStore();
+
+    const QString base = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    const QString dir  = QDir(base.isEmpty() ? QDir::tempPath() : base).filePath("thumbs");
+    QDir().mkpath(dir);
+    const QString tag  = root.isEmpty() ? QStringLiteral("_misc") : root;
+    openStore(QDir(dir).filePath(QString::number(fnv1a(tag.toUtf8()), 16) + ".thumbs"));
+
+    bool compact = false;
+    {
+        QMutexLocker lk(&m_storeMutex);
+        compact = needsCompaction();
+    }
+    if (compact) {
+        const quint64 gen = m_generation;
+        m_pool.start([this, gen]{ compactStore(gen); });
+    }
+}
+
+void ThumbnailCache::openStore(const QString& file)
+{
+    QMutexLocker lk(&m_storeMutex);
+    m_store.setFileName(file);
+    if (!m_store.open(QIODevice::ReadWrite)) {
+        qWarning() << "[Thumbs] cannot open cache" << file << m_store.errorString();
+        return;
+    }
+    char magic[sizeof(kFileMagic)] = {};
+    if (m_store.size() < qint64(sizeof(kFileMagic))
+        || m_store.read(magic, sizeof(magic)) != qint64(sizeof(magic))
+        || memcmp(magic, kFileMagic, sizeof(magic)) != 0) {
+        m_store.resize(0);                          // yeni ya da başka sürüm → baştan
+        m_store.seek(0);
+        m_store.write(kFileMagic, sizeof(kFileMagic));
+        m_store.flush();
+    }
+    scanStore();
+}
+
+void ThumbnailCache::closeStore()
+{
+    QMutexLocker lk(&m_storeMutex);
+    if (m_map) { m_store.unmap(m_map); m_map = nullptr; }
+    m_mapSize = 0;
+    m_index.clear();
+    if (m_store.isOpen()) m_store.close();
+}
+
+// Açılışta tek geçiş: kayıt başlıklarını mmap üzerinden oku, anahtar → konum indeksi kur.
+// Aynı anahtarın sonraki kaydı öncekini geçersiz kılar. Yarım kalmış son kayıt kesilir.
+void ThumbnailCache::scanStore()
+{
+    const qint64 size = m_store.size();
+    m_map     = size > qint64(sizeof(kFileMagic)) ? m_store.map(0, size) : nullptr;
+    m_mapSize = m_map ? size : 0;
+
+    qint64 off = sizeof(kFileMagic);
+    while (m_map && off + qint64(sizeof(RecHeader)) <= m_mapSize) {
+        RecHeader h;
+        memcpy(&h, m_map + off, sizeof(h));
+        const qint64 dataOff = off + qint64(sizeof(RecHeader));
+        if (h.magic != kRecMagic || dataOff + h.len > m_mapSize) break;
+        m_index.insert(h.key, Entry{dataOff, h.len, h.mtime});
+        off = dataOff + h.len;
+    }
+    if (off < size) {                              // çökme sonrası bozuk kuyruk
+        qWarning() << "[Thumbs] truncating damaged cache tail at" << off;
+        if (m_map) { m_store.unmap(m_map); m_map = nullptr; m_mapSize = 0; }
+        m_store.resize(off);
+        if (off > qint64(sizeof(kFileMagic))) {
+            m_map     = m_store.map(0, off);
+            m_mapSize = m_map ? off : 0;
+        }
+    }
+}
+
+bool ThumbnailCache::needsCompaction() const
+{
+    if (!m_store.isOpen()) return false;
+    qint64 live = sizeof(kFileMagic);
+    for (const Entry& e : m_index) live += qint64(sizeof(RecHeader)) + e.len;
+    const qint64 size = m_store.size(), dead = size - live;
+    return size > kMaxStoreBytes || (dead > live && dead > (8ll << 20));
+}
+
+// Canlı kayıtlar (en yeniler önce, sınırın 3/4'üne kadar) yeni dosyaya; eski dosya atomik değişir.
+// Kilit boyunca üretim bekler; GUI'ye dokunmaz (bellek önbelleği ve kuyruk ayrı kilitte).
+void ThumbnailCache::compactStore(quint64 gen)
+{
+    QMutexLocker lk(&m_storeMutex);
+    if (gen != m_generation || !m_store.isOpen() || !needsCompaction()) return;
+
+    QVector<QPair<quint64, Entry>> live;
+    live.reserve(m_index.size());
+    for (auto it = m_index.cbegin(); it != m_index.cend(); ++it) live.push_back({it.key(), it.value()});
+    std::sort(live.begin(), live.end(), [](const auto& a, const auto& b){ return a.second.offset > b.second.offset; });
+
+    const QString path = m_store.fileName();
+    const qint64  before = m_store.size();
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) { qWarning() << "[Thumbs] compaction:" << out.errorString(); return; }
+    out.write(kFileMagic, sizeof(kFileMagic));
+    qint64 budget = kMaxStoreBytes * 3 / 4, kept = 0;
+    QByteArray blob;
+    for (const auto& [key, e] : std::as_const(live)) {
+        const qint64 recSize = qint64(sizeof(RecHeader)) + e.len;
+        if (recSize > budget) break;
+        if (!readBlob(e, &blob)) continue;
+        RecHeader h{};
+        if (m_map && e.offset <= m_mapSize) memcpy(&h, m_map + e.offset - sizeof(RecHeader), sizeof(h));
+        else if (!m_store.seek(e.offset - qint64(sizeof(RecHeader)))
+                 || m_store.read(reinterpret_cast<char*>(&h), sizeof(h)) != qint64(sizeof(h))) continue;
+        if (h.magic != kRecMagic || h.key != key) continue;
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(blob);
+        budget -= recSize;
+        ++kept;
+    }
+
+    // Eski dosya kapanmadan yerine yazılamaz (Windows); commit başarısızsa eskisi yeniden açılır
+    if (m_map) { m_store.unmap(m_map); m_map = nullptr; }
+    m_mapSize = 0;
+    m_index.clear();
+    m_store.close();
+    const bool ok = out.commit();
+    if (!ok) qWarning() << "[Thumbs] compaction failed:" << out.errorString();
+    if (!m_store.open(QIODevice::ReadWrite)) {
+        qWarning() << "[Thumbs] cannot reopen cache" << path << m_store.errorString();
+        return;
+    }
+    scanStore();
+    if (ok) qDebug() << "[Thumbs] compacted" << before << "->" << m_store.size() << "bytes," << kept << "records";
+}
+
+bool ThumbnailCache::readBlob(const Entry& e, QByteArray* out)
+{
+    // m_storeMutex tutuluyor
+    if (m_map && e.offset + e.len <= m_mapSize) {
+        *out = QByteArray(reinterpret_cast<const char*>(m_map + e.offset), int(e.len));
+        return true;
+    }
+    // Açılıştan sonra eklenen kayıtlar mmap dışında: normal okuma
+    if (!m_store.isOpen() || !m_store.seek(e.offset)) return false;
+    *out = m_store.read(e.len);
+    return out->size() == int(e.len);
+}
+
+void ThumbnailCache::appendBlob(quint64 gen, quint64 key, qint64 mtime, const QSize& sz, const QByteArray& jpeg)
+{
+    QMutexLocker lk(&m_storeMutex);
+    if (!m_store.isOpen() || gen != m_generation) return;   // veri seti değişti: başka depo
+
+    RecHeader h{};
+    h.magic = kRecMagic;
+    h.len   = quint32(jpeg.size());
+    h.key   = key;
+    h.mtime = mtime;
+    h.w     = quint16(sz.width());
+    h.h     = quint16(sz.height());
+
+    const qint64 off = m_store.size();
+    if (!m_store.seek(off)
+        || m_store.write(reinterpret_cast<const char*>(&h), sizeof(h)) != qint64(sizeof(h))
+        || m_store.write(jpeg) != jpeg.size()) {
+        qWarning() << "[Thumbs] append failed:" << m_store.errorString();
+        m_store.resize(off);
+        return;
+    }
+    m_index.insert(key, Entry{off + qint64(sizeof(h)), h.len, mtime});
+}
+
+// ---------------------------
+// İstek kuyruğu
+// ---------------------------
+QPixmap ThumbnailCache::thumbnail(const QString& path)
+{
+    if (path.isEmpty()) return {};
+    if (const QPixmap* p = m_mem.object(path)) return *p;   // üretilemeyenler boş pixmap olarak durur
+
+    bool start = false;
+    {
+        QMutexLocker lk(&m_queueMutex);
+        if (m_requested.contains(path)) return {};
+        m_requested.insert(path);
+        m_queue.append(path);
+        while (m_queue.size() > kMaxQueue)
+            m_requested.remove(m_queue.takeFirst());        // ekrandan çoktan çıkmış satırlar
+        if (m_drainers < m_pool.maxThreadCount()) { ++m_drainers; start = true; }
+    }
+    if (start) m_pool.start([this]{ drain(); });
+    return {};
+}
+
+void ThumbnailCache::cancelPending()
+{
+    QMutexLocker lk(&m_queueMutex);
+    for (const QString& p : std::as_const(m_queue)) m_requested.remove(p);
+    m_queue.clear();
+}
+
+void ThumbnailCache::drain()
+{
+    for (;;) {
+        QString path, root;
+        quint64 gen = 0;
+        {
+            QMutexLocker lk(&m_queueMutex);
+            if (m_queue.isEmpty()) { --m_drainers; return; }
+            path = m_queue.takeLast();                       // LIFO: en yeni görünür satır
+            gen  = m_generation;                             // kök ile aynı kilit altında: tutarlı çift
+            root = m_root;
+        }
+        const QImage img = produce(path, root, gen);
+        QMetaObject::invokeMethod(this, [this, gen, path, img]{ onReady(gen, path, img); },
+                                  Qt::QueuedConnection);
+    }
+}
+
+QImage ThumbnailCache::produce(const QString& path, const QString& root, quint64 gen)
+{
+    const qint64  mtime = QFileInfo(path).lastModified().toMSecsSinceEpoch();
+    const QString rel   = (!root.isEmpty() && path.startsWith(root + '/'))
+                          ? path.mid(root.size() + 1) : path;
+    const quint64 key   = fnv1a(rel.toUtf8());
+
+    QByteArray blob;
+    {
+        QMutexLocker lk(&m_storeMutex);
+        if (gen != m_generation) return {};                  // açık depo başka veri setinin
+        auto it = m_index.constFind(key);
+        if (it != m_index.cend() && it->mtime == mtime && !readBlob(*it, &blob)) blob.clear();
+    }
+    if (!blob.isEmpty()) {
+        QImage img;
+        if (img.loadFromData(blob, "JPG")) return img;
+    }
+
+    // Üret: sadece hedef boyutta decode (JPEG'de DCT ölçekleme, tam görüntü belleğe alınmaz)
+    QImageReader r(path);
+    r.setAutoTransform(true);
+    const QSize full = r.size();                             // başlıktan, decode yok
+    if (full.isValid() && (full.width() > kSize || full.height() > kSize))
+        r.setScaledSize(full.scaled(kSize, kSize, Qt::KeepAspectRatio));
+    QImage img = r.read();
+    if (img.isNull()) return {};
+    if (img.width() > kSize || img.height() > kSize)
+        img = img.scaled(kSize, kSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    QByteArray jpeg;
+    QBuffer buf(&jpeg);
+    buf.open(QIODevice::WriteOnly);
+    if (img.convertToFormat(QImage::Format_RGB32).save(&buf, "JPG", 80))
+        appendBlob(gen, key, mtime, img.size(), jpeg);
+    return img;
+}
+
+void ThumbnailCache::onReady(quint64 gen, const QString& path, const QImage& img)
+{
+    {
+        QMutexLocker lk(&m_queueMutex);
+        m_requested.remove(path);
+    }
+    if (gen != m_generation) return;
+    QPixmap* px = new QPixmap(img.isNull() ? QPixmap() : QPixmap::fromImage(img));
+    m_mem.insert(path, px, qMax(1, img.width() * img.height() * 4 / 1024));
+    emit thumbnailReady(path);
+}
@@ -0,0 +1,78 @@
+// thumbnailcache.h
+#pragma once
+
+#include <QObject>
+#include <QCache>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QPixmap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
+
+// Veri seti başına tek dosyada kalıcı küçük resim önbelleği.
+//  - Dosya: <cache>/thumbs/<kök klasör hash>.thumbs — başlık + ardışık kayıtlar
+//      [RecHeader][JPEG baytları] ...   (sadece sona ekleme; açılışta mmap ile taranır)
+//  - Anahtar: yol hash'i + dosya mtime'ı (görsel değişirse kayıt geçersiz, yenisi eklenir)
+//  - Depo sadece büyüdüğü için açılışta ölü kayıt oranı / kMaxStoreBytes aşımı varsa arka planda
+//    sıkıştırılır: canlı kayıtların en yenileri yeni dosyaya yazılır
+//  - Eksikler düşük öncelikli worker havuzunda QImageReader::setScaledSize ile üretilir
+//    (JPEG'de libjpeg DCT ölçekleme → tam çözünürlük decode yok)
+//  - GUI tarafında küçük bir QPixmap bellek önbelleği; hazır olunca thumbnailReady(path)
+class ThumbnailCache : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr int kSize = 96;     // uzun kenar (px)
+
+    explicit ThumbnailCache(QObject* parent=nullptr);
+    ~ThumbnailCache() override;
+
+    void setDataset(const QString& rootDir);   // boş: "karışık" dosyalar için ortak önbellek
+
+    // Hazırsa döner; değilse üretim kuyruğuna alır ve boş QPixmap döner (GUI thread)
+    QPixmap thumbnail(const QString& path);
+    void    cancelPending();                   // hızlı kaydırmada eski istekleri at
+
+signals:
+    void thumbnailReady(const QString& path);
+
+private:
+    struct Entry { qint64 offset = 0; quint32 len = 0; qint64 mtime = 0; };
+
+    static constexpr int    kMaxQueue      = 512;          // görünmeyen eski satırlar kuyruğu şişirmesin
+    static constexpr qint64 kMaxStoreBytes = 256ll << 20;  // depo dosyası üst sınırı (sıkıştırma tetikler)
+
+    void    openStore(const QString& file);
+    void    closeStore();
+    void    scanStore();                       // mmap üzerinden indeks kur
+    bool    needsCompaction() const;           // m_storeMutex tutuluyor
+    void    compactStore(quint64 gen);         // worker
+    void    drain();                           // worker
+    // worker: önbellekten oku ya da üret + ekle (gen eskiyse depoya dokunmaz)
+    QImage  produce(const QString& path, const QString& root, quint64 gen);
+    bool    readBlob(const Entry& e, QByteArray* out);
+    void    appendBlob(quint64 gen, quint64 key, qint64 mtime, const QSize& sz, const QByteArray& jpeg);
+    void    onReady(quint64 gen, const QString& path, const QImage& img);
+
+    // Kalıcı depo (m_storeMutex)
+    QMutex                 m_storeMutex;
+    QFile                  m_store;
+    uchar*                 m_map     = nullptr;
+    qint64                 m_mapSize = 0;
+    QHash<quint64, Entry>  m_index;
+
+    // İş kuyruğu (m_queueMutex); LIFO: en son istenen (görünür) önce
+    QMutex                 m_queueMutex;
+    QStringList            m_queue;
+    QSet<QString>          m_requested;        // kuyrukta veya üretimde
+    int                    m_drainers = 0;
+
+    QString                m_root;             // GUI'de m_queueMutex altında yazılır, worker orada okur
+    std::atomic<quint64>   m_generation{0};    // veri seti değişince eski sonuçları ele (m_queueMutex altında artar)
+    QCache<QString, QPixmap> m_mem;            // GUI thread
+    QThreadPool            m_pool;
+};
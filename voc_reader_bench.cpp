@@ -0,0 +1,148 @@
+// voc_reader_bench.cpp
+// VOC XML okuma: eski yol (QString + etiket başına yeni QRegularExpression) ile tek geçişli
+// QXmlStreamReader okuyucunun (readVOCxmlNorm) karşılaştırması. Dosyalar geçici klasöre üretilir.
+//   voc_reader_bench [dosya sayısı=10000] [dosya başına nesne=8]
+#include "labelcompare.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const QStringList kClasses = {"person", "car", "bicycle", "dog", "cat", "bus", "truck", "chair"};
+
+QByteArray makeVoc(QRandomGenerator& rng, int objects, int W, int H)
+{
+    QByteArray x;
+    x += "<annotation>\n  <folder>images</folder>\n  <filename>img.jpg</filename>\n"
+         "  <size>\n    <width>" + QByteArray::number(W) + "</width>\n    <height>" + QByteArray::number(H) +
+         "</height>\n    <depth>3</depth>\n  </size>\n  <segmented>0</segmented>\n";
+    for (int i = 0; i < objects; ++i) {
+        const int x1 = int(rng.bounded(W - 40)), y1 = int(rng.bounded(H - 40));
+        const int x2 = x1 + 8 + int(rng.bounded(32)), y2 = y1 + 8 + int(rng.bounded(32));
+        x += "  <object>\n    <name>" + kClasses[int(rng.bounded(kClasses.size()))].toUtf8() +
+             "</name>\n    <pose>Unspecified</pose>\n    <truncated>0</truncated>\n    <difficult>0</difficult>\n"
+             "    <bndbox>\n      <xmin>" + QByteArray::number(x1) + "</xmin>\n      <ymin>" + QByteArray::number(y1) +
+             "</ymin>\n      <xmax>" + QByteArray::number(x2) + "</xmax>\n      <ymax>" + QByteArray::number(y2) +
+             "</ymax>\n    </bndbox>\n  </object>\n";
+    }
+    x += "</annotation>\n";
+    return x;
+}
+
+// Önceki labelcompare readVOCxmlNorm gövdesi (sınıf her zaman 0)
+QVector<XYXY> legacyReadVOC(const QString& xmlPath)
+{
+    QVector<XYXY> out;
+    QFile f(xmlPath);
+    if (!f.open(QIODevice::ReadOnly|QIODevice::Text)) return out;
+    const QString xml = QString::fromUtf8(f.readAll());
+    f.close();
+
+    auto getTag = [&](const QString& tag)->QString{
+        QRegularExpression rx(QString("<%1>([^<]+)</%1>").arg(tag));
+        auto m = rx.match(xml);
+        return m.hasMatch() ? m.captured(1).trimmed() : QString();
+    };
+    const int W = getTag("width").toInt();
+    const int H = getTag("height").toInt();
+    if (W<=0 || H<=0) return out;
+
+    QRegularExpression rxObj("<object>([\\s\\S]*?)</object>");
+    auto it = rxObj.globalMatch(xml);
+    while (it.hasNext()) {
+        const QString seg = it.next().captured(1);
+        auto val = [&](const char* tag)->int{
+            QRegularExpression rr(QString("<%1>([^<]+)</%1>").arg(tag));
+            auto mm = rr.match(seg);
+            return mm.hasMatch() ? mm.captured(1).toInt() : 0;
+        };
+        const int xmin = val("xmin"), ymin = val("ymin"), xmax = val("xmax"), ymax = val("ymax");
+        if (xmax>xmin && ymax>ymin) {
+            XYXY b;
+            b.cls = 0;
+            b.x1 = double(xmin)/W; b.y1 = double(ymin)/H;
+            b.x2 = double(xmax)/W; b.y2 = double(ymax)/H;
+            out.push_back(b);
+        }
+    }
+    return out;
+}
+
+template <typename Fn>
+double bench(QTextStream& out, const char* name, const QStringList& files, Fn fn)
+{
+    QElapsedTimer t;
+    t.start();
+    qint64 boxes = 0;
+    for (const QString& p : files) boxes += fn(p).size();
+    const double ms = t.nsecsElapsed() / 1e6;
+    out << QString("%1 %2 ms  %3 dosya/s  (%4 kutu)\n")
+               .arg(QString::fromLatin1(name), -28)
+               .arg(ms, 9, 'f', 1)
+               .arg(files.size() / (ms / 1000.0), 10, 'f', 0)
+               .arg(boxes);
+    out.flush();
+    return ms;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments().mid(1);
+    const int count   = args.size() > 0 ? args[0].toInt() : 10000;
+    const int objects = args.size() > 1 ? args[1].toInt() : 8;
+
+    QTemporaryDir tmp;
+    if (!tmp.isValid()) return 2;
+    const QDir dir(tmp.path());
+    QFile cf(dir.filePath("classes.txt"));
+    if (!cf.open(QIODevice::WriteOnly)) return 2;
+    cf.write(kClasses.join('\n').toUtf8() + '\n');
+    cf.close();
+
+    QRandomGenerator rng(42);
+    QStringList files;
+    files.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const QString p = dir.filePath(QString("img_%1.xml").arg(i));
+        QFile f(p);
+        if (!f.open(QIODevice::WriteOnly)) return 2;
+        f.write(makeVoc(rng, objects, 1280, 720));
+        files << p;
+    }
+
+    QTextStream out(stdout);
+    out << "files=" << count << " objects/file=" << objects << "\n";
+
+    // Eşdeğerlik: aynı kutular (eski okuyucu sınıfı hep 0 verir; yenisi classes.txt'ten)
+    const ClassIndex classes = loadClassIndex(dir.path());
+    bool same = true, named = true;
+    for (int i = 0; i < std::min(count, 200); ++i) {
+        const QVector<XYXY> a = legacyReadVOC(files[i]);
+        const QVector<XYXY> b = readVOCxmlNorm(files[i], &classes);
+        same = same && a.size() == b.size();
+        for (int k = 0; same && k < a.size(); ++k)
+            same = std::fabs(a[k].x1 - b[k].x1) < 1e-12 && std::fabs(a[k].y2 - b[k].y2) < 1e-12;
+        for (const XYXY& x : b) named = named && x.cls >= 0;
+    }
+    out << "identical boxes: " << (same ? "yes" : "NO") << "  names mapped: " << (named ? "yes" : "NO") << "\n";
+
+    // Önce bir tur okuyup sayfa önbelleğini ısıt (iki yol aynı koşulda ölçülsün)
+    for (const QString& p : files) { QFile f(p); if (f.open(QIODevice::ReadOnly)) f.readAll(); }
+
+    const double tOld = bench(out, "regex (legacy)", files, [](const QString& p){ return legacyReadVOC(p); });
+    const double tNew = bench(out, "QXmlStreamReader", files, [&](const QString& p){ return readVOCxmlNorm(p, &classes); });
+    out << QString("speedup: %1x\n").arg(tOld / tNew, 0, 'f', 1);
+    return (same && named) ? 0 : 1;
+}